@@ -33,7 +33,7 @@ class Colvar_traj(object):
         """Sets the name of the variable"""
         self._name = name
         self._step = np.zeros(shape=(0), dtype=np.int64)
-        self._colvar = np.zeros(shape=(0), dtype=np.float)
+        self._colvar = np.zeros(shape=(0), dtype=np.float64)
 
     def __len__(self):
         """Returns the length of the trajectory"""
@@ -108,6 +108,9 @@ class Colvars_traj(object):
     _found = {}
     _frame = -1
 
+    # Identifier at the beginning of each header of a binary colvars.traj
+    _binary_magic = b'CVTRAJB\n'
+
     def __init__(self, filenames=None, first=0, last=-1, every=1):
         """
         Initialize from the given list of colvars.traj files
@@ -168,15 +171,63 @@ class Colvars_traj(object):
         for v in self._keys[1:]:
             text = line[self._start[v]:self._end[v]]
             v_v = np.fromstring(text.lstrip(' (').rstrip(') '), sep=',')
-            n_d = len(v_v)
-            if (v not in self._colvars):
-                self._colvars[v] = Colvar_traj(v)
-                self._colvars[v]._set_num_dimensions(n_d)
-            cv = self._colvars[v]
-            n = len(cv)
-            cv._resize(n+1)
-            cv.steps[n] = step
+            self._append_value(v, step, v_v)
+
+    def _append_value(self, v, step, v_v):
+        """
+        Append the value v_v of the variable v at the given step
+        """
+        n_d = len(v_v)
+        if (v not in self._colvars):
+            self._colvars[v] = Colvar_traj(v)
+            self._colvars[v]._set_num_dimensions(n_d)
+        cv = self._colvars[v]
+        n = len(cv)
+        cv._resize(n+1)
+        cv.steps[n] = step
+        if (n_d > 1):
             cv.values[n] = v_v
+        else:
+            cv.values[n] = v_v[0]
+
+    def _read_binary_file(self, f, list_variables, first, last, every):
+        """
+        Read a colvars.traj file written in the binary format (see
+        colvarsTrajFormat): each header lists the labels and numbers of
+        columns of the records that follow it
+        """
+        groups = []
+        num_columns = 0
+        last_step = -1
+        while True:
+            head = f.read(8)
+            if (len(head) < 8): break
+            if (head == self._binary_magic):
+                version, length = np.frombuffer(f.read(8), dtype='<u4')
+                if (version != 1):
+                    raise ValueError("Error: unsupported version or byte "
+                                     "order of binary trajectory.")
+                lines = f.read(length).decode('utf-8').splitlines()
+                groups = [(l.split()[0], int(l.split()[1])) for l in lines[1:]]
+                num_columns = sum([width for (label, width) in groups])
+                self._keys = ['step'] + [label for (label, width) in groups]
+                continue
+            if list_variables:
+                return self.variables
+            step = np.frombuffer(head, dtype='<i8')[0]
+            values = np.frombuffer(f.read(8*num_columns), dtype='<f8')
+            if (step == last_step): continue
+            if ((self._frame >= first) and (self._frame <= last) and
+                (self._frame % every == 0)):
+                offset = 0
+                for (label, width) in groups:
+                    self._append_value(label, step,
+                                       values[offset:offset+width])
+                    offset += width
+            self._frame += 1
+            last_step = step
+        if list_variables:
+            return self.variables
 
 
     def read_files(self, filenames, list_variables=False,
@@ -199,7 +250,18 @@ class Colvars_traj(object):
         if (last == -1):
             last = np.int64(np.iinfo(np.int64).max)
         last_step = -1
-        for f in [open(filename) for filename in filenames]:
+        for filename in filenames:
+            f = open(filename, 'rb')
+            if (f.read(8) == self._binary_magic):
+                f.seek(0)
+                r = self._read_binary_file(f, list_variables,
+                                           first, last, every)
+                f.close()
+                if list_variables:
+                    return r
+                continue
+            f.close()
+            f = open(filename)
             for line in f:
                 if (len(line) == 0): continue
                 if (line[:1] == "@"): continue # xmgr file metadata
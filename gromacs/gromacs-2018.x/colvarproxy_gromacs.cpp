@@ -563,12 +563,11 @@ int colvarproxy_gromacs::init_atom(int atom_number)
   // GROMACS uses zero-based arrays.
   int aid = atom_number-1;
 
-  for (size_t i = 0; i < atoms_ids.size(); i++) {
-    if (atoms_ids[i] == aid) {
-      // this atom id was already recorded
-      atoms_ncopies[i] += 1;
-      return i;
-    }
+  int const slot = find_atom_slot(aid);
+  if (slot >= 0) {
+    // this atom id was already recorded
+    atoms_ncopies[slot] += 1;
+    return slot;
   }
 
   aid = check_atom_id(atom_number);
@@ -252,6 +252,9 @@ double colvarproxy_lammps::compute()
   for (size_t i = 0; i < atoms_new_colvar_forces.size(); i++) {
     atoms_new_colvar_forces[i].reset();
   }
+  for (size_t i = 0; i < atom_groups_new_colvar_forces.size(); i++) {
+    atom_groups_new_colvar_forces[i].reset();
+  }
 
   bias_energy = 0.0;
 
@@ -427,12 +430,11 @@ int colvarproxy_lammps::init_atom(int atom_number)
 {
   int aid = atom_number;
 
-  for (size_t i = 0; i < atoms_ids.size(); i++) {
-    if (atoms_ids[i] == aid) {
-      // this atom id was already recorded
-      atoms_ncopies[i] += 1;
-      return i;
-    }
+  int const slot = find_atom_slot(aid);
+  if (slot >= 0) {
+    // this atom id was already recorded
+    atoms_ncopies[slot] += 1;
+    return slot;
   }
 
   aid = check_atom_id(atom_number);
@@ -447,3 +449,51 @@ int colvarproxy_lammps::init_atom(int atom_number)
   return index;
 }
 
+
+int colvarproxy_lammps::init_atoms(std::vector<int> const &atom_numbers,
+                                   std::vector<int> &indices)
+{
+  std::vector<int> ids(atom_numbers.size());
+  for (size_t i = 0; i < atom_numbers.size(); i++) {
+    // check only the atoms that have not been requested before
+    int const aid = atom_numbers[i];
+    ids[i] = (find_atom_slot(aid) >= 0) ? aid : check_atom_id(atom_numbers[i]);
+  }
+
+  int const error_code = colvarproxy::init_atom_slots(ids, indices);
+  // add entries for the LAMMPS-specific fields
+  atoms_types.resize(atoms_ids.size(), 0);
+
+  return error_code;
+}
+
+
+void colvarproxy_lammps::reserve_atoms(size_t num_atoms)
+{
+  colvarproxy::reserve_atoms(num_atoms);
+  atoms_types.reserve(atoms_types.size() + num_atoms);
+}
+
+
+int colvarproxy_lammps::init_atom_group(std::vector<int> const &atoms_ids)
+{
+  if (cvm::debug())
+    log("Requesting a scalable group of size "+cvm::to_str(atoms_ids.size())+
+        " for collective variables calculation.\n");
+
+  // reuse an identical group, if it was already requested
+  for (size_t ig = 0; ig < atom_groups_atoms.size(); ig++) {
+    if (atom_groups_atoms[ig] == atoms_ids) {
+      atom_groups_ncopies[ig] += 1;
+      return ig;
+    }
+  }
+
+  // the atom IDs were already checked by check_atom_id(); the total mass
+  // and charge of the group are computed by the fix at setup
+  int const index = add_atom_group_slot(atom_groups_ids.size());
+  atom_groups_atoms.push_back(atoms_ids);
+
+  return index;
+}
+
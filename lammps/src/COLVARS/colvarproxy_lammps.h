@@ -47,6 +47,9 @@ class colvarproxy_lammps : public colvarproxy {
 
   std::vector<int> atoms_types;
 
+  // IDs of the atoms of each scalable group (centers of mass computed by the fix)
+  std::vector<std::vector<int> > atom_groups_atoms;
+
   MPI_Comm inter_comm;        // MPI comm with 1 root proc from each world
   int inter_me, inter_num;    // rank for the inter replica comm
 
@@ -114,9 +117,20 @@ class colvarproxy_lammps : public colvarproxy {
 
   int init_atom(int atom_number);
   int check_atom_id(int atom_number);
+  int init_atoms(std::vector<int> const &atom_numbers,
+                 std::vector<int> &indices);
+  void reserve_atoms(size_t num_atoms);
 
   inline std::vector<int> *modify_atom_types() { return &atoms_types; }
 
+  int scalable_group_coms() { return COLVARS_OK; }
+  int init_atom_group(std::vector<int> const &atoms_ids);
+
+  inline std::vector<std::vector<int> > const *get_atom_groups_atoms() const
+  {
+    return &atom_groups_atoms;
+  }
+
   virtual int replica_enabled();
   virtual int replica_index();
   virtual int num_replicas();
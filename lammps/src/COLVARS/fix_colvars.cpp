@@ -57,7 +57,8 @@ static const char colvars_pub[] =
   " note =    {doi: 10.1080/00268976.2013.813594}\n"
   "}\n\n";
 
-/* struct for packed data communication of coordinates and forces. */
+/* struct for packed data communication of coordinates and forces.
+ * with collective communication, tag is the index of the atom in taglist. */
 struct LAMMPS_NS::commdata {
   int tag,type;
   double x,y,z,m,q;
@@ -281,6 +282,7 @@ int FixColvars::instances=0;
   output  <output prefix>   (defaults to 'out')
   seed    <integer>         (seed for RNG, defaults to '1966')
   tstat   <fix label>       (label of thermostatting fix)
+  gather  <collective|serial> (communication pattern, defaults to 'collective')
 
  ***************************************************************/
 
@@ -307,6 +309,7 @@ FixColvars::FixColvars(LAMMPS *lmp, int narg, char **arg) :
   conf_file = strdup(arg[3]);
   rng_seed = 1966;
   unwrap_flag = 1;
+  gather_flag = 1;
 
   inp_name = nullptr;
   out_name = nullptr;
@@ -333,6 +336,14 @@ FixColvars::FixColvars(LAMMPS *lmp, int narg, char **arg) :
       } else {
         error->all(FLERR,"Incorrect fix colvars unwrap flag");
       }
+    } else if (0 == strcmp(arg[argsdone], "gather")) {
+      if (0 == strcmp(arg[argsdone+1], "collective")) {
+        gather_flag = 1;
+      } else if (0 == strcmp(arg[argsdone+1], "serial")) {
+        gather_flag = 0;
+      } else {
+        error->all(FLERR,"Incorrect fix colvars gather flag");
+      }
     } else if (0 == strcmp(arg[argsdone], "tstat")) {
       tmp_name = strdup(arg[argsdone+1]);
     } else {
@@ -353,6 +364,19 @@ FixColvars::FixColvars(LAMMPS *lmp, int narg, char **arg) :
   force_buf = nullptr;
   proxy = nullptr;
   idmap = nullptr;
+  local_map = nullptr;
+  ngather = 0;
+  gather_buf = nullptr;
+  gather_counts = gather_displs = nullptr;
+  force_counts = force_displs = nullptr;
+  num_groups = 0;
+  group_offsets = nullptr;
+  group_tags = nullptr;
+  group_masses = nullptr;
+  group_buf = nullptr;
+  group_local_offsets = nullptr;
+  group_local = nullptr;
+  group_local_max = 0;
 
   /* storage required to communicate a single coordinate or force. */
   size_one = sizeof(struct commdata);
@@ -371,6 +395,18 @@ FixColvars::~FixColvars()
   memory->sfree(out_name);
   memory->sfree(tmp_name);
   memory->sfree(comm_buf);
+  memory->destroy(local_map);
+  memory->sfree(gather_buf);
+  memory->destroy(gather_counts);
+  memory->destroy(gather_displs);
+  memory->destroy(force_counts);
+  memory->destroy(force_displs);
+  memory->destroy(group_offsets);
+  memory->destroy(group_tags);
+  memory->destroy(group_masses);
+  memory->destroy(group_buf);
+  memory->destroy(group_local_offsets);
+  memory->destroy(group_local);
 
   if (proxy) {
     delete proxy;
@@ -393,6 +429,8 @@ int FixColvars::setmask()
   mask |= MIN_POST_FORCE;
   mask |= POST_FORCE;
   mask |= POST_FORCE_RESPA;
+  mask |= PRE_NEIGHBOR;
+  mask |= MIN_PRE_NEIGHBOR;
   mask |= END_OF_STEP;
   mask |= POST_RUN;
   return mask;
@@ -489,8 +527,62 @@ void FixColvars::one_time_init()
       taglist[i] = tl[i];
       inthash_insert(hashtable, tl[i], i);
     }
+
+    if (gather_flag) {
+      ngather = num_coords;
+      memory->create(gather_buf,ngather,"colvars:gather_buf");
+      memory->create(gather_counts,comm->nprocs,"colvars:gather_counts");
+      memory->create(gather_displs,comm->nprocs,"colvars:gather_displs");
+      memory->create(force_counts,comm->nprocs,"colvars:force_counts");
+      memory->create(force_displs,comm->nprocs,"colvars:force_displs");
+    }
   }
   MPI_Bcast(taglist, num_coords, MPI_LMP_TAGINT, 0, world);
+
+  // send the atom IDs of all scalable atom groups to all nodes.
+
+  if (me == 0)
+    num_groups = proxy->get_atom_group_ids()->size();
+
+  MPI_Bcast(&num_groups, 1, MPI_INT, 0, world);
+  memory->create(group_offsets,num_groups+1,"colvars:group_offsets");
+  memory->create(group_masses,num_groups,"colvars:group_masses");
+  memory->create(group_buf,3*num_groups,"colvars:group_buf");
+  memory->create(group_local_offsets,num_groups+1,"colvars:group_local_offsets");
+
+  if (me == 0) {
+    std::vector<std::vector<int> > const &ga = *(proxy->get_atom_groups_atoms());
+    group_offsets[0] = 0;
+    for (i=0; i < num_groups; ++i)
+      group_offsets[i+1] = group_offsets[i] + ga[i].size();
+  }
+  MPI_Bcast(group_offsets, num_groups+1, MPI_INT, 0, world);
+  memory->create(group_tags,group_offsets[num_groups],"colvars:group_tags");
+
+  if (me == 0) {
+    std::vector<std::vector<int> > const &ga = *(proxy->get_atom_groups_atoms());
+    for (i=0; i < num_groups; ++i)
+      for (tmp=0; tmp < (int) ga[i].size(); ++tmp)
+        group_tags[group_offsets[i]+tmp] = ga[i][tmp];
+  }
+  MPI_Bcast(group_tags, group_offsets[num_groups], MPI_LMP_TAGINT, 0, world);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void FixColvars::setup_pre_neighbor()
+{
+  pre_neighbor();
+}
+
+/* ---------------------------------------------------------------------- */
+
+// the local indices of the atoms only change when atoms are exchanged
+// between procs or sorted, i.e. right before reneighboring.
+
+void FixColvars::pre_neighbor()
+{
+  build_group_local();
 }
 
 /* ---------------------------------------------------------------------- */
@@ -550,6 +642,7 @@ void FixColvars::setup(int vflag)
 
   MPI_Allreduce(&nme,&nmax,1,MPI_INT,MPI_MAX,world);
   memory->create(comm_buf,nmax,"colvars:comm_buf");
+  memory->grow(local_map,nmax,"colvars:local_map");
 
   const double * const * const x = atom->x;
   const imageint * const image = atom->image;
@@ -561,7 +654,71 @@ void FixColvars::setup(int vflag)
   const double xz = domain->xz;
   const double yz = domain->yz;
 
-  if (me == 0) {
+  if (gather_flag) {
+
+    // copy coordinate data of the local atoms into communication buffer
+
+    nme = 0;
+    for (i=0; i<num_coords; ++i) {
+      const tagint k = atom->map(taglist[i]);
+      if ((k >= 0) && (k < nlocal)) {
+
+        comm_buf[nme].tag  = i;
+        comm_buf[nme].type = type[k];
+
+        if (unwrap_flag) {
+          const int ix = (image[k] & IMGMASK) - IMGMAX;
+          const int iy = (image[k] >> IMGBITS & IMGMASK) - IMGMAX;
+          const int iz = (image[k] >> IMG2BITS) - IMGMAX;
+
+          comm_buf[nme].x = x[k][0] + ix * xprd + iy * xy + iz * xz;
+          comm_buf[nme].y = x[k][1] + iy * yprd + iz * yz;
+          comm_buf[nme].z = x[k][2] + iz * zprd;
+        } else {
+          comm_buf[nme].x = x[k][0];
+          comm_buf[nme].y = x[k][1];
+          comm_buf[nme].z = x[k][2];
+        }
+
+        if (atom->rmass_flag) {
+          comm_buf[nme].m = atom->rmass[k];
+        } else {
+          comm_buf[nme].m = atom->mass[type[k]];
+        }
+
+        comm_buf[nme].q = atom->q_flag ? atom->q[k] : 0.0;
+
+        ++nme;
+      }
+    }
+
+    ndata = gather_comm_buf(nme);
+
+    if (me == 0) {
+
+      std::vector<int>           &tp = *(proxy->modify_atom_types());
+      std::vector<cvm::atom_pos> &cd = *(proxy->modify_atom_positions());
+      std::vector<cvm::rvector>  &of = *(proxy->modify_atom_total_forces());
+      std::vector<cvm::real>     &m  = *(proxy->modify_atom_masses());
+      std::vector<cvm::real>     &q  = *(proxy->modify_atom_charges());
+
+      for (int k=0; k<ndata; ++k) {
+        const int j = gather_buf[k].tag;
+
+        tp[j] = gather_buf[k].type;
+
+        cd[j].x = gather_buf[k].x;
+        cd[j].y = gather_buf[k].y;
+        cd[j].z = gather_buf[k].z;
+
+        m[j] = gather_buf[k].m;
+        if (atom->q_flag) q[j] = gather_buf[k].q;
+
+        of[j].x = of[j].y = of[j].z = 0.0;
+      }
+    }
+
+  } else if (me == 0) {
 
     std::vector<int>     const &id = *(proxy->get_atom_ids());
     std::vector<int>           &tp = *(proxy->modify_atom_types());
@@ -676,6 +833,51 @@ void FixColvars::setup(int vflag)
     MPI_Rsend(comm_buf, nme*size_one, MPI_BYTE, 0, 0, world);
   }
 
+  // compute total mass and charge of the scalable atom groups from the
+  // local atoms; the masses are also needed on all procs to apply forces.
+  // NOTE: these are computed only here, i.e. once per run: per-atom masses
+  // changed during a run (e.g. by fix adapt) are not seen by the groups
+
+  if (num_groups > 0) {
+    // the groups are only known after one_time_init() in the first run,
+    // i.e. after setup_pre_neighbor()
+    build_group_local();
+
+    for (i=0; i < 2*num_groups; ++i) group_buf[i] = 0.0;
+
+    for (int g=0; g < num_groups; ++g) {
+      for (int n=group_local_offsets[g]; n < group_local_offsets[g+1]; ++n) {
+        const int k = group_local[n];
+        if (atom->rmass_flag) {
+          group_buf[2*g] += atom->rmass[k];
+        } else {
+          group_buf[2*g] += atom->mass[type[k]];
+        }
+        if (atom->q_flag) {
+          group_buf[2*g+1] += atom->q[k];
+        }
+      }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE,group_buf,2*num_groups,MPI_DOUBLE,MPI_SUM,world);
+
+    for (int g=0; g < num_groups; ++g) {
+      group_masses[g] = group_buf[2*g];
+      // all procs have the same sums, and the masses are used as divisors
+      if (group_masses[g] <= 0.0)
+        error->all(FLERR,"Fix colvars atom group has zero total mass");
+    }
+
+    if (me == 0) {
+      std::vector<cvm::real> &gm = *(proxy->modify_atom_group_masses());
+      std::vector<cvm::real> &gq = *(proxy->modify_atom_group_charges());
+      for (int g=0; g < num_groups; ++g) {
+        gm[g] = group_buf[2*g];
+        gq[g] = group_buf[2*g+1];
+      }
+    }
+  }
+
   // run pre-run setup in colvarproxy
   if (me == 0)
     proxy->setup();
@@ -739,13 +941,54 @@ void FixColvars::post_force(int /*vflag*/)
   if (nmax_new > nmax) {
     nmax = nmax_new;
     memory->grow(comm_buf,nmax,"colvars:comm_buf");
+    memory->grow(local_map,nmax,"colvars:local_map");
   }
 
   MPI_Status status;
   MPI_Request request;
   int tmp, ndata;
 
-  if (me == 0) {
+  if (gather_flag) {
+
+    /* copy coordinate data of the local atoms into communication buffer */
+    nme = 0;
+    for (i=0; i<num_coords; ++i) {
+      const tagint k = atom->map(taglist[i]);
+      if ((k >= 0) && (k < nlocal)) {
+        comm_buf[nme].tag = i;
+        local_map[nme] = k;
+
+        if (unwrap_flag) {
+          const int ix = (image[k] & IMGMASK) - IMGMAX;
+          const int iy = (image[k] >> IMGBITS & IMGMASK) - IMGMAX;
+          const int iz = (image[k] >> IMG2BITS) - IMGMAX;
+
+          comm_buf[nme].x = x[k][0] + ix * xprd + iy * xy + iz * xz;
+          comm_buf[nme].y = x[k][1] + iy * yprd + iz * yz;
+          comm_buf[nme].z = x[k][2] + iz * zprd;
+        } else {
+          comm_buf[nme].x = x[k][0];
+          comm_buf[nme].y = x[k][1];
+          comm_buf[nme].z = x[k][2];
+        }
+
+        ++nme;
+      }
+    }
+
+    ndata = gather_comm_buf(nme);
+
+    if (me == 0) {
+      std::vector<cvm::atom_pos> &cd = *(proxy->modify_atom_positions());
+      for (int k=0; k<ndata; ++k) {
+        const int j = gather_buf[k].tag;
+        cd[j].x = gather_buf[k].x;
+        cd[j].y = gather_buf[k].y;
+        cd[j].z = gather_buf[k].z;
+      }
+    }
+
+  } else if (me == 0) {
 
     std::vector<cvm::atom_pos> &cd = *(proxy->modify_atom_positions());
 
@@ -820,6 +1063,48 @@ void FixColvars::post_force(int /*vflag*/)
     MPI_Rsend(comm_buf, nme*size_one, MPI_BYTE, 0, 0, world);
   }
 
+  // centers of mass of the scalable atom groups: sum the mass-weighted
+  // coordinates of the local atoms, and reduce them on rank 0
+
+  if (num_groups > 0) {
+    const int * const type = atom->type;
+
+    for (i=0; i < 3*num_groups; ++i) group_buf[i] = 0.0;
+
+    for (int g=0; g < num_groups; ++g) {
+      double * const gbuf = group_buf + 3*g;
+      for (int n=group_local_offsets[g]; n < group_local_offsets[g+1]; ++n) {
+        const int k = group_local[n];
+        const double mk = atom->rmass_flag ? atom->rmass[k] : atom->mass[type[k]];
+
+        if (unwrap_flag) {
+          const int ix = (image[k] & IMGMASK) - IMGMAX;
+          const int iy = (image[k] >> IMGBITS & IMGMASK) - IMGMAX;
+          const int iz = (image[k] >> IMG2BITS) - IMGMAX;
+
+          gbuf[0] += mk * (x[k][0] + ix * xprd + iy * xy + iz * xz);
+          gbuf[1] += mk * (x[k][1] + iy * yprd + iz * yz);
+          gbuf[2] += mk * (x[k][2] + iz * zprd);
+        } else {
+          gbuf[0] += mk * x[k][0];
+          gbuf[1] += mk * x[k][1];
+          gbuf[2] += mk * x[k][2];
+        }
+      }
+    }
+
+    reduce_group_buf(3*num_groups);
+
+    if (me == 0) {
+      std::vector<cvm::rvector> &gc = *(proxy->modify_atom_group_positions());
+      for (int g=0; g < num_groups; ++g) {
+        gc[g].x = group_buf[3*g+0] / group_masses[g];
+        gc[g].y = group_buf[3*g+1] / group_masses[g];
+        gc[g].z = group_buf[3*g+2] / group_masses[g];
+      }
+    }
+  }
+
   ////////////////////////////////////////////////////////////////////////
   // call our workhorse and retrieve additional information.
   if (me == 0) {
@@ -832,6 +1117,63 @@ void FixColvars::post_force(int /*vflag*/)
   MPI_Bcast(&energy, 1, MPI_DOUBLE, 0, world);
   MPI_Bcast(&store_forces, 1, MPI_INT, 0, world);
 
+  // broadcast the biasing forces on the scalable atom groups, and apply
+  // them to the local atoms in proportion to their masses
+
+  if (num_groups > 0) {
+    const int * const type = atom->type;
+
+    if (me == 0) {
+      std::vector<cvm::rvector> &gf = *(proxy->modify_atom_group_applied_forces());
+      for (int g=0; g < num_groups; ++g) {
+        group_buf[3*g+0] = gf[g].x;
+        group_buf[3*g+1] = gf[g].y;
+        group_buf[3*g+2] = gf[g].z;
+      }
+    }
+    MPI_Bcast(group_buf, 3*num_groups, MPI_DOUBLE, 0, world);
+
+    for (int g=0; g < num_groups; ++g) {
+      const double * const gbuf = group_buf + 3*g;
+      for (int n=group_local_offsets[g]; n < group_local_offsets[g+1]; ++n) {
+        const int k = group_local[n];
+        const double mk = atom->rmass_flag ? atom->rmass[k] : atom->mass[type[k]];
+        const double w = mk / group_masses[g];
+        f[k][0] += w * gbuf[0];
+        f[k][1] += w * gbuf[1];
+        f[k][2] += w * gbuf[2];
+      }
+    }
+  }
+
+  if (gather_flag) {
+
+    // send to each proc only the biasing forces on its atoms, in the
+    // same order in which they were gathered, and apply them
+
+    if (me == 0) {
+      std::vector<cvm::rvector> &fo = *(proxy->modify_atom_applied_forces());
+
+      double *fbuf = force_buf;
+      for (int k=0; k < ndata; ++k) {
+        const int j = gather_buf[k].tag;
+        *fbuf++ = fo[j].x;
+        *fbuf++ = fo[j].y;
+        *fbuf++ = fo[j].z;
+      }
+    }
+
+    scatter_force_buf(nme);
+
+    for (int n=0; n < nme; ++n) {
+      const int k = local_map[n];
+      f[k][0] += force_buf[3*n+0];
+      f[k][1] += force_buf[3*n+1];
+      f[k][2] += force_buf[3*n+2];
+    }
+    return;
+  }
+
   // broadcast and apply biasing forces
 
   if (me == 0) {
@@ -892,13 +1234,41 @@ void FixColvars::end_of_step()
     if (nmax_new > nmax) {
       nmax = nmax_new;
       memory->grow(comm_buf,nmax,"colvars:comm_buf");
+      memory->grow(local_map,nmax,"colvars:local_map");
     }
 
     MPI_Status status;
     MPI_Request request;
     int tmp, ndata;
 
-    if (me == 0) {
+    if (gather_flag) {
+
+      /* copy total force data of the local atoms into communication buffer */
+      nme = 0;
+      for (i=0; i<num_coords; ++i) {
+        const tagint k = atom->map(taglist[i]);
+        if ((k >= 0) && (k < nlocal)) {
+          comm_buf[nme].tag  = i;
+          comm_buf[nme].x    = f[k][0];
+          comm_buf[nme].y    = f[k][1];
+          comm_buf[nme].z    = f[k][2];
+          ++nme;
+        }
+      }
+
+      ndata = gather_comm_buf(nme);
+
+      if (me == 0) {
+        std::vector<cvm::rvector> &of = *(proxy->modify_atom_total_forces());
+        for (int k=0; k<ndata; ++k) {
+          const int j = gather_buf[k].tag;
+          of[j].x = gather_buf[k].x;
+          of[j].y = gather_buf[k].y;
+          of[j].z = gather_buf[k].z;
+        }
+      }
+
+    } else if (me == 0) {
 
       // store old force data
       std::vector<cvm::rvector> &of = *(proxy->modify_atom_total_forces());
@@ -952,7 +1322,118 @@ void FixColvars::end_of_step()
       MPI_Recv(&tmp, 0, MPI_INT, 0, 0, world, MPI_STATUS_IGNORE);
       MPI_Rsend(comm_buf, nme*size_one, MPI_BYTE, 0, 0, world);
     }
+
+    // total forces on the scalable atom groups
+
+    if (num_groups > 0) {
+      for (i=0; i < 3*num_groups; ++i) group_buf[i] = 0.0;
+
+      for (int g=0; g < num_groups; ++g) {
+        double * const gbuf = group_buf + 3*g;
+        for (int n=group_local_offsets[g]; n < group_local_offsets[g+1]; ++n) {
+          const int k = group_local[n];
+          gbuf[0] += f[k][0];
+          gbuf[1] += f[k][1];
+          gbuf[2] += f[k][2];
+        }
+      }
+
+      reduce_group_buf(3*num_groups);
+
+      if (me == 0) {
+        std::vector<cvm::rvector> &gt = *(proxy->modify_atom_group_total_forces());
+        for (int g=0; g < num_groups; ++g) {
+          gt[g].x = group_buf[3*g+0];
+          gt[g].y = group_buf[3*g+1];
+          gt[g].z = group_buf[3*g+2];
+        }
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Collect the nme entries of comm_buf of all procs into gather_buf on
+ * rank 0, in the order of the ranks; returns the total number of entries
+ * on rank 0, and zero elsewhere. */
+int FixColvars::gather_comm_buf(int nme)
+{
+  int ntotal = 0;
+
+  MPI_Gather(&nme, 1, MPI_INT, gather_counts, 1, MPI_INT, 0, world);
+
+  if (me == 0) {
+    for (int i=0; i < comm->nprocs; ++i) {
+      force_counts[i] = 3*gather_counts[i];
+      force_displs[i] = 3*ntotal;
+      gather_displs[i] = ntotal*size_one;
+      ntotal += gather_counts[i];
+      gather_counts[i] *= size_one;
+    }
+    if (ntotal > ngather) {
+      ngather = ntotal;
+      memory->grow(gather_buf,ngather,"colvars:gather_buf");
+      memory->grow(force_buf,3*ngather,"colvars:force_buf");
+    }
+  }
+
+  MPI_Gatherv(comm_buf, nme*size_one, MPI_BYTE, gather_buf,
+              gather_counts, gather_displs, MPI_BYTE, 0, world);
+
+  return ntotal;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Send from rank 0 to each proc the forces on the nme atoms that it sent
+ * in the last call to gather_comm_buf(); rank 0 keeps its own at the
+ * beginning of force_buf. */
+void FixColvars::scatter_force_buf(int nme)
+{
+  if (me == 0) {
+    MPI_Scatterv(force_buf, force_counts, force_displs, MPI_DOUBLE,
+                 MPI_IN_PLACE, 3*nme, MPI_DOUBLE, 0, world);
+  } else {
+    MPI_Scatterv(nullptr, nullptr, nullptr, MPI_DOUBLE,
+                 force_buf, 3*nme, MPI_DOUBLE, 0, world);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+/* Sum the first n elements of group_buf over all procs, on rank 0. */
+void FixColvars::reduce_group_buf(int n)
+{
+  if (me == 0) {
+    MPI_Reduce(MPI_IN_PLACE, group_buf, n, MPI_DOUBLE, MPI_SUM, 0, world);
+  } else {
+    MPI_Reduce(group_buf, nullptr, n, MPI_DOUBLE, MPI_SUM, 0, world);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+/* List in group_local the local indices of the atoms of each scalable
+ * group owned by this proc, so that the loops over the groups at each
+ * step only visit these atoms. */
+void FixColvars::build_group_local()
+{
+  if (num_groups == 0) return;
+
+  const int nlocal = atom->nlocal;
+  int nme = 0;
+  for (int g=0; g < num_groups; ++g) {
+    group_local_offsets[g] = nme;
+    for (int n=group_offsets[g]; n < group_offsets[g+1]; ++n) {
+      const tagint k = atom->map(group_tags[n]);
+      if ((k >= 0) && (k < nlocal)) {
+        if (nme == group_local_max) {
+          group_local_max = (nme > 0) ? 2*nme : 1024;
+          memory->grow(group_local,group_local_max,"colvars:group_local");
+        }
+        group_local[nme] = k;
+        ++nme;
+      }
+    }
   }
+  group_local_offsets[num_groups] = nme;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -1004,5 +1485,10 @@ double FixColvars::memory_usage(void)
 {
   double bytes = (double) (num_coords * (2*sizeof(int)+3*sizeof(double)));
   bytes += (double)(double) (nmax*size_one) + sizeof(this);
+  bytes += (double) (nmax*sizeof(int));
+  bytes += (double) (ngather*size_one + 4*(me == 0 ? comm->nprocs : 0)*sizeof(int));
+  bytes += (double) (num_groups*(sizeof(int)+4*sizeof(double)));
+  bytes += (double) (num_groups > 0 ? group_offsets[num_groups]*sizeof(tagint) : 0);
+  bytes += (double) ((num_groups+1+group_local_max)*sizeof(int));
   return bytes;
 }
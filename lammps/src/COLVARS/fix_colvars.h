@@ -50,6 +50,9 @@ class FixColvars : public Fix {
   virtual void setup(int);
   virtual int modify_param(int, char **);
   virtual void min_setup(int vflag) { setup(vflag); };
+  virtual void setup_pre_neighbor();
+  virtual void pre_neighbor();
+  virtual void min_pre_neighbor() { pre_neighbor(); };
   virtual void min_post_force(int);
   virtual void post_force(int);
   virtual void post_force_respa(int, int, int);
@@ -83,6 +86,24 @@ class FixColvars : public Fix {
   void *idmap;       // hash for mapping atom indices to consistent order.
   int *rev_idmap;    // list of the hash keys for reverse mapping.
 
+  int gather_flag;              // 1 to use collective communication, 0 for serial
+  int *local_map;               // local indices of the atoms packed in comm_buf
+  int ngather;                  // size of gather_buf
+  struct commdata *gather_buf;  // data gathered from all procs (rank 0 only)
+  int *gather_counts;           // bytes gathered from each proc (rank 0 only)
+  int *gather_displs;           // offsets in gather_buf (rank 0 only)
+  int *force_counts;            // forces sent to each proc (rank 0 only)
+  int *force_displs;            // offsets in force_buf (rank 0 only)
+
+  int num_groups;               // number of scalable atom groups
+  int *group_offsets;           // offsets of each group in group_tags
+  tagint *group_tags;           // list of the atom IDs of all scalable groups
+  double *group_masses;         // total mass of each scalable group (at setup)
+  double *group_buf;            // communication buffer for group data
+  int *group_local_offsets;     // offsets of each group in group_local
+  int *group_local;             // local indices of the atoms of each group
+  int group_local_max;          // size of group_local
+
   int nlevels_respa;       // flag to determine respa levels.
   int store_forces;        // flag to determine whether to store total forces
   int unwrap_flag;         // 1 if atom coords are unwrapped, 0 if not
@@ -91,6 +112,10 @@ class FixColvars : public Fix {
                            // only supports one instance at a time
   MPI_Comm root2root;      // inter-root communicator for multi-replica support
   void one_time_init();    // one time initialization
+  int gather_comm_buf(int);        // gather comm_buf on rank 0
+  void scatter_force_buf(int);     // send to each proc the forces on its atoms
+  void reduce_group_buf(int);      // sum group data of all procs on rank 0
+  void build_group_local();        // list the local atoms of each group
 };
 
 }    // namespace LAMMPS_NS
@@ -121,6 +146,10 @@ E: Incorrect fix colvars unwrap flag
 
 Self-explanatory. Check the input script syntax.
 
+E: Incorrect fix colvars gather flag
+
+Self-explanatory. Check the input script syntax.
+
 E: Unknown fix colvars parameter
 
 Self-explanatory. Check your input script syntax.
@@ -0,0 +1,63 @@
+#!/bin/sh
+if [ $# -lt 1 ] || [ ! -x "$1" ]
+then
+    cat <<EOF2
+ usage: $0 <path-to-lammps> [number-of-ranks]
+
+ Runs in.mpi_gather with both values of the gather keyword of fix colvars,
+ on one and on number-of-ranks (default: 4) MPI ranks, and checks that both
+ give identical output.  Runs in.mpi_scalable with the default settings
+ (centers of mass computed in parallel) and with "scalable off", on the
+ same numbers of ranks, and checks that both give the same trajectory
+ within rounding errors.  Set MPIRUN to change the MPI launcher (default:
+ mpirun).
+
+EOF2
+exit 1
+fi
+lmp="$1"
+nranks=${2:-4}
+mpirun=${MPIRUN:-mpirun}
+status=0
+
+for ranks in 1 ${nranks}
+do \
+    for gather in serial collective
+    do \
+        ${mpirun} -np ${ranks} ${lmp} -echo none -screen none -log none \
+          -in in.mpi_gather -var gather ${gather} -var ranks ${ranks} \
+          || { echo "Error: run with gather ${gather} on ${ranks} ranks failed."; status=1; }
+    done
+    for f in colvars.traj colvars.state
+    do \
+        if cmp mpi_gather.serial.${ranks}.${f} mpi_gather.collective.${ranks}.${f}
+        then \
+            echo "Identical ${f} files on ${ranks} MPI rank(s)."
+        else \
+            status=1
+        fi
+    done
+    rm -f mpi_gather.serial.${ranks}.* mpi_gather.collective.${ranks}.*
+done
+
+for ranks in 1 ${nranks}
+do \
+    for scalable in default off
+    do \
+        ${mpirun} -np ${ranks} ${lmp} -echo none -screen none -log none \
+          -in in.mpi_scalable -var scalable ${scalable} -var ranks ${ranks} \
+          || { echo "Error: run with scalable ${scalable} on ${ranks} ranks failed."; status=1; }
+    done
+    # the sums over the atoms are done in a different order
+    if ../library/common/cvtraj-compare.pl \
+         mpi_scalable.default.${ranks}.colvars.traj \
+         mpi_scalable.off.${ranks}.colvars.traj > /dev/null
+    then \
+        echo "Matching colvars.traj files with and without scalable groups on ${ranks} MPI rank(s)."
+    else \
+        status=1
+    fi
+    rm -f mpi_scalable.default.${ranks}.* mpi_scalable.off.${ranks}.*
+done
+
+exit ${status}
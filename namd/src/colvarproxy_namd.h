@@ -118,6 +118,10 @@ public:
   }
 
 #if CMK_SMP && USE_CKLOOP
+  /// Threads are provided by CkLoop: "smp threads" and "smp openmp" fall
+  /// back to it with a warning
+  int set_smp_mode(std::string const &mode, int num_threads = 0);
+
   int smp_enabled()
   {
     if (b_smp_active) {
@@ -180,6 +184,8 @@ public:
 
   int init_atom(int atom_number);
   int check_atom_id(int atom_number);
+  int init_atoms(std::vector<int> const &atom_numbers,
+                 std::vector<int> &indices);
   int init_atom(cvm::residue_id const &residue,
                 std::string const     &atom_name,
                 std::string const     &segment_id);
@@ -17,6 +17,7 @@
 #include "colvar.h"
 #include "colvarcomp.h"
 #include "colvarscript.h"
+#include "colvartraj.h"
 
 #if (__cplusplus >= 201103L)
 std::map<std::string, std::function<colvar::cvc* (const std::string& subcv_conf)>> colvar::global_cvc_map = std::map<std::string, std::function<colvar::cvc* (const std::string& subcv_conf)>>();
@@ -837,6 +838,8 @@ int colvar::init_components(std::string const &conf)
     "weighted by inverse power", "distanceInv");
   error_code |= init_components_type<distance_pairs>(conf, "N1xN2-long vector "
     "of pairwise distances", "distancePairs");
+  error_code |= init_components_type<distance_pairs_list>(conf, "vector of "
+    "distances between listed pairs of atoms", "distancePairsList");
   error_code |= init_components_type<dipole_magnitude>(conf, "dipole magnitude",
     "dipoleMagnitude");
   error_code |= init_components_type<coordnum>(conf, "coordination "
@@ -1209,6 +1212,78 @@ std::vector<std::vector<int> > colvar::get_atom_lists()
 }
 
 
+std::vector<cvm::atom_group *> colvar::get_shareable_atom_groups()
+{
+  std::vector<cvm::atom_group *> groups;
+  for (size_t i = 0; i < cvcs.size(); i++) {
+    std::vector<cvm::atom_group *> const cvc_groups =
+      cvcs[i]->get_shareable_atom_groups();
+    groups.insert(groups.end(), cvc_groups.begin(), cvc_groups.end());
+  }
+  return groups;
+}
+
+
+void colvar::flag_shared_atom_groups()
+{
+  for (size_t i = 0; i < cvcs.size(); i++) {
+    if (!cvcs[i]->is_enabled()) continue;
+    std::vector<cvm::atom_group *> const &groups = cvcs[i]->atom_groups;
+    for (size_t ig = 0; ig < groups.size(); ig++) {
+      if (groups[ig]->is_shared()) {
+        cvm::atom_group *source = groups[ig]->shared_source ?
+          groups[ig]->shared_source : groups[ig];
+        source->b_shared_active = true;
+      }
+    }
+  }
+}
+
+
+cvm::real colvar::cvc_cost_estimate(size_t i) const
+{
+  return (i < cvcs.size()) ? cvcs[i]->cost_estimate() : -1.0;
+}
+
+
+void colvar::update_cvc_cost_estimate(size_t i, cvm::real seconds)
+{
+  if (i < cvcs.size()) {
+    cvcs[i]->update_cost_estimate(seconds);
+  }
+}
+
+
+void colvar::reset_profile()
+{
+  profile.reset();
+  for (size_t i = 0; i < cvcs.size(); i++) {
+    cvcs[i]->profile.reset();
+  }
+}
+
+
+std::string colvar::profile_report() const
+{
+  std::string result = profile.report("colvar \""+name+"\"");
+  for (size_t i = 0; i < cvcs.size(); i++) {
+    result += cvcs[i]->profile.report("  "+cvcs[i]->function_type+
+                                      " \""+cvcs[i]->name+"\"");
+  }
+  return result;
+}
+
+
+std::vector<cvm::real> colvar::get_cvc_cost_estimates() const
+{
+  std::vector<cvm::real> costs(cvcs.size());
+  for (size_t i = 0; i < cvcs.size(); i++) {
+    costs[i] = cvcs[i]->cost_estimate();
+  }
+  return costs;
+}
+
+
 std::vector<int> const &colvar::get_volmap_ids()
 {
   volmap_ids_.resize(cvcs.size());
@@ -1224,6 +1299,141 @@ std::vector<int> const &colvar::get_volmap_ids()
 }
 
 
+#if (__cplusplus >= 201103L)
+colvar::cvc *colvar::acquire_shared_sub_cvc(std::string const &key,
+                                            std::string const &conf,
+                                            cvc *consumer)
+{
+  std::vector<cvm::shared_sub_cvc *> &shared_sub_cvcs =
+    cvm::main()->shared_sub_cvcs_list();
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    if ((shared_sub_cvcs[i]->key == key) && (shared_sub_cvcs[i]->conf == conf)) {
+      shared_sub_cvcs[i]->consumers.push_back(consumer);
+      return shared_sub_cvcs[i]->sub_cvc;
+    }
+  }
+  if (global_cvc_map.count(key) == 0) {
+    cvm::error("Error: \""+key+"\" is not a valid component keyword.\n",
+               INPUT_ERROR);
+    return NULL;
+  }
+  cvm::shared_sub_cvc *entry = new cvm::shared_sub_cvc;
+  entry->key = key;
+  entry->conf = conf;
+  entry->sub_cvc = global_cvc_map[key](conf);
+  entry->consumers.push_back(consumer);
+  entry->b_force = false;
+  entry->b_active = false;
+  entry->b_gradients = false;
+  shared_sub_cvcs.push_back(entry);
+  if (cvm::debug()) {
+    cvm::log("Created shared sub-component \""+entry->sub_cvc->name+"\".\n");
+  }
+  return entry->sub_cvc;
+}
+
+
+void colvar::release_shared_sub_cvc(cvc *sub_cvc, cvc *consumer)
+{
+  std::vector<cvm::shared_sub_cvc *> &shared_sub_cvcs =
+    cvm::main()->shared_sub_cvcs_list();
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    if (shared_sub_cvcs[i]->sub_cvc != sub_cvc) continue;
+    std::vector<cvc *> &consumers = shared_sub_cvcs[i]->consumers;
+    consumers.erase(std::remove(consumers.begin(), consumers.end(), consumer),
+                    consumers.end());
+    if (consumers.empty()) {
+      delete sub_cvc;
+      delete shared_sub_cvcs[i];
+      shared_sub_cvcs.erase(shared_sub_cvcs.begin() + i);
+    }
+    return;
+  }
+}
+
+
+void colvar::add_shared_sub_cvc_force(cvc *sub_cvc, colvarvalue const &force)
+{
+  std::vector<cvm::shared_sub_cvc *> &shared_sub_cvcs =
+    cvm::main()->shared_sub_cvcs_list();
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    if (shared_sub_cvcs[i]->sub_cvc != sub_cvc) continue;
+    if (shared_sub_cvcs[i]->b_force) {
+      shared_sub_cvcs[i]->force += force;
+    } else {
+      shared_sub_cvcs[i]->force = force;
+      shared_sub_cvcs[i]->b_force = true;
+    }
+    return;
+  }
+}
+
+
+void colvar::flag_shared_sub_cvcs(std::vector<colvar *> const &cvs)
+{
+  std::vector<cvm::shared_sub_cvc *> &shared_sub_cvcs =
+    cvm::main()->shared_sub_cvcs_list();
+  if (shared_sub_cvcs.empty()) return;
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    shared_sub_cvcs[i]->b_active = false;
+    shared_sub_cvcs[i]->b_gradients = false;
+  }
+  for (size_t icv = 0; icv < cvs.size(); icv++) {
+    std::vector<cvc *> const &cv_cvcs = cvs[icv]->cvcs;
+    for (size_t icvc = 0; icvc < cv_cvcs.size(); icvc++) {
+      if (!cv_cvcs[icvc]->is_enabled()) continue;
+      for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+        cvm::shared_sub_cvc &entry = *(shared_sub_cvcs[i]);
+        if (std::find(entry.consumers.begin(), entry.consumers.end(),
+                      cv_cvcs[icvc]) != entry.consumers.end()) {
+          entry.b_active = true;
+          if (cv_cvcs[icvc]->is_enabled(f_cvc_gradient)) {
+            entry.b_gradients = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+
+int colvar::calc_shared_sub_cvcs()
+{
+  std::vector<cvm::shared_sub_cvc *> &shared_sub_cvcs =
+    cvm::main()->shared_sub_cvcs_list();
+  int error_code = COLVARS_OK;
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    cvm::shared_sub_cvc &entry = *(shared_sub_cvcs[i]);
+    entry.b_force = false;
+    if (!entry.b_active) continue;
+    entry.sub_cvc->read_data();
+    entry.sub_cvc->calc_value();
+    if (entry.b_gradients) {
+      entry.sub_cvc->calc_gradients();
+      entry.sub_cvc->calc_fit_gradients();
+    }
+    error_code |= cvm::get_error();
+  }
+  return error_code;
+}
+
+
+int colvar::apply_shared_sub_cvc_forces()
+{
+  std::vector<cvm::shared_sub_cvc *> &shared_sub_cvcs =
+    cvm::main()->shared_sub_cvcs_list();
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    cvm::shared_sub_cvc &entry = *(shared_sub_cvcs[i]);
+    if (entry.b_force) {
+      entry.sub_cvc->apply_force(entry.force);
+      entry.b_force = false;
+    }
+  }
+  return cvm::get_error();
+}
+#endif
+
+
 colvar::~colvar()
 {
   // There is no need to call free_children_deps() here
@@ -1312,6 +1522,7 @@ int colvar::calc_cvcs(int first_cvc, size_t num_cvcs)
 
   colvarproxy *proxy = cvm::main()->proxy;
   int error_code = COLVARS_OK;
+  double const t_start = cvm::profiling() ? cvm::wall_time() : 0.0;
 
   error_code |= check_cvc_range(first_cvc, num_cvcs);
   if (error_code != COLVARS_OK) {
@@ -1331,6 +1542,13 @@ int colvar::calc_cvcs(int first_cvc, size_t num_cvcs)
     error_code |= calc_cvc_total_force(first_cvc, num_cvcs);
   }
 
+  if (cvm::profiling()) {
+    // Components of the same colvar may be computed on different threads
+    proxy->smp_lock();
+    profile.add(cvm::wall_time() - t_start, 0);
+    proxy->smp_unlock();
+  }
+
   if (cvm::debug())
     cvm::log("Done calculating colvar \""+this->name+"\".\n");
 
@@ -1345,6 +1563,7 @@ int colvar::collect_cvc_data()
 
   colvarproxy *proxy = cvm::main()->proxy;
   int error_code = COLVARS_OK;
+  double const t_start = cvm::profiling() ? cvm::wall_time() : 0.0;
 
   if ((cvm::step_relative() > 0) && (!proxy->total_forces_same_step())){
     // Total force depends on Jacobian derivative from previous timestep
@@ -1360,6 +1579,10 @@ int colvar::collect_cvc_data()
   }
   error_code |= calc_colvar_properties();
 
+  if (cvm::profiling()) {
+    profile.add(cvm::wall_time() - t_start);
+  }
+
   if (cvm::debug())
     cvm::log("Done calculating colvar \""+this->name+"\"'s properties.\n");
 
@@ -1395,8 +1618,12 @@ int colvar::calc_cvc_values(int first_cvc, size_t num_cvcs)
        i++) {
     if (!cvcs[i]->is_enabled()) continue;
     cvc_count++;
+    double const t_start = cvm::profiling() ? cvm::wall_time() : 0.0;
     (cvcs[i])->read_data();
     (cvcs[i])->calc_value();
+    if (cvm::profiling()) {
+      (cvcs[i])->profile.add(cvm::wall_time() - t_start);
+    }
     if (cvm::debug())
       cvm::log("Colvar component no. "+cvm::to_str(i+1)+
                 " within colvar \""+this->name+"\" has value "+
@@ -1498,12 +1725,16 @@ int colvar::calc_cvc_gradients(int first_cvc, size_t num_cvcs)
     cvc_count++;
 
     if ((cvcs[i])->is_enabled(f_cvc_gradient)) {
+      double const t_start = cvm::profiling() ? cvm::wall_time() : 0.0;
       (cvcs[i])->calc_gradients();
       // if requested, propagate (via chain rule) the gradients above
       // to the atoms used to define the roto-translation
      (cvcs[i])->calc_fit_gradients();
       if ((cvcs[i])->is_enabled(f_cvc_debug_gradient))
         (cvcs[i])->debug_gradients();
+      if (cvm::profiling()) {
+        (cvcs[i])->profile.add(cvm::wall_time() - t_start, 0);
+      }
     }
 
     cvm::decrease_depth();
@@ -2293,23 +2524,20 @@ std::istream & colvar::read_state(std::istream &is)
 }
 
 
-std::istream & colvar::read_traj(std::istream &is)
+int colvar::read_traj(colvartraj_frame const &frame, bool warn_missing)
 {
-  std::streampos const start_pos = is.tellg();
+  bool const b_extended = is_enabled(f_cv_extended_Lagrangian) &&
+    !is_enabled(f_cv_external);
 
-  if (is_enabled(f_cv_output_value)) {
+  // Optional quantities not found in the frame keep their previous values
+  std::string missing;
 
-    if (!(is >> x)) {
-      cvm::log("Error: in reading the value of colvar \""+
-                this->name+"\" from trajectory.\n");
-      is.clear();
-      is.seekg(start_pos, std::ios::beg);
-      is.setstate(std::ios::failbit);
-      return is;
+  if (is_enabled(f_cv_output_value)) {
+    if (!frame.get("", name, x)) {
+      return cvm::error("Error: cannot find the value of colvar \""+name+
+                        "\" in the trajectory.\n", INPUT_ERROR);
     }
-
-    if (is_enabled(f_cv_extended_Lagrangian)) {
-      is >> x_ext;
+    if (b_extended && frame.get("r_", name, x_ext)) {
       x_reported = x_ext;
     } else {
       x_reported = x;
@@ -2317,11 +2545,10 @@ std::istream & colvar::read_traj(std::istream &is)
   }
 
   if (is_enabled(f_cv_output_velocity)) {
-
-    is >> v_fdiff;
-
-    if (is_enabled(f_cv_extended_Lagrangian)) {
-      is >> v_ext;
+    if (!frame.get("v_", name, v_fdiff)) {
+      missing += " v_"+name;
+    }
+    if (b_extended && frame.get("vr_", name, v_ext)) {
       v_reported = v_ext;
     } else {
       v_reported = v_fdiff;
@@ -2329,15 +2556,24 @@ std::istream & colvar::read_traj(std::istream &is)
   }
 
   if (is_enabled(f_cv_output_total_force)) {
-    is >> ft;
+    if (!frame.get("ft_", name, ft)) {
+      missing += " ft_"+name;
+    }
     ft_reported = ft;
   }
 
   if (is_enabled(f_cv_output_applied_force)) {
-    is >> f;
+    if (!frame.get("fa_", name, f)) {
+      missing += " fa_"+name;
+    }
   }
 
-  return is;
+  if (warn_missing && missing.size()) {
+    cvm::log("Warning: the trajectory does not contain the columns:"+missing+
+             "; their values will not be updated.\n");
+  }
+
+  return COLVARS_OK;
 }
 
 
@@ -2485,6 +2721,47 @@ std::ostream & colvar::write_traj(std::ostream &os)
 }
 
 
+int colvar::write_traj_columns(colvartraj_frame &frame)
+{
+  // Labels and order of the columns are the same as in write_traj()
+  bool const b_extended = is_enabled(f_cv_extended_Lagrangian) &&
+    !is_enabled(f_cv_external);
+
+  if (is_enabled(f_cv_output_value)) {
+    if (b_extended) {
+      frame.add("", name, x);
+      frame.add("r_", name, x_reported);
+    } else {
+      frame.add("", name, x_reported);
+    }
+  }
+
+  if (is_enabled(f_cv_output_velocity)) {
+    if (b_extended) {
+      frame.add("v_", name, v_fdiff);
+      frame.add("vr_", name, v_reported);
+    } else {
+      frame.add("v_", name, v_reported);
+    }
+  }
+
+  if (is_enabled(f_cv_output_energy)) {
+    frame.add("Ep_", name, potential_energy);
+    frame.add("Ek_", name, kinetic_energy);
+  }
+
+  if (is_enabled(f_cv_output_total_force)) {
+    frame.add("ft_", name, ft_reported);
+  }
+
+  if (is_enabled(f_cv_output_applied_force)) {
+    frame.add("fa_", name, applied_force());
+  }
+
+  return COLVARS_OK;
+}
+
+
 int colvar::write_output_files()
 {
   int error_code = COLVARS_OK;
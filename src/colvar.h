@@ -396,6 +396,10 @@ public:
     return value().size();
   }
 
+  /// \brief Time spent computing this colvar and applying its forces,
+  /// including the time of its components
+  cvm::profile_counter profile;
+
   /// \brief Number of CVC objects defined
   inline size_t num_cvcs() const
   {
@@ -409,6 +413,22 @@ public:
     return n_active_cvcs;
   }
 
+  /// \brief Estimated time (in seconds) to compute the i-th CVC (negative
+  /// if not measured yet), used to balance the load across threads
+  cvm::real cvc_cost_estimate(size_t i) const;
+
+  /// Add the measured time (in seconds) of the i-th CVC to its estimate
+  void update_cvc_cost_estimate(size_t i, cvm::real seconds);
+
+  /// Estimated times (in seconds) to compute each CVC
+  std::vector<cvm::real> get_cvc_cost_estimates() const;
+
+  /// Reset the profiling counters of this colvar and of its CVCs
+  void reset_profile();
+
+  /// Profiling report of this colvar, followed by those of its CVCs
+  std::string profile_report() const;
+
   /// \brief Use the internal metrics (as from \link colvar::cvc
   /// \endlink objects) to calculate square distances and gradients
   ///
@@ -442,14 +462,19 @@ public:
   /// Perform analysis tasks
   int analyze();
 
-  /// Read the value from a collective variable trajectory file
-  std::istream & read_traj(std::istream &is);
-
   /// Output formatted values to the trajectory file
   std::ostream & write_traj(std::ostream &os);
   /// Write a label to the trajectory file (comment line)
   std::ostream & write_traj_label(std::ostream &os);
 
+  /// \brief Read the value from a frame of a trajectory file (text or
+  /// binary); if warn_missing is true, print a warning for each quantity
+  /// that should be in the frame but is not
+  int read_traj(colvartraj_frame const &frame, bool warn_missing = false);
+
+  /// Append the same quantities as write_traj() to a binary trajectory frame
+  int write_traj_columns(colvartraj_frame &frame);
+
   /// Read the collective variable from a restart file
   std::istream & read_state(std::istream &is);
   /// Write the collective variable to a restart file
@@ -571,6 +596,7 @@ public:
   class polar_phi;
   class distance_inv;
   class distance_pairs;
+  class distance_pairs_list;
   class dipole_magnitude;
   class angle;
   class dipole_angle;
@@ -621,6 +647,35 @@ public:
   static const std::map<std::string, std::function<colvar::cvc* (const std::string& subcv_conf)>>& get_global_cvc_map() {
       return global_cvc_map;
   }
+
+  /// \brief Get the sub-component defined by the given keyword and
+  /// configuration, shared by all composite components (gspathCV,
+  /// linearCombination, ...) that define it in the same way; it is created
+  /// at the first request, and computed by calc_shared_sub_cvcs()
+  static cvc *acquire_shared_sub_cvc(std::string const &key,
+                                     std::string const &conf,
+                                     cvc *consumer);
+
+  /// \brief Release a sub-component obtained from acquire_shared_sub_cvc(),
+  /// deleting it when no other component uses it
+  static void release_shared_sub_cvc(cvc *sub_cvc, cvc *consumer);
+
+  /// \brief Add a force on a shared sub-component; the forces from all of
+  /// its consumers are applied together by apply_shared_sub_cvc_forces()
+  static void add_shared_sub_cvc_force(cvc *sub_cvc, colvarvalue const &force);
+
+  /// \brief Mark the shared sub-components used by the active components of
+  /// the given (active) colvars: the others are not computed in this step
+  static void flag_shared_sub_cvcs(std::vector<colvar *> const &cvs);
+
+  /// \brief Compute the values of the shared sub-components used in this
+  /// step (once, before any colvar), and their gradients if any of their
+  /// active consumers needs them
+  static int calc_shared_sub_cvcs();
+
+  /// \brief Apply the total force on each shared sub-component (after all
+  /// colvars have communicated their forces)
+  static int apply_shared_sub_cvc_forces();
 #endif
 
 protected:
@@ -678,12 +733,41 @@ public:
   /// \brief Get vector of vectors of atom IDs for all atom groups
   virtual std::vector<std::vector<int> > get_atom_lists();
 
+  /// \brief Get the atom groups of all CVCs that may share their positions
+  /// with identical groups elsewhere
+  std::vector<cvm::atom_group *> get_shareable_atom_groups();
+
+  /// \brief Mark the shared atom groups used by the active CVCs, so that
+  /// colvarmodule::calc_shared_atom_groups() computes them in this step
+  void flag_shared_atom_groups();
+
   /// Volmap numeric IDs, one for each CVC (-1 if not available)
   std::vector<int> const &get_volmap_ids();
 
 };
 
 
+/// A sub-component shared by composite components
+struct colvarmodule::shared_sub_cvc {
+  /// Keyword of the sub-component
+  std::string key;
+  /// Configuration of the sub-component
+  std::string conf;
+  /// The sub-component itself
+  colvar::cvc *sub_cvc;
+  /// Composite components using it
+  std::vector<colvar::cvc *> consumers;
+  /// Total force from all consumers
+  colvarvalue force;
+  /// Whether any force was added since the last application
+  bool b_force;
+  /// Whether any consumer is active in this step
+  bool b_active;
+  /// Whether any active consumer needs the gradients
+  bool b_gradients;
+};
+
+
 inline cvm::real const & colvar::force_constant() const
 {
   return ext_force_k;
@@ -9,6 +9,7 @@
 
 
 #include "colvarmodule.h"
+#include "colvarparse.h"
 
 #include <vector>
 #include <cmath>
@@ -62,6 +63,19 @@ protected:
     long sign;
     double M;
     double m;
+    /// Number of frames evaluated on each side of the closest one (0: all)
+    size_t frame_window;
+    /// Number of evaluations between two scans of all frames (0: never)
+    size_t full_scan_frequency;
+    /// Number of evaluations since the last scan of all frames
+    size_t evaluations_since_full_scan;
+    /// Frames whose distances are computed, [window_begin, window_end)
+    size_t window_begin;
+    size_t window_end;
+    /// Whether one of the two closest frames is on an edge of a partial window
+    bool closestFramesOnWindowEdge() const;
+    /// Choose the frames to evaluate next, around the current closest frame
+    void updateFrameWindow();
 public:
     GeometricPathBase(size_t vector_size, const element_type& element = element_type(), size_t total_frames = 1, bool p_use_second_closest_frame = true, bool p_use_third_closest_frame = false, bool p_use_z_square = false);
     GeometricPathBase(size_t vector_size, const std::vector<element_type>& elements, size_t total_frames = 1, bool p_use_second_closest_frame = true, bool p_use_third_closest_frame = false, bool p_use_z_square = false);
@@ -69,7 +83,16 @@ public:
     virtual ~GeometricPathBase() {}
     virtual void initialize(size_t vector_size, const element_type& element = element_type(), size_t total_frames = 1, bool p_use_second_closest_frame = true, bool p_use_third_closest_frame = false, bool p_use_z_square = false);
     virtual void initialize(size_t vector_size, const std::vector<element_type>& elements, size_t total_frames = 1, bool p_use_second_closest_frame = true, bool p_use_third_closest_frame = false, bool p_use_z_square = false);
+    /// \brief Only compute the distances from p_frame_window frames on each
+    /// side of the previous closest frame, scanning all frames every
+    /// p_full_scan_frequency evaluations, or when the closest frames reach an
+    /// edge of the window
+    void setFrameWindow(size_t p_frame_window, size_t p_full_scan_frequency);
+    /// \brief Read frameWindow and fullScanFrequency from the configuration
+    /// of the component parser, and call setFrameWindow() accordingly
+    int parseFrameWindow(colvarparse &parser, std::string const &conf);
     virtual void prepareVectors() = 0;
+    /// \brief Compute frame_distances for the frames in [window_begin, window_end)
     virtual void updateDistanceToReferenceFrames() = 0;
     virtual void compute();
     virtual void determineClosestFrames();
@@ -118,6 +141,11 @@ void GeometricPathBase<element_type, scalar_type, path_type>::initialize(size_t
     use_z_square = p_use_z_square;
     M = static_cast<scalar_type>(total_frames - 1);
     m = static_cast<scalar_type>(1.0);
+    frame_window = 0;
+    full_scan_frequency = 0;
+    evaluations_since_full_scan = 0;
+    window_begin = 0;
+    window_end = total_frames;
 }
 
 template <typename element_type, typename scalar_type, path_sz path_type>
@@ -151,6 +179,68 @@ void GeometricPathBase<element_type, scalar_type, path_type>::initialize(size_t
     use_z_square = p_use_z_square;
     M = static_cast<scalar_type>(total_frames - 1);
     m = static_cast<scalar_type>(1.0);
+    frame_window = 0;
+    full_scan_frequency = 0;
+    evaluations_since_full_scan = 0;
+    window_begin = 0;
+    window_end = total_frames;
+}
+
+template <typename element_type, typename scalar_type, path_sz path_type>
+void GeometricPathBase<element_type, scalar_type, path_type>::setFrameWindow(size_t p_frame_window, size_t p_full_scan_frequency) {
+    frame_window = p_frame_window;
+    full_scan_frequency = p_full_scan_frequency;
+    evaluations_since_full_scan = 0;
+    window_begin = 0;
+    window_end = frame_distances.size();
+}
+
+template <typename element_type, typename scalar_type, path_sz path_type>
+int GeometricPathBase<element_type, scalar_type, path_type>::parseFrameWindow(colvarparse &parser, std::string const &conf) {
+    size_t frame_window_size = 0, full_scan_freq = 100;
+    parser.get_keyval(conf, "frameWindow", frame_window_size, frame_window_size);
+    parser.get_keyval(conf, "fullScanFrequency", full_scan_freq, full_scan_freq);
+    if (frame_window_size == 1) {
+        return cvm::error("Error: frameWindow must be either 0 (evaluate all frames) or at least 2.\n", INPUT_ERROR);
+    }
+    if (frame_window_size > 0) {
+        cvm::log(std::string("Geometric path ") + std::string(path_type == S ? "s" : "z") + std::string("(σ) will evaluate ") + cvm::to_str(frame_window_size) + std::string(" frames on each side of the closest frame, and all frames every ") + cvm::to_str(full_scan_freq) + std::string(" steps\n"));
+        setFrameWindow(frame_window_size, full_scan_freq);
+    }
+    return COLVARS_OK;
+}
+
+template <typename element_type, typename scalar_type, path_sz path_type>
+bool GeometricPathBase<element_type, scalar_type, path_type>::closestFramesOnWindowEdge() const {
+    const size_t total_frames = frame_distances.size();
+    for (size_t i = 0; i < 2 && i < frame_index.size(); ++i) {
+        if ((window_begin > 0 && frame_index[i] == window_begin) ||
+            (window_end < total_frames && frame_index[i] + 1 == window_end)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename element_type, typename scalar_type, path_sz path_type>
+void GeometricPathBase<element_type, scalar_type, path_type>::updateFrameWindow() {
+    const size_t total_frames = frame_distances.size();
+    if (frame_window == 0) {
+        return;
+    }
+    if (window_begin == 0 && window_end == total_frames) {
+        evaluations_since_full_scan = 0;
+    } else {
+        ++evaluations_since_full_scan;
+    }
+    if (full_scan_frequency > 0 && evaluations_since_full_scan + 1 >= full_scan_frequency) {
+        window_begin = 0;
+        window_end = total_frames;
+    } else {
+        const size_t closest = static_cast<size_t>(min_frame_index_1);
+        window_begin = (closest > frame_window) ? (closest - frame_window) : 0;
+        window_end = std::min(closest + frame_window + 1, total_frames);
+    }
 }
 
 template <typename element_type, typename scalar_type, path_sz path_type>
@@ -161,7 +251,11 @@ void GeometricPathBase<element_type, scalar_type, path_type>::compute() {
 
 template <typename element_type, typename scalar_type, path_sz path_type>
 void GeometricPathBase<element_type, scalar_type, path_type>::determineClosestFrames() {
-    // Find the closest and the second closest frames
+    // Find the closest and the second closest frames among those evaluated
+    frame_index.resize(window_end - window_begin);
+    for (size_t i_frame = 0; i_frame < frame_index.size(); ++i_frame) {
+        frame_index[i_frame] = window_begin + i_frame;
+    }
     std::sort(frame_index.begin(), frame_index.end(), doCompareFrameDistance(*this));
     // Determine the sign
     sign = static_cast<long>(frame_index[0]) - static_cast<long>(frame_index[1]);
@@ -189,6 +283,14 @@ template <typename element_type, typename scalar_type, path_sz path_type>
 void GeometricPathBase<element_type, scalar_type, path_type>::computeValue() {
     updateDistanceToReferenceFrames();
     determineClosestFrames();
+    if (closestFramesOnWindowEdge()) {
+        // The closest frames may lie outside the window: scan all of them
+        window_begin = 0;
+        window_end = frame_distances.size();
+        updateDistanceToReferenceFrames();
+        determineClosestFrames();
+    }
+    updateFrameWindow();
     prepareVectors();
     v1v1 = scalar_type();
     v2v2 = scalar_type();
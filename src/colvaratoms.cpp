@@ -69,6 +69,20 @@ cvm::atom::atom(atom const &a)
 }
 
 
+cvm::atom cvm::atom::from_proxy_index(int proxy_index)
+{
+  cvm::atom a;
+  if (proxy_index >= 0) {
+    colvarproxy *p = cvm::proxy;
+    a.index = proxy_index;
+    a.id = p->get_atom_id(a.index);
+    a.update_mass();
+    a.update_charge();
+  }
+  return a;
+}
+
+
 cvm::atom::~atom()
 {
   if (index >= 0) {
@@ -112,6 +126,10 @@ cvm::atom_group::~atom_group()
   }
 
   cvm::main()->unregister_named_atom_group(this);
+
+  if (is_shared()) {
+    cvm::main()->remove_shared_atom_group(this);
+  }
 }
 
 
@@ -133,6 +151,8 @@ int cvm::atom_group::add_atom(cvm::atom const &a)
   // for consistency with add_atom_id(), we update the list as well
   atoms_ids.push_back(a.id);
   atoms.push_back(a);
+  atoms_index.push_back(a.proxy_index());
+  masses.push_back(a.mass);
   total_mass += a.mass;
   total_charge += a.charge;
 
@@ -160,6 +180,138 @@ int cvm::atom_group::add_atom_id(int aid)
 }
 
 
+namespace {
+
+  // Flag the elements of ids that are not in existing_ids, and not repeated
+  // earlier in ids, by sorting both lists and merging them
+  void select_new_atom_ids(std::vector<int> const &existing_ids,
+                           std::vector<int> const &ids,
+                           std::vector<bool> &is_new)
+  {
+    std::vector<int> existing(existing_ids);
+    std::sort(existing.begin(), existing.end());
+
+    std::vector< std::pair<int, size_t> > sorted_ids(ids.size());
+    for (size_t i = 0; i < ids.size(); i++) {
+      sorted_ids[i] = std::make_pair(ids[i], i);
+    }
+    std::sort(sorted_ids.begin(), sorted_ids.end());
+
+    is_new.assign(ids.size(), false);
+    std::vector<int>::const_iterator ei = existing.begin();
+    for (size_t k = 0; k < sorted_ids.size(); k++) {
+      int const id = sorted_ids[k].first;
+      if ((k > 0) && (sorted_ids[k-1].first == id)) {
+        continue;
+      }
+      while ((ei != existing.end()) && (*ei < id)) {
+        ei++;
+      }
+      if ((ei != existing.end()) && (*ei == id)) {
+        continue;
+      }
+      is_new[sorted_ids[k].second] = true;
+    }
+  }
+
+}
+
+
+int cvm::atom_group::add_atoms(std::vector<cvm::atom> const &new_atoms)
+{
+  std::vector<int> new_ids(new_atoms.size());
+  for (size_t i = 0; i < new_atoms.size(); i++) {
+    new_ids[i] = new_atoms[i].id;
+  }
+
+  std::vector<bool> is_new;
+  select_new_atom_ids(atoms_ids, new_ids, is_new);
+
+  size_t const num_new = std::count(is_new.begin(), is_new.end(), true);
+  atoms_ids.reserve(atoms_ids.size()+num_new);
+  atoms.reserve(atoms.size()+num_new);
+  atoms_index.reserve(atoms_index.size()+num_new);
+  masses.reserve(masses.size()+num_new);
+
+  int error_code = COLVARS_OK;
+
+  for (size_t i = 0; i < new_atoms.size(); i++) {
+    cvm::atom const &a = new_atoms[i];
+    if (a.id < 0) {
+      error_code |= COLVARS_ERROR;
+      continue;
+    }
+    if (!is_new[i]) {
+      if (cvm::debug())
+        cvm::log("Discarding doubly counted atom with number "+
+                 cvm::to_str(a.id+1)+".\n");
+      continue;
+    }
+    atoms_ids.push_back(a.id);
+    atoms.push_back(a);
+    atoms_index.push_back(a.proxy_index());
+    masses.push_back(a.mass);
+    total_mass += a.mass;
+    total_charge += a.charge;
+  }
+
+  return error_code;
+}
+
+
+int cvm::atom_group::add_atom_ids(std::vector<int> const &new_ids)
+{
+  std::vector<bool> is_new;
+  select_new_atom_ids(atoms_ids, new_ids, is_new);
+
+  atoms_ids.reserve(atoms_ids.size() +
+                    std::count(is_new.begin(), is_new.end(), true));
+
+  int error_code = COLVARS_OK;
+
+  for (size_t i = 0; i < new_ids.size(); i++) {
+    if (new_ids[i] < 0) {
+      error_code |= COLVARS_ERROR;
+      continue;
+    }
+    if (!is_new[i]) {
+      if (cvm::debug())
+        cvm::log("Discarding doubly counted atom with number "+
+                 cvm::to_str(new_ids[i]+1)+".\n");
+      continue;
+    }
+    atoms_ids.push_back(new_ids[i]);
+  }
+
+  return error_code;
+}
+
+
+int cvm::atom_group::add_atom_numbers(std::vector<int> const &atom_numbers)
+{
+  colvarproxy *p = cvm::proxy;
+
+  if (is_enabled(f_ag_scalable)) {
+    std::vector<int> new_ids(atom_numbers.size());
+    for (size_t i = 0; i < atom_numbers.size(); i++) {
+      new_ids[i] = p->check_atom_id(atom_numbers[i]);
+    }
+    return add_atom_ids(new_ids);
+  }
+
+  // if we are handling the group on rank 0, request all atoms from the
+  // proxy at once, and allocate the vector in one shot
+  std::vector<int> indices;
+  p->init_atoms(atom_numbers, indices);
+  std::vector<cvm::atom> new_atoms;
+  new_atoms.reserve(indices.size());
+  for (size_t i = 0; i < indices.size(); i++) {
+    new_atoms.push_back(cvm::atom::from_proxy_index(indices[i]));
+  }
+  return add_atoms(new_atoms);
+}
+
+
 int cvm::atom_group::remove_atom(cvm::atom_iter ai)
 {
   if (is_enabled(f_ag_scalable)) {
@@ -173,7 +325,10 @@ int cvm::atom_group::remove_atom(cvm::atom_iter ai)
   } else {
     total_mass -= ai->mass;
     total_charge -= ai->charge;
-    atoms_ids.erase(atoms_ids.begin() + (ai - atoms.begin()));
+    size_t const i = ai - atoms.begin();
+    atoms_ids.erase(atoms_ids.begin() + i);
+    if (masses.size() > i) masses.erase(masses.begin() + i);
+    if (atoms_index.size() > i) atoms_index.erase(atoms_index.begin() + i);
     atoms.erase(ai);
   }
 
@@ -213,6 +368,11 @@ int cvm::atom_group::init()
   // These may be overwritten by parse(), if a name is provided
 
   atoms.clear();
+  atoms_index.clear();
+  masses.clear();
+  pos_x.clear();
+  pos_y.clear();
+  pos_z.clear();
   init_dependencies();
   index = -1;
 
@@ -220,6 +380,10 @@ int cvm::atom_group::init()
   b_user_defined_fit = false;
   fitting_group = NULL;
 
+  shared_source = NULL;
+  b_shared_source = false;
+  b_shared_active = false;
+
   noforce = false;
 
   total_mass = 0.0;
@@ -298,9 +462,11 @@ int cvm::atom_group::setup()
       atoms_ids.push_back(ai->id);
     }
   }
-  for (cvm::atom_iter ai = atoms.begin(); ai != atoms.end(); ai++) {
-    ai->update_mass();
-    ai->update_charge();
+  atoms_index.resize(atoms.size());
+  for (size_t i = 0; i < atoms.size(); i++) {
+    atoms_index[i] = atoms[i].proxy_index();
+    atoms[i].update_mass();
+    atoms[i].update_charge();
   }
   update_total_mass();
   update_total_charge();
@@ -319,8 +485,10 @@ void cvm::atom_group::update_total_mass()
     total_mass = (cvm::proxy)->get_atom_group_mass(index);
   } else {
     total_mass = 0.0;
-    for (cvm::atom_iter ai = this->begin(); ai != this->end(); ai++) {
-      total_mass += ai->mass;
+    masses.resize(this->size());
+    for (size_t i = 0; i < this->size(); i++) {
+      masses[i] = atoms[i].mass;
+      total_mass += masses[i];
     }
   }
   if (total_mass < 1e-15) {
@@ -577,20 +745,18 @@ int cvm::atom_group::add_atoms_of_group(atom_group const *ag)
   std::vector<int> const &source_ids = ag->atoms_ids;
 
   if (source_ids.size()) {
-    atoms_ids.reserve(atoms_ids.size()+source_ids.size());
 
     if (is_enabled(f_ag_scalable)) {
-      for (size_t i = 0; i < source_ids.size(); i++) {
-        add_atom_id(source_ids[i]);
-      }
+      add_atom_ids(source_ids);
     } else {
-      atoms.reserve(atoms.size()+source_ids.size());
+      // We could use the atom copy constructor, but only if the source
+      // group is not scalable - whereas this works in both cases
+      // atom numbers are 1-based
+      std::vector<int> atom_numbers(source_ids.size());
       for (size_t i = 0; i < source_ids.size(); i++) {
-        // We could use the atom copy constructor, but only if the source
-        // group is not scalable - whereas this works in both cases
-        // atom constructor expects 1-based atom number
-        add_atom(cvm::atom(source_ids[i] + 1));
+        atom_numbers[i] = source_ids[i] + 1;
       }
+      add_atom_numbers(atom_numbers);
     }
 
     if (cvm::get_error()) return COLVARS_ERROR;
@@ -616,19 +782,8 @@ int cvm::atom_group::add_atom_numbers(std::string const &numbers_conf)
   }
 
   if (atom_indexes.size()) {
-    atoms_ids.reserve(atoms_ids.size()+atom_indexes.size());
 
-    if (is_enabled(f_ag_scalable)) {
-      for (size_t i = 0; i < atom_indexes.size(); i++) {
-        add_atom_id((cvm::proxy)->check_atom_id(atom_indexes[i]));
-      }
-    } else {
-      // if we are handling the group on rank 0, better allocate the vector in one shot
-      atoms.reserve(atoms.size()+atom_indexes.size());
-      for (size_t i = 0; i < atom_indexes.size(); i++) {
-        add_atom(cvm::atom(atom_indexes[i]));
-      }
-    }
+    add_atom_numbers(atom_indexes);
 
     if (cvm::get_error()) return COLVARS_ERROR;
   } else {
@@ -660,25 +815,7 @@ int cvm::atom_group::add_index_group(std::string const &index_group_name)
                       INPUT_ERROR);
   }
 
-  int error_code = COLVARS_OK;
-
-  std::vector<int> const &index_group = *(index_groups[i_group]);
-
-  atoms_ids.reserve(atoms_ids.size()+index_group.size());
-
-  if (is_enabled(f_ag_scalable)) {
-    for (size_t i = 0; i < index_group.size(); i++) {
-      error_code |=
-        add_atom_id((cvm::proxy)->check_atom_id(index_group[i]));
-    }
-  } else {
-    atoms.reserve(atoms.size()+index_group.size());
-    for (size_t i = 0; i < index_group.size(); i++) {
-      error_code |= add_atom(cvm::atom(index_group[i]));
-    }
-  }
-
-  return error_code;
+  return add_atom_numbers(*(index_groups[i_group]));
 }
 
 
@@ -692,18 +829,11 @@ int cvm::atom_group::add_atom_numbers_range(std::string const &range_conf)
          (is >> dash) && (dash == '-') &&
          (is >> final) && (final > 0) ) {
 
-      atoms_ids.reserve(atoms_ids.size() + (final - initial + 1));
-
-      if (is_enabled(f_ag_scalable)) {
-        for (int anum = initial; anum <= final; anum++) {
-          add_atom_id((cvm::proxy)->check_atom_id(anum));
-        }
-      } else {
-        atoms.reserve(atoms.size() + (final - initial + 1));
-        for (int anum = initial; anum <= final; anum++) {
-          add_atom(cvm::atom(anum));
-        }
+      std::vector<int> atom_numbers;
+      for (int anum = initial; anum <= final; anum++) {
+        atom_numbers.push_back(anum);
       }
+      add_atom_numbers(atom_numbers);
 
     }
     if (cvm::get_error()) return COLVARS_ERROR;
@@ -730,17 +860,19 @@ int cvm::atom_group::add_atom_name_residue_range(std::string const &psf_segid,
          (is >> dash) && (dash == '-') &&
          (is >> final) && (final > 0) ) {
 
-      atoms_ids.reserve(atoms_ids.size() + (final - initial + 1));
-
       if (is_enabled(f_ag_scalable)) {
+        std::vector<int> new_ids;
         for (int resid = initial; resid <= final; resid++) {
-          add_atom_id((cvm::proxy)->check_atom_id(resid, atom_name, psf_segid));
+          new_ids.push_back((cvm::proxy)->check_atom_id(resid, atom_name, psf_segid));
         }
+        add_atom_ids(new_ids);
       } else {
-        atoms.reserve(atoms.size() + (final - initial + 1));
+        std::vector<cvm::atom> new_atoms;
+        new_atoms.reserve((final >= initial) ? (final - initial + 1) : 0);
         for (int resid = initial; resid <= final; resid++) {
-          add_atom(cvm::atom(resid, atom_name, psf_segid));
+          new_atoms.push_back(cvm::atom(resid, atom_name, psf_segid));
         }
+        add_atoms(new_atoms);
       }
 
       if (cvm::get_error()) return COLVARS_ERROR;
@@ -868,8 +1000,6 @@ int cvm::atom_group::parse_fitting_options(std::string const &group_conf)
                "to its radius of gyration), the optimal rotation and its gradients may become discontinuous.  "
                "If that happens, use fittingGroup (or a different definition for it if already defined) "
                "to align the coordinates.\n");
-      // initialize rot member data
-      rot.request_group1_gradients(group_for_fit->size());
     }
   }
 
@@ -897,7 +1027,6 @@ void cvm::atom_group::do_feature_side_effects(int id)
       if (is_enabled(f_ag_center) || is_enabled(f_ag_rotate)) {
         atom_group *group_for_fit = fitting_group ? fitting_group : this;
         group_for_fit->fit_gradients.assign(group_for_fit->size(), cvm::atom_pos(0.0, 0.0, 0.0));
-        rot.request_group1_gradients(group_for_fit->size());
       }
       break;
   }
@@ -970,8 +1099,18 @@ void cvm::atom_group::read_positions()
 {
   if (b_dummy) return;
 
-  for (cvm::atom_iter ai = this->begin(); ai != this->end(); ai++) {
-    ai->read_position();
+  // Read straight from the proxy's buffer through the index list
+  std::vector<cvm::rvector> const &proxy_pos =
+    *((cvm::proxy)->get_atom_positions());
+  size_t const n = this->size();
+  pos_x.resize(n);
+  pos_y.resize(n);
+  pos_z.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    cvm::rvector const &p = proxy_pos[atoms_index[i]];
+    pos_x[i] = p.x;
+    pos_y[i] = p.y;
+    pos_z[i] = p.z;
   }
 
   if (fitting_group)
@@ -979,6 +1118,117 @@ void cvm::atom_group::read_positions()
 }
 
 
+bool cvm::atom_group::has_same_coordinates(atom_group const &g) const
+{
+  if (b_dummy || g.b_dummy) return false;
+  if (is_enabled(f_ag_scalable) || g.is_enabled(f_ag_scalable)) return false;
+  if (atoms_ids != g.atoms_ids) return false;
+
+  int const fit_features[] = { f_ag_center, f_ag_center_origin, f_ag_rotate };
+  for (size_t i = 0; i < sizeof(fit_features)/sizeof(int); i++) {
+    if (is_enabled(fit_features[i]) != g.is_enabled(fit_features[i])) {
+      return false;
+    }
+  }
+
+  if (is_enabled(f_ag_center) || is_enabled(f_ag_rotate)) {
+    if ((fitting_group == NULL) != (g.fitting_group == NULL)) return false;
+    if (fitting_group && (fitting_group->ids() != g.fitting_group->ids())) {
+      return false;
+    }
+    if ((ref_pos_cog - g.ref_pos_cog).norm2() > 0.0) return false;
+    if (ref_pos.size() != g.ref_pos.size()) return false;
+    for (size_t i = 0; i < ref_pos.size(); i++) {
+      if ((ref_pos[i] - g.ref_pos[i]).norm2() > 0.0) return false;
+    }
+  }
+
+  return true;
+}
+
+
+void cvm::atom_group::share_data_of(atom_group *source)
+{
+  shared_source = source;
+  b_shared_source = false;
+  source->b_shared_source = true;
+  // the source computes the union of the derivatives requested by its copies
+  if (rot.dQ0_1.size() && !source->rot.dQ0_1.size()) {
+    source->rot.request_group1_gradients(rot.dQ0_1.size());
+  }
+  if (rot.dQ0_2.size() && !source->rot.dQ0_2.size()) {
+    source->rot.request_group2_gradients(rot.dQ0_2.size());
+  }
+}
+
+
+void cvm::atom_group::restore_shared_data()
+{
+  if (shared_source) {
+    pos_x = shared_source->pos_x;
+    pos_y = shared_source->pos_y;
+    pos_z = shared_source->pos_z;
+    cog = shared_source->cog;
+    com = shared_source->com;
+    cog_orig = shared_source->cog_orig;
+    if (is_enabled(f_ag_rotate)) {
+      // rotation owns its eigensolver: copy only its results, and the
+      // derivatives that this group requested
+      cvm::rotation const &src_rot = shared_source->rot;
+      rot.q = src_rot.q;
+      rot.lambda = src_rot.lambda;
+      rot.C = src_rot.C;
+      rot.S = src_rot.S;
+      rot.S_eigval = src_rot.S_eigval;
+      rot.S_eigvec = src_rot.S_eigvec;
+      rot.dQ0_proj = src_rot.dQ0_proj;
+      if (rot.dQ0_1.size()) {
+        rot.dL0_1 = src_rot.dL0_1;
+        rot.dQ0_1 = src_rot.dQ0_1;
+      }
+      if (rot.dQ0_2.size()) {
+        rot.dL0_2 = src_rot.dL0_2;
+        rot.dQ0_2 = src_rot.dQ0_2;
+      }
+    }
+    if (fitting_group) {
+      atom_group const &src_fit = *(shared_source->fitting_group);
+      fitting_group->pos_x = src_fit.pos_x;
+      fitting_group->pos_y = src_fit.pos_y;
+      fitting_group->pos_z = src_fit.pos_z;
+      fitting_group->cog = src_fit.cog;
+      fitting_group->com = src_fit.com;
+      fitting_group->cog_orig = src_fit.cog_orig;
+    }
+  }
+}
+
+
+void cvm::atom_group::scatter_positions()
+{
+  for (size_t i = 0; i < this->size(); i++) {
+    atoms[i].pos = cvm::atom_pos(pos_x[i], pos_y[i], pos_z[i]);
+  }
+}
+
+
+void cvm::atom_group::reset_gradients()
+{
+  size_t const n = this->size();
+  grad_x.assign(n, 0.0);
+  grad_y.assign(n, 0.0);
+  grad_z.assign(n, 0.0);
+}
+
+
+void cvm::atom_group::scatter_gradients()
+{
+  for (size_t i = 0; i < this->size(); i++) {
+    atoms[i].grad = cvm::rvector(grad_x[i], grad_y[i], grad_z[i]);
+  }
+}
+
+
 int cvm::atom_group::calc_required_properties()
 {
   // TODO check if the com is needed?
@@ -1029,19 +1279,15 @@ void cvm::atom_group::calc_apply_roto_translation()
   if (is_enabled(f_ag_rotate)) {
     // rotate the group (around the center of geometry if f_ag_center is
     // enabled, around the origin otherwise)
-    rot.calc_optimal_rotation(fitting_group ?
-                              fitting_group->positions() :
-                              this->positions(),
+    atom_group const *group_for_fit = fitting_group ? fitting_group : this;
+    rot.calc_optimal_rotation(group_for_fit->pos_x,
+                              group_for_fit->pos_y,
+                              group_for_fit->pos_z,
                               ref_pos);
 
-    cvm::atom_iter ai;
-    for (ai = this->begin(); ai != this->end(); ai++) {
-      ai->pos = rot.rotate(ai->pos);
-    }
+    rotate_positions();
     if (fitting_group) {
-      for (ai = fitting_group->begin(); ai != fitting_group->end(); ai++) {
-        ai->pos = rot.rotate(ai->pos);
-      }
+      fitting_group->rotate_positions();
     }
   }
 
@@ -1052,10 +1298,35 @@ void cvm::atom_group::calc_apply_roto_translation()
       fitting_group->apply_translation(ref_pos_cog);
     }
   }
+
   // update of COM and COG is done from the calling routine
 }
 
 
+void cvm::atom_group::rotate_positions()
+{
+  cvm::rmatrix const R = rot.matrix();
+  cvm::real const rxx = R.xx(), rxy = R.xy(), rxz = R.xz();
+  cvm::real const ryx = R.yx(), ryy = R.yy(), ryz = R.yz();
+  cvm::real const rzx = R.zx(), rzy = R.zy(), rzz = R.zz();
+  size_t const n = this->size();
+  cvm::real *px = n ? &(pos_x[0]) : NULL;
+  cvm::real *py = n ? &(pos_y[0]) : NULL;
+  cvm::real *pz = n ? &(pos_z[0]) : NULL;
+  bool const b_smp = (cvm::proxy)->smp_atoms_loop_enabled(n);
+  (void) b_smp;
+#if defined(_OPENMP)
+#pragma omp parallel for if (b_smp)
+#endif
+  for (long i = 0; i < long(n); i++) {
+    cvm::real const x = px[i], y = py[i], z = pz[i];
+    px[i] = rxx * x + rxy * y + rxz * z;
+    py[i] = ryx * x + ryy * y + ryz * z;
+    pz[i] = rzx * x + rzy * y + rzz * z;
+  }
+}
+
+
 void cvm::atom_group::apply_translation(cvm::rvector const &t)
 {
   if (b_dummy) {
@@ -1068,8 +1339,20 @@ void cvm::atom_group::apply_translation(cvm::rvector const &t)
     return;
   }
 
-  for (cvm::atom_iter ai = this->begin(); ai != this->end(); ai++) {
-    ai->pos += t;
+  size_t const n = this->size();
+  cvm::real *px = n ? &(pos_x[0]) : NULL;
+  cvm::real *py = n ? &(pos_y[0]) : NULL;
+  cvm::real *pz = n ? &(pos_z[0]) : NULL;
+  cvm::real const tx = t.x, ty = t.y, tz = t.z;
+  bool const b_smp = (cvm::proxy)->smp_atoms_loop_enabled(n);
+  (void) b_smp;
+#if defined(_OPENMP)
+#pragma omp parallel for if (b_smp)
+#endif
+  for (long i = 0; i < long(n); i++) {
+    px[i] += tx;
+    py[i] += ty;
+    pz[i] += tz;
   }
 }
 
@@ -1120,11 +1403,15 @@ int cvm::atom_group::calc_center_of_geometry()
   if (b_dummy) {
     cog = dummy_atom_pos;
   } else {
-    cog.reset();
-    for (cvm::atom_const_iter ai = this->begin(); ai != this->end(); ai++) {
-      cog += ai->pos;
+    cvm::real cog_x = 0.0, cog_y = 0.0, cog_z = 0.0;
+    size_t const n = this->size();
+    for (size_t i = 0; i < n; i++) {
+      cog_x += pos_x[i];
+      cog_y += pos_y[i];
+      cog_z += pos_z[i];
     }
-    cog /= this->size();
+    cog = cvm::atom_pos(cog_x, cog_y, cog_z);
+    cog /= cvm::real(n);
   }
   return COLVARS_OK;
 }
@@ -1140,10 +1427,14 @@ int cvm::atom_group::calc_center_of_mass()
   } else if (is_enabled(f_ag_scalable)) {
     com = (cvm::proxy)->get_atom_group_com(index);
   } else {
-    com.reset();
-    for (cvm::atom_const_iter ai = this->begin(); ai != this->end(); ai++) {
-      com += ai->mass * ai->pos;
+    cvm::real com_x = 0.0, com_y = 0.0, com_z = 0.0;
+    size_t const n = this->size();
+    for (size_t i = 0; i < n; i++) {
+      com_x += masses[i] * pos_x[i];
+      com_y += masses[i] * pos_y[i];
+      com_z += masses[i] * pos_z[i];
     }
+    com = cvm::atom_pos(com_x, com_y, com_z);
     com /= total_mass;
   }
   return COLVARS_OK;
@@ -1157,8 +1448,8 @@ int cvm::atom_group::calc_dipole(cvm::atom_pos const &dipole_center)
                       "of a dummy group.\n", INPUT_ERROR);
   }
   dip.reset();
-  for (cvm::atom_const_iter ai = this->begin(); ai != this->end(); ai++) {
-    dip += ai->charge * (ai->pos - dipole_center);
+  for (size_t i = 0; i < this->size(); i++) {
+    dip += atoms[i].charge * (position(i) - dipole_center);
   }
   return COLVARS_OK;
 }
@@ -1171,9 +1462,17 @@ void cvm::atom_group::set_weighted_gradient(cvm::rvector const &grad)
   scalar_com_gradient = grad;
 
   if (!is_enabled(f_ag_scalable)) {
-    for (cvm::atom_iter ai = this->begin(); ai != this->end(); ai++) {
-      ai->grad = (ai->mass/total_mass) * grad;
+    size_t const n = this->size();
+    grad_x.resize(n);
+    grad_y.resize(n);
+    grad_z.resize(n);
+    for (size_t i = 0; i < n; i++) {
+      cvm::real const w = masses[i]/total_mass;
+      grad_x[i] = w * grad.x;
+      grad_y[i] = w * grad.y;
+      grad_z[i] = w * grad.z;
     }
+    scatter_gradients();
   }
 }
 
@@ -1207,22 +1506,23 @@ void cvm::atom_group::calc_fit_gradients()
     // add the rotation matrix contribution to the gradients
     cvm::rotation const rot_inv = rot.inverse();
 
+    // dQ0/dx_j does not depend on i: first sum the contractions over the
+    // atoms of this group, then multiply once for each atom of the fitting group
+    cvm::quaternion sum_dxdq(0.0, 0.0, 0.0, 0.0);
+
     for (size_t i = 0; i < this->size(); i++) {
 
       // compute centered, unrotated position
       cvm::atom_pos const pos_orig =
-        rot_inv.rotate((is_enabled(f_ag_center) ? (atoms[i].pos - ref_pos_cog) : (atoms[i].pos)));
+        rot_inv.rotate((is_enabled(f_ag_center) ? (position(i) - ref_pos_cog) : position(i)));
 
       // calculate \partial(R(q) \vec{x}_i)/\partial q) \cdot \partial\xi/\partial\vec{x}_i
-      cvm::quaternion const dxdq =
-        rot.q.position_derivative_inner(pos_orig, atoms[i].grad);
+      sum_dxdq += rot.q.position_derivative_inner(pos_orig, atoms[i].grad);
+    }
 
-      for (size_t j = 0; j < group_for_fit->size(); j++) {
-        // multiply by {\partial q}/\partial\vec{x}_j and add it to the fit gradients
-        for (size_t iq = 0; iq < 4; iq++) {
-          group_for_fit->fit_gradients[j] += dxdq[iq] * rot.dQ0_1[j][iq];
-        }
-      }
+    for (size_t j = 0; j < group_for_fit->size(); j++) {
+      // multiply by {\partial q}/\partial\vec{x}_j and add it to the fit gradients
+      group_for_fit->fit_gradients[j] += rot.dQ0_1_dot(ref_pos[j], sum_dxdq);
     }
   }
 
@@ -1243,11 +1543,10 @@ std::vector<cvm::atom_pos> cvm::atom_group::positions() const
                "from a scalable atom group.\n", INPUT_ERROR);
   }
 
-  std::vector<cvm::atom_pos> x(this->size(), 0.0);
-  cvm::atom_const_iter ai = this->begin();
-  std::vector<cvm::atom_pos>::iterator xi = x.begin();
-  for ( ; ai != this->end(); ++xi, ++ai) {
-    *xi = ai->pos;
+  size_t const n = this->size();
+  std::vector<cvm::atom_pos> x(n, 0.0);
+  for (size_t i = 0; i < n; i++) {
+    x[i] = cvm::atom_pos(pos_x[i], pos_y[i], pos_z[i]);
   }
   return x;
 }
@@ -1264,11 +1563,11 @@ std::vector<cvm::atom_pos> cvm::atom_group::positions_shifted(cvm::rvector const
                "from a scalable atom group.\n", INPUT_ERROR);
   }
 
-  std::vector<cvm::atom_pos> x(this->size(), 0.0);
-  cvm::atom_const_iter ai = this->begin();
-  std::vector<cvm::atom_pos>::iterator xi = x.begin();
-  for ( ; ai != this->end(); ++xi, ++ai) {
-    *xi = (ai->pos + shift);
+  size_t const n = this->size();
+  std::vector<cvm::atom_pos> x(n, 0.0);
+  for (size_t i = 0; i < n; i++) {
+    x[i] = cvm::atom_pos(pos_x[i] + shift.x, pos_y[i] + shift.y,
+                         pos_z[i] + shift.z);
   }
   return x;
 }
@@ -1355,6 +1654,24 @@ void cvm::atom_group::apply_colvar_force(cvm::real const &force)
     return;
   }
 
+  if (is_shared()) {
+    // summed with the forces on the identical groups, and applied once by
+    // the source group (see apply_shared_forces())
+    atom_group *source = shared_source ? shared_source : this;
+    bool const add_fit_forces = (is_enabled(f_ag_center) || is_enabled(f_ag_rotate)) &&
+      is_enabled(f_ag_fit_gradients);
+    source->shared_forces.resize(this->size(), cvm::rvector(0.0));
+    if (add_fit_forces) {
+      source->shared_fit_forces.resize(this->size(), cvm::rvector(0.0));
+    }
+    for (size_t i = 0; i < this->size(); i++) {
+      cvm::rvector const f = force * atoms[i].grad;
+      source->shared_forces[i] += f;
+      if (add_fit_forces) source->shared_fit_forces[i] += f;
+    }
+    return;
+  }
+
   if (is_enabled(f_ag_rotate)) {
 
     // rotate forces back to the original frame
@@ -1365,8 +1682,11 @@ void cvm::atom_group::apply_colvar_force(cvm::real const &force)
 
   } else {
 
-    for (cvm::atom_iter ai = this->begin(); ai != this->end(); ai++) {
-      ai->apply_force(force * ai->grad);
+    // accumulate directly into the proxy's buffer
+    std::vector<cvm::rvector> &proxy_forces =
+      *((cvm::proxy)->modify_atom_applied_forces());
+    for (size_t i = 0; i < this->size(); i++) {
+      proxy_forces[atoms_index[i]] += force * atoms[i].grad;
     }
   }
 
@@ -1401,6 +1721,15 @@ void cvm::atom_group::apply_force(cvm::rvector const &force)
     return;
   }
 
+  if (is_shared()) {
+    atom_group *source = shared_source ? shared_source : this;
+    source->shared_forces.resize(this->size(), cvm::rvector(0.0));
+    for (size_t i = 0; i < this->size(); i++) {
+      source->shared_forces[i] += (masses[i]/total_mass) * force;
+    }
+    return;
+  }
+
   if (is_enabled(f_ag_rotate)) {
 
     cvm::rotation const rot_inv = rot.inverse();
@@ -1410,10 +1739,68 @@ void cvm::atom_group::apply_force(cvm::rvector const &force)
 
   } else {
 
-    for (cvm::atom_iter ai = this->begin(); ai != this->end(); ai++) {
-      ai->apply_force((ai->mass/total_mass) * force);
+    std::vector<cvm::rvector> &proxy_forces =
+      *((cvm::proxy)->modify_atom_applied_forces());
+    for (size_t i = 0; i < this->size(); i++) {
+      proxy_forces[atoms_index[i]] += (masses[i]/total_mass) * force;
+    }
+  }
+}
+
+
+
+void cvm::atom_group::apply_shared_forces()
+{
+  if (shared_forces.empty()) return;
+
+  std::vector<cvm::rvector> &proxy_forces =
+    *((cvm::proxy)->modify_atom_applied_forces());
+
+  cvm::rotation const rot_inv = rot.inverse();
+
+  if (is_enabled(f_ag_rotate)) {
+    // rotate forces back to the original frame
+    for (size_t i = 0; i < this->size(); i++) {
+      proxy_forces[atoms_index[i]] += rot_inv.rotate(shared_forces[i]);
+    }
+  } else {
+    for (size_t i = 0; i < this->size(); i++) {
+      proxy_forces[atoms_index[i]] += shared_forces[i];
+    }
+  }
+
+  if (!shared_fit_forces.empty()) {
+
+    // same as calc_fit_gradients(), using the summed forces as gradients
+    atom_group *group_for_fit = fitting_group ? fitting_group : this;
+
+    cvm::rvector center_force(0.0);
+    if (is_enabled(f_ag_center)) {
+      for (size_t i = 0; i < this->size(); i++) {
+        center_force += shared_fit_forces[i];
+      }
+      if (is_enabled(f_ag_rotate)) center_force = rot_inv.rotate(center_force);
+      center_force *= (-1.0)/(cvm::real(group_for_fit->size()));
+    }
+
+    cvm::quaternion sum_dxdq(0.0, 0.0, 0.0, 0.0);
+    if (is_enabled(f_ag_rotate)) {
+      for (size_t i = 0; i < this->size(); i++) {
+        cvm::atom_pos const pos_orig =
+          rot_inv.rotate((is_enabled(f_ag_center) ? (position(i) - ref_pos_cog) : position(i)));
+        sum_dxdq += rot.q.position_derivative_inner(pos_orig, shared_fit_forces[i]);
+      }
+    }
+
+    for (size_t j = 0; j < group_for_fit->size(); j++) {
+      cvm::rvector f = center_force;
+      if (is_enabled(f_ag_rotate)) f += rot.dQ0_1_dot(ref_pos[j], sum_dxdq);
+      (*group_for_fit)[j].apply_force(f);
     }
   }
+
+  shared_forces.clear();
+  shared_fit_forces.clear();
 }
 
 
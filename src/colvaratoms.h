@@ -87,6 +87,11 @@ public:
   /// Copy constructor
   atom(atom const &a);
 
+  /// \brief Atom object for a slot of the colvarproxy arrays that has
+  /// already been initialized (see colvarproxy::init_atoms()) \param
+  /// proxy_index Index in the colvarproxy arrays (an error code if negative)
+  static atom from_proxy_index(int proxy_index);
+
   /// Destructor
   ~atom();
 
@@ -111,6 +116,12 @@ public:
     charge = p->get_atom_charge(index);
   }
 
+  /// Index in the colvarproxy arrays
+  inline int proxy_index() const
+  {
+    return index;
+  }
+
   /// Get the current position
   inline void read_position()
   {
@@ -200,6 +211,19 @@ public:
   /// \brief Add an atom ID to this group (the actual atomicdata will be not be handled by the group)
   int add_atom_id(int aid);
 
+  /// \brief Add a list of atom objects to this group, skipping those already
+  /// in the group or repeated in the list; faster than add_atom() for long
+  /// lists, because duplicates are found by sorting
+  int add_atoms(std::vector<cvm::atom> const &new_atoms);
+
+  /// \brief Add a list of atom IDs to this group, skipping those already in
+  /// the group or repeated in the list (see add_atoms())
+  int add_atom_ids(std::vector<int> const &new_ids);
+
+  /// \brief Add the atoms with the given numbers (starting from 1), either
+  /// as atom objects or as atom IDs if the group is scalable
+  int add_atom_numbers(std::vector<int> const &atom_numbers);
+
   /// \brief Remove an atom object from this group
   int remove_atom(cvm::atom_iter ai);
 
@@ -241,6 +265,10 @@ protected:
   /// \brief Internal atom IDs for host code
   std::vector<int> atoms_ids;
 
+  /// \brief Indices of the atoms in the colvarproxy arrays, used to read
+  /// positions and write forces directly from/to the proxy buffers
+  std::vector<int> atoms_index;
+
   /// Sorted list of internal atom IDs (populated on-demand by
   /// create_sorted_ids); used to read coordinate files
   std::vector<int> sorted_atoms_ids;
@@ -360,7 +388,52 @@ public:
   /// only to calculate a colvar)
   bool noforce;
 
-  /// \brief Get the current positions
+  /// \brief Another group with the same atoms and fitting options, whose
+  /// positions, centers and rotation are reused by this group
+  atom_group *shared_source;
+
+  /// \brief Whether other groups reuse the positions, centers and rotation
+  /// of this group
+  bool b_shared_source;
+
+  /// \brief Whether this group is the source of shared data and at least
+  /// one of the components that use it is active in this step
+  bool b_shared_active;
+
+  /// \brief Forces from all groups sharing this source, in the frame of
+  /// the group (applied at once by apply_shared_forces())
+  std::vector<cvm::rvector> shared_forces;
+
+  /// \brief Part of shared_forces that also acts through the fitting
+  /// transformation, i.e. from groups with f_ag_fit_gradients
+  std::vector<cvm::rvector> shared_fit_forces;
+
+  /// \brief Whether this group is computed only once together with
+  /// identical groups (see colvarmodule::setup_shared_atom_groups())
+  inline bool is_shared() const
+  {
+    return b_shared_source || (shared_source != NULL);
+  }
+
+  /// \brief Whether g has the same atoms (in the same order) and the same
+  /// fitting options and reference positions as this group
+  bool has_same_coordinates(atom_group const &g) const;
+
+  /// \brief Make this group reuse the data of source, which will also
+  /// compute the derivatives of the rotation requested by this group
+  void share_data_of(atom_group *source);
+
+  /// \brief Copy positions, centers and rotation from shared_source (the
+  /// source group keeps its own, which reset_atoms_data() does not clear)
+  void restore_shared_data();
+
+  /// \brief Apply the forces accumulated in shared_forces and
+  /// shared_fit_forces by all groups sharing this source, then reset them
+  void apply_shared_forces();
+
+  /// \brief Get the current positions from the proxy's buffer into pos_x,
+  /// pos_y, pos_z (the pos member of each atom is not set: see
+  /// scatter_positions())
   void read_positions();
 
   /// \brief (Re)calculate the optimal roto-translation
@@ -375,9 +448,13 @@ public:
   /// reference positions (eg. RMSD, eigenvector).
   void center_ref_pos();
 
-  /// \brief Move all positions
+  /// \brief Move all positions (only pos_x, pos_y, pos_z are updated)
   void apply_translation(cvm::rvector const &t);
 
+  /// \brief Rotate all positions by rot (only pos_x, pos_y, pos_z are
+  /// updated)
+  void rotate_positions();
+
   /// \brief Get the current velocities; this must be called always
   /// *after* read_positions(); if f_ag_rotate is defined, the same
   /// rotation applied to the coordinates will be used
@@ -403,6 +480,37 @@ public:
   /// \brief Return a copy of the current atom positions
   std::vector<cvm::atom_pos> positions() const;
 
+  /// \brief Cartesian components of the atom positions, each stored in its
+  /// own contiguous array; these are updated by read_positions() and by
+  /// calc_required_properties(), and are the only copy of the positions
+  /// kept by the group
+  std::vector<cvm::real> pos_x, pos_y, pos_z;
+
+  /// \brief Cartesian components of the atom gradients, each stored in its
+  /// own contiguous array; CVCs that compute gradients into these must call
+  /// scatter_gradients() to make them available to the rest of the code
+  std::vector<cvm::real> grad_x, grad_y, grad_z;
+
+  /// \brief Masses of the atoms (updated by update_total_mass())
+  std::vector<cvm::real> masses;
+
+  /// \brief Position of the i-th atom, taken from pos_x, pos_y, pos_z
+  inline cvm::atom_pos position(size_t const i) const
+  {
+    return cvm::atom_pos(pos_x[i], pos_y[i], pos_z[i]);
+  }
+
+  /// \brief Copy pos_x, pos_y, pos_z into the pos member of each atom; only
+  /// needed by code that reads cvm::atom::pos (e.g. volumetric maps
+  /// computed by the back-end), which must call it itself
+  void scatter_positions();
+
+  /// \brief Set grad_x, grad_y, grad_z to zero
+  void reset_gradients();
+
+  /// \brief Copy grad_x, grad_y, grad_z into the grad member of each atom
+  void scatter_gradients();
+
   /// \brief Calculate the center of geometry of the atomic positions, assuming
   /// that they are already pbc-wrapped
   int calc_center_of_geometry();
@@ -15,6 +15,7 @@
 #include "colvarvalue.h"
 #include "colvarbias.h"
 #include "colvargrid.h"
+#include "colvartraj.h"
 
 
 colvarbias::colvarbias(char const *key)
@@ -639,6 +640,15 @@ std::ostream & colvarbias::write_traj(std::ostream &os)
 }
 
 
+int colvarbias::write_traj_columns(colvartraj_frame &frame)
+{
+  if (b_output_energy) {
+    frame.add("E_", this->name, bias_energy);
+  }
+  return COLVARS_OK;
+}
+
+
 
 colvarbias_ti::colvarbias_ti(char const *key)
   : colvarbias(key)
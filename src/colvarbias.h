@@ -32,6 +32,9 @@ public:
   /// If there is more than one bias of this type, record its rank
   int rank;
 
+  /// Time spent updating this bias and communicating its forces
+  cvm::profile_counter profile;
+
   /// Add a new collective variable to this bias
   int add_colvar(std::string const &cv_name);
 
@@ -176,6 +179,10 @@ public:
   /// Output quantities such as the bias energy to the trajectory file
   virtual std::ostream & write_traj(std::ostream &os);
 
+  /// \brief Append the same quantities as write_traj() to a frame of the
+  /// binary trajectory file
+  virtual int write_traj_columns(colvartraj_frame &frame);
+
   /// (Re)initialize the output files (does not write them yet)
   virtual int setup_output()
   {
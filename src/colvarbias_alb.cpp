@@ -12,6 +12,7 @@
 #include "colvarmodule.h"
 #include "colvarbias.h"
 #include "colvarbias_alb.h"
+#include "colvartraj.h"
 
 #ifdef _MSC_VER
 #if _MSC_VER <= 1700
@@ -400,6 +401,36 @@ std::ostream & colvarbias_alb::write_traj(std::ostream &os)
 }
 
 
+int colvarbias_alb::write_traj_columns(colvartraj_frame &frame)
+{
+  if (b_output_energy) {
+    frame.add("E_", this->name, bias_energy);
+  }
+
+  if (b_output_coupling) {
+    for (size_t i = 0; i < current_coupling.size(); i++) {
+      frame.add("ForceConst_", cvm::to_str(i), current_coupling[i]);
+    }
+  }
+
+  if (b_output_centers) {
+    for (size_t i = 0; i < num_variables(); i++) {
+      frame.add("x0_", colvars[i]->name, colvar_centers[i]);
+    }
+  }
+
+  if (b_output_grad) {
+    for (size_t i = 0; i < means.size(); i++) {
+      frame.add("Grad_", colvars[i]->name,
+                -2.0 * (means[i] / (static_cast<cvm::real>(colvar_centers[i])) - 1) *
+                ssd[i] / (fmax(update_calls, 2.0) - 1));
+    }
+  }
+
+  return COLVARS_OK;
+}
+
+
 cvm::real colvarbias_alb::restraint_potential(cvm::real k,
                                               colvar const *x,
                                               colvarvalue const &xcenter) const
@@ -27,6 +27,7 @@ public:
   virtual int set_state_params(std::string const &conf);
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
 
 protected:
 
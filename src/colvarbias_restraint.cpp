@@ -11,6 +11,7 @@
 #include "colvarproxy.h"
 #include "colvarvalue.h"
 #include "colvarbias_restraint.h"
+#include "colvartraj.h"
 
 
 
@@ -88,6 +89,12 @@ std::ostream & colvarbias_restraint::write_traj(std::ostream &os)
 }
 
 
+int colvarbias_restraint::write_traj_columns(colvartraj_frame &frame)
+{
+  return colvarbias::write_traj_columns(frame);
+}
+
+
 
 colvarbias_restraint_centers::colvarbias_restraint_centers(char const *key)
   : colvarbias(key), colvarbias_ti(key), colvarbias_restraint(key)
@@ -487,6 +494,22 @@ std::ostream & colvarbias_restraint_centers_moving::write_traj(std::ostream &os)
 }
 
 
+int colvarbias_restraint_centers_moving::write_traj_columns(colvartraj_frame &frame)
+{
+  if (b_output_centers) {
+    for (size_t i = 0; i < num_variables(); i++) {
+      frame.add("x0_", variables(i)->name, colvar_centers[i]);
+    }
+  }
+
+  if (b_chg_centers && is_enabled(f_cvb_output_acc_work)) {
+    frame.add("W_", this->name, acc_work);
+  }
+
+  return COLVARS_OK;
+}
+
+
 
 colvarbias_restraint_k_moving::colvarbias_restraint_k_moving(char const *key)
   : colvarbias(key),
@@ -705,6 +728,15 @@ std::ostream & colvarbias_restraint_k_moving::write_traj(std::ostream &os)
 }
 
 
+int colvarbias_restraint_k_moving::write_traj_columns(colvartraj_frame &frame)
+{
+  if (b_chg_force_k && is_enabled(f_cvb_output_acc_work)) {
+    frame.add("W_", this->name, acc_work);
+  }
+  return COLVARS_OK;
+}
+
+
 
 colvarbias_restraint_harmonic::colvarbias_restraint_harmonic(char const *key)
   : colvarbias(key),
@@ -831,6 +863,16 @@ std::ostream & colvarbias_restraint_harmonic::write_traj(std::ostream &os)
 }
 
 
+int colvarbias_restraint_harmonic::write_traj_columns(colvartraj_frame &frame)
+{
+  int error_code = COLVARS_OK;
+  error_code |= colvarbias_restraint::write_traj_columns(frame);
+  error_code |= colvarbias_restraint_centers_moving::write_traj_columns(frame);
+  error_code |= colvarbias_restraint_k_moving::write_traj_columns(frame);
+  return error_code;
+}
+
+
 int colvarbias_restraint_harmonic::change_configuration(std::string const &conf)
 {
   return colvarbias_restraint_centers::change_configuration(conf) |
@@ -1126,6 +1168,189 @@ std::ostream & colvarbias_restraint_harmonic_walls::write_traj(std::ostream &os)
 }
 
 
+int colvarbias_restraint_harmonic_walls::write_traj_columns(colvartraj_frame &frame)
+{
+  int error_code = COLVARS_OK;
+  error_code |= colvarbias_restraint::write_traj_columns(frame);
+  error_code |= colvarbias_restraint_k_moving::write_traj_columns(frame);
+  return error_code;
+}
+
+
+
+colvarbias_restraint_harmonic_walls_vector::colvarbias_restraint_harmonic_walls_vector(char const *key)
+  : colvarbias(key),
+    colvarbias_ti(key),
+    colvarbias_restraint(key),
+    colvarbias_restraint_k(key)
+{
+  lower_wall_k = -1.0;
+  upper_wall_k = -1.0;
+}
+
+
+int colvarbias_restraint_harmonic_walls_vector::init(std::string const &conf)
+{
+  colvarbias_restraint::init(conf);
+  colvarbias_restraint_k::init(conf);
+
+  size_t i;
+
+  element_offsets.resize(num_variables()+1);
+  element_offsets[0] = 0;
+  for (i = 0; i < num_variables(); i++) {
+    colvarvalue::Type const vt = variables(i)->value().type();
+    if ((vt != colvarvalue::type_scalar) && (vt != colvarvalue::type_vector)) {
+      return cvm::error("Error: variable \""+variables(i)->name+
+                        "\" is neither a scalar nor a vector of numbers.\n",
+                        INPUT_ERROR);
+    }
+    if (variables(i)->is_enabled(f_cv_periodic)) {
+      return cvm::error("Error: variable \""+variables(i)->name+
+                        "\" is periodic, which is not supported.\n",
+                        INPUT_ERROR);
+    }
+    element_offsets[i+1] = element_offsets[i] + variables(i)->value().size();
+  }
+  size_t const num_elements = element_offsets[num_variables()];
+
+  get_keyval(conf, "lowerWalls", lower_walls, lower_walls);
+  get_keyval(conf, "upperWalls", upper_walls, upper_walls);
+
+  if ((lower_walls.size() == 0) && (upper_walls.size() == 0)) {
+    return cvm::error("Error: no walls provided.\n", INPUT_ERROR);
+  }
+
+  if ((lower_walls.size() > 0) && (lower_walls.size() != num_elements)) {
+    return cvm::error("Error: the number of lower walls ("+
+                      cvm::to_str(lower_walls.size())+
+                      ") does not match the total number of elements "
+                      "of the variables ("+cvm::to_str(num_elements)+").\n",
+                      INPUT_ERROR);
+  }
+  if ((upper_walls.size() > 0) && (upper_walls.size() != num_elements)) {
+    return cvm::error("Error: the number of upper walls ("+
+                      cvm::to_str(upper_walls.size())+
+                      ") does not match the total number of elements "
+                      "of the variables ("+cvm::to_str(num_elements)+").\n",
+                      INPUT_ERROR);
+  }
+
+  if ((lower_walls.size() > 0) && (upper_walls.size() > 0)) {
+    for (size_t ie = 0; ie < num_elements; ie++) {
+      if (lower_walls[ie] > upper_walls[ie]) {
+        return cvm::error("Error: upper wall number "+cvm::to_str(ie+1)+
+                          ", "+cvm::to_str(upper_walls[ie])+
+                          ", is lower than the lower wall, "+
+                          cvm::to_str(lower_walls[ie])+".\n",
+                          INPUT_ERROR);
+      }
+    }
+  }
+
+  if (lower_walls.size() > 0) {
+    get_keyval(conf, "lowerWallConstant", lower_wall_k,
+               (lower_wall_k > 0.0) ? lower_wall_k : force_k);
+  }
+  if (upper_walls.size() > 0) {
+    get_keyval(conf, "upperWallConstant", upper_wall_k,
+               (upper_wall_k > 0.0) ? upper_wall_k : force_k);
+  }
+
+  // Same convention as harmonicWalls: force_k is the geometric mean of the
+  // two constants, which are then stored as relative values
+  if ((lower_walls.size() > 0) && (upper_walls.size() > 0)) {
+    if (lower_wall_k * upper_wall_k <= 0.0) {
+      return cvm::error("Error: lowerWallConstant and upperWallConstant, "
+                        "when defined, must both be positive.\n",
+                        INPUT_ERROR);
+    }
+    force_k = cvm::sqrt(lower_wall_k * upper_wall_k);
+    lower_wall_k /= force_k;
+    upper_wall_k /= force_k;
+  } else {
+    if (lower_walls.size() > 0) {
+      force_k = lower_wall_k;
+      lower_wall_k = 1.0;
+    }
+    if (upper_walls.size() > 0) {
+      force_k = upper_wall_k;
+      upper_wall_k = 1.0;
+    }
+  }
+
+  cvm::log("Applying walls to "+cvm::to_str(num_elements)+
+           " elements of "+cvm::to_str(num_variables())+" variables.\n");
+
+  return COLVARS_OK;
+}
+
+
+cvm::real colvarbias_restraint_harmonic_walls_vector::element_distance(size_t i, size_t ie) const
+{
+  cvm::real const x = variables(i)->value()[ie];
+  size_t const iw = element_offsets[i] + ie;
+  if ((lower_walls.size() > 0) && (x < lower_walls[iw])) {
+    return x - lower_walls[iw];
+  }
+  if ((upper_walls.size() > 0) && (x > upper_walls[iw])) {
+    return x - upper_walls[iw];
+  }
+  return 0.0;
+}
+
+
+cvm::real colvarbias_restraint_harmonic_walls_vector::restraint_potential(size_t i) const
+{
+  cvm::real const w2 = variables(i)->width * variables(i)->width;
+  size_t const n = element_offsets[i+1] - element_offsets[i];
+  cvm::real sum_lower = 0.0, sum_upper = 0.0;
+  for (size_t ie = 0; ie < n; ie++) {
+    cvm::real const dist = element_distance(i, ie);
+    if (dist > 0.0) {
+      sum_upper += dist * dist;
+    } else {
+      sum_lower += dist * dist;
+    }
+  }
+  return 0.5 * force_k / w2 * (upper_wall_k * sum_upper +
+                               lower_wall_k * sum_lower);
+}
+
+
+colvarvalue const colvarbias_restraint_harmonic_walls_vector::restraint_force(size_t i) const
+{
+  cvm::real const w2 = variables(i)->width * variables(i)->width;
+  size_t const n = element_offsets[i+1] - element_offsets[i];
+  colvarvalue force(variables(i)->value());
+  force.is_derivative();
+  for (size_t ie = 0; ie < n; ie++) {
+    cvm::real const dist = element_distance(i, ie);
+    cvm::real const scale = dist > 0.0 ? upper_wall_k : lower_wall_k;
+    force[ie] = -1.0 * force_k * scale / w2 * dist;
+  }
+  return force;
+}
+
+
+cvm::real colvarbias_restraint_harmonic_walls_vector::d_restraint_potential_dk(size_t i) const
+{
+  return (force_k > 0.0) ? restraint_potential(i) / force_k : 0.0;
+}
+
+
+std::ostream & colvarbias_restraint_harmonic_walls_vector::write_state_data(std::ostream &os)
+{
+  return colvarbias_ti::write_state_data(os);
+}
+
+
+std::istream & colvarbias_restraint_harmonic_walls_vector::read_state_data(std::istream &is)
+{
+  return colvarbias_ti::read_state_data(is);
+}
+
+
 
 colvarbias_restraint_linear::colvarbias_restraint_linear(char const *key)
   : colvarbias(key),
@@ -1283,6 +1508,16 @@ std::ostream & colvarbias_restraint_linear::write_traj(std::ostream &os)
 }
 
 
+int colvarbias_restraint_linear::write_traj_columns(colvartraj_frame &frame)
+{
+  int error_code = COLVARS_OK;
+  error_code |= colvarbias_restraint::write_traj_columns(frame);
+  error_code |= colvarbias_restraint_centers_moving::write_traj_columns(frame);
+  error_code |= colvarbias_restraint_k_moving::write_traj_columns(frame);
+  return error_code;
+}
+
+
 
 colvarbias_restraint_histogram::colvarbias_restraint_histogram(char const *key)
   : colvarbias(key)
@@ -1531,3 +1766,12 @@ std::ostream & colvarbias_restraint_histogram::write_traj(std::ostream &os)
   }
   return os;
 }
+
+
+int colvarbias_restraint_histogram::write_traj_columns(colvartraj_frame &frame)
+{
+  if (b_output_energy) {
+    frame.add("E_", this->name, bias_energy);
+  }
+  return COLVARS_OK;
+}
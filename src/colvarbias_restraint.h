@@ -38,6 +38,7 @@ public:
 
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
 
   /// \brief Constructor
   colvarbias_restraint(char const *key);
@@ -153,6 +154,7 @@ public:
   virtual int set_state_params(std::string const &conf);
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
 
 protected:
 
@@ -192,6 +194,7 @@ public:
   virtual int set_state_params(std::string const &conf);
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
 
 protected:
 
@@ -235,6 +238,7 @@ public:
   virtual std::istream & read_state_data(std::istream &os);
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
   virtual int change_configuration(std::string const &conf);
   virtual cvm::real energy_difference(std::string const &conf);
 
@@ -262,6 +266,7 @@ public:
   virtual std::istream & read_state_data(std::istream &os);
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
 
 protected:
 
@@ -284,6 +289,47 @@ protected:
 };
 
 
+/// \brief Flat-bottom harmonic walls applied independently to each element
+/// of (possibly multi-dimensional) variables, e.g. one wall pair per NOE
+/// distance of a distancePairsList component
+/// (implementation of \link colvarbias_restraint \endlink)
+class colvarbias_restraint_harmonic_walls_vector
+  : public colvarbias_restraint_k
+{
+public:
+
+  colvarbias_restraint_harmonic_walls_vector(char const *key);
+  virtual int init(std::string const &conf);
+  virtual std::ostream & write_state_data(std::ostream &os);
+  virtual std::istream & read_state_data(std::istream &os);
+
+protected:
+
+  /// \brief Lower walls, one per element of all variables concatenated
+  std::vector<cvm::real> lower_walls;
+
+  /// \brief Upper walls, one per element of all variables concatenated
+  std::vector<cvm::real> upper_walls;
+
+  /// \brief Relative force constant of the lower walls
+  cvm::real lower_wall_k;
+
+  /// \brief Relative force constant of the upper walls
+  cvm::real upper_wall_k;
+
+  /// \brief Index of the first element of each variable in the wall arrays
+  std::vector<size_t> element_offsets;
+
+  /// \brief Signed distance of an element of the i-th variable from the
+  /// nearest wall (zero between walls)
+  cvm::real element_distance(size_t i, size_t ie) const;
+
+  virtual cvm::real restraint_potential(size_t i) const;
+  virtual colvarvalue const restraint_force(size_t i) const;
+  virtual cvm::real d_restraint_potential_dk(size_t i) const;
+};
+
+
 /// \brief Linear bias restraint
 /// (implementation of \link colvarbias_restraint \endlink)
 class colvarbias_restraint_linear
@@ -304,6 +350,7 @@ public:
   virtual std::istream & read_state_data(std::istream &os);
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
 
 protected:
 
@@ -328,6 +375,7 @@ public:
   virtual int write_output_files();
   virtual std::ostream & write_traj_label(std::ostream &os);
   virtual std::ostream & write_traj(std::ostream &os);
+  virtual int write_traj_columns(colvartraj_frame &frame);
 
 protected:
 
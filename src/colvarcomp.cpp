@@ -25,6 +25,7 @@ colvar::cvc::cvc()
   period = 0.0;
   wrap_center = 0.0;
   width = 0.0;
+  cost = -1.0;
   init_dependencies();
 }
 
@@ -38,6 +39,7 @@ colvar::cvc::cvc(std::string const &conf)
   period = 0.0;
   wrap_center = 0.0;
   width = 0.0;
+  cost = -1.0;
   init_dependencies();
   init(conf);
 }
@@ -380,8 +382,13 @@ void colvar::cvc::read_data()
   for (ig = 0; ig < atom_groups.size(); ig++) {
     cvm::atom_group &atoms = *(atom_groups[ig]);
     atoms.reset_atoms_data();
-    atoms.read_positions();
-    atoms.calc_required_properties();
+    if (atoms.is_shared()) {
+      // already computed by colvarmodule::calc_shared_atom_groups()
+      atoms.restore_shared_data();
+    } else {
+      atoms.read_positions();
+      atoms.calc_required_properties();
+    }
     // each atom group will take care of its own fitting_group, if defined
   }
 
@@ -396,6 +403,16 @@ void colvar::cvc::read_data()
 }
 
 
+std::vector<cvm::atom_group *> colvar::cvc::get_shareable_atom_groups()
+{
+  if (is_enabled(f_cvc_debug_gradient)) {
+    // debug_gradients() perturbs the positions of its own groups
+    return std::vector<cvm::atom_group *>();
+  }
+  return atom_groups;
+}
+
+
 std::vector<std::vector<int> > colvar::cvc::get_atom_lists()
 {
   std::vector<std::vector<int> > lists;
@@ -480,6 +497,18 @@ void colvar::cvc::calc_fit_gradients()
 }
 
 
+void colvar::cvc::update_cost_estimate(cvm::real seconds)
+{
+  // Weight of the latest measurement in the moving average
+  cvm::real const weight = 0.2;
+  if (cost < 0.0) {
+    cost = seconds;
+  } else {
+    cost = (1.0 - weight) * cost + weight * seconds;
+  }
+}
+
+
 void colvar::cvc::debug_gradients()
 {
   // this function should work for any scalar cvc:
@@ -534,7 +563,9 @@ void colvar::cvc::debug_gradients()
         // (re)read original positions
         group->read_positions();
         // change one coordinate
-        (*group)[ia].pos[id] += cvm::debug_gradients_step_size;
+        std::vector<cvm::real> &pos_id = (id == 0) ? group->pos_x :
+          ((id == 1) ? group->pos_y : group->pos_z);
+        pos_id[ia] += cvm::debug_gradients_step_size;
         group->calc_required_properties();
         calc_value();
         cvm::real x_1 = x.real_value;
@@ -569,7 +600,9 @@ void colvar::cvc::debug_gradients()
           group->read_positions();
           ref_group->read_positions();
           // change one coordinate
-          (*ref_group)[ia].pos[id] += cvm::debug_gradients_step_size;
+          std::vector<cvm::real> &pos_id = (id == 0) ? ref_group->pos_x :
+            ((id == 1) ? ref_group->pos_y : ref_group->pos_z);
+          pos_id[ia] += cvm::debug_gradients_step_size;
           group->calc_required_properties();
           calc_value();
 
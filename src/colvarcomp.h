@@ -163,6 +163,10 @@ public:
   /// \brief Obtain data needed for the calculation for the backend
   virtual void read_data();
 
+  /// \brief Get the atom groups whose positions, centers and rotations may
+  /// be copied from identical groups of other CVCs (see read_data())
+  virtual std::vector<cvm::atom_group *> get_shareable_atom_groups();
+
   /// \brief Calculate the variable
   virtual void calc_value() = 0;
 
@@ -171,7 +175,7 @@ public:
   virtual void calc_gradients() {}
 
   /// \brief Calculate the atomic fit gradients
-  void calc_fit_gradients();
+  virtual void calc_fit_gradients();
 
   /// \brief Calculate finite-difference gradients alongside the analytical ones, for each Cartesian component
   virtual void debug_gradients();
@@ -271,6 +275,20 @@ public:
   /// \brief Whether or not this CVC will be computed in parallel whenever possible
   bool b_try_scalable;
 
+  /// \brief Estimated time (in seconds) of one calculation of this CVC, as
+  /// an exponential moving average; negative if it was never measured
+  inline cvm::real cost_estimate() const
+  {
+    return cost;
+  }
+
+  /// Add the measured time (in seconds) of the latest calculation to the
+  /// moving average returned by cost_estimate()
+  void update_cost_estimate(cvm::real seconds);
+
+  /// Time spent computing the value and gradients of this CVC
+  cvm::profile_counter profile;
+
   /// Forcibly set value of CVC - useful for driving an external coordinate,
   /// eg. lambda dynamics
   inline void set_value(colvarvalue const &new_value) {
@@ -312,6 +330,9 @@ protected:
 
   /// \brief CVC-specific default colvar width
   cvm::real width;
+
+  /// \brief Estimated cost of this CVC (see cost_estimate())
+  cvm::real cost;
 };
 
 
@@ -601,6 +622,41 @@ public:
 
 
 
+/// \brief Colvar component: vector of distances between arbitrary pairs
+/// of atoms, optionally averaged in groups of pairs as
+/// \f$ \left(\frac{1}{N}\sum r^{-n}\right)^{-1/n} \f$ (e.g. for NOE
+/// restraints); all pairs are taken from one flat list of atom numbers and
+/// computed in a single pass (colvarvalue::type_vector type, range (0:*)
+/// for each component)
+class colvar::distance_pairs_list
+  : public colvar::cvc
+{
+protected:
+  /// Group containing each atom referenced by the pairs exactly once
+  cvm::atom_group  *atoms;
+  /// Indices within the group of the first atom of each pair
+  std::vector<size_t> pair_first;
+  /// Indices within the group of the second atom of each pair
+  std::vector<size_t> pair_second;
+  /// For each element of the vector, index of its first pair
+  /// (the pairs of element k are pair_offsets[k] to pair_offsets[k+1]-1)
+  std::vector<size_t> pair_offsets;
+  /// Distance vectors of the pairs, saved for apply_force()
+  std::vector<cvm::rvector> pair_dist_v;
+  /// Derivatives of each element with respect to the lengths of its pairs
+  std::vector<cvm::real> pair_dxdr;
+  /// Exponent used to average the distances within each element
+  int exponent;
+public:
+  distance_pairs_list(std::string const &conf);
+  virtual ~distance_pairs_list() {}
+  virtual void calc_value();
+  virtual void calc_gradients();
+  virtual void apply_force(colvarvalue const &force);
+};
+
+
+
 /// \brief Colvar component:  dipole magnitude of a molecule
 class colvar::dipole_magnitude
   : public colvar::cvc
@@ -952,12 +1008,31 @@ public:
   /// this pair \param tolerance A pair is defined as having a larger
   /// coordination than this number
   template<int flags>
+  static inline cvm::real switching_function(cvm::real const &r0,
+                                             cvm::rvector const &r0_vec,
+                                             int en,
+                                             int ed,
+                                             cvm::atom &A1,
+                                             cvm::atom &A2,
+                                             bool **pairlist_elem,
+                                             cvm::real tolerance)
+  {
+    return switching_function<flags>(r0, r0_vec, en, ed, A1.pos, A2.pos,
+                                     A1.grad, A2.grad, pairlist_elem,
+                                     tolerance);
+  }
+
+  /// \brief Same as above, but using positions and gradients stored outside
+  /// of atom objects (e.g. in the contiguous arrays of an atom group)
+  template<int flags>
   static cvm::real switching_function(cvm::real const &r0,
                                       cvm::rvector const &r0_vec,
                                       int en,
                                       int ed,
-                                      cvm::atom &A1,
-                                      cvm::atom &A2,
+                                      cvm::atom_pos const &A1_pos,
+                                      cvm::atom_pos const &A2_pos,
+                                      cvm::rvector &A1_grad,
+                                      cvm::rvector &A2_grad,
                                       bool **pairlist_elem,
                                       cvm::real tolerance);
 
@@ -1520,7 +1595,18 @@ class colvar::CartesianBasedPath
   : public colvar::cvc
 {
 protected:
-    virtual void computeDistanceToReferenceFrames(std::vector<cvm::real>& result);
+    /// \brief Compute the RMSDs from the frames [first_frame, last_frame)
+    virtual void computeDistanceToReferenceFrames(std::vector<cvm::real>& result, size_t first_frame, size_t last_frame);
+    /// \brief Whether the current positions are fitted to many reference
+    /// frames in a single pass (no fittingAtoms, no debugGradients)
+    bool use_batched_frames() const;
+    /// \brief Fit to the frames [first_frame, last_frame) at once: one sweep
+    /// over the atoms builds all correlation matrices, then each rotation is
+    /// solved
+    void calc_batched_frames(std::vector<cvm::real>& result, size_t first_frame, size_t last_frame);
+    /// \brief Set the positions of comp_atoms[i_frame] from its rotation; the
+    /// batched calculation only does this for the frames that are used
+    void update_frame_positions(size_t i_frame);
     /// Selected atoms
     cvm::atom_group *atoms;
     /// Fitting options
@@ -1532,9 +1618,32 @@ protected:
     std::vector<cvm::atom_group*> comp_atoms;
     /// Total number of reference frames
     size_t total_reference_frames;
+    /// Whether the frames can be fitted in a batch (see use_batched_frames())
+    bool b_batched_frames;
+    /// \brief Centered reference frames, stored contiguously with all frames
+    /// of one atom next to each other (index i_atom * frames + i_frame)
+    std::vector<cvm::real> frames_ref_x, frames_ref_y, frames_ref_z;
+    /// Squared norm of each centered reference frame
+    std::vector<cvm::real> frames_ref_norm2;
+    /// Current positions of the atoms, centered
+    std::vector<cvm::real> centered_x, centered_y, centered_z;
+    /// Squared norm of the centered positions
+    cvm::real centered_norm2;
+    /// \brief Centered positions as vectors, only set when the rotation of
+    /// any frame needs them (derivatives with respect to the reference
+    /// frame, or gradient tests)
+    std::vector<cvm::atom_pos> centered_pos;
+    /// \brief Correlation matrices with all frames (index
+    /// component * frames + i_frame, components in row-major order)
+    std::vector<cvm::real> frames_C;
+    /// Whether the positions of comp_atoms[i_frame] are up to date
+    std::vector<int> frames_updated;
 public:
     CartesianBasedPath(std::string const &conf);
     virtual ~CartesianBasedPath();
+    virtual void read_data();
+    virtual std::vector<cvm::atom_group *> get_shareable_atom_groups();
+    virtual void calc_fit_gradients();
     virtual void calc_value() = 0;
     virtual void apply_force(colvarvalue const &force) = 0;
 };
@@ -1590,8 +1699,15 @@ protected:
     std::vector<colvar::cvc*> cv;
     /// If all sub-cvs use explicit gradients then we also use it
     bool use_explicit_gradients;
+    /// Whether the sub-cvs are shared with other components (computed once
+    /// per step by colvar::calc_shared_sub_cvcs())
+    bool use_shared_sub_cvcs;
 protected:
     cvm::real getPolynomialFactorOfCVGradient(size_t i_cv) const;
+    /// Whether the atomic gradients of a sub-cv are scaled and used directly
+    bool useSubCVExplicitGradient(size_t i_cv) const;
+    /// Apply a force to a sub-cv, or add it to the shared one
+    void applySubCVForce(size_t i_cv, colvarvalue const &cv_force);
 public:
     linearCombination(std::string const &conf);
     virtual ~linearCombination();
@@ -1611,13 +1727,22 @@ protected:
     std::vector<std::vector<colvarvalue>> ref_cv;
     /// If all sub-cvs use explicit gradients then we also use it
     bool use_explicit_gradients;
+    /// Whether the sub-cvs are shared with other components (computed once
+    /// per step by colvar::calc_shared_sub_cvcs())
+    bool use_shared_sub_cvcs;
     /// Total number of reference frames
     size_t total_reference_frames;
 protected:
-    virtual void computeDistanceToReferenceFrames(std::vector<cvm::real>& result);
+    /// \brief Compute the distances from the frames [first_frame, last_frame),
+    /// using the current values of the sub-CVs
+    virtual void computeDistanceToReferenceFrames(std::vector<cvm::real>& result, size_t first_frame, size_t last_frame);
     /// Helper function to determine the distance between reference frames
     virtual void computeDistanceBetweenReferenceFrames(std::vector<cvm::real>& result) const;
     cvm::real getPolynomialFactorOfCVGradient(size_t i_cv) const;
+    /// Whether the atomic gradients of a sub-cv are scaled and used directly
+    bool useSubCVExplicitGradient(size_t i_cv) const;
+    /// Apply a force to a sub-cv, or add it to the shared one
+    void applySubCVForce(size_t i_cv, colvarvalue const &cv_force);
 public:
     CVBasedPath(std::string const &conf);
     virtual ~CVBasedPath();
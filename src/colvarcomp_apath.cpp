@@ -18,22 +18,20 @@ colvar::aspathCV::aspathCV(std::string const &conf): CVBasedPath(conf) {
     std::vector<cvm::real> p_weights(cv.size(), 1.0);
     get_keyval(conf, "weights", p_weights, std::vector<cvm::real>(cv.size(), 1.0));
     x.type(colvarvalue::type_scalar);
-    use_explicit_gradients = true;
     cvm::real p_lambda;
     get_keyval(conf, "lambda", p_lambda, -1.0);
     ArithmeticPathCV::ArithmeticPathBase<colvarvalue, cvm::real, ArithmeticPathCV::path_sz::S>::initialize(cv.size(), total_reference_frames, p_lambda, ref_cv[0], p_weights);
     cvm::log(std::string("Lambda is ") + cvm::to_str(lambda) + std::string("\n"));
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if (!cv[i_cv]->is_enabled(f_cvc_explicit_gradient)) {
-            use_explicit_gradients = false;
-        }
         cvm::log(std::string("The weight of CV ") + cvm::to_str(i_cv) + std::string(" is ") + cvm::to_str(weights[i_cv]) + std::string("\n"));
     }
 }
 
 void colvar::aspathCV::updateDistanceToReferenceFrames() {
-    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        cv[i_cv]->calc_value();
+    if (!use_shared_sub_cvcs) {
+        for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
+            cv[i_cv]->calc_value();
+        }
     }
     for (size_t i_frame = 0; i_frame < ref_cv.size(); ++i_frame) {
         for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
@@ -66,10 +64,8 @@ void colvar::aspathCV::calc_value() {
 void colvar::aspathCV::calc_gradients() {
     computeDerivatives();
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        cv[i_cv]->calc_gradients();
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)) {
+        if (!use_shared_sub_cvcs) cv[i_cv]->calc_gradients();
+        if (useSubCVExplicitGradient(i_cv)) {
             cvm::real factor_polynomial = getPolynomialFactorOfCVGradient(i_cv);
             for (size_t j_elem = 0; j_elem < cv[i_cv]->value().size(); ++j_elem) {
                 for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
@@ -84,17 +80,14 @@ void colvar::aspathCV::calc_gradients() {
 
 void colvar::aspathCV::apply_force(colvarvalue const &force) {
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)
-        ) {
+        if (useSubCVExplicitGradient(i_cv)) {
             for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
                 (cv[i_cv]->atom_groups)[k_ag]->apply_colvar_force(force.real_value);
             }
         } else {
             cvm::real factor_polynomial = getPolynomialFactorOfCVGradient(i_cv);
             colvarvalue cv_force = dsdx[i_cv] * force.real_value * factor_polynomial;
-            cv[i_cv]->apply_force(cv_force);
+            applySubCVForce(i_cv, cv_force);
         }
     }
 }
@@ -107,22 +100,20 @@ colvar::azpathCV::azpathCV(std::string const &conf): CVBasedPath(conf) {
     std::vector<cvm::real> p_weights(cv.size(), 1.0);
     get_keyval(conf, "weights", p_weights, std::vector<cvm::real>(cv.size(), 1.0));
     x.type(colvarvalue::type_scalar);
-    use_explicit_gradients = true;
     cvm::real p_lambda;
     get_keyval(conf, "lambda", p_lambda, -1.0);
     ArithmeticPathCV::ArithmeticPathBase<colvarvalue, cvm::real, ArithmeticPathCV::path_sz::Z>::initialize(cv.size(), total_reference_frames, p_lambda, ref_cv[0], p_weights);
     cvm::log(std::string("Lambda is ") + cvm::to_str(lambda) + std::string("\n"));
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if (!cv[i_cv]->is_enabled(f_cvc_explicit_gradient)) {
-            use_explicit_gradients = false;
-        }
         cvm::log(std::string("The weight of CV ") + cvm::to_str(i_cv) + std::string(" is ") + cvm::to_str(weights[i_cv]) + std::string("\n"));
     }
 }
 
 void colvar::azpathCV::updateDistanceToReferenceFrames() {
-    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        cv[i_cv]->calc_value();
+    if (!use_shared_sub_cvcs) {
+        for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
+            cv[i_cv]->calc_value();
+        }
     }
     for (size_t i_frame = 0; i_frame < ref_cv.size(); ++i_frame) {
         for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
@@ -155,10 +146,8 @@ void colvar::azpathCV::calc_value() {
 void colvar::azpathCV::calc_gradients() {
     computeDerivatives();
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        cv[i_cv]->calc_gradients();
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)) {
+        if (!use_shared_sub_cvcs) cv[i_cv]->calc_gradients();
+        if (useSubCVExplicitGradient(i_cv)) {
             cvm::real factor_polynomial = getPolynomialFactorOfCVGradient(i_cv);
             for (size_t j_elem = 0; j_elem < cv[i_cv]->value().size(); ++j_elem) {
                 for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
@@ -174,17 +163,14 @@ void colvar::azpathCV::calc_gradients() {
 
 void colvar::azpathCV::apply_force(colvarvalue const &force) {
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)
-        ) {
+        if (useSubCVExplicitGradient(i_cv)) {
             for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
                 (cv[i_cv]->atom_groups)[k_ag]->apply_colvar_force(force.real_value);
             }
         } else {
             cvm::real factor_polynomial = getPolynomialFactorOfCVGradient(i_cv);
             const colvarvalue cv_force = dzdx[i_cv] * force.real_value * factor_polynomial;
-            cv[i_cv]->apply_force(cv_force);
+            applySubCVForce(i_cv, cv_force);
         }
     }
 }
@@ -21,8 +21,10 @@ cvm::real colvar::coordnum::switching_function(cvm::real const &r0,
                                                cvm::rvector const &r0_vec,
                                                int en,
                                                int ed,
-                                               cvm::atom &A1,
-                                               cvm::atom &A2,
+                                               cvm::atom_pos const &A1_pos,
+                                               cvm::atom_pos const &A2_pos,
+                                               cvm::rvector &A1_grad,
+                                               cvm::rvector &A2_grad,
                                                bool **pairlist_elem,
                                                cvm::real pairlist_tol)
 {
@@ -38,7 +40,7 @@ cvm::real colvar::coordnum::switching_function(cvm::real const &r0,
                               r0_vec.y*r0_vec.y,
                               r0_vec.z*r0_vec.z);
 
-  cvm::rvector const diff = cvm::position_distance(A1.pos, A2.pos);
+  cvm::rvector const diff = cvm::position_distance(A1_pos, A2_pos);
 
   cvm::rvector const scal_diff(diff.x/((flags & ef_anisotropic) ?
                                        r0_vec.x : r0),
@@ -82,8 +84,8 @@ cvm::real colvar::coordnum::switching_function(cvm::real const &r0,
                                    r0*r0)) * diff.y,
                              (2.0/((flags & ef_anisotropic) ? r0sq_vec.z :
                                    r0*r0)) * diff.z);
-    A1.grad += (-1.0)*dFdl2*dl2dx;
-    A2.grad +=        dFdl2*dl2dx;
+    A1_grad += (-1.0)*dFdl2*dl2dx;
+    A2_grad +=        dFdl2*dl2dx;
   }
 
   return func;
@@ -194,9 +196,12 @@ template<int flags> void colvar::coordnum::main_loop(bool **pairlist_elem)
   if (b_group2_center_only) {
     cvm::atom group2_com_atom;
     group2_com_atom.pos = group2->center_of_mass();
-    for (cvm::atom_iter ai1 = group1->begin(); ai1 != group1->end(); ai1++) {
+    for (size_t i1 = 0; i1 < group1->size(); i1++) {
       x.real_value += switching_function<flags>(r0, r0_vec, en, ed,
-                                                *ai1, group2_com_atom,
+                                                group1->position(i1),
+                                                group2_com_atom.pos,
+                                                (*group1)[i1].grad,
+                                                group2_com_atom.grad,
                                                 pairlist_elem,
                                                 tolerance);
     }
@@ -204,13 +209,44 @@ template<int flags> void colvar::coordnum::main_loop(bool **pairlist_elem)
       group2->set_weighted_gradient(group2_com_atom.grad);
     }
   } else {
-    for (cvm::atom_iter ai1 = group1->begin(); ai1 != group1->end(); ai1++) {
-      for (cvm::atom_iter ai2 = group2->begin(); ai2 != group2->end(); ai2++) {
+    // Read positions from the contiguous arrays of both groups, and
+    // accumulate the gradients of group2 into its own contiguous arrays
+    size_t const n1 = group1->size();
+    size_t const n2 = group2->size();
+    std::vector<cvm::real> const &x2 = group2->pos_x;
+    std::vector<cvm::real> const &y2 = group2->pos_y;
+    std::vector<cvm::real> const &z2 = group2->pos_z;
+    if (flags & ef_gradients) {
+      group2->reset_gradients();
+    }
+    std::vector<cvm::real> &gx2 = group2->grad_x;
+    std::vector<cvm::real> &gy2 = group2->grad_y;
+    std::vector<cvm::real> &gz2 = group2->grad_z;
+    for (size_t i1 = 0; i1 < n1; i1++) {
+      cvm::atom_pos const pos1 = group1->position(i1);
+      cvm::rvector grad1(0.0);
+      for (size_t i2 = 0; i2 < n2; i2++) {
+        cvm::rvector grad2(0.0);
         x.real_value += switching_function<flags>(r0, r0_vec, en, ed,
-                                                  *ai1, *ai2,
+                                                  pos1,
+                                                  cvm::atom_pos(x2[i2],
+                                                                y2[i2],
+                                                                z2[i2]),
+                                                  grad1, grad2,
                                                   pairlist_elem,
                                                   tolerance);
+        if (flags & ef_gradients) {
+          gx2[i2] += grad2.x;
+          gy2[i2] += grad2.y;
+          gz2[i2] += grad2.z;
+        }
       }
+      if (flags & ef_gradients) {
+        (*group1)[i1].grad += grad1;
+      }
+    }
+    if (flags & ef_gradients) {
+      group2->scatter_gradients();
     }
   }
 }
@@ -365,8 +401,10 @@ void colvar::h_bond::calc_value()
   cvm::rvector const r0_vec(0.0); // TODO enable the flag?
   x.real_value =
     coordnum::switching_function<flags>(r0, r0_vec, en, ed,
-                                        (*atom_groups[0])[0],
-                                        (*atom_groups[0])[1],
+                                        atom_groups[0]->position(0),
+                                        atom_groups[0]->position(1),
+                                        (*atom_groups[0])[0].grad,
+                                        (*atom_groups[0])[1].grad,
                                         NULL, 0.0);
 }
 
@@ -376,8 +414,10 @@ void colvar::h_bond::calc_gradients()
   int const flags = coordnum::ef_gradients;
   cvm::rvector const r0_vec(0.0); // TODO enable the flag?
   coordnum::switching_function<flags>(r0, r0_vec, en, ed,
-                                      (*atom_groups[0])[0],
-                                      (*atom_groups[0])[1],
+                                      atom_groups[0]->position(0),
+                                      atom_groups[0]->position(1),
+                                      (*atom_groups[0])[0].grad,
+                                      (*atom_groups[0])[1].grad,
                                       NULL, 0.0);
 }
 
@@ -467,8 +507,10 @@ template<int compute_flags> int colvar::selfcoordnum::compute_selfcoordnum()
         for (j = i + 1; j < n; j++) {
           x.real_value +=
             coordnum::switching_function<flags>(r0, r0_vec, en, ed,
-                                                (*group1)[i],
-                                                (*group1)[j],
+                                                group1->position(i),
+                                                group1->position(j),
+                                                (*group1)[i].grad,
+                                                (*group1)[j].grad,
                                                 &pairlist_elem,
                                                 tolerance);
         }
@@ -479,8 +521,10 @@ template<int compute_flags> int colvar::selfcoordnum::compute_selfcoordnum()
         for (j = i + 1; j < n; j++) {
           x.real_value +=
             coordnum::switching_function<flags>(r0, r0_vec, en, ed,
-                                                (*group1)[i],
-                                                (*group1)[j],
+                                                group1->position(i),
+                                                group1->position(j),
+                                                (*group1)[i].grad,
+                                                (*group1)[j].grad,
                                                 &pairlist_elem,
                                                 tolerance);
         }
@@ -494,8 +538,10 @@ template<int compute_flags> int colvar::selfcoordnum::compute_selfcoordnum()
       for (j = i + 1; j < n; j++) {
         x.real_value +=
           coordnum::switching_function<flags>(r0, r0_vec, en, ed,
-                                              (*group1)[i],
-                                              (*group1)[j],
+                                              group1->position(i),
+                                              group1->position(j),
+                                              (*group1)[i].grad,
+                                              (*group1)[j].grad,
                                               &pairlist_elem,
                                               tolerance);
       }
@@ -8,6 +8,7 @@
 // Colvars repository at GitHub.
 
 #include <algorithm>
+#include <map>
 
 #include "colvarmodule.h"
 #include "colvarvalue.h"
@@ -595,28 +596,35 @@ colvar::distance_inv::distance_inv(std::string const &conf)
 void colvar::distance_inv::calc_value()
 {
   x.real_value = 0.0;
+  size_t const n1 = group1->size();
+  size_t const n2 = group2->size();
   if (!is_enabled(f_cvc_pbc_minimum_image)) {
-    for (cvm::atom_iter ai1 = group1->begin(); ai1 != group1->end(); ai1++) {
-      for (cvm::atom_iter ai2 = group2->begin(); ai2 != group2->end(); ai2++) {
-        cvm::rvector const dv = ai2->pos - ai1->pos;
+    for (size_t i1 = 0; i1 < n1; i1++) {
+      cvm::atom_pos const pos1 = group1->position(i1);
+      cvm::rvector &grad1 = (*group1)[i1].grad;
+      for (size_t i2 = 0; i2 < n2; i2++) {
+        cvm::rvector const dv = group2->position(i2) - pos1;
         cvm::real const d2 = dv.norm2();
         cvm::real const dinv = cvm::integer_power(d2, -1*(exponent/2));
         x.real_value += dinv;
         cvm::rvector const dsumddv = -1.0*(exponent/2) * dinv/d2 * 2.0 * dv;
-        ai1->grad += -1.0 * dsumddv;
-        ai2->grad +=        dsumddv;
+        grad1 += -1.0 * dsumddv;
+        (*group2)[i2].grad += dsumddv;
       }
     }
   } else {
-    for (cvm::atom_iter ai1 = group1->begin(); ai1 != group1->end(); ai1++) {
-      for (cvm::atom_iter ai2 = group2->begin(); ai2 != group2->end(); ai2++) {
-        cvm::rvector const dv = cvm::position_distance(ai1->pos, ai2->pos);
+    for (size_t i1 = 0; i1 < n1; i1++) {
+      cvm::atom_pos const pos1 = group1->position(i1);
+      cvm::rvector &grad1 = (*group1)[i1].grad;
+      for (size_t i2 = 0; i2 < n2; i2++) {
+        cvm::rvector const dv = cvm::position_distance(pos1,
+                                                       group2->position(i2));
         cvm::real const d2 = dv.norm2();
         cvm::real const dinv = cvm::integer_power(d2, -1*(exponent/2));
         x.real_value += dinv;
         cvm::rvector const dsumddv = -1.0*(exponent/2) * dinv/d2 * 2.0 * dv;
-        ai1->grad += -1.0 * dsumddv;
-        ai2->grad +=        dsumddv;
+        grad1 += -1.0 * dsumddv;
+        (*group2)[i2].grad += dsumddv;
       }
     }
   }
@@ -685,7 +693,7 @@ void colvar::distance_pairs::calc_value()
     size_t i1, i2;
     for (i1 = 0; i1 < group1->size(); i1++) {
       for (i2 = 0; i2 < group2->size(); i2++) {
-        cvm::rvector const dv = (*group2)[i2].pos - (*group1)[i1].pos;
+        cvm::rvector const dv = group2->position(i2) - group1->position(i1);
         cvm::real const d = dv.norm();
         x.vector1d_value[i1*group2->size() + i2] = d;
         (*group1)[i1].grad = -1.0 * dv.unit();
@@ -696,8 +704,8 @@ void colvar::distance_pairs::calc_value()
     size_t i1, i2;
     for (i1 = 0; i1 < group1->size(); i1++) {
       for (i2 = 0; i2 < group2->size(); i2++) {
-        cvm::rvector const dv = cvm::position_distance((*group1)[i1].pos,
-                                                       (*group2)[i2].pos);
+        cvm::rvector const dv = cvm::position_distance(group1->position(i1),
+                                                       group2->position(i2));
         cvm::real const d = dv.norm();
         x.vector1d_value[i1*group2->size() + i2] = d;
         (*group1)[i1].grad = -1.0 * dv.unit();
@@ -720,7 +728,7 @@ void colvar::distance_pairs::apply_force(colvarvalue const &force)
     size_t i1, i2;
     for (i1 = 0; i1 < group1->size(); i1++) {
       for (i2 = 0; i2 < group2->size(); i2++) {
-        cvm::rvector const dv = (*group2)[i2].pos - (*group1)[i1].pos;
+        cvm::rvector const dv = group2->position(i2) - group1->position(i1);
         (*group1)[i1].apply_force(force[i1*group2->size() + i2] * (-1.0) * dv.unit());
         (*group2)[i2].apply_force(force[i1*group2->size() + i2] * dv.unit());
       }
@@ -729,8 +737,8 @@ void colvar::distance_pairs::apply_force(colvarvalue const &force)
     size_t i1, i2;
     for (i1 = 0; i1 < group1->size(); i1++) {
       for (i2 = 0; i2 < group2->size(); i2++) {
-        cvm::rvector const dv = cvm::position_distance((*group1)[i1].pos,
-                                                       (*group2)[i2].pos);
+        cvm::rvector const dv = cvm::position_distance(group1->position(i1),
+                                                       group2->position(i2));
         (*group1)[i1].apply_force(force[i1*group2->size() + i2] * (-1.0) * dv.unit());
         (*group2)[i2].apply_force(force[i1*group2->size() + i2] * dv.unit());
       }
@@ -740,6 +748,174 @@ void colvar::distance_pairs::apply_force(colvarvalue const &force)
 
 
 
+colvar::distance_pairs_list::distance_pairs_list(std::string const &conf)
+  : cvc(conf)
+{
+  function_type = "distance_pairs_list";
+  x.type(colvarvalue::type_vector);
+  disable(f_cvc_explicit_gradient);
+
+  std::vector<int> pair_numbers;
+  get_keyval(conf, "atomPairs", pair_numbers, pair_numbers);
+  if ((pair_numbers.size() == 0) || (pair_numbers.size() % 2)) {
+    cvm::error("Error: \"atomPairs\" must contain an even, non-zero "
+               "number of atom numbers.\n", INPUT_ERROR);
+    return;
+  }
+  size_t const num_pairs = pair_numbers.size() / 2;
+
+  std::vector<size_t> pair_group_sizes;
+  if (get_keyval(conf, "pairGroupSizes", pair_group_sizes, pair_group_sizes)) {
+    size_t num_grouped_pairs = 0;
+    for (size_t k = 0; k < pair_group_sizes.size(); k++) {
+      if (pair_group_sizes[k] == 0) {
+        cvm::error("Error: \"pairGroupSizes\" cannot contain zeros.\n",
+                   INPUT_ERROR);
+        return;
+      }
+      num_grouped_pairs += pair_group_sizes[k];
+    }
+    if (num_grouped_pairs != num_pairs) {
+      cvm::error("Error: the sum of \"pairGroupSizes\" ("+
+                 cvm::to_str(num_grouped_pairs)+
+                 ") does not match the number of pairs ("+
+                 cvm::to_str(num_pairs)+").\n", INPUT_ERROR);
+      return;
+    }
+  } else {
+    pair_group_sizes.assign(num_pairs, 1);
+  }
+
+  get_keyval(conf, "exponent", exponent, 6);
+  if (exponent <= 0) {
+    cvm::error("Error: \"exponent\" must be a positive integer.\n",
+               INPUT_ERROR);
+    return;
+  }
+
+  // Each atom is requested from the proxy only once, no matter how many
+  // pairs it belongs to
+  atoms = new cvm::atom_group("atoms");
+  std::map<int, size_t> atom_group_index;
+  pair_first.resize(num_pairs);
+  pair_second.resize(num_pairs);
+  for (size_t ip = 0; ip < pair_numbers.size(); ip++) {
+    int const number = pair_numbers[ip];
+    std::map<int, size_t>::const_iterator const it =
+      atom_group_index.find(number);
+    size_t group_index = 0;
+    if (it == atom_group_index.end()) {
+      group_index = atoms->size();
+      atom_group_index[number] = group_index;
+      atoms->add_atom(cvm::atom(number));
+      if (cvm::get_error()) return;
+    } else {
+      group_index = it->second;
+    }
+    if (ip % 2) {
+      pair_second[ip/2] = group_index;
+    } else {
+      pair_first[ip/2] = group_index;
+    }
+  }
+  atoms->setup();
+  register_atom_group(atoms);
+
+  for (size_t ip = 0; ip < num_pairs; ip++) {
+    if (pair_first[ip] == pair_second[ip]) {
+      cvm::error("Error: pair number "+cvm::to_str(ip+1)+
+                 " is made of the same atom twice.\n", INPUT_ERROR);
+      return;
+    }
+  }
+
+  pair_offsets.resize(pair_group_sizes.size()+1);
+  pair_offsets[0] = 0;
+  for (size_t k = 0; k < pair_group_sizes.size(); k++) {
+    pair_offsets[k+1] = pair_offsets[k] + pair_group_sizes[k];
+  }
+
+  pair_dist_v.resize(num_pairs);
+  pair_dxdr.resize(num_pairs);
+  x.vector1d_value.resize(pair_group_sizes.size());
+
+  cvm::log("Computing "+cvm::to_str(pair_group_sizes.size())+
+           " distances from "+cvm::to_str(num_pairs)+" pairs of "+
+           cvm::to_str(atoms->size())+" atoms.\n");
+}
+
+
+void colvar::distance_pairs_list::calc_value()
+{
+  bool const use_pbc = is_enabled(f_cvc_pbc_minimum_image);
+  size_t const num_pairs = pair_first.size();
+  size_t ip;
+
+  for (ip = 0; ip < num_pairs; ip++) {
+    cvm::atom_pos const pos1 = atoms->position(pair_first[ip]);
+    cvm::atom_pos const pos2 = atoms->position(pair_second[ip]);
+    pair_dist_v[ip] = use_pbc ? cvm::position_distance(pos1, pos2) :
+      pos2 - pos1;
+  }
+
+  size_t const num_elements = pair_offsets.size() - 1;
+  for (size_t k = 0; k < num_elements; k++) {
+    size_t const ip_begin = pair_offsets[k];
+    size_t const ip_end = pair_offsets[k+1];
+    if (ip_end - ip_begin == 1) {
+      // Single pair: plain distance, no need for the power average
+      cvm::real const d = pair_dist_v[ip_begin].norm();
+      x.vector1d_value[k] = d;
+      pair_dxdr[ip_begin] = 1.0 / d;
+      continue;
+    }
+    cvm::real sum = 0.0;
+    for (ip = ip_begin; ip < ip_end; ip++) {
+      cvm::real const d2 = pair_dist_v[ip].norm2();
+      cvm::real const dinv = cvm::integer_power(d2, -1*(exponent/2)) *
+        ((exponent % 2) ? 1.0/cvm::sqrt(d2) : 1.0);
+      // Derivative of r^-n with respect to the distance vector, divided by
+      // the vector itself: -n r^(-n-2)
+      pair_dxdr[ip] = -1.0 * cvm::real(exponent) * dinv / d2;
+      sum += dinv;
+    }
+    cvm::real const n_pairs = cvm::real(ip_end - ip_begin);
+    sum /= n_pairs;
+    cvm::real const value = cvm::pow(sum, -1.0/cvm::real(exponent));
+    x.vector1d_value[k] = value;
+    // d(value)/d(sum) = -(1/n) * value / sum
+    cvm::real const dxdsum = -1.0 / cvm::real(exponent) * value / sum;
+    for (ip = ip_begin; ip < ip_end; ip++) {
+      pair_dxdr[ip] *= dxdsum / n_pairs;
+    }
+  }
+}
+
+
+void colvar::distance_pairs_list::calc_gradients()
+{
+  // will be calculated on the fly in apply_force()
+}
+
+
+void colvar::distance_pairs_list::apply_force(colvarvalue const &force)
+{
+  if (atoms->noforce) return;
+
+  size_t const num_elements = pair_offsets.size() - 1;
+  for (size_t k = 0; k < num_elements; k++) {
+    cvm::real const f = force.vector1d_value[k];
+    if (f == 0.0) continue;
+    for (size_t ip = pair_offsets[k]; ip < pair_offsets[k+1]; ip++) {
+      cvm::rvector const f_pair = (f * pair_dxdr[ip]) * pair_dist_v[ip];
+      (*atoms)[pair_first[ip]].apply_force(-1.0 * f_pair);
+      (*atoms)[pair_second[ip]].apply_force(f_pair);
+    }
+  }
+}
+
+
+
 colvar::dipole_magnitude::dipole_magnitude(std::string const &conf)
   : cvc(conf)
 {
@@ -819,20 +995,31 @@ colvar::gyration::gyration(std::string const &conf)
 
 void colvar::gyration::calc_value()
 {
-  x.real_value = 0.0;
-  for (cvm::atom_iter ai = atoms->begin(); ai != atoms->end(); ai++) {
-    x.real_value += (ai->pos).norm2();
+  std::vector<cvm::real> const &pos_x = atoms->pos_x;
+  std::vector<cvm::real> const &pos_y = atoms->pos_y;
+  std::vector<cvm::real> const &pos_z = atoms->pos_z;
+  size_t const n = atoms->size();
+  cvm::real sum = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    sum += pos_x[i]*pos_x[i] + pos_y[i]*pos_y[i] + pos_z[i]*pos_z[i];
   }
-  x.real_value = cvm::sqrt(x.real_value / cvm::real(atoms->size()));
+  x.real_value = cvm::sqrt(sum / cvm::real(n));
 }
 
 
 void colvar::gyration::calc_gradients()
 {
   cvm::real const drdx = 1.0/(cvm::real(atoms->size()) * x.real_value);
-  for (cvm::atom_iter ai = atoms->begin(); ai != atoms->end(); ai++) {
-    ai->grad = drdx * ai->pos;
+  size_t const n = atoms->size();
+  atoms->grad_x.resize(n);
+  atoms->grad_y.resize(n);
+  atoms->grad_z.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    atoms->grad_x[i] = drdx * atoms->pos_x[i];
+    atoms->grad_y[i] = drdx * atoms->pos_y[i];
+    atoms->grad_z[i] = drdx * atoms->pos_z[i];
   }
+  atoms->scatter_gradients();
 }
 
 
@@ -843,8 +1030,8 @@ void colvar::gyration::calc_force_invgrads()
   cvm::real const dxdr = 1.0/x.real_value;
   ft.real_value = 0.0;
 
-  for (cvm::atom_iter ai = atoms->begin(); ai != atoms->end(); ai++) {
-    ft.real_value += dxdr * ai->pos * ai->total_force;
+  for (size_t i = 0; i < atoms->size(); i++) {
+    ft.real_value += dxdr * atoms->position(i) * (*atoms)[i].total_force;
   }
 }
 
@@ -876,18 +1063,29 @@ colvar::inertia::inertia(std::string const &conf)
 
 void colvar::inertia::calc_value()
 {
+  std::vector<cvm::real> const &pos_x = atoms->pos_x;
+  std::vector<cvm::real> const &pos_y = atoms->pos_y;
+  std::vector<cvm::real> const &pos_z = atoms->pos_z;
+  size_t const n = atoms->size();
   x.real_value = 0.0;
-  for (cvm::atom_iter ai = atoms->begin(); ai != atoms->end(); ai++) {
-    x.real_value += (ai->pos).norm2();
+  for (size_t i = 0; i < n; i++) {
+    x.real_value += pos_x[i]*pos_x[i] + pos_y[i]*pos_y[i] + pos_z[i]*pos_z[i];
   }
 }
 
 
 void colvar::inertia::calc_gradients()
 {
-  for (cvm::atom_iter ai = atoms->begin(); ai != atoms->end(); ai++) {
-    ai->grad = 2.0 * ai->pos;
+  size_t const n = atoms->size();
+  atoms->grad_x.resize(n);
+  atoms->grad_y.resize(n);
+  atoms->grad_z.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    atoms->grad_x[i] = 2.0 * atoms->pos_x[i];
+    atoms->grad_y[i] = 2.0 * atoms->pos_y[i];
+    atoms->grad_z[i] = 2.0 * atoms->pos_z[i];
   }
+  atoms->scatter_gradients();
 }
 
 
@@ -923,8 +1121,8 @@ colvar::inertia_z::inertia_z(std::string const &conf)
 void colvar::inertia_z::calc_value()
 {
   x.real_value = 0.0;
-  for (cvm::atom_iter ai = atoms->begin(); ai != atoms->end(); ai++) {
-    cvm::real const iprod = ai->pos * axis;
+  for (size_t i = 0; i < atoms->size(); i++) {
+    cvm::real const iprod = atoms->position(i) * axis;
     x.real_value += iprod * iprod;
   }
 }
@@ -932,8 +1130,8 @@ void colvar::inertia_z::calc_value()
 
 void colvar::inertia_z::calc_gradients()
 {
-  for (cvm::atom_iter ai = atoms->begin(); ai != atoms->end(); ai++) {
-    ai->grad = 2.0 * (ai->pos * axis) * axis;
+  for (size_t i = 0; i < atoms->size(); i++) {
+    (*atoms)[i].grad = 2.0 * (atoms->position(i) * axis) * axis;
   }
 }
 
@@ -1092,20 +1290,25 @@ void colvar::rmsd::calc_value()
 {
   // rotational-translational fit is handled by the atom group
 
+  std::vector<cvm::real> const &pos_x = atoms->pos_x;
+  std::vector<cvm::real> const &pos_y = atoms->pos_y;
+  std::vector<cvm::real> const &pos_z = atoms->pos_z;
+  size_t const n = atoms->size();
+
   x.real_value = 0.0;
-  for (size_t ia = 0; ia < atoms->size(); ia++) {
-    x.real_value += ((*atoms)[ia].pos - ref_pos[ia]).norm2();
-  }
   best_perm_index = 0;
 
   // Compute sum of squares for each symmetry permutation of atoms, keep the smallest
-  size_t ref_pos_index = atoms->size();
-  for (size_t ip = 1; ip < n_permutations; ip++) {
+  for (size_t ip = 0; ip < n_permutations; ip++) {
+    cvm::atom_pos const *ref = &(ref_pos[ip * n]);
     cvm::real value = 0.0;
-    for (size_t ia = 0; ia < atoms->size(); ia++) {
-      value += ((*atoms)[ia].pos - ref_pos[ref_pos_index++]).norm2();
+    for (size_t ia = 0; ia < n; ia++) {
+      cvm::real const dx = pos_x[ia] - ref[ia].x;
+      cvm::real const dy = pos_y[ia] - ref[ia].y;
+      cvm::real const dz = pos_z[ia] - ref[ia].z;
+      value += dx*dx + dy*dy + dz*dz;
     }
-    if (value < x.real_value) {
+    if ((ip == 0) || (value < x.real_value)) {
       x.real_value = value;
       best_perm_index = ip;
     }
@@ -1122,10 +1325,17 @@ void colvar::rmsd::calc_gradients()
     0.0;
 
   // Use the appropriate symmetry permutation of reference positions to calculate gradients
-  size_t const start = atoms->size() * best_perm_index;
-  for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = (drmsddx2 * 2.0 * ((*atoms)[ia].pos - ref_pos[start + ia]));
+  size_t const n = atoms->size();
+  cvm::atom_pos const *ref = &(ref_pos[n * best_perm_index]);
+  atoms->grad_x.resize(n);
+  atoms->grad_y.resize(n);
+  atoms->grad_z.resize(n);
+  for (size_t ia = 0; ia < n; ia++) {
+    atoms->grad_x[ia] = drmsddx2 * 2.0 * (atoms->pos_x[ia] - ref[ia].x);
+    atoms->grad_y[ia] = drmsddx2 * 2.0 * (atoms->pos_y[ia] - ref[ia].y);
+    atoms->grad_z[ia] = drmsddx2 * 2.0 * (atoms->pos_z[ia] - ref[ia].z);
   }
+  atoms->scatter_gradients();
 }
 
 
@@ -1408,9 +1618,14 @@ colvar::eigenvector::eigenvector(std::string const &conf)
 
 void colvar::eigenvector::calc_value()
 {
+  std::vector<cvm::real> const &pos_x = atoms->pos_x;
+  std::vector<cvm::real> const &pos_y = atoms->pos_y;
+  std::vector<cvm::real> const &pos_z = atoms->pos_z;
   x.real_value = 0.0;
   for (size_t i = 0; i < atoms->size(); i++) {
-    x.real_value += ((*atoms)[i].pos - ref_pos[i]) * eigenvec[i];
+    x.real_value += (pos_x[i] - ref_pos[i].x) * eigenvec[i].x +
+      (pos_y[i] - ref_pos[i].y) * eigenvec[i].y +
+      (pos_z[i] - ref_pos[i].z) * eigenvec[i].z;
   }
 }
 
@@ -1532,7 +1747,7 @@ void colvar::cartesian::calc_value()
   size_t ia, j;
   for (ia = 0; ia < atoms->size(); ia++) {
     for (j = 0; j < dim; j++) {
-      x.vector1d_value[dim*ia + j] = (*atoms)[ia].pos[axes[j]];
+      x.vector1d_value[dim*ia + j] = atoms->position(ia)[axes[j]];
     }
   }
 }
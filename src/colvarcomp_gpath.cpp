@@ -24,6 +24,22 @@ bool compareColvarComponent(colvar::cvc *i, colvar::cvc *j)
     return i->name < j->name;
 }
 
+/// Whether the atomic gradients of all sub-cvcs can be scaled in place and
+/// used directly (never for shared sub-cvcs, whose gradients are also used
+/// by other components)
+static bool subCVsUseExplicitGradients(std::vector<colvar::cvc*> const &cv, bool use_shared_sub_cvcs)
+{
+    if (use_shared_sub_cvcs) {
+        return false;
+    }
+    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
+        if (!cv[i_cv]->is_enabled(colvardeps::f_cvc_explicit_gradient)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 colvar::CartesianBasedPath::CartesianBasedPath(std::string const &conf): cvc(conf), atoms(nullptr), reference_frames(0) {
     // Parse selected atoms
     atoms = parse_group(conf, "atoms");
@@ -70,8 +86,6 @@ colvar::CartesianBasedPath::CartesianBasedPath(std::string const &conf): cvc(con
             tmp_atoms->ref_pos = reference_frames[i_frame];
             tmp_atoms->center_ref_pos();
             tmp_atoms->enable(f_ag_fit_gradients);
-            tmp_atoms->rot.request_group1_gradients(tmp_atoms->size());
-            tmp_atoms->rot.request_group2_gradients(tmp_atoms->size());
             comp_atoms.push_back(tmp_atoms);
         } else {
             // parse a group of atoms for fitting
@@ -97,12 +111,46 @@ colvar::CartesianBasedPath::CartesianBasedPath(std::string const &conf): cvc(con
             tmp_atoms->enable(f_ag_fit_gradients);
             tmp_atoms->enable(f_ag_fitting_group);
             tmp_atoms->fitting_group = tmp_fitting_atoms;
-            tmp_atoms->rot.request_group1_gradients(tmp_fitting_atoms->size());
-            tmp_atoms->rot.request_group2_gradients(tmp_fitting_atoms->size());
             reference_fitting_frames.push_back(reference_fitting_position);
             comp_atoms.push_back(tmp_atoms);
         }
     }
+    // Without fitting groups, all frames are fitted to the same centered
+    // positions: store the centered frames contiguously to do that in a batch
+    b_batched_frames = !has_user_defined_fitting &&
+        !atoms->is_enabled(f_ag_center) && !atoms->is_enabled(f_ag_rotate) &&
+        !atoms->is_enabled(f_ag_scalable);
+    for (size_t i_frame = 0; i_frame < comp_atoms.size(); ++i_frame) {
+        if (comp_atoms[i_frame]->rot.b_debug_gradients) {
+            b_batched_frames = false;
+        }
+    }
+    if (b_batched_frames) {
+        size_t const num_atoms = atoms->size();
+        size_t const num_frames = comp_atoms.size();
+        frames_ref_x.resize(num_atoms * num_frames);
+        frames_ref_y.resize(num_atoms * num_frames);
+        frames_ref_z.resize(num_atoms * num_frames);
+        frames_ref_norm2.assign(num_frames, 0.0);
+        for (size_t i_frame = 0; i_frame < num_frames; ++i_frame) {
+            std::vector<cvm::atom_pos> const &ref_pos = comp_atoms[i_frame]->ref_pos;
+            comp_atoms[i_frame]->pos_x.assign(num_atoms, 0.0);
+            comp_atoms[i_frame]->pos_y.assign(num_atoms, 0.0);
+            comp_atoms[i_frame]->pos_z.assign(num_atoms, 0.0);
+            for (size_t i_atom = 0; i_atom < num_atoms; ++i_atom) {
+                frames_ref_x[i_atom * num_frames + i_frame] = ref_pos[i_atom].x;
+                frames_ref_y[i_atom * num_frames + i_frame] = ref_pos[i_atom].y;
+                frames_ref_z[i_atom * num_frames + i_frame] = ref_pos[i_atom].z;
+                frames_ref_norm2[i_frame] += ref_pos[i_atom].norm2();
+            }
+        }
+        centered_x.resize(num_atoms);
+        centered_y.resize(num_atoms);
+        centered_z.resize(num_atoms);
+        centered_norm2 = 0.0;
+        frames_C.resize(9 * num_frames);
+        frames_updated.assign(num_frames, 0);
+    }
     x.type(colvarvalue::type_scalar);
     // Don't use implicit gradient
     enable(f_cvc_explicit_gradient);
@@ -118,11 +166,163 @@ colvar::CartesianBasedPath::~CartesianBasedPath() {
     atom_groups.clear();
 }
 
-void colvar::CartesianBasedPath::computeDistanceToReferenceFrames(std::vector<cvm::real>& result) {
-    for (size_t i_frame = 0; i_frame < reference_frames.size(); ++i_frame) {
+bool colvar::CartesianBasedPath::use_batched_frames() const {
+    return b_batched_frames && !is_enabled(f_cvc_debug_gradient);
+}
+
+std::vector<cvm::atom_group *> colvar::CartesianBasedPath::get_shareable_atom_groups() {
+    if (!use_batched_frames()) {
+        return cvc::get_shareable_atom_groups();
+    }
+    // The groups fitted to the reference frames are computed by read_data()
+    return std::vector<cvm::atom_group *>(1, atoms);
+}
+
+void colvar::CartesianBasedPath::read_data() {
+    if (!use_batched_frames()) {
+        cvc::read_data();
+        return;
+    }
+    atoms->reset_atoms_data();
+    if (atoms->is_shared()) {
+        atoms->restore_shared_data();
+    } else {
+        atoms->read_positions();
+        atoms->calc_required_properties();
+    }
+    // Only the groups whose positions were set in the previous step carry
+    // any data
+    for (size_t i_frame = 0; i_frame < comp_atoms.size(); ++i_frame) {
+        if (frames_updated[i_frame]) {
+            comp_atoms[i_frame]->reset_atoms_data();
+            frames_updated[i_frame] = 0;
+        }
+    }
+    size_t const num_atoms = atoms->size();
+    cvm::atom_pos const cog = atoms->center_of_geometry();
+    centered_norm2 = 0.0;
+    for (size_t i_atom = 0; i_atom < num_atoms; ++i_atom) {
+        centered_x[i_atom] = atoms->pos_x[i_atom] - cog.x;
+        centered_y[i_atom] = atoms->pos_y[i_atom] - cog.y;
+        centered_z[i_atom] = atoms->pos_z[i_atom] - cog.z;
+        centered_norm2 += centered_x[i_atom] * centered_x[i_atom] +
+            centered_y[i_atom] * centered_y[i_atom] +
+            centered_z[i_atom] * centered_z[i_atom];
+    }
+    bool need_positions = false;
+    for (size_t i_frame = 0; i_frame < comp_atoms.size(); ++i_frame) {
+        cvm::rotation const &rot = comp_atoms[i_frame]->rot;
+        if (!rot.dQ0_2.empty() || rot.b_debug_gradients) {
+            need_positions = true;
+            break;
+        }
+    }
+    centered_pos.resize(need_positions ? num_atoms : 0);
+    for (size_t i_atom = 0; i_atom < centered_pos.size(); ++i_atom) {
+        centered_pos[i_atom] = cvm::atom_pos(centered_x[i_atom],
+                                             centered_y[i_atom],
+                                             centered_z[i_atom]);
+    }
+}
+
+void colvar::CartesianBasedPath::calc_batched_frames(std::vector<cvm::real>& result, size_t first_frame, size_t last_frame) {
+    size_t const num_atoms = atoms->size();
+    size_t const num_frames = comp_atoms.size();
+    // Correlation matrices with all frames in the range, in one sweep over the
+    // atoms; the innermost loop runs over contiguous frames and can be
+    // vectorized
+    cvm::real *const C = &(frames_C[0]);
+    for (size_t k = 0; k < 9; ++k) {
+        std::fill(C + k * num_frames + first_frame, C + k * num_frames + last_frame, 0.0);
+    }
+    for (size_t i_atom = 0; i_atom < num_atoms; ++i_atom) {
+        cvm::real const x = centered_x[i_atom];
+        cvm::real const y = centered_y[i_atom];
+        cvm::real const z = centered_z[i_atom];
+        cvm::real const *const rx = &(frames_ref_x[i_atom * num_frames]);
+        cvm::real const *const ry = &(frames_ref_y[i_atom * num_frames]);
+        cvm::real const *const rz = &(frames_ref_z[i_atom * num_frames]);
+        for (size_t i_frame = first_frame; i_frame < last_frame; ++i_frame) {
+            C[i_frame] += x * rx[i_frame];
+            C[num_frames + i_frame] += x * ry[i_frame];
+            C[2 * num_frames + i_frame] += x * rz[i_frame];
+            C[3 * num_frames + i_frame] += y * rx[i_frame];
+            C[4 * num_frames + i_frame] += y * ry[i_frame];
+            C[5 * num_frames + i_frame] += y * rz[i_frame];
+            C[6 * num_frames + i_frame] += z * rx[i_frame];
+            C[7 * num_frames + i_frame] += z * ry[i_frame];
+            C[8 * num_frames + i_frame] += z * rz[i_frame];
+        }
+    }
+    // Solve the rotations; the RMSDs follow from their eigenvalues, without
+    // rotating the positions (which are passed only if some rotation also
+    // needs them, see read_data())
+    for (size_t i_frame = first_frame; i_frame < last_frame; ++i_frame) {
+        cvm::atom_group &group = *(comp_atoms[i_frame]);
+        cvm::rotation &rot = group.rot;
+        rot.C.resize(3, 3);
+        rot.C.xx() = C[i_frame];
+        rot.C.xy() = C[num_frames + i_frame];
+        rot.C.xz() = C[2 * num_frames + i_frame];
+        rot.C.yx() = C[3 * num_frames + i_frame];
+        rot.C.yy() = C[4 * num_frames + i_frame];
+        rot.C.yz() = C[5 * num_frames + i_frame];
+        rot.C.zx() = C[6 * num_frames + i_frame];
+        rot.C.zy() = C[7 * num_frames + i_frame];
+        rot.C.zz() = C[8 * num_frames + i_frame];
+        rot.calc_optimal_rotation_from_C(centered_pos, group.ref_pos);
+        cvm::real const frame_msd =
+            (centered_norm2 + frames_ref_norm2[i_frame] - 2.0 * rot.lambda) /
+            cvm::real(num_atoms);
+        result[i_frame] = (frame_msd > 0.0) ? cvm::sqrt(frame_msd) : 0.0;
+    }
+}
+
+void colvar::CartesianBasedPath::update_frame_positions(size_t i_frame) {
+    if (!use_batched_frames() || frames_updated[i_frame]) {
+        return;
+    }
+    cvm::atom_group &group = *(comp_atoms[i_frame]);
+    group.reset_atoms_data();
+    cvm::rmatrix const R = group.rot.matrix();
+    cvm::atom_pos const shift = group.is_enabled(f_ag_center_origin) ?
+        cvm::atom_pos(0.0, 0.0, 0.0) : group.ref_pos_cog;
+    size_t const num_atoms = atoms->size();
+    for (size_t i_atom = 0; i_atom < num_atoms; ++i_atom) {
+        cvm::real const x = centered_x[i_atom];
+        cvm::real const y = centered_y[i_atom];
+        cvm::real const z = centered_z[i_atom];
+        group.pos_x[i_atom] = R.xx() * x + R.xy() * y + R.xz() * z + shift.x;
+        group.pos_y[i_atom] = R.yx() * x + R.yy() * y + R.yz() * z + shift.y;
+        group.pos_z[i_atom] = R.zx() * x + R.zy() * y + R.zz() * z + shift.z;
+    }
+    group.calc_center_of_geometry();
+    group.calc_center_of_mass();
+    frames_updated[i_frame] = 1;
+}
+
+void colvar::CartesianBasedPath::calc_fit_gradients() {
+    if (!use_batched_frames()) {
+        cvc::calc_fit_gradients();
+        return;
+    }
+    // Only the frames whose positions were used can have non-zero gradients
+    for (size_t i_frame = 0; i_frame < comp_atoms.size(); ++i_frame) {
+        if (frames_updated[i_frame]) {
+            comp_atoms[i_frame]->calc_fit_gradients();
+        }
+    }
+}
+
+void colvar::CartesianBasedPath::computeDistanceToReferenceFrames(std::vector<cvm::real>& result, size_t first_frame, size_t last_frame) {
+    if (use_batched_frames()) {
+        calc_batched_frames(result, first_frame, last_frame);
+        return;
+    }
+    for (size_t i_frame = first_frame; i_frame < last_frame; ++i_frame) {
         cvm::real frame_rmsd = 0.0;
         for (size_t i_atom = 0; i_atom < atoms->size(); ++i_atom) {
-            frame_rmsd += ((*(comp_atoms[i_frame]))[i_atom].pos - reference_frames[i_frame][i_atom]).norm2();
+            frame_rmsd += (comp_atoms[i_frame]->position(i_atom) - reference_frames[i_frame][i_atom]).norm2();
         }
         frame_rmsd /= cvm::real(atoms->size());
         frame_rmsd = cvm::sqrt(frame_rmsd);
@@ -148,21 +348,24 @@ colvar::gspath::gspath(std::string const &conf): CartesianBasedPath(conf) {
         cvm::error("Error: you have specified " + cvm::to_str(total_reference_frames) + " reference frames, but gspath requires at least 2 frames.\n");
     }
     GeometricPathCV::GeometricPathBase<cvm::atom_pos, cvm::real, GeometricPathCV::path_sz::S>::initialize(atoms->size(), cvm::atom_pos(), total_reference_frames, use_second_closest_frame, use_third_closest_frame);
+    parseFrameWindow(*this, conf);
     cvm::log(std::string("Geometric pathCV(s) is initialized.\n"));
     cvm::log(std::string("Geometric pathCV(s) loaded ") + cvm::to_str(reference_frames.size()) + std::string(" frames.\n"));
 }
 
 void colvar::gspath::updateDistanceToReferenceFrames() {
-    computeDistanceToReferenceFrames(frame_distances);
+    computeDistanceToReferenceFrames(frame_distances, window_begin, window_end);
 }
 
 void colvar::gspath::prepareVectors() {
+    update_frame_positions(min_frame_index_1);
+    update_frame_positions(min_frame_index_2);
     size_t i_atom;
     for (i_atom = 0; i_atom < atoms->size(); ++i_atom) {
         // v1 = s_m - z
-        v1[i_atom] = reference_frames[min_frame_index_1][i_atom] - (*(comp_atoms[min_frame_index_1]))[i_atom].pos;
+        v1[i_atom] = reference_frames[min_frame_index_1][i_atom] - comp_atoms[min_frame_index_1]->position(i_atom);
         // v2 = z - s_(m-1)
-        v2[i_atom] = (*(comp_atoms[min_frame_index_2]))[i_atom].pos - reference_frames[min_frame_index_2][i_atom];
+        v2[i_atom] = comp_atoms[min_frame_index_2]->position(i_atom) - reference_frames[min_frame_index_2][i_atom];
     }
     if (min_frame_index_3 < 0 || min_frame_index_3 > M) {
         cvm::atom_pos reference_cog_1, reference_cog_2;
@@ -294,16 +497,19 @@ colvar::gzpath::gzpath(std::string const &conf): CartesianBasedPath(conf) {
         cvm::error("Error: you have specified " + cvm::to_str(total_reference_frames) + " reference frames, but gzpath requires at least 2 frames.\n");
     }
     GeometricPathCV::GeometricPathBase<cvm::atom_pos, cvm::real, GeometricPathCV::path_sz::Z>::initialize(atoms->size(), cvm::atom_pos(), total_reference_frames, use_second_closest_frame, use_third_closest_frame, b_use_z_square);
+    parseFrameWindow(*this, conf);
     // Logging
     cvm::log(std::string("Geometric pathCV(z) is initialized.\n"));
     cvm::log(std::string("Geometric pathCV(z) loaded ") + cvm::to_str(reference_frames.size()) + std::string(" frames.\n"));
 }
 
 void colvar::gzpath::updateDistanceToReferenceFrames() {
-    computeDistanceToReferenceFrames(frame_distances);
+    computeDistanceToReferenceFrames(frame_distances, window_begin, window_end);
 }
 
 void colvar::gzpath::prepareVectors() {
+    update_frame_positions(min_frame_index_1);
+    update_frame_positions(min_frame_index_2);
     cvm::atom_pos reference_cog_1, reference_cog_2;
     size_t i_atom;
     for (i_atom = 0; i_atom < atoms->size(); ++i_atom) {
@@ -339,8 +545,8 @@ void colvar::gzpath::prepareVectors() {
         rot_v4.calc_optimal_rotation(tmp_reference_frame_1, tmp_reference_frame_2);
     }
     for (i_atom = 0; i_atom < atoms->size(); ++i_atom) {
-        v1[i_atom] = reference_frames[min_frame_index_1][i_atom] - (*(comp_atoms[min_frame_index_1]))[i_atom].pos;
-        v2[i_atom] = (*(comp_atoms[min_frame_index_2]))[i_atom].pos - reference_frames[min_frame_index_2][i_atom];
+        v1[i_atom] = reference_frames[min_frame_index_1][i_atom] - comp_atoms[min_frame_index_1]->position(i_atom);
+        v2[i_atom] = comp_atoms[min_frame_index_2]->position(i_atom) - reference_frames[min_frame_index_2][i_atom];
         // v4 only computes in gzpath
         // v4 = s_m - s_(m-1)
         v4[i_atom] = rot_v4.q.rotate(tmp_reference_frame_1[i_atom]) - tmp_reference_frame_2[i_atom];
@@ -402,31 +608,34 @@ void colvar::gzpath::apply_force(colvarvalue const &force) {
 }
 
 colvar::linearCombination::linearCombination(std::string const &conf): cvc(conf) {
+    // Sub-cvcs defined identically by other components may be shared with them
+    get_keyval(conf, "sharedSubComponents", use_shared_sub_cvcs, false);
     // Lookup all available sub-cvcs
     for (auto it_cv_map = colvar::get_global_cvc_map().begin(); it_cv_map != colvar::get_global_cvc_map().end(); ++it_cv_map) {
         if (key_lookup(conf, it_cv_map->first.c_str())) {
             std::vector<std::string> sub_cvc_confs;
             get_key_string_multi_value(conf, it_cv_map->first.c_str(), sub_cvc_confs);
             for (auto it_sub_cvc_conf = sub_cvc_confs.begin(); it_sub_cvc_conf != sub_cvc_confs.end(); ++it_sub_cvc_conf) {
-                cv.push_back((it_cv_map->second)(*(it_sub_cvc_conf)));
+                if (use_shared_sub_cvcs) {
+                    cvc *sub_cv = colvar::acquire_shared_sub_cvc(it_cv_map->first, *(it_sub_cvc_conf), this);
+                    if (sub_cv != NULL) cv.push_back(sub_cv);
+                } else {
+                    cv.push_back((it_cv_map->second)(*(it_sub_cvc_conf)));
+                }
             }
         }
     }
     // Sort all sub CVs by their names
     std::sort(cv.begin(), cv.end(), compareColvarComponent);
-    for (auto it_sub_cv = cv.begin(); it_sub_cv != cv.end(); ++it_sub_cv) {
+    // Atom groups of shared sub-cvcs are handled by colvar::calc_shared_sub_cvcs()
+    for (auto it_sub_cv = cv.begin(); it_sub_cv != cv.end() && !use_shared_sub_cvcs; ++it_sub_cv) {
         for (auto it_atom_group = (*it_sub_cv)->atom_groups.begin(); it_atom_group != (*it_sub_cv)->atom_groups.end(); ++it_atom_group) {
             register_atom_group(*it_atom_group);
         }
     }
     x.type(cv[0]->value());
     x.reset();
-    use_explicit_gradients = true;
-    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if (!cv[i_cv]->is_enabled(f_cvc_explicit_gradient)) {
-            use_explicit_gradients = false;
-        }
-    }
+    use_explicit_gradients = subCVsUseExplicitGradients(cv, use_shared_sub_cvcs);
     if (!use_explicit_gradients) {
         disable(f_cvc_explicit_gradient);
     }
@@ -444,14 +653,34 @@ cvm::real colvar::linearCombination::getPolynomialFactorOfCVGradient(size_t i_cv
 
 colvar::linearCombination::~linearCombination() {
     for (auto it = cv.begin(); it != cv.end(); ++it) {
-        delete (*it);
+        if (use_shared_sub_cvcs) {
+            colvar::release_shared_sub_cvc(*it, this);
+        } else {
+            delete (*it);
+        }
+    }
+    atom_groups.clear();
+}
+
+bool colvar::linearCombination::useSubCVExplicitGradient(size_t i_cv) const {
+    return !use_shared_sub_cvcs &&
+           cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
+           !cv[i_cv]->is_enabled(f_cvc_scalable) &&
+           !cv[i_cv]->is_enabled(f_cvc_scalable_com);
+}
+
+void colvar::linearCombination::applySubCVForce(size_t i_cv, colvarvalue const &cv_force) {
+    if (use_shared_sub_cvcs) {
+        colvar::add_shared_sub_cvc_force(cv[i_cv], cv_force);
+    } else {
+        cv[i_cv]->apply_force(cv_force);
     }
 }
 
 void colvar::linearCombination::calc_value() {
     x.reset();
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        cv[i_cv]->calc_value();
+        if (!use_shared_sub_cvcs) cv[i_cv]->calc_value();
         colvarvalue current_cv_value(cv[i_cv]->value());
         // polynomial combination allowed
         if (current_cv_value.type() == colvarvalue::type_scalar) {
@@ -464,10 +693,8 @@ void colvar::linearCombination::calc_value() {
 
 void colvar::linearCombination::calc_gradients() {
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        cv[i_cv]->calc_gradients();
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)) {
+        if (!use_shared_sub_cvcs) cv[i_cv]->calc_gradients();
+        if (useSubCVExplicitGradient(i_cv)) {
             cvm::real factor_polynomial = getPolynomialFactorOfCVGradient(i_cv);
             for (size_t j_elem = 0; j_elem < cv[i_cv]->value().size(); ++j_elem) {
                 for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
@@ -484,10 +711,7 @@ void colvar::linearCombination::apply_force(colvarvalue const &force) {
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
         // If this CV us explicit gradients, then atomic gradients is already calculated
         // We can apply the force to atom groups directly
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)
-        ) {
+        if (useSubCVExplicitGradient(i_cv)) {
             for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
                 (cv[i_cv]->atom_groups)[k_ag]->apply_colvar_force(force.real_value);
             }
@@ -495,19 +719,26 @@ void colvar::linearCombination::apply_force(colvarvalue const &force) {
             // Compute factors for polynomial combinations
             cvm::real factor_polynomial = getPolynomialFactorOfCVGradient(i_cv);
             colvarvalue cv_force = force.real_value * factor_polynomial;
-            cv[i_cv]->apply_force(cv_force);
+            applySubCVForce(i_cv, cv_force);
         }
     }
 }
 
 colvar::CVBasedPath::CVBasedPath(std::string const &conf): cvc(conf) {
+    // Sub-cvcs defined identically by other components may be shared with them
+    get_keyval(conf, "sharedSubComponents", use_shared_sub_cvcs, false);
     // Lookup all available sub-cvcs
     for (auto it_cv_map = colvar::get_global_cvc_map().begin(); it_cv_map != colvar::get_global_cvc_map().end(); ++it_cv_map) {
         if (key_lookup(conf, it_cv_map->first.c_str())) {
             std::vector<std::string> sub_cvc_confs;
             get_key_string_multi_value(conf, it_cv_map->first.c_str(), sub_cvc_confs);
             for (auto it_sub_cvc_conf = sub_cvc_confs.begin(); it_sub_cvc_conf != sub_cvc_confs.end(); ++it_sub_cvc_conf) {
-                cv.push_back((it_cv_map->second)(*(it_sub_cvc_conf)));
+                if (use_shared_sub_cvcs) {
+                    cvc *sub_cv = colvar::acquire_shared_sub_cvc(it_cv_map->first, *(it_sub_cvc_conf), this);
+                    if (sub_cv != NULL) cv.push_back(sub_cv);
+                } else {
+                    cv.push_back((it_cv_map->second)(*(it_sub_cvc_conf)));
+                }
             }
         }
     }
@@ -516,7 +747,8 @@ colvar::CVBasedPath::CVBasedPath(std::string const &conf): cvc(conf) {
     // Register atom groups and determine the colvar type for reference
     std::vector<colvarvalue> tmp_cv;
     for (auto it_sub_cv = cv.begin(); it_sub_cv != cv.end(); ++it_sub_cv) {
-        for (auto it_atom_group = (*it_sub_cv)->atom_groups.begin(); it_atom_group != (*it_sub_cv)->atom_groups.end(); ++it_atom_group) {
+        // Atom groups of shared sub-cvcs are handled by colvar::calc_shared_sub_cvcs()
+        for (auto it_atom_group = (*it_sub_cv)->atom_groups.begin(); it_atom_group != (*it_sub_cv)->atom_groups.end() && !use_shared_sub_cvcs; ++it_atom_group) {
             register_atom_group(*it_atom_group);
         }
         colvarvalue tmp_i_cv((*it_sub_cv)->value());
@@ -563,22 +795,14 @@ colvar::CVBasedPath::CVBasedPath(std::string const &conf): cvc(conf) {
 	cvm::error("Error: there is only 1 or 0 reference frame, which doesn't constitute a path.\n");
     }
     x.type(colvarvalue::type_scalar);
-    use_explicit_gradients = true;
-    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if (!cv[i_cv]->is_enabled(f_cvc_explicit_gradient)) {
-            use_explicit_gradients = false;
-        }
-    }
+    use_explicit_gradients = subCVsUseExplicitGradients(cv, use_shared_sub_cvcs);
     if (!use_explicit_gradients) {
         disable(f_cvc_explicit_gradient);
     }
 }
 
-void colvar::CVBasedPath::computeDistanceToReferenceFrames(std::vector<cvm::real>& result) {
-    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        cv[i_cv]->calc_value();
-    }
-    for (size_t i_frame = 0; i_frame < ref_cv.size(); ++i_frame) {
+void colvar::CVBasedPath::computeDistanceToReferenceFrames(std::vector<cvm::real>& result, size_t first_frame, size_t last_frame) {
+    for (size_t i_frame = first_frame; i_frame < last_frame; ++i_frame) {
         cvm::real rmsd_i = 0.0;
         for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
             colvarvalue ref_cv_value(ref_cv[i_frame][i_cv]);
@@ -623,11 +847,30 @@ cvm::real colvar::CVBasedPath::getPolynomialFactorOfCVGradient(size_t i_cv) cons
 
 colvar::CVBasedPath::~CVBasedPath() {
     for (auto it = cv.begin(); it != cv.end(); ++it) {
-        delete (*it);
+        if (use_shared_sub_cvcs) {
+            colvar::release_shared_sub_cvc(*it, this);
+        } else {
+            delete (*it);
+        }
     }
     atom_groups.clear();
 }
 
+bool colvar::CVBasedPath::useSubCVExplicitGradient(size_t i_cv) const {
+    return !use_shared_sub_cvcs &&
+           cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
+           !cv[i_cv]->is_enabled(f_cvc_scalable) &&
+           !cv[i_cv]->is_enabled(f_cvc_scalable_com);
+}
+
+void colvar::CVBasedPath::applySubCVForce(size_t i_cv, colvarvalue const &cv_force) {
+    if (use_shared_sub_cvcs) {
+        colvar::add_shared_sub_cvc_force(cv[i_cv], cv_force);
+    } else {
+        cv[i_cv]->apply_force(cv_force);
+    }
+}
+
 colvar::gspathCV::gspathCV(std::string const &conf): CVBasedPath(conf) {
     function_type = "gspathCV";
     cvm::log(std::string("Total number of frames: ") + cvm::to_str(total_reference_frames) + std::string("\n"));
@@ -648,29 +891,23 @@ colvar::gspathCV::gspathCV(std::string const &conf): CVBasedPath(conf) {
         cvm::error("Error: you have specified " + cvm::to_str(total_reference_frames) + " reference frames, but gspathCV requires at least 2 frames.\n");
     }
     GeometricPathCV::GeometricPathBase<colvarvalue, cvm::real, GeometricPathCV::path_sz::S>::initialize(cv.size(), ref_cv[0], total_reference_frames, use_second_closest_frame, use_third_closest_frame);
+    parseFrameWindow(*this, conf);
     x.type(colvarvalue::type_scalar);
-    use_explicit_gradients = true;
-    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if (!cv[i_cv]->is_enabled(f_cvc_explicit_gradient)) {
-            use_explicit_gradients = false;
-        }
-    }
     if (!use_explicit_gradients) {
         cvm::log("Geometric path s(σ) will use implicit gradients.\n");
-        disable(f_cvc_explicit_gradient);
     }
 }
 
 colvar::gspathCV::~gspathCV() {}
 
 void colvar::gspathCV::updateDistanceToReferenceFrames() {
-    computeDistanceToReferenceFrames(frame_distances);
+    computeDistanceToReferenceFrames(frame_distances, window_begin, window_end);
 }
 
 void colvar::gspathCV::prepareVectors() {
     // Compute v1, v2 and v3
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        // values of sub-cvc are computed in update_distances
+        // values of sub-cvc are computed in calc_value()
         // cv[i_cv]->calc_value();
         colvarvalue f1_ref_cv_i_value(ref_cv[min_frame_index_1][i_cv]);
         colvarvalue f2_ref_cv_i_value(ref_cv[min_frame_index_2][i_cv]);
@@ -700,6 +937,11 @@ void colvar::gspathCV::prepareVectors() {
 }
 
 void colvar::gspathCV::calc_value() {
+    if (!use_shared_sub_cvcs) {
+        for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
+            cv[i_cv]->calc_value();
+        }
+    }
     computeValue();
     x = s;
 }
@@ -707,12 +949,11 @@ void colvar::gspathCV::calc_value() {
 void colvar::gspathCV::calc_gradients() {
     computeDerivatives();
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        // No matter whether the i-th cv uses implicit gradient, compute it first.
-        cv[i_cv]->calc_gradients();
+        // No matter whether the i-th cv uses implicit gradient, compute it first
+        // (unless it is shared, and then computed by calc_shared_sub_cvcs()).
+        if (!use_shared_sub_cvcs) cv[i_cv]->calc_gradients();
         // If the gradient is not implicit, then add the gradients to its atom groups
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)) {
+        if (useSubCVExplicitGradient(i_cv)) {
             // Temporary variables storing gradients
             colvarvalue tmp_cv_grad_v1(cv[i_cv]->value());
             colvarvalue tmp_cv_grad_v2(cv[i_cv]->value());
@@ -741,10 +982,7 @@ void colvar::gspathCV::apply_force(colvarvalue const &force) {
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
         // If this CV us explicit gradients, then atomic gradients is already calculated
         // We can apply the force to atom groups directly
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)
-        ) {
+        if (useSubCVExplicitGradient(i_cv)) {
             for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
                 (cv[i_cv]->atom_groups)[k_ag]->apply_colvar_force(force.real_value);
             }
@@ -760,7 +998,7 @@ void colvar::gspathCV::apply_force(colvarvalue const &force) {
                 tmp_cv_grad_v2[j_elem] = sign * 0.5 * dfdv2[i_cv][j_elem] / M;
             }
             colvarvalue cv_force = force.real_value * factor_polynomial * (tmp_cv_grad_v1 + tmp_cv_grad_v2);
-            cv[i_cv]->apply_force(cv_force);
+            applySubCVForce(i_cv, cv_force);
         }
     }
 }
@@ -792,16 +1030,10 @@ colvar::gzpathCV::gzpathCV(std::string const &conf): CVBasedPath(conf) {
         cvm::error("Error: you have specified " + cvm::to_str(total_reference_frames) + " reference frames, but gzpathCV requires at least 2 frames.\n");
     }
     GeometricPathCV::GeometricPathBase<colvarvalue, cvm::real, GeometricPathCV::path_sz::Z>::initialize(cv.size(), ref_cv[0], total_reference_frames, use_second_closest_frame, use_third_closest_frame, b_use_z_square);
+    parseFrameWindow(*this, conf);
     x.type(colvarvalue::type_scalar);
-    use_explicit_gradients = true;
-    for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        if (!cv[i_cv]->is_enabled(f_cvc_explicit_gradient)) {
-            use_explicit_gradients = false;
-        }
-    }
     if (!use_explicit_gradients) {
         cvm::log("Geometric path z(σ) will use implicit gradients.\n");
-        disable(f_cvc_explicit_gradient);
     }
 }
 
@@ -809,13 +1041,13 @@ colvar::gzpathCV::~gzpathCV() {
 }
 
 void colvar::gzpathCV::updateDistanceToReferenceFrames() {
-    computeDistanceToReferenceFrames(frame_distances);
+    computeDistanceToReferenceFrames(frame_distances, window_begin, window_end);
 }
 
 void colvar::gzpathCV::prepareVectors() {
     // Compute v1, v2 and v3
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        // values of sub-cvc are computed in update_distances
+        // values of sub-cvc are computed in calc_value()
         // cv[i_cv]->calc_value();
         colvarvalue f1_ref_cv_i_value(ref_cv[min_frame_index_1][i_cv]);
         colvarvalue f2_ref_cv_i_value(ref_cv[min_frame_index_2][i_cv]);
@@ -847,6 +1079,11 @@ void colvar::gzpathCV::prepareVectors() {
 }
 
 void colvar::gzpathCV::calc_value() {
+    if (!use_shared_sub_cvcs) {
+        for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
+            cv[i_cv]->calc_value();
+        }
+    }
     computeValue();
     x = z;
 }
@@ -854,12 +1091,11 @@ void colvar::gzpathCV::calc_value() {
 void colvar::gzpathCV::calc_gradients() {
     computeDerivatives();
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
-        // No matter whether the i-th cv uses implicit gradient, compute it first.
-        cv[i_cv]->calc_gradients();
+        // No matter whether the i-th cv uses implicit gradient, compute it first
+        // (unless it is shared, and then computed by calc_shared_sub_cvcs()).
+        if (!use_shared_sub_cvcs) cv[i_cv]->calc_gradients();
         // If the gradient is not implicit, then add the gradients to its atom groups
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)) {
+        if (useSubCVExplicitGradient(i_cv)) {
             // Temporary variables storing gradients
             colvarvalue tmp_cv_grad_v1 = -1.0 * dzdv1[i_cv];
             colvarvalue tmp_cv_grad_v2 =  1.0 * dzdv2[i_cv];
@@ -884,9 +1120,7 @@ void colvar::gzpathCV::apply_force(colvarvalue const &force) {
     for (size_t i_cv = 0; i_cv < cv.size(); ++i_cv) {
         // If this CV us explicit gradients, then atomic gradients is already calculated
         // We can apply the force to atom groups directly
-        if ( cv[i_cv]->is_enabled(f_cvc_explicit_gradient) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable) &&
-            !cv[i_cv]->is_enabled(f_cvc_scalable_com)) {
+        if (useSubCVExplicitGradient(i_cv)) {
             for (size_t k_ag = 0 ; k_ag < cv[i_cv]->atom_groups.size(); ++k_ag) {
                 (cv[i_cv]->atom_groups)[k_ag]->apply_colvar_force(force.real_value);
             }
@@ -898,7 +1132,7 @@ void colvar::gzpathCV::apply_force(colvarvalue const &force) {
             // Compute factors for polynomial combinations
             cvm::real factor_polynomial = getPolynomialFactorOfCVGradient(i_cv);
             colvarvalue cv_force = force.real_value * factor_polynomial * (tmp_cv_grad_v1 + tmp_cv_grad_v2);
-            cv[i_cv]->apply_force(cv_force);
+            applySubCVForce(i_cv, cv_force);
         }
     }
 }
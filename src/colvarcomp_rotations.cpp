@@ -82,11 +82,6 @@ int colvar::orientation::init(std::string const &conf)
 
   get_keyval(conf, "closestToQuaternion", ref_quat, cvm::quaternion(1.0, 0.0, 0.0, 0.0));
 
-  // initialize rot member data
-  if (!atoms->noforce) {
-    rot.request_group2_gradients(atoms->size());
-  }
-
   return error_code;
 }
 
@@ -105,7 +100,8 @@ void colvar::orientation::calc_value()
   rot.b_debug_gradients = is_enabled(f_cvc_debug_gradient);
   atoms_cog = atoms->center_of_geometry();
 
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
 
   if ((rot.q).inner(ref_quat) >= 0.0) {
     x.quaternion_value = rot.q;
@@ -130,9 +126,7 @@ void colvar::orientation::apply_force(colvarvalue const &force)
 
   if (!atoms->noforce) {
     for (size_t ia = 0; ia < atoms->size(); ia++) {
-      for (size_t i = 0; i < 4; i++) {
-        (*atoms)[ia].apply_force(FQ[i] * rot.dQ0_2[ia][i]);
-      }
+      (*atoms)[ia].apply_force(rot.dQ0_2_dot(ref_pos[ia], FQ));
     }
   }
 }
@@ -180,7 +174,8 @@ void colvar::orientation_angle::calc_value()
 {
   atoms_cog = atoms->center_of_geometry();
 
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
 
   if ((rot.q).q0 >= 0.0) {
     x.real_value = (180.0/PI) * 2.0 * cvm::acos((rot.q).q0);
@@ -198,7 +193,8 @@ void colvar::orientation_angle::calc_gradients()
       0.0 );
 
   for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = (dxdq0 * (rot.dQ0_2[ia])[0]);
+    (*atoms)[ia].grad =
+      rot.dQ0_2_dot(ref_pos[ia], cvm::quaternion(dxdq0, 0.0, 0.0, 0.0));
   }
 }
 
@@ -236,7 +232,8 @@ int colvar::orientation_proj::init(std::string const &conf)
 void colvar::orientation_proj::calc_value()
 {
   atoms_cog = atoms->center_of_geometry();
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
   x.real_value = 2.0 * (rot.q).q0 * (rot.q).q0 - 1.0;
 }
 
@@ -245,7 +242,8 @@ void colvar::orientation_proj::calc_gradients()
 {
   cvm::real const dxdq0 = 2.0 * 2.0 * (rot.q).q0;
   for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = (dxdq0 * (rot.dQ0_2[ia])[0]);
+    (*atoms)[ia].grad =
+      rot.dQ0_2_dot(ref_pos[ia], cvm::quaternion(dxdq0, 0.0, 0.0, 0.0));
   }
 }
 
@@ -295,7 +293,8 @@ void colvar::tilt::calc_value()
 {
   atoms_cog = atoms->center_of_geometry();
 
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
 
   x.real_value = rot.cos_theta(axis);
 }
@@ -306,10 +305,7 @@ void colvar::tilt::calc_gradients()
   cvm::quaternion const dxdq = rot.dcos_theta_dq(axis);
 
   for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = cvm::rvector(0.0, 0.0, 0.0);
-    for (size_t iq = 0; iq < 4; iq++) {
-      (*atoms)[ia].grad += (dxdq[iq] * (rot.dQ0_2[ia])[iq]);
-    }
+    (*atoms)[ia].grad = rot.dQ0_2_dot(ref_pos[ia], dxdq);
   }
 }
 
@@ -371,7 +367,8 @@ void colvar::spin_angle::calc_value()
 {
   atoms_cog = atoms->center_of_geometry();
 
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
 
   x.real_value = rot.spin_angle(axis);
   this->wrap(x);
@@ -383,10 +380,7 @@ void colvar::spin_angle::calc_gradients()
   cvm::quaternion const dxdq = rot.dspin_angle_dq(axis);
 
   for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = cvm::rvector(0.0, 0.0, 0.0);
-    for (size_t iq = 0; iq < 4; iq++) {
-      (*atoms)[ia].grad += (dxdq[iq] * (rot.dQ0_2[ia])[iq]);
-    }
+    (*atoms)[ia].grad = rot.dQ0_2_dot(ref_pos[ia], dxdq);
   }
 }
 
@@ -479,7 +473,8 @@ void colvar::euler_phi::calc_value()
 {
   atoms_cog = atoms->center_of_geometry();
 
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
 
   const cvm::real& q0 = rot.q.q0;
   const cvm::real& q1 = rot.q.q1;
@@ -503,10 +498,8 @@ void colvar::euler_phi::calc_gradients()
   const cvm::real dxdq2 = (180.0/PI) * (-4 * q2 * (-2 * q0 * q1 - 2 * q2 * q3) + 2 * q3 * (-2 * q1 * q1 - 2 * q2 * q2 + 1)) / denominator;
   const cvm::real dxdq3 = (180.0/PI) * 2 * q2 * (-2 * q1 * q1 - 2 * q2 * q2 + 1) / denominator;
   for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = (dxdq0 * (rot.dQ0_2[ia])[0]) +
-                        (dxdq1 * (rot.dQ0_2[ia])[1]) +
-                        (dxdq2 * (rot.dQ0_2[ia])[2]) +
-                        (dxdq3 * (rot.dQ0_2[ia])[3]);
+    (*atoms)[ia].grad =
+      rot.dQ0_2_dot(ref_pos[ia], cvm::quaternion(dxdq0, dxdq1, dxdq2, dxdq3));
   }
 }
 
@@ -598,7 +591,8 @@ void colvar::euler_psi::calc_value()
 {
   atoms_cog = atoms->center_of_geometry();
 
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
 
   const cvm::real& q0 = rot.q.q0;
   const cvm::real& q1 = rot.q.q1;
@@ -622,10 +616,8 @@ void colvar::euler_psi::calc_gradients()
   const cvm::real dxdq2 = (180.0/PI) * (2 * q1 * (-2 * q2 * q2 - 2 * q3 * q3 + 1) - 4 * q2 * (-2 * q0 * q3 - 2 * q1 * q2)) / denominator;
   const cvm::real dxdq3 = (180.0/PI) * (2 * q0 * (-2 * q2 * q2 - 2 * q3 * q3 + 1) - 4 * q3 * (-2 * q0 * q3 - 2 * q1 * q2)) / denominator;
   for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = (dxdq0 * (rot.dQ0_2[ia])[0]) +
-                        (dxdq1 * (rot.dQ0_2[ia])[1]) +
-                        (dxdq2 * (rot.dQ0_2[ia])[2]) +
-                        (dxdq3 * (rot.dQ0_2[ia])[3]);
+    (*atoms)[ia].grad =
+      rot.dQ0_2_dot(ref_pos[ia], cvm::quaternion(dxdq0, dxdq1, dxdq2, dxdq3));
   }
 }
 
@@ -713,7 +705,8 @@ void colvar::euler_theta::calc_value()
 {
   atoms_cog = atoms->center_of_geometry();
 
-  rot.calc_optimal_rotation(ref_pos, atoms->positions_shifted(-1.0 * atoms_cog));
+  rot.calc_optimal_rotation(ref_pos, atoms->pos_x, atoms->pos_y, atoms->pos_z,
+                            -1.0 * atoms_cog);
 
   const cvm::real& q0 = rot.q.q0;
   const cvm::real& q1 = rot.q.q1;
@@ -735,10 +728,8 @@ void colvar::euler_theta::calc_gradients()
   const cvm::real dxdq2 = (180.0/PI) * 2 * q0 / denominator;
   const cvm::real dxdq3 = (180.0/PI) * -2 * q1 / denominator;
   for (size_t ia = 0; ia < atoms->size(); ia++) {
-    (*atoms)[ia].grad = (dxdq0 * (rot.dQ0_2[ia])[0]) +
-                        (dxdq1 * (rot.dQ0_2[ia])[1]) +
-                        (dxdq2 * (rot.dQ0_2[ia])[2]) +
-                        (dxdq3 * (rot.dQ0_2[ia])[3]);
+    (*atoms)[ia].grad =
+      rot.dQ0_2_dot(ref_pos[ia], cvm::quaternion(dxdq0, dxdq1, dxdq2, dxdq3));
   }
 }
 
@@ -114,6 +114,8 @@ void colvar::map_total::calc_value()
       flags |= colvarproxy::volmap_flag_use_atom_field;
       w = &(atom_weights[0]);
     }
+    // The back-end reads the pos member of each atom
+    atoms->scatter_positions();
     proxy->compute_volmap(flags, volmap_id, atoms->begin(), atoms->end(),
                           &(x.real_value), w);
   } else {
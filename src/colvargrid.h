@@ -971,6 +971,10 @@ public:
   std::ostream & write_raw(std::ostream &os,
                            size_t const buf_size = 3) const
   {
+    if (os.iword(cvm::binary_state_flag())) {
+      return write_raw_binary(os);
+    }
+
     std::streamsize const w = os.width();
     std::streamsize const p = os.precision();
 
@@ -992,11 +996,36 @@ public:
     return os;
   }
 
+  /// \brief Write the same data as write_raw() as a binary array,
+  /// preceded by a text marker "<binary count size>"; used in the
+  /// sections of binary restart files
+  std::ostream & write_raw_binary(std::ostream &os) const
+  {
+    std::vector<T> values;
+    values.reserve(data.size());
+    for (std::vector<int> ix = new_index(); index_ok(ix); incr(ix)) {
+      for (size_t imult = 0; imult < mult; imult++) {
+        values.push_back(value_output(ix, imult));
+      }
+    }
+    os << " <binary " << values.size() << " " << sizeof(T) << ">\n";
+    if (values.size()) {
+      os.write(reinterpret_cast<char const *>(&(values[0])),
+               values.size() * sizeof(T));
+    }
+    os << "\n";
+    return os;
+  }
+
   /// \brief Read data written by colvar_grid::write_raw()
   std::istream & read_raw(std::istream &is)
   {
     std::streampos const start_pos = is.tellg();
 
+    if ((is >> std::ws) && (is.peek() == '<')) {
+      return read_raw_binary(is, start_pos);
+    }
+
     for (std::vector<int> ix = new_index(); index_ok(ix); incr(ix)) {
       for (size_t imult = 0; imult < mult; imult++) {
         T new_value;
@@ -1016,6 +1045,41 @@ public:
     return is;
   }
 
+  /// \brief Read data written by colvar_grid::write_raw_binary()
+  std::istream & read_raw_binary(std::istream &is,
+                                 std::streampos const &start_pos)
+  {
+    size_t num_values = 0;
+    for (std::vector<int> ix = new_index(); index_ok(ix); incr(ix)) {
+      num_values += mult;
+    }
+    std::string word;
+    size_t count = 0, value_size = 0;
+    char c1 = 0, c2 = 0, c3 = 0;
+    std::vector<T> values;
+    if (is.get(c1) && (is >> word >> count >> value_size) &&
+        is.get(c2) && is.get(c3) && (word == "binary") && (c2 == '>') &&
+        (c3 == '\n') && (count == num_values) && (value_size == sizeof(T))) {
+      values.resize(count);
+      if ((count == 0) ||
+          is.read(reinterpret_cast<char *>(&(values[0])), count * sizeof(T))) {
+        size_t i = 0;
+        for (std::vector<int> ix = new_index(); index_ok(ix); incr(ix)) {
+          for (size_t imult = 0; imult < mult; imult++) {
+            value_input(ix, values[i++], imult);
+          }
+        }
+        has_data = true;
+        return is;
+      }
+    }
+    is.clear();
+    is.seekg(start_pos, std::ios::beg);
+    is.setstate(std::ios::failbit);
+    cvm::error("Error: failed to read all of the grid points from binary data.  Possible explanations: grid parameters in the configuration (lowerBoundary, upperBoundary, width) are different from those in the file, or the file is corrupt/incomplete.\n");
+    return is;
+  }
+
   /// \brief Write the grid in a format which is both human readable
   /// and suitable for visualization e.g. with gnuplot
   void write_multicol(std::ostream &os) const
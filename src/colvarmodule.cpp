@@ -8,7 +8,23 @@
 // Colvars repository at GitHub.
 
 #include <sstream>
+#include <cctype>
 #include <cstring>
+#include <ctime>
+#include <algorithm>
+
+#if (__cplusplus >= 201103L)
+#include <chrono>
+#elif defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#if !defined(WIN32) || defined(__CYGWIN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #include "colvarmodule.h"
 #include "colvarparse.h"
@@ -23,6 +39,7 @@
 #include "colvarscript.h"
 #include "colvaratoms.h"
 #include "colvarcomp.h"
+#include "colvartraj.h"
 
 
 colvarmodule::colvarmodule(colvarproxy *proxy_in)
@@ -78,6 +95,7 @@ colvarmodule::colvarmodule(colvarproxy *proxy_in)
 
   colvarmodule::rotation::monitor_crossings = false;
   colvarmodule::rotation::crossing_threshold = 1.0e-02;
+  colvarmodule::rotation::use_qcp = false;
 
   cv_traj_freq = 100;
   restart_out_freq = proxy->default_restart_frequency();
@@ -85,7 +103,17 @@ colvarmodule::colvarmodule(colvarproxy *proxy_in)
   // by default overwrite the existing trajectory file
   cv_traj_append = false;
 
+  cv_traj_binary = false;
+  cv_traj_read_index = false;
+  restart_out_binary = false;
+  restart_out_append_diffs = false;
+  restart_out_base_size = 0;
+  restart_out_diffs_size = 0;
+  cv_traj_frame = NULL;
+
   cv_traj_write_labels = true;
+
+  profiling_freq = 0;
 }
 
 
@@ -270,6 +298,10 @@ int colvarmodule::append_new_config(std::string const &new_conf)
 void colvarmodule::config_changed()
 {
   cv_traj_write_labels = true;
+  if (proxy) {
+    // colvars or biases may have been added or deleted
+    proxy->smp_task_graph_reset();
+  }
 }
 
 
@@ -299,9 +331,27 @@ int colvarmodule::parse_global_params(std::string const &conf)
     }
   }
 
-  if (parse->get_keyval(conf, "smp", proxy->b_smp_active, proxy->b_smp_active)) {
-    if (proxy->b_smp_active == false) {
-      cvm::log("SMP parallelism has been disabled.\n");
+  std::string smp_mode;
+  if (parse->get_keyval(conf, "smp", smp_mode, std::string(""))) {
+    int smp_num_threads = 0;
+    parse->get_keyval(conf, "smpThreads", smp_num_threads, smp_num_threads);
+    if (proxy->set_smp_mode(smp_mode, smp_num_threads) == COLVARS_OK) {
+      if (proxy->b_smp_active == false) {
+        cvm::log("SMP parallelism has been disabled.\n");
+      } else if (proxy->get_smp_mode() == colvarproxy_smp::smp_mode_threads) {
+        cvm::log("SMP parallelism will use a pool of "+
+                 cvm::to_str(proxy->smp_num_threads())+" threads.\n");
+      }
+    }
+  }
+
+  if (parse->get_keyval(conf, "smpTaskGraph", proxy->b_smp_task_graph,
+                        proxy->b_smp_task_graph)) {
+    if (proxy->b_smp_task_graph &&
+        (proxy->smp_task_graph_enabled() != COLVARS_OK)) {
+      cvm::log("Warning: the task graph is not available with the current "
+               "SMP settings: colvars and biases will be computed in "
+               "separate loops.\n");
     }
   }
 
@@ -324,6 +374,9 @@ int colvarmodule::parse_global_params(std::string const &conf)
                     colvarmodule::rotation::crossing_threshold,
                     colvarmodule::rotation::crossing_threshold,
                     colvarparse::parse_silent);
+  parse->get_keyval(conf, "optimalRotationQCP",
+                    colvarmodule::rotation::use_qcp,
+                    colvarmodule::rotation::use_qcp);
 
   parse->get_keyval(conf, "colvarsTrajFrequency", cv_traj_freq, cv_traj_freq);
   parse->get_keyval(conf, "colvarsRestartFrequency",
@@ -333,6 +386,73 @@ int colvarmodule::parse_global_params(std::string const &conf)
   parse->get_keyval(conf, "colvarsTrajAppend",
                     cv_traj_append, cv_traj_append, colvarparse::parse_silent);
 
+  std::string traj_format(cv_traj_binary ? "binary" : "text");
+  if (parse->get_keyval(conf, "colvarsTrajFormat", traj_format, traj_format)) {
+    traj_format = colvarparse::to_lower_cppstr(traj_format);
+    if ((traj_format != "text") && (traj_format != "binary")) {
+      return cvm::error("Error: colvarsTrajFormat must be either \"text\" or "
+                        "\"binary\".\n", INPUT_ERROR);
+    }
+    if (cv_traj_binary != (traj_format == "binary")) {
+      // Continue in a new file with the new format
+      close_traj_file();
+      cv_traj_binary = (traj_format == "binary");
+      if (cv_traj_name.size()) {
+        cv_traj_name = traj_file_name(output_prefix());
+      }
+    }
+  }
+
+  parse->get_keyval(conf, "colvarsTrajIndexFile", cv_traj_read_index,
+                    cv_traj_read_index);
+
+  std::string state_format(restart_out_binary ? "binary" : "text");
+  if (parse->get_keyval(conf, "colvarsStateFormat", state_format,
+                        state_format)) {
+    state_format = colvarparse::to_lower_cppstr(state_format);
+    if ((state_format != "text") && (state_format != "binary")) {
+      return cvm::error("Error: colvarsStateFormat must be either \"text\" "
+                        "or \"binary\".\n", INPUT_ERROR);
+    }
+    restart_out_binary = (state_format == "binary");
+  }
+
+  if (parse->get_keyval(conf, "colvarsStateAppendDiffs",
+                        restart_out_append_diffs, restart_out_append_diffs)) {
+    if (restart_out_append_diffs && !restart_out_binary) {
+      return cvm::error("Error: colvarsStateAppendDiffs requires "
+                        "colvarsStateFormat binary.\n", INPUT_ERROR);
+    }
+    restart_out_base_size = 0;
+  }
+
+  {
+    bool async_output = proxy->async_output();
+    int async_buffer_size = 64;
+    bool const b_buffer_size =
+      parse->get_keyval(conf, "asyncOutputBufferSize", async_buffer_size,
+                        async_buffer_size);
+    if (async_buffer_size < 1) {
+      return cvm::error("Error: asyncOutputBufferSize must be positive.\n",
+                        INPUT_ERROR);
+    }
+    // A new buffer size also applies to the files already open
+    if (parse->get_keyval(conf, "asyncOutput", async_output, async_output) ||
+        (b_buffer_size && async_output)) {
+      int const error_code =
+        proxy->set_async_output(async_output,
+                                size_t(async_buffer_size) * 1048576);
+      if (error_code != COLVARS_OK) {
+        return error_code;
+      }
+    }
+  }
+
+  if (parse->get_keyval(conf, "profilingFrequency", profiling_freq,
+                        profiling_freq)) {
+    set_profiling(profiling_freq > 0);
+  }
+
   parse->get_keyval(conf, "scriptedColvarForces",
                     use_scripted_forces, use_scripted_forces);
 
@@ -385,6 +505,7 @@ int colvarmodule::parse_colvars(std::string const &conf)
   if (pos > 0) {
     // One or more new variables were added
     config_changed();
+    setup_shared_atom_groups();
   }
 
   if (!colvars.size()) {
@@ -462,6 +583,9 @@ int colvarmodule::parse_biases(std::string const &conf)
   /// initialize harmonic walls restraints
   parse_biases_type<colvarbias_restraint_harmonic_walls>(conf, "harmonicWalls");
 
+  /// initialize element-wise harmonic walls restraints
+  parse_biases_type<colvarbias_restraint_harmonic_walls_vector>(conf, "harmonicWallsVector");
+
   /// initialize histograms
   parse_biases_type<colvarbias_histogram>(conf, "histogram");
 
@@ -645,6 +769,160 @@ void colvarmodule::unregister_named_atom_group(cvm::atom_group *ag)
 }
 
 
+int colvarmodule::setup_shared_atom_groups()
+{
+  clear_shared_atom_groups();
+
+  std::vector<cvm::atom_group *> groups;
+  for (std::vector<colvar *>::iterator cvi = colvars.begin();
+       cvi != colvars.end();
+       cvi++) {
+    std::vector<cvm::atom_group *> const cv_groups =
+      (*cvi)->get_shareable_atom_groups();
+    groups.insert(groups.end(), cv_groups.begin(), cv_groups.end());
+  }
+
+  size_t num_copies = 0;
+  for (size_t i = 0; i < groups.size(); i++) {
+    if (groups[i]->shared_source != NULL) continue;
+    for (size_t j = i+1; j < groups.size(); j++) {
+      if ((groups[j] == groups[i]) || (groups[j]->shared_source != NULL)) {
+        continue;
+      }
+      if (groups[i]->has_same_coordinates(*(groups[j]))) {
+        if (!groups[i]->b_shared_source) {
+          shared_atom_groups.push_back(groups[i]);
+        }
+        groups[j]->share_data_of(groups[i]);
+        shared_atom_groups.push_back(groups[j]);
+        num_copies++;
+      }
+    }
+  }
+
+  if (num_copies > 0) {
+    cvm::log("Found "+cvm::to_str(num_copies)+" atom groups identical to "
+             "others: their positions, centers and rotations will be "
+             "computed only once.\n");
+  }
+
+  return COLVARS_OK;
+}
+
+
+void colvarmodule::clear_shared_atom_groups()
+{
+  for (std::vector<cvm::atom_group *>::iterator agi = shared_atom_groups.begin();
+       agi != shared_atom_groups.end();
+       agi++) {
+    (*agi)->shared_source = NULL;
+    (*agi)->b_shared_source = false;
+    (*agi)->b_shared_active = false;
+  }
+  shared_atom_groups.clear();
+}
+
+
+void colvarmodule::remove_shared_atom_group(cvm::atom_group *ag)
+{
+  std::vector<cvm::atom_group *>::iterator agi =
+    std::find(shared_atom_groups.begin(), shared_atom_groups.end(), ag);
+  if (agi == shared_atom_groups.end()) return;
+  shared_atom_groups.erase(agi);
+
+  cvm::atom_group *source = ag->shared_source;
+  if (ag->b_shared_source) {
+    // the first remaining copy becomes the source of the others
+    source = NULL;
+    for (agi = shared_atom_groups.begin(); agi != shared_atom_groups.end(); agi++) {
+      if ((*agi)->shared_source != ag) continue;
+      if (source == NULL) {
+        source = *agi;
+        source->shared_source = NULL;
+        source->b_shared_source = true;
+      } else {
+        (*agi)->share_data_of(source);
+      }
+    }
+  }
+  ag->shared_source = NULL;
+  ag->b_shared_source = false;
+  ag->b_shared_active = false;
+
+  if (source == NULL) return;
+
+  // a source left without copies computes its own data again
+  for (agi = shared_atom_groups.begin(); agi != shared_atom_groups.end(); agi++) {
+    if ((*agi)->shared_source == source) return;
+  }
+  source->b_shared_source = false;
+  source->b_shared_active = false;
+  shared_atom_groups.erase(std::find(shared_atom_groups.begin(),
+                                     shared_atom_groups.end(), source));
+}
+
+
+int colvarmodule::calc_shared_atom_groups()
+{
+  for (std::vector<cvm::atom_group *>::iterator agi = shared_atom_groups.begin();
+       agi != shared_atom_groups.end();
+       agi++) {
+    // skip the groups whose components are all inactive in this step
+    if ((*agi)->b_shared_source && (*agi)->b_shared_active) {
+      (*agi)->read_positions();
+      (*agi)->calc_required_properties();
+    }
+  }
+  return cvm::get_error() ? COLVARS_ERROR : COLVARS_OK;
+}
+
+
+int colvarmodule::apply_shared_atom_group_forces()
+{
+  for (std::vector<cvm::atom_group *>::iterator agi = shared_atom_groups.begin();
+       agi != shared_atom_groups.end();
+       agi++) {
+    if ((*agi)->b_shared_source) {
+      (*agi)->apply_shared_forces();
+    }
+  }
+  return cvm::get_error() ? COLVARS_ERROR : COLVARS_OK;
+}
+
+
+namespace {
+  /// Order SMP items by decreasing cost, with unmeasured (negative) costs first
+  struct smp_item_cost_greater {
+    std::vector<cvm::real> const &costs;
+    smp_item_cost_greater(std::vector<cvm::real> const &c) : costs(c) {}
+    bool operator () (size_t i, size_t j) const
+    {
+      if ((costs[i] < 0.0) != (costs[j] < 0.0)) return (costs[i] < 0.0);
+      return costs[i] > costs[j];
+    }
+  };
+}
+
+
+void colvarmodule::sort_variables_active_smp()
+{
+  size_t const n = colvars_smp.size();
+  std::vector<cvm::real> costs(n);
+  std::vector<size_t> order(n);
+  for (size_t i = 0; i < n; i++) {
+    costs[i] = colvars_smp[i]->cvc_cost_estimate(colvars_smp_items[i]);
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), smp_item_cost_greater(costs));
+  std::vector<colvar *> const cvs(colvars_smp);
+  std::vector<int> const items(colvars_smp_items);
+  for (size_t i = 0; i < n; i++) {
+    colvars_smp[i] = cvs[order[i]];
+    colvars_smp_items[i] = items[order[i]];
+  }
+}
+
+
 int colvarmodule::change_configuration(std::string const &bias_name,
                                        std::string const &conf)
 {
@@ -706,15 +984,29 @@ int colvarmodule::calc()
              cvm::to_str(cvm::step_absolute())+"\n");
   }
 
-  error_code |= calc_colvars();
-  error_code |= calc_biases();
+  double t_stage = b_profiling ? wall_time() : 0.0;
+
+  if (use_task_graph()) {
+    error_code |= calc_task_graph();
+    if (b_profiling) t_stage = add_stage_time(profile_calc_task_graph, t_stage);
+  } else {
+    error_code |= calc_colvars();
+    if (b_profiling) t_stage = add_stage_time(profile_calc_colvars, t_stage);
+    error_code |= calc_biases();
+    if (b_profiling) t_stage = add_stage_time(profile_calc_biases, t_stage);
+  }
   error_code |= update_colvar_forces();
+  if (b_profiling) {
+    t_stage = add_stage_time(profile_update_colvar_forces, t_stage);
+  }
 
   error_code |= analyze();
+  if (b_profiling) t_stage = add_stage_time(profile_analyze, t_stage);
 
   // write trajectory files, if needed
   if (cv_traj_freq && cv_traj_name.size()) {
     error_code |= write_traj_files();
+    if (b_profiling) t_stage = add_stage_time(profile_write_traj, t_stage);
   }
 
   // write restart files and similar data
@@ -741,6 +1033,7 @@ int colvarmodule::calc()
       error_code |= (*bi)->write_state_to_replicas();
     }
     cvm::decrease_depth();
+    if (b_profiling) t_stage = add_stage_time(profile_write_restart, t_stage);
   }
 
   // Write output files for biases, at the specified frequency for each
@@ -752,11 +1045,19 @@ int colvarmodule::calc()
       if ((cvm::step_relative() > 0) &&
           ((cvm::step_absolute() % (*bi)->output_freq) == 0) ) {
         error_code |= (*bi)->write_output_files();
+        if (b_profiling) {
+          t_stage = add_stage_time(profile_write_bias_output, t_stage);
+        }
       }
     }
   }
   cvm::decrease_depth();
 
+  if (b_profiling && (profiling_freq > 0) && (cvm::step_relative() > 0) &&
+      ((cvm::step_absolute() % profiling_freq) == 0)) {
+    cvm::log(profile_report());
+  }
+
   error_code |= end_of_step();
 
   // TODO move this to a base-class proxy method that calls this function
@@ -766,12 +1067,8 @@ int colvarmodule::calc()
 }
 
 
-int colvarmodule::calc_colvars()
+int colvarmodule::prepare_colvars()
 {
-  if (cvm::debug())
-    cvm::log("Calculating collective variables.\n");
-  // calculate collective variables and their gradients
-
   // First, we need to decide which biases are awake
   // so they can activate colvars as needed
   std::vector<colvarbias *>::iterator bi;
@@ -804,32 +1101,79 @@ int colvarmodule::calc_colvars()
     }
   }
 
-  // if SMP support is available, split up the work
-  if (proxy->smp_enabled() == COLVARS_OK) {
+  // groups shared by multiple components are computed once, ahead of them,
+  // but only if any of those components is active
+  for (std::vector<cvm::atom_group *>::iterator agi = shared_atom_groups.begin();
+       agi != shared_atom_groups.end();
+       agi++) {
+    (*agi)->b_shared_active = false;
+  }
+  for (cvi = variables_active()->begin(); cvi != variables_active()->end(); cvi++) {
+    error_code |= (*cvi)->update_cvc_flags();
+    (*cvi)->flag_shared_atom_groups();
+  }
+  error_code |= calc_shared_atom_groups();
+
+#if (__cplusplus >= 201103L)
+  // so are sub-components shared by multiple composite components
+  colvar::flag_shared_sub_cvcs(*(variables_active()));
+  error_code |= colvar::calc_shared_sub_cvcs();
+#endif
+
+  return error_code;
+}
 
-    // first, calculate how much work (currently, how many active CVCs) each colvar has
 
-    variables_active_smp()->clear();
-    variables_active_smp_items()->clear();
+int colvarmodule::update_variables_active_smp()
+{
+  int error_code = COLVARS_OK;
+  std::vector<colvar *>::iterator cvi;
 
-    variables_active_smp()->reserve(variables_active()->size());
-    variables_active_smp_items()->reserve(variables_active()->size());
+  // first, calculate how much work (currently, how many active CVCs) each colvar has
 
-    // set up a vector containing all components
-    cvm::increase_depth();
-    for (cvi = variables_active()->begin(); cvi != variables_active()->end(); cvi++) {
+  variables_active_smp()->clear();
+  variables_active_smp_items()->clear();
 
-      error_code |= (*cvi)->update_cvc_flags();
+  variables_active_smp()->reserve(variables_active()->size());
+  variables_active_smp_items()->reserve(variables_active()->size());
 
-      size_t num_items = (*cvi)->num_active_cvcs();
-      variables_active_smp()->reserve(variables_active_smp()->size() + num_items);
-      variables_active_smp_items()->reserve(variables_active_smp_items()->size() + num_items);
-      for (size_t icvc = 0; icvc < num_items; icvc++) {
-        variables_active_smp()->push_back(*cvi);
-        variables_active_smp_items()->push_back(icvc);
-      }
+  // set up a vector containing all components
+  cvm::increase_depth();
+  for (cvi = variables_active()->begin(); cvi != variables_active()->end(); cvi++) {
+
+    error_code |= (*cvi)->update_cvc_flags();
+
+    size_t num_items = (*cvi)->num_active_cvcs();
+    variables_active_smp()->reserve(variables_active_smp()->size() + num_items);
+    variables_active_smp_items()->reserve(variables_active_smp_items()->size() + num_items);
+    for (size_t icvc = 0; icvc < num_items; icvc++) {
+      variables_active_smp()->push_back(*cvi);
+      variables_active_smp_items()->push_back(icvc);
     }
-    cvm::decrease_depth();
+  }
+  cvm::decrease_depth();
+
+  // start from the most expensive components, using their timings from
+  // the previous steps, so that all threads finish at about the same time
+  sort_variables_active_smp();
+
+  return error_code;
+}
+
+
+int colvarmodule::calc_colvars()
+{
+  if (cvm::debug())
+    cvm::log("Calculating collective variables.\n");
+  // calculate collective variables and their gradients
+
+  int error_code = prepare_colvars();
+  std::vector<colvar *>::iterator cvi;
+
+  // if SMP support is available, split up the work
+  if (proxy->smp_enabled() == COLVARS_OK) {
+
+    error_code |= update_variables_active_smp();
 
     // calculate colvar components in parallel
     error_code |= proxy->smp_colvars_loop();
@@ -858,22 +1202,14 @@ int colvarmodule::calc_colvars()
 }
 
 
-int colvarmodule::calc_biases()
+void colvarmodule::prepare_biases()
 {
-  // update the biases and communicate their forces to the collective
-  // variables
-  if (cvm::debug() && num_biases())
-    cvm::log("Updating collective variable biases.\n");
-
   // set biasing forces to zero before biases are calculated and summed over
   for (std::vector<colvar *>::iterator cvi = colvars.begin();
        cvi != colvars.end(); cvi++) {
     (*cvi)->reset_bias_force();
   }
 
-  std::vector<colvarbias *>::iterator bi;
-  int error_code = COLVARS_OK;
-
   // Total bias energy is reset before calling scripted biases
   total_bias_energy = 0.0;
 
@@ -881,11 +1217,26 @@ int colvarmodule::calc_biases()
   // which may have changed based on f_cvb_awake in calc_colvars()
   biases_active()->clear();
   biases_active()->reserve(biases.size());
-  for (bi = biases.begin(); bi != biases.end(); bi++) {
+  for (std::vector<colvarbias *>::iterator bi = biases.begin();
+       bi != biases.end(); bi++) {
     if ((*bi)->is_enabled()) {
       biases_active()->push_back(*bi);
     }
   }
+}
+
+
+int colvarmodule::calc_biases()
+{
+  // update the biases and communicate their forces to the collective
+  // variables
+  if (cvm::debug() && num_biases())
+    cvm::log("Updating collective variable biases.\n");
+
+  std::vector<colvarbias *>::iterator bi;
+  int error_code = COLVARS_OK;
+
+  prepare_biases();
 
   // if SMP support is available, split up the work
   if (proxy->smp_enabled() == COLVARS_OK) {
@@ -906,7 +1257,7 @@ int colvarmodule::calc_biases()
 
     cvm::increase_depth();
     for (bi = biases_active()->begin(); bi != biases_active()->end(); bi++) {
-      error_code |= (*bi)->update();
+      error_code |= update_bias(*bi);
       if (cvm::get_error()) {
         return error_code;
       }
@@ -922,6 +1273,66 @@ int colvarmodule::calc_biases()
 }
 
 
+bool colvarmodule::use_task_graph()
+{
+  if (proxy->smp_task_graph_enabled() != COLVARS_OK) {
+    return false;
+  }
+  // Scripted functions are evaluated by the interpreter of the main thread
+  // while collecting the components of their colvars
+  for (std::vector<colvar *>::iterator cvi = colvars.begin();
+       cvi != colvars.end(); cvi++) {
+    if ((*cvi)->is_enabled(colvardeps::f_cv_scripted)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+int colvarmodule::calc_task_graph()
+{
+  if (cvm::debug()) {
+    cvm::log("Calculating collective variables and biases as a task graph.\n");
+  }
+
+  int error_code = prepare_colvars();
+  error_code |= update_variables_active_smp();
+  prepare_biases();
+
+  // components, colvars and biases, each as soon as what it needs is done
+  error_code |= proxy->smp_task_graph_loop();
+  if (cvm::get_error()) {
+    return COLVARS_ERROR;
+  }
+
+  // scripted forces do not depend on the biases, and must be run by the
+  // main thread
+  if (use_scripted_forces && !scripting_after_biases) {
+    error_code |= calc_scripted_forces();
+  }
+
+  for (std::vector<colvarbias *>::iterator bi = biases_active()->begin();
+       bi != biases_active()->end(); bi++) {
+    total_bias_energy += (*bi)->get_energy();
+  }
+
+  return (cvm::get_error() ? COLVARS_ERROR : error_code);
+}
+
+
+int colvarmodule::update_bias(colvarbias *b)
+{
+  if (!b_profiling) {
+    return b->update();
+  }
+  double const t_start = wall_time();
+  int const error_code = b->update();
+  b->profile.add(wall_time() - t_start);
+  return error_code;
+}
+
+
 int colvarmodule::update_colvar_forces()
 {
   int error_code = COLVARS_OK;
@@ -934,7 +1345,9 @@ int colvarmodule::update_colvar_forces()
     cvm::log("Collecting forces from all biases.\n");
   cvm::increase_depth();
   for (bi = biases_active()->begin(); bi != biases_active()->end(); bi++) {
+    double const t_start = b_profiling ? wall_time() : 0.0;
     (*bi)->communicate_forces();
+    if (b_profiling) (*bi)->profile.add(wall_time() - t_start, 0);
     if (cvm::get_error()) {
       return COLVARS_ERROR;
     }
@@ -977,69 +1390,245 @@ int colvarmodule::update_colvar_forces()
   cvm::increase_depth();
   for (cvi = variables_active()->begin(); cvi != variables_active()->end(); cvi++) {
     if ((*cvi)->is_enabled(colvardeps::f_cv_gradient)) {
+      double const t_start = b_profiling ? wall_time() : 0.0;
       (*cvi)->communicate_forces();
+      if (b_profiling) (*cvi)->profile.add(wall_time() - t_start, 0);
       if (cvm::get_error()) {
         return COLVARS_ERROR;
       }
     }
   }
+#if (__cplusplus >= 201103L)
+  // shared sub-components apply the forces of all their consumers at once
+  if (colvar::apply_shared_sub_cvc_forces() != COLVARS_OK) {
+    return COLVARS_ERROR;
+  }
+#endif
+  // so do atom groups shared by multiple components
+  if (apply_shared_atom_group_forces() != COLVARS_OK) {
+    return COLVARS_ERROR;
+  }
   cvm::decrease_depth();
 
   return (cvm::get_error() ? COLVARS_ERROR : COLVARS_OK);
 }
 
 
-int colvarmodule::calc_scripted_forces()
+double colvarmodule::wall_time()
 {
-  // Run user force script, if provided,
-  // potentially adding scripted forces to the colvars
-  int res;
-  res = proxy->run_force_callback();
-  if (res == COLVARS_NOT_IMPLEMENTED) {
-    cvm::error("Colvar forces scripts are not implemented.");
-    return COLVARS_NOT_IMPLEMENTED;
-  }
-  if (res != COLVARS_OK) {
-    cvm::error("Error running user colvar forces script");
-    return COLVARS_ERROR;
-  }
-  return COLVARS_OK;
+#if (__cplusplus >= 201103L)
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#elif defined(_OPENMP)
+  return omp_get_wtime();
+#else
+  return double(std::clock()) / double(CLOCKS_PER_SEC);
+#endif
 }
 
 
-int colvarmodule::write_restart_file(std::string const &out_name)
+void colvarmodule::set_profiling(bool on)
 {
-  cvm::log("Saving collective variables state to \""+out_name+"\".\n");
-  proxy->backup_file(out_name);
-  std::ostream *restart_out_os = proxy->output_stream(out_name);
-  if (!restart_out_os) return cvm::get_error();
-  if (!write_restart(*restart_out_os)) {
-    return cvm::error("Error: in writing restart file.\n", FILE_ERROR);
-  }
-  proxy->close_output_stream(out_name);
-  if (cv_traj_os != NULL) {
-    // Take the opportunity to flush colvars.traj
-    proxy->flush_output_stream(cv_traj_os);
-  }
-  return (cvm::get_error() ? COLVARS_ERROR : COLVARS_OK);
+  b_profiling = on;
 }
 
 
-int colvarmodule::write_restart_string(std::string &output)
+void colvarmodule::reset_profile()
 {
-  cvm::log("Saving state to output buffer.\n");
-  std::ostringstream os;
-  if (!write_restart(os)) {
-    return cvm::error("Error: in writing restart to buffer.\n", FILE_ERROR);
+  for (size_t i = 0; i < profile_num_stages; i++) {
+    stage_profiles[i].reset();
+  }
+  for (std::vector<colvar *>::iterator cvi = colvars.begin();
+       cvi != colvars.end();
+       cvi++) {
+    (*cvi)->reset_profile();
+  }
+  for (std::vector<colvarbias *>::iterator bi = biases.begin();
+       bi != biases.end();
+       bi++) {
+    (*bi)->profile.reset();
   }
-  output = os.str();
-  return COLVARS_OK;
 }
 
 
-int colvarmodule::write_traj_files()
+double colvarmodule::add_stage_time(profile_stage stage, double t_start)
 {
-  if (cvm::debug()) {
+  double const t_now = wall_time();
+  stage_profiles[stage].add(t_now - t_start);
+  return t_now;
+}
+
+
+std::string colvarmodule::profile_counter::report(std::string const &label)
+  const
+{
+  std::ostringstream os;
+  os << "  " << std::left << std::setw(40) << label << std::right
+     << " " << std::setw(12) << std::fixed << std::setprecision(6)
+     << total_time
+     << " " << std::setw(10) << num_calls
+     << " " << std::setw(12) << std::setprecision(6)
+     << ((num_calls > 0) ? 1000.0 * total_time / double(num_calls) : 0.0)
+     << "\n";
+  return os.str();
+}
+
+
+std::string colvarmodule::profile_report() const
+{
+  static char const * const stage_names[profile_num_stages] = {
+    "calc_colvars",
+    "calc_biases",
+    "calc_task_graph",
+    "update_colvar_forces",
+    "analyze",
+    "write_traj",
+    "write_restart",
+    "write_bias_output"
+  };
+
+  std::ostringstream os;
+  os << "Profiling report at step " << it << ":\n"
+     << "  " << std::left << std::setw(40) << "task" << std::right
+     << " " << std::setw(12) << "time (s)"
+     << " " << std::setw(10) << "calls"
+     << " " << std::setw(12) << "ms/call" << "\n";
+  for (size_t i = 0; i < profile_num_stages; i++) {
+    os << stage_profiles[i].report(stage_names[i]);
+  }
+  for (std::vector<colvar *>::const_iterator cvi = colvars.begin();
+       cvi != colvars.end();
+       cvi++) {
+    os << (*cvi)->profile_report();
+  }
+  for (std::vector<colvarbias *>::const_iterator bi = biases.begin();
+       bi != biases.end();
+       bi++) {
+    os << (*bi)->profile.report((*bi)->bias_type+" \""+(*bi)->name+"\"");
+  }
+  return os.str();
+}
+
+
+int colvarmodule::calc_scripted_forces()
+{
+  // Run user force script, if provided,
+  // potentially adding scripted forces to the colvars
+  int res;
+  res = proxy->run_force_callback();
+  if (res == COLVARS_NOT_IMPLEMENTED) {
+    cvm::error("Colvar forces scripts are not implemented.");
+    return COLVARS_NOT_IMPLEMENTED;
+  }
+  if (res != COLVARS_OK) {
+    cvm::error("Error running user colvar forces script");
+    return COLVARS_ERROR;
+  }
+  return COLVARS_OK;
+}
+
+
+int colvarmodule::write_restart_file(std::string const &out_name)
+{
+  cvm::log("Saving collective variables state to \""+out_name+"\".\n");
+
+  if (restart_out_binary) {
+
+    std::vector<std::string> keys, names, payloads;
+    write_restart_sections(keys, names, payloads);
+
+    // Differences are only appended to the periodic restart file; other
+    // state files (e.g. the final one, or "cv save") are written in full
+    bool const append_diffs = restart_out_append_diffs &&
+      (out_name == restart_out_name);
+    if (restart_out_append_diffs && !append_diffs) {
+      cvm::log("Note: writing the full state to \""+out_name+"\", because "
+               "colvarsStateAppendDiffs only applies to the periodic restart "
+               "file.\n");
+    }
+    bool appended = false;
+
+    if (append_diffs && (restart_out_base_size > 0) &&
+        (restart_out_diffs_size < restart_out_base_size)) {
+      // Append the changes if the file is still the one last written
+      proxy->drain_output_streams();
+      std::ifstream check_is(out_name.c_str(), std::ios::binary);
+      check_is.seekg(0, std::ios::end);
+      if (check_is.is_open() &&
+          (size_t(check_is.tellg()) ==
+           restart_out_base_size + restart_out_diffs_size)) {
+        check_is.close();
+        std::ostream *restart_out_os =
+          proxy->output_stream(out_name, std::ios::out | std::ios::app |
+                               std::ios::binary);
+        if (!restart_out_os) return cvm::get_error();
+        restart_out_diffs_size +=
+          write_restart_diff(*restart_out_os, keys, names, payloads);
+        if (!*restart_out_os) {
+          return cvm::error("Error: in writing restart file.\n", FILE_ERROR);
+        }
+        proxy->close_output_stream(out_name);
+        appended = true;
+      }
+    }
+
+    if (!appended) {
+      // Write the full state (this also compacts previous differences)
+      proxy->backup_file(out_name);
+      std::ostream *restart_out_os =
+        proxy->output_stream(out_name, std::ios::out | std::ios::binary);
+      if (!restart_out_os) return cvm::get_error();
+      size_t file_size = 0;
+      if (write_restart_binary(*restart_out_os, keys, names, payloads,
+                               file_size) != COLVARS_OK) {
+        return cvm::get_error();
+      }
+      proxy->close_output_stream(out_name);
+      restart_out_base_size = append_diffs ? file_size : 0;
+      restart_out_diffs_size = 0;
+    }
+
+    if (append_diffs) {
+      // Keep the sections as the reference for the next differences
+      restart_out_keys.swap(keys);
+      restart_out_names.swap(names);
+      restart_out_payloads.swap(payloads);
+    }
+
+  } else {
+
+    proxy->backup_file(out_name);
+    std::ostream *restart_out_os = proxy->output_stream(out_name);
+    if (!restart_out_os) return cvm::get_error();
+    if (!write_restart(*restart_out_os)) {
+      return cvm::error("Error: in writing restart file.\n", FILE_ERROR);
+    }
+    proxy->close_output_stream(out_name);
+  }
+
+  if (cv_traj_os != NULL) {
+    // Take the opportunity to flush colvars.traj
+    proxy->flush_output_stream(cv_traj_os);
+  }
+  return (cvm::get_error() ? COLVARS_ERROR : COLVARS_OK);
+}
+
+
+int colvarmodule::write_restart_string(std::string &output)
+{
+  cvm::log("Saving state to output buffer.\n");
+  std::ostringstream os;
+  if (!write_restart(os)) {
+    return cvm::error("Error: in writing restart to buffer.\n", FILE_ERROR);
+  }
+  output = os.str();
+  return COLVARS_OK;
+}
+
+
+int colvarmodule::write_traj_files()
+{
+  if (cvm::debug()) {
     cvm::log("colvarmodule::write_traj_files()\n");
   }
 
@@ -1051,16 +1640,30 @@ int colvarmodule::write_traj_files()
     }
   }
 
-  // write labels in the traj file every 1000 lines and at first timestep
-  if ((cvm::step_absolute() % (cv_traj_freq * 1000)) == 0 ||
-      cvm::step_relative() == 0 ||
-      cv_traj_write_labels) {
-    write_traj_label(*cv_traj_os);
-  }
-  cv_traj_write_labels = false;
+  if (cv_traj_binary) {
 
-  if ((cvm::step_absolute() % cv_traj_freq) == 0) {
-    write_traj(*cv_traj_os);
+    // describe the columns at the first record and after they change
+    if (cvm::step_relative() == 0) {
+      cv_traj_write_labels = true;
+    }
+    if ((cvm::step_absolute() % cv_traj_freq) == 0) {
+      write_traj_binary(*cv_traj_os, cv_traj_write_labels);
+      cv_traj_write_labels = false;
+    }
+
+  } else {
+
+    // write labels in the traj file every 1000 lines and at first timestep
+    if ((cvm::step_absolute() % (cv_traj_freq * 1000)) == 0 ||
+        cvm::step_relative() == 0 ||
+        cv_traj_write_labels) {
+      write_traj_label(*cv_traj_os);
+    }
+    cv_traj_write_labels = false;
+
+    if ((cvm::step_absolute() % cv_traj_freq) == 0) {
+      write_traj(*cv_traj_os);
+    }
   }
 
   if (restart_out_freq && (cv_traj_os != NULL) &&
@@ -1136,10 +1739,38 @@ int colvarmodule::setup()
        cvi != variables()->end();  cvi++) {
     (*cvi)->setup();
   }
+  setup_shared_sub_cvcs();
+  return (cvm::get_error() ? COLVARS_ERROR : COLVARS_OK);
+}
+
+
+int colvarmodule::setup_shared_sub_cvcs()
+{
+  // loop over the shared sub-components to update masses and charges of
+  // their groups (those of all other components are updated by colvar::setup())
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    std::vector<cvm::atom_group *> &groups =
+      shared_sub_cvcs[i]->sub_cvc->atom_groups;
+    for (size_t ig = 0; ig < groups.size(); ig++) {
+      groups[ig]->setup();
+      groups[ig]->read_positions();
+    }
+  }
   return (cvm::get_error() ? COLVARS_ERROR : COLVARS_OK);
 }
 
 
+void colvarmodule::clear_shared_sub_cvcs()
+{
+  // normally empty, because each consumer releases its sub-components
+  for (size_t i = 0; i < shared_sub_cvcs.size(); i++) {
+    delete shared_sub_cvcs[i]->sub_cvc;
+    delete shared_sub_cvcs[i];
+  }
+  shared_sub_cvcs.clear();
+}
+
+
 colvarmodule::~colvarmodule()
 {
   if ((proxy->smp_thread_id() == COLVARS_NOT_IMPLEMENTED) ||
@@ -1155,6 +1786,8 @@ colvarmodule::~colvarmodule()
 
     delete parse;
     parse = NULL;
+    delete cv_traj_frame;
+    cv_traj_frame = NULL;
     proxy = NULL;
   }
 }
@@ -1183,6 +1816,8 @@ int colvarmodule::reset()
   }
   colvars.clear();
 
+  clear_shared_sub_cvcs();
+
   reset_index_groups();
 
   proxy->flush_output_streams();
@@ -1216,7 +1851,13 @@ int colvarmodule::setup_input()
     } else {
       cvm::log(cvm::line_marker);
       cvm::log("Loading state from file \""+restart_in_name+"\".\n");
-      read_restart(input_is);
+      if (is_binary_state(input_is)) {
+        input_is.close();
+        input_is.open(restart_in_name.c_str(), std::ios::binary);
+        read_restart_binary(input_is);
+      } else {
+        read_restart(input_is);
+      }
       cvm::log(cvm::line_marker);
       return cvm::get_error();
     }
@@ -1245,6 +1886,15 @@ int colvarmodule::setup_input()
 }
 
 
+std::string colvarmodule::traj_file_name(std::string const &prefix) const
+{
+  if (prefix.size() == 0) {
+    return std::string("");
+  }
+  return prefix+(cv_traj_binary ? ".colvars.traj.bin" : ".colvars.traj");
+}
+
+
 int colvarmodule::setup_output()
 {
   int error_code = COLVARS_OK;
@@ -1254,6 +1904,9 @@ int colvarmodule::setup_output()
     std::string(proxy->restart_output_prefix()+".colvars.state") :
     std::string("");
 
+  // The next restart file will be written in full
+  restart_out_base_size = 0;
+
   if (restart_out_name.size()) {
     cvm::log("The restart output state file will be \""+
              restart_out_name+"\".\n");
@@ -1268,10 +1921,7 @@ int colvarmodule::setup_output()
     // cvm::log (cvm::line_marker);
   }
 
-  cv_traj_name =
-    (output_prefix().size() ?
-     std::string(output_prefix()+".colvars.traj") :
-     std::string(""));
+  cv_traj_name = traj_file_name(output_prefix());
 
   if (cv_traj_freq && cv_traj_name.size()) {
     error_code |= open_traj_file(cv_traj_name);
@@ -1307,61 +1957,68 @@ std::string colvarmodule::state_file_prefix(char const *filename)
 
 std::istream & colvarmodule::read_restart(std::istream &is)
 {
-  bool warn_total_forces = false;
-
   {
     // read global restart information
     std::string restart_conf;
     if (is >> colvarparse::read_block("configuration", &restart_conf)) {
+      read_restart_configuration(restart_conf);
+    } else {
+      parse->clear_keyword_registry();
+    }
+    is.clear();
+  }
 
-      parse->get_keyval(restart_conf, "step",
-                        it_restart, static_cast<step_number>(0),
-                        colvarparse::parse_restart);
-      it = it_restart;
-
-      std::string restart_version;
-      int restart_version_int = 0;
-      parse->get_keyval(restart_conf, "version",
-                        restart_version, std::string(""),
-                        colvarparse::parse_restart);
-      if (restart_version.size()) {
-        if (restart_version != std::string(COLVARS_VERSION)) {
-          cvm::log("This state file was generated with version "+
-                   restart_version+"\n");
-        }
-        restart_version_int =
-          proxy->get_version_from_string(restart_version.c_str());
-      }
+  read_objects_state(is);
 
-      if (restart_version_int < 20160810) {
-        // check for total force change
-        if (proxy->total_forces_enabled()) {
-          warn_total_forces = true;
-        }
-      }
+  return is;
+}
 
-      std::string units_restart;
-      if (parse->get_keyval(restart_conf, "units",
-                            units_restart, std::string(""),
-                            colvarparse::parse_restart)) {
-        units_restart = colvarparse::to_lower_cppstr(units_restart);
-        if ((proxy->units.size() > 0) && (units_restart != proxy->units)) {
-          cvm::error("Error: the state file has units \""+units_restart+
-                     "\", but the current unit system is \""+proxy->units+
-                     "\".\n", INPUT_ERROR);
-        }
-      }
 
+int colvarmodule::read_restart_configuration(std::string const &restart_conf)
+{
+  bool warn_total_forces = false;
+
+  parse->get_keyval(restart_conf, "step",
+                    it_restart, static_cast<step_number>(0),
+                    colvarparse::parse_restart);
+  it = it_restart;
+
+  std::string restart_version;
+  int restart_version_int = 0;
+  parse->get_keyval(restart_conf, "version",
+                    restart_version, std::string(""),
+                    colvarparse::parse_restart);
+  if (restart_version.size()) {
+    if (restart_version != std::string(COLVARS_VERSION)) {
+      cvm::log("This state file was generated with version "+
+               restart_version+"\n");
     }
-    is.clear();
-    parse->clear_keyword_registry();
+    restart_version_int =
+      proxy->get_version_from_string(restart_version.c_str());
   }
 
-  print_total_forces_errning(warn_total_forces);
+  if (restart_version_int < 20160810) {
+    // check for total force change
+    if (proxy->total_forces_enabled()) {
+      warn_total_forces = true;
+    }
+  }
 
-  read_objects_state(is);
+  std::string units_restart;
+  if (parse->get_keyval(restart_conf, "units",
+                        units_restart, std::string(""),
+                        colvarparse::parse_restart)) {
+    units_restart = colvarparse::to_lower_cppstr(units_restart);
+    if ((proxy->units.size() > 0) && (units_restart != proxy->units)) {
+      cvm::error("Error: the state file has units \""+units_restart+
+                 "\", but the current unit system is \""+proxy->units+
+                 "\".\n", INPUT_ERROR);
+    }
+  }
 
-  return is;
+  parse->clear_keyword_registry();
+
+  return print_total_forces_errning(warn_total_forces);
 }
 
 
@@ -1487,70 +2144,54 @@ int colvarmodule::read_traj(char const *traj_filename,
 {
   cvm::log("Opening trajectory file \""+
            std::string(traj_filename)+"\".\n");
-  std::ifstream traj_is(traj_filename);
 
-  while (true) {
-    while (true) {
-
-      std::string line("");
-
-      do {
-        if (!colvarparse::getline_nocomments(traj_is, line)) {
-          cvm::log("End of file \""+std::string(traj_filename)+
-                   "\" reached, or corrupted file.\n");
-          traj_is.close();
-          return false;
-        }
-      } while (line.find_first_not_of(colvarparse::white_space) == std::string::npos);
-
-      std::istringstream is(line);
-
-      if (!(is >> it)) return false;
-
-      if ( (it < traj_read_begin) ) {
+  colvartraj_reader reader;
+  int error_code = reader.open(traj_filename, cv_traj_read_index);
+  if (error_code != COLVARS_OK) {
+    return error_code;
+  }
 
-        if ((it % 1000) == 0)
-          std::cerr << "Skipping trajectory step " << it
-                    << "                    \r";
+  colvartraj_frame frame;
+  // Number of column groups of the previous frame: missing columns are
+  // reported at the first frame and whenever the columns change
+  size_t num_groups = 0;
 
-        continue;
+  for (size_t i = reader.find_step(traj_read_begin); i < reader.num_frames();
+       i++) {
 
-      } else {
+    it = reader.frame_step(i);
 
-        if ((it % 1000) == 0)
-          std::cerr << "Reading from trajectory, step = " << it
-                    << "                    \r";
-
-        if ( (traj_read_end > traj_read_begin) &&
-             (it > traj_read_end) ) {
-          std::cerr << "\n";
-          cvm::error("Reached the end of the trajectory, "
-                     "read_end = "+cvm::to_str(traj_read_end)+"\n",
-                     FILE_ERROR);
-          return COLVARS_ERROR;
-        }
+    if ((traj_read_end > traj_read_begin) && (it > traj_read_end)) {
+      return cvm::error("Reached the end of the trajectory, "
+                        "read_end = "+cvm::to_str(traj_read_end)+"\n",
+                        FILE_ERROR);
+    }
 
-        for (std::vector<colvar *>::iterator cvi = colvars.begin();
-             cvi != colvars.end();
-             cvi++) {
-          if (!(*cvi)->read_traj(is)) {
-            cvm::error("Error: in reading colvar \""+(*cvi)->name+
-                       "\" from trajectory file \""+
-                       std::string(traj_filename)+"\".\n",
-                       FILE_ERROR);
-            return COLVARS_ERROR;
-          }
-        }
+    error_code = reader.read_frame(i, frame);
+    if (error_code != COLVARS_OK) {
+      return error_code;
+    }
+    bool const warn_missing = (num_groups != frame.groups().size());
+    num_groups = frame.groups().size();
 
-        break;
+    for (std::vector<colvar *>::iterator cvi = colvars.begin();
+         cvi != colvars.end();
+         cvi++) {
+      if ((*cvi)->read_traj(frame, warn_missing) != COLVARS_OK) {
+        return cvm::error("Error: in reading colvar \""+(*cvi)->name+
+                          "\" from trajectory file \""+
+                          std::string(traj_filename)+"\".\n",
+                          FILE_ERROR);
       }
     }
   }
+
+  cvm::log("End of file \""+std::string(traj_filename)+"\" reached.\n");
   return (cvm::get_error() ? COLVARS_ERROR : COLVARS_OK);
 }
 
 
-std::ostream & colvarmodule::write_restart(std::ostream &os)
+std::ostream & colvarmodule::write_restart_configuration(std::ostream &os)
 {
   os.setf(std::ios::scientific, std::ios::floatfield);
   os << "configuration {\n"
@@ -1562,6 +2203,13 @@ std::ostream & colvarmodule::write_restart(std::ostream &os)
     os << "  units " << proxy->units << "\n";
   }
   os << "}\n\n";
+  return os;
+}
+
+
+std::ostream & colvarmodule::write_restart(std::ostream &os)
+{
+  write_restart_configuration(os);
 
   int error_code = COLVARS_OK;
 
@@ -1588,20 +2236,587 @@ std::ostream & colvarmodule::write_restart(std::ostream &os)
 }
 
 
+char const colvarmodule::binary_state_magic[9] = "CVSTATB\n";
+
+unsigned int const colvarmodule::binary_state_version = 1;
+
+
+bool colvarmodule::is_binary_state(std::istream &is)
+{
+  char buffer[8];
+  std::streampos const start_pos = is.tellg();
+  is.read(buffer, 8);
+  bool const result = is.good() &&
+    (std::memcmp(buffer, binary_state_magic, 8) == 0);
+  is.clear();
+  is.seekg(start_pos, std::ios::beg);
+  return result;
+}
+
+
+int colvarmodule::binary_state_flag()
+{
+  static int const index = std::ios_base::xalloc();
+  return index;
+}
+
+
+namespace {
+
+  /// \brief Table of the CRC-32 checksum (polynomial 0xEDB88320), constant
+  /// so that checksum() can be called by multiple threads
+  unsigned int const crc32_table[256] = {
+    0x00000000U, 0x77073096U, 0xEE0E612CU, 0x990951BAU,
+    0x076DC419U, 0x706AF48FU, 0xE963A535U, 0x9E6495A3U,
+    0x0EDB8832U, 0x79DCB8A4U, 0xE0D5E91EU, 0x97D2D988U,
+    0x09B64C2BU, 0x7EB17CBDU, 0xE7B82D07U, 0x90BF1D91U,
+    0x1DB71064U, 0x6AB020F2U, 0xF3B97148U, 0x84BE41DEU,
+    0x1ADAD47DU, 0x6DDDE4EBU, 0xF4D4B551U, 0x83D385C7U,
+    0x136C9856U, 0x646BA8C0U, 0xFD62F97AU, 0x8A65C9ECU,
+    0x14015C4FU, 0x63066CD9U, 0xFA0F3D63U, 0x8D080DF5U,
+    0x3B6E20C8U, 0x4C69105EU, 0xD56041E4U, 0xA2677172U,
+    0x3C03E4D1U, 0x4B04D447U, 0xD20D85FDU, 0xA50AB56BU,
+    0x35B5A8FAU, 0x42B2986CU, 0xDBBBC9D6U, 0xACBCF940U,
+    0x32D86CE3U, 0x45DF5C75U, 0xDCD60DCFU, 0xABD13D59U,
+    0x26D930ACU, 0x51DE003AU, 0xC8D75180U, 0xBFD06116U,
+    0x21B4F4B5U, 0x56B3C423U, 0xCFBA9599U, 0xB8BDA50FU,
+    0x2802B89EU, 0x5F058808U, 0xC60CD9B2U, 0xB10BE924U,
+    0x2F6F7C87U, 0x58684C11U, 0xC1611DABU, 0xB6662D3DU,
+    0x76DC4190U, 0x01DB7106U, 0x98D220BCU, 0xEFD5102AU,
+    0x71B18589U, 0x06B6B51FU, 0x9FBFE4A5U, 0xE8B8D433U,
+    0x7807C9A2U, 0x0F00F934U, 0x9609A88EU, 0xE10E9818U,
+    0x7F6A0DBBU, 0x086D3D2DU, 0x91646C97U, 0xE6635C01U,
+    0x6B6B51F4U, 0x1C6C6162U, 0x856530D8U, 0xF262004EU,
+    0x6C0695EDU, 0x1B01A57BU, 0x8208F4C1U, 0xF50FC457U,
+    0x65B0D9C6U, 0x12B7E950U, 0x8BBEB8EAU, 0xFCB9887CU,
+    0x62DD1DDFU, 0x15DA2D49U, 0x8CD37CF3U, 0xFBD44C65U,
+    0x4DB26158U, 0x3AB551CEU, 0xA3BC0074U, 0xD4BB30E2U,
+    0x4ADFA541U, 0x3DD895D7U, 0xA4D1C46DU, 0xD3D6F4FBU,
+    0x4369E96AU, 0x346ED9FCU, 0xAD678846U, 0xDA60B8D0U,
+    0x44042D73U, 0x33031DE5U, 0xAA0A4C5FU, 0xDD0D7CC9U,
+    0x5005713CU, 0x270241AAU, 0xBE0B1010U, 0xC90C2086U,
+    0x5768B525U, 0x206F85B3U, 0xB966D409U, 0xCE61E49FU,
+    0x5EDEF90EU, 0x29D9C998U, 0xB0D09822U, 0xC7D7A8B4U,
+    0x59B33D17U, 0x2EB40D81U, 0xB7BD5C3BU, 0xC0BA6CADU,
+    0xEDB88320U, 0x9ABFB3B6U, 0x03B6E20CU, 0x74B1D29AU,
+    0xEAD54739U, 0x9DD277AFU, 0x04DB2615U, 0x73DC1683U,
+    0xE3630B12U, 0x94643B84U, 0x0D6D6A3EU, 0x7A6A5AA8U,
+    0xE40ECF0BU, 0x9309FF9DU, 0x0A00AE27U, 0x7D079EB1U,
+    0xF00F9344U, 0x8708A3D2U, 0x1E01F268U, 0x6906C2FEU,
+    0xF762575DU, 0x806567CBU, 0x196C3671U, 0x6E6B06E7U,
+    0xFED41B76U, 0x89D32BE0U, 0x10DA7A5AU, 0x67DD4ACCU,
+    0xF9B9DF6FU, 0x8EBEEFF9U, 0x17B7BE43U, 0x60B08ED5U,
+    0xD6D6A3E8U, 0xA1D1937EU, 0x38D8C2C4U, 0x4FDFF252U,
+    0xD1BB67F1U, 0xA6BC5767U, 0x3FB506DDU, 0x48B2364BU,
+    0xD80D2BDAU, 0xAF0A1B4CU, 0x36034AF6U, 0x41047A60U,
+    0xDF60EFC3U, 0xA867DF55U, 0x316E8EEFU, 0x4669BE79U,
+    0xCB61B38CU, 0xBC66831AU, 0x256FD2A0U, 0x5268E236U,
+    0xCC0C7795U, 0xBB0B4703U, 0x220216B9U, 0x5505262FU,
+    0xC5BA3BBEU, 0xB2BD0B28U, 0x2BB45A92U, 0x5CB36A04U,
+    0xC2D7FFA7U, 0xB5D0CF31U, 0x2CD99E8BU, 0x5BDEAE1DU,
+    0x9B64C2B0U, 0xEC63F226U, 0x756AA39CU, 0x026D930AU,
+    0x9C0906A9U, 0xEB0E363FU, 0x72076785U, 0x05005713U,
+    0x95BF4A82U, 0xE2B87A14U, 0x7BB12BAEU, 0x0CB61B38U,
+    0x92D28E9BU, 0xE5D5BE0DU, 0x7CDCEFB7U, 0x0BDBDF21U,
+    0x86D3D2D4U, 0xF1D4E242U, 0x68DDB3F8U, 0x1FDA836EU,
+    0x81BE16CDU, 0xF6B9265BU, 0x6FB077E1U, 0x18B74777U,
+    0x88085AE6U, 0xFF0F6A70U, 0x66063BCAU, 0x11010B5CU,
+    0x8F659EFFU, 0xF862AE69U, 0x616BFFD3U, 0x166CCF45U,
+    0xA00AE278U, 0xD70DD2EEU, 0x4E048354U, 0x3903B3C2U,
+    0xA7672661U, 0xD06016F7U, 0x4969474DU, 0x3E6E77DBU,
+    0xAED16A4AU, 0xD9D65ADCU, 0x40DF0B66U, 0x37D83BF0U,
+    0xA9BCAE53U, 0xDEBB9EC5U, 0x47B2CF7FU, 0x30B5FFE9U,
+    0xBDBDF21CU, 0xCABAC28AU, 0x53B39330U, 0x24B4A3A6U,
+    0xBAD03605U, 0xCDD70693U, 0x54DE5729U, 0x23D967BFU,
+    0xB3667A2EU, 0xC4614AB8U, 0x5D681B02U, 0x2A6F2B94U,
+    0xB40BBE37U, 0xC30C8EA1U, 0x5A05DF1BU, 0x2D02EF8DU
+  };
+}
+
+
+unsigned int colvarmodule::checksum(char const *data, size_t size)
+{
+  unsigned int crc = 0xFFFFFFFFU;
+  for (size_t i = 0; i < size; i++) {
+    crc = crc32_table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFFU] ^
+      (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFU;
+}
+
+
+namespace {
+
+  /// Section of a binary restart file, as listed in its table of contents
+  struct state_section {
+    /// Keyword of the object ("configuration", "colvar" or the state keyword
+    /// of a bias)
+    std::string key;
+    /// Name of the object
+    std::string name;
+    /// Position of the section in the file
+    cvm::step_number offset;
+    /// Size of the section
+    cvm::step_number size;
+    /// Checksum of the section
+    unsigned int checksum;
+  };
+
+  /// Identifier at the beginning of each difference segment
+  char const state_diff_magic[9] = "CVSTATD\n";
+
+  /// Size of the blocks compared and written by difference segments
+  size_t const state_diff_block_size = 4096;
+
+  void write_toc_string(std::ostream &os, std::string const &s)
+  {
+    unsigned int const length = s.size();
+    os.write(reinterpret_cast<char const *>(&length), sizeof(length));
+    os.write(s.c_str(), length);
+  }
+
+  bool read_toc_string(std::istream &is, std::string &s)
+  {
+    unsigned int length = 0;
+    if (!is.read(reinterpret_cast<char *>(&length), sizeof(length)) ||
+        (length > 65536)) {
+      return false;
+    }
+    s.resize(length);
+    return (length == 0) || is.read(&(s[0]), length);
+  }
+
+  /// Index of the object with the given key and name, or -1
+  int find_state_object(std::vector<std::string> const &keys,
+                        std::vector<std::string> const &names,
+                        std::string const &key, std::string const &name)
+  {
+    for (size_t i = 0; i < keys.size(); i++) {
+      if ((keys[i] == key) && (names[i] == name)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  /// Read the contents of a section, checking their integrity
+  int read_state_section(std::istream &is, state_section const &s,
+                         std::string &payload)
+  {
+    payload.resize(s.size);
+    is.clear();
+    is.seekg(s.offset, std::ios::beg);
+    if ((s.size > 0) &&
+        (!is.read(&(payload[0]), payload.size()) ||
+         (cvm::checksum(payload.data(), payload.size()) != s.checksum))) {
+      return cvm::error("Error: the section of \""+s.name+"\" ("+s.key+
+                        ") in the binary state file is corrupt or "
+                        "truncated.\n", INPUT_ERROR);
+    }
+    return COLVARS_OK;
+  }
+
+  /// \brief Apply the changes of a difference segment (without its
+  /// magic string, length and checksum) to the objects whose keys and
+  /// names are listed; changes to other objects are skipped
+  int apply_state_diff(std::string const &body,
+                        std::vector<std::string> const &keys,
+                        std::vector<std::string> const &names,
+                        std::vector<std::string> &payloads,
+                        std::vector<bool> &found)
+  {
+    std::istringstream is(body);
+    unsigned int num_entries = 0;
+    is.read(reinterpret_cast<char *>(&num_entries), sizeof(num_entries));
+    for (unsigned int ie = 0; is && (ie < num_entries); ie++) {
+      std::string key, name;
+      cvm::step_number new_size = 0;
+      unsigned int new_checksum = 0, block_size = 0, num_blocks = 0;
+      if (!read_toc_string(is, key) || !read_toc_string(is, name) ||
+          !is.read(reinterpret_cast<char *>(&new_size), sizeof(new_size)) ||
+          !is.read(reinterpret_cast<char *>(&new_checksum),
+                   sizeof(new_checksum)) ||
+          !is.read(reinterpret_cast<char *>(&block_size), sizeof(block_size)) ||
+          !is.read(reinterpret_cast<char *>(&num_blocks), sizeof(num_blocks)) ||
+          (block_size == 0)) {
+        break;
+      }
+      int const i = find_state_object(keys, names, key, name);
+      std::string skipped;
+      std::string &payload = (i >= 0) ? payloads[i] : skipped;
+      payload.resize(new_size);
+      for (unsigned int ib = 0; ib < num_blocks; ib++) {
+        unsigned int block = 0;
+        is.read(reinterpret_cast<char *>(&block), sizeof(block));
+        size_t const start = size_t(block) * block_size;
+        if (start >= payload.size()) {
+          is.setstate(std::ios::failbit);
+          break;
+        }
+        size_t const length = std::min(size_t(block_size),
+                                       payload.size() - start);
+        is.read(&(payload[start]), length);
+      }
+      if (!is) {
+        break;
+      }
+      if (i >= 0) {
+        if (cvm::checksum(payload.data(), payload.size()) != new_checksum) {
+          return cvm::error("Error: a difference segment of the state "
+                            "file does not reproduce the state of \""+name+
+                            "\" ("+key+").\n", INPUT_ERROR);
+        }
+        found[i] = true;
+      }
+    }
+    if (!is) {
+      return cvm::error("Error: corrupt difference segment in the binary "
+                        "state file.\n", INPUT_ERROR);
+    }
+    return COLVARS_OK;
+  }
+}
+
+
+void colvarmodule::write_restart_sections(std::vector<std::string> &keys,
+                                          std::vector<std::string> &names,
+                                          std::vector<std::string> &payloads)
+{
+  keys.clear();
+  names.clear();
+  payloads.clear();
+
+  {
+    std::ostringstream conf_os;
+    write_restart_configuration(conf_os);
+    keys.push_back("configuration");
+    names.push_back("");
+    payloads.push_back(conf_os.str());
+  }
+
+  cvm::increase_depth();
+  for (std::vector<colvar *>::iterator cvi = colvars.begin();
+       cvi != colvars.end();
+       cvi++) {
+    std::ostringstream cv_os;
+    cv_os.iword(binary_state_flag()) = 1;
+    cv_os.setf(std::ios::scientific, std::ios::floatfield);
+    (*cvi)->write_state(cv_os);
+    keys.push_back("colvar");
+    names.push_back((*cvi)->name);
+    payloads.push_back(cv_os.str());
+  }
+  for (std::vector<colvarbias *>::iterator bi = biases.begin();
+       bi != biases.end();
+       bi++) {
+    std::ostringstream bias_os;
+    bias_os.iword(binary_state_flag()) = 1;
+    (*bi)->write_state(bias_os);
+    keys.push_back((*bi)->state_keyword);
+    names.push_back((*bi)->name);
+    payloads.push_back(bias_os.str());
+  }
+  cvm::decrease_depth();
+}
+
+
+int colvarmodule::write_restart_binary(std::ostream &os,
+                                       std::vector<std::string> const &keys,
+                                       std::vector<std::string> const &names,
+                                       std::vector<std::string> const &payloads,
+                                       size_t &file_size)
+{
+  // Lay out the sections after the table of contents
+  std::vector<state_section> sections(keys.size());
+  unsigned int const num_sections = sections.size();
+  size_t offset = 8 + 2 * sizeof(unsigned int);
+  for (size_t i = 0; i < sections.size(); i++) {
+    sections[i].key = keys[i];
+    sections[i].name = names[i];
+    offset += 2 * sizeof(unsigned int) + sections[i].key.size() +
+      sections[i].name.size() + 2 * sizeof(cvm::step_number) +
+      sizeof(unsigned int);
+  }
+  offset += sizeof(unsigned int);
+  for (size_t i = 0; i < sections.size(); i++) {
+    sections[i].offset = offset;
+    sections[i].size = payloads[i].size();
+    sections[i].checksum = checksum(payloads[i].data(), payloads[i].size());
+    offset += payloads[i].size();
+  }
+  file_size = offset;
+
+  std::ostringstream toc;
+  toc.write(reinterpret_cast<char const *>(&binary_state_version),
+            sizeof(binary_state_version));
+  toc.write(reinterpret_cast<char const *>(&num_sections),
+            sizeof(num_sections));
+  for (size_t i = 0; i < sections.size(); i++) {
+    write_toc_string(toc, sections[i].key);
+    write_toc_string(toc, sections[i].name);
+    toc.write(reinterpret_cast<char const *>(&(sections[i].offset)),
+              sizeof(sections[i].offset));
+    toc.write(reinterpret_cast<char const *>(&(sections[i].size)),
+              sizeof(sections[i].size));
+    toc.write(reinterpret_cast<char const *>(&(sections[i].checksum)),
+              sizeof(sections[i].checksum));
+  }
+  std::string const toc_str = toc.str();
+  unsigned int const toc_checksum = checksum(toc_str.data(), toc_str.size());
+
+  os.write(binary_state_magic, 8);
+  os.write(toc_str.data(), toc_str.size());
+  os.write(reinterpret_cast<char const *>(&toc_checksum),
+           sizeof(toc_checksum));
+  for (size_t i = 0; i < payloads.size(); i++) {
+    os.write(payloads[i].data(), payloads[i].size());
+  }
+
+  return os.good() ? COLVARS_OK :
+    cvm::error("Error: in writing the binary restart file.\n", FILE_ERROR);
+}
+
+
+size_t colvarmodule::write_restart_diff(std::ostream &os,
+                                         std::vector<std::string> const &keys,
+                                         std::vector<std::string> const &names,
+                                         std::vector<std::string> const &payloads)
+{
+  std::ostringstream entries;
+  unsigned int num_entries = 0;
+  unsigned int const block_size = state_diff_block_size;
+  std::vector<unsigned int> blocks;
+
+  for (size_t i = 0; i < keys.size(); i++) {
+
+    std::string const &new_data = payloads[i];
+    int const j = find_state_object(restart_out_keys, restart_out_names,
+                                    keys[i], names[i]);
+    std::string const empty;
+    std::string const &old_data = (j >= 0) ? restart_out_payloads[j] : empty;
+
+    // Blocks that differ from those last written
+    blocks.clear();
+    for (size_t start = 0; start < new_data.size(); start += block_size) {
+      size_t const length = std::min(size_t(block_size),
+                                     new_data.size() - start);
+      if ((start + length > old_data.size()) ||
+          (std::memcmp(new_data.data() + start, old_data.data() + start,
+                       length) != 0)) {
+        blocks.push_back(start / block_size);
+      }
+    }
+    if ((j >= 0) && blocks.empty() && (new_data.size() == old_data.size())) {
+      continue;
+    }
+
+    cvm::step_number const new_size = new_data.size();
+    unsigned int const new_checksum = checksum(new_data.data(),
+                                               new_data.size());
+    unsigned int const num_blocks = blocks.size();
+    write_toc_string(entries, keys[i]);
+    write_toc_string(entries, names[i]);
+    entries.write(reinterpret_cast<char const *>(&new_size), sizeof(new_size));
+    entries.write(reinterpret_cast<char const *>(&new_checksum),
+                  sizeof(new_checksum));
+    entries.write(reinterpret_cast<char const *>(&block_size),
+                  sizeof(block_size));
+    entries.write(reinterpret_cast<char const *>(&num_blocks),
+                  sizeof(num_blocks));
+    for (size_t ib = 0; ib < blocks.size(); ib++) {
+      size_t const start = size_t(blocks[ib]) * block_size;
+      entries.write(reinterpret_cast<char const *>(&(blocks[ib])),
+                    sizeof(blocks[ib]));
+      entries.write(new_data.data() + start,
+                    std::min(size_t(block_size), new_data.size() - start));
+    }
+    num_entries++;
+  }
+
+  std::string body(reinterpret_cast<char const *>(&num_entries),
+                   sizeof(num_entries));
+  body += entries.str();
+  cvm::step_number const body_length = body.size();
+  unsigned int const body_checksum = checksum(body.data(), body.size());
+
+  os.write(state_diff_magic, 8);
+  os.write(reinterpret_cast<char const *>(&body_length), sizeof(body_length));
+  os.write(body.data(), body.size());
+  os.write(reinterpret_cast<char const *>(&body_checksum),
+           sizeof(body_checksum));
+
+  return 8 + sizeof(body_length) + body.size() + sizeof(body_checksum);
+}
+
+
+int colvarmodule::read_restart_binary(std::istream &is)
+{
+  char magic[8];
+  unsigned int version = 0, num_sections = 0;
+  is.read(magic, 8);
+  is.read(reinterpret_cast<char *>(&version), sizeof(version));
+  is.read(reinterpret_cast<char *>(&num_sections), sizeof(num_sections));
+  if (!is || (std::memcmp(magic, binary_state_magic, 8) != 0) ||
+      (version != binary_state_version)) {
+    return cvm::error("Error: unsupported version or byte order of the "
+                      "binary state file.\n", INPUT_ERROR);
+  }
+
+  std::vector<state_section> sections(num_sections);
+  for (size_t i = 0; i < sections.size(); i++) {
+    if (!read_toc_string(is, sections[i].key) ||
+        !read_toc_string(is, sections[i].name) ||
+        !is.read(reinterpret_cast<char *>(&(sections[i].offset)),
+                 sizeof(sections[i].offset)) ||
+        !is.read(reinterpret_cast<char *>(&(sections[i].size)),
+                 sizeof(sections[i].size)) ||
+        !is.read(reinterpret_cast<char *>(&(sections[i].checksum)),
+                 sizeof(sections[i].checksum))) {
+      return cvm::error("Error: truncated table of contents in the binary "
+                        "state file.\n", INPUT_ERROR);
+    }
+  }
+
+  // Verify the table of contents before using it
+  std::streampos const toc_end = is.tellg();
+  std::string toc_str(size_t(toc_end) - 8, ' ');
+  unsigned int toc_checksum = 0;
+  is.seekg(8, std::ios::beg);
+  is.read(&(toc_str[0]), toc_str.size());
+  is.read(reinterpret_cast<char *>(&toc_checksum), sizeof(toc_checksum));
+  if (!is || (checksum(toc_str.data(), toc_str.size()) != toc_checksum)) {
+    return cvm::error("Error: corrupt table of contents in the binary state "
+                      "file.\n", INPUT_ERROR);
+  }
+
+  // Objects whose state is needed; biases may be listed with either their
+  // state keyword or their type
+  std::vector<std::string> keys, names;
+  keys.push_back("configuration");
+  names.push_back("");
+  for (std::vector<colvar *>::iterator cvi = colvars.begin();
+       cvi != colvars.end();
+       cvi++) {
+    keys.push_back("colvar");
+    names.push_back((*cvi)->name);
+  }
+  for (std::vector<colvarbias *>::iterator bi = biases.begin();
+       bi != biases.end();
+       bi++) {
+    keys.push_back((*bi)->state_keyword);
+    names.push_back((*bi)->name);
+    keys.push_back((*bi)->bias_type);
+    names.push_back((*bi)->name);
+  }
+  std::vector<std::string> payloads(keys.size());
+  std::vector<bool> found(keys.size(), false);
+
+  // Read only the sections of those objects
+  std::streampos base_end = is.tellg();
+  for (size_t is_ = 0; is_ < sections.size(); is_++) {
+    state_section const &s = sections[is_];
+    if (std::streampos(s.offset + s.size) > base_end) {
+      base_end = s.offset + s.size;
+    }
+    int const i = find_state_object(keys, names, s.key, s.name);
+    if ((i < 0) || found[i]) continue;
+    if (read_state_section(is, s, payloads[i]) != COLVARS_OK) {
+      return cvm::get_error();
+    }
+    found[i] = true;
+  }
+
+  // Apply the difference segments appended after the sections, if any
+  is.clear();
+  is.seekg(base_end, std::ios::beg);
+  size_t num_diffs = 0;
+  while (is.read(magic, 8)) {
+    cvm::step_number body_length = 0;
+    unsigned int body_checksum = 0;
+    std::string body;
+    bool complete = (std::memcmp(magic, state_diff_magic, 8) == 0) &&
+      is.read(reinterpret_cast<char *>(&body_length), sizeof(body_length)) &&
+      (body_length > 0);
+    if (complete) {
+      body.resize(body_length);
+      complete = is.read(&(body[0]), body.size()) &&
+        is.read(reinterpret_cast<char *>(&body_checksum),
+                sizeof(body_checksum)) &&
+        (checksum(body.data(), body.size()) == body_checksum);
+    }
+    if (!complete) {
+      cvm::log("Warning: ignoring an incomplete difference segment at the "
+               "end of the state file; the state is that of the previous "
+               "segment.\n");
+      break;
+    }
+    if (apply_state_diff(body, keys, names, payloads, found) != COLVARS_OK) {
+      return cvm::get_error();
+    }
+    num_diffs++;
+  }
+  if (num_diffs > 0) {
+    cvm::log("Applied "+cvm::to_str(num_diffs)+" difference segments "
+             "to the state file.\n");
+  }
+
+  if (found[0]) {
+    std::string restart_conf;
+    std::istringstream conf_is(payloads[0]);
+    if (conf_is >> colvarparse::read_block("configuration", &restart_conf)) {
+      read_restart_configuration(restart_conf);
+    }
+  }
+
+  size_t i = 1;
+  cvm::increase_depth();
+  for (std::vector<colvar *>::iterator cvi = colvars.begin();
+       cvi != colvars.end();
+       cvi++, i++) {
+    if (!found[i]) continue;
+    std::istringstream cv_is(payloads[i]);
+    if (!((*cvi)->read_state(cv_is))) {
+      cvm::error("Error: in reading restart configuration for "
+                 "collective variable \""+(*cvi)->name+"\".\n",
+                 INPUT_ERROR);
+    }
+  }
+
+  for (std::vector<colvarbias *>::iterator bi = biases.begin();
+       bi != biases.end();
+       bi++, i += 2) {
+    size_t const ib = found[i] ? i : i+1;
+    if (!found[ib]) continue;
+    std::istringstream bias_is(payloads[ib]);
+    if (!((*bi)->read_state(bias_is))) {
+      cvm::error("Error: in reading restart configuration for bias \""+
+                 (*bi)->name+"\".\n",
+                 INPUT_ERROR);
+    }
+  }
+  cvm::decrease_depth();
+
+  return cvm::get_error();
+}
+
+
 int colvarmodule::open_traj_file(std::string const &file_name)
 {
   if (cv_traj_os != NULL) {
     return COLVARS_OK;
   }
 
+  std::ios_base::openmode const mode = cv_traj_binary ?
+    (std::ios::out | std::ios::binary) : std::ios::out;
+
   // (re)open trajectory file
   if (cv_traj_append) {
     cvm::log("Appending to trajectory file \""+file_name+"\".\n");
-    cv_traj_os = (cvm::proxy)->output_stream(file_name, std::ios::app);
+    cv_traj_os = (cvm::proxy)->output_stream(file_name, mode | std::ios::app);
   } else {
     cvm::log("Opening trajectory file \""+file_name+"\".\n");
     proxy->backup_file(file_name.c_str());
-    cv_traj_os = (cvm::proxy)->output_stream(file_name);
+    cv_traj_os = (cvm::proxy)->output_stream(file_name, mode);
   }
 
   if (cv_traj_os == NULL) {
@@ -1682,6 +2897,45 @@ std::ostream & colvarmodule::write_traj(std::ostream &os)
 }
 
 
+int colvarmodule::write_traj_binary(std::ostream &os, bool write_header)
+{
+  if (cv_traj_frame == NULL) {
+    cv_traj_frame = new colvartraj_frame();
+  }
+  colvartraj_frame &frame = *cv_traj_frame;
+
+  // labels are only collected for the header
+  frame.clear(write_header);
+
+  int error_code = COLVARS_OK;
+  for (std::vector<colvar *>::iterator cvi = colvars.begin();
+       cvi != colvars.end();
+       cvi++) {
+    error_code |= (*cvi)->write_traj_columns(frame);
+  }
+  for (std::vector<colvarbias *>::iterator bi = biases.begin();
+       bi != biases.end();
+       bi++) {
+    error_code |= (*bi)->write_traj_columns(frame);
+  }
+
+  if (write_header) {
+    frame.write_binary_header(os, proxy->units);
+  }
+  frame.write_binary_record(os, it);
+
+  if (!os.good()) {
+    error_code |= cvm::error("Error: cannot write to file \""+cv_traj_name+
+                             "\".\n", FILE_ERROR);
+  }
+  if (cvm::debug()) {
+    proxy->flush_output_stream(&os);
+  }
+
+  return error_code;
+}
+
+
 void colvarmodule::log(std::string const &message, int min_log_level)
 {
   if (cvm::log_level() < min_log_level) return;
@@ -1770,10 +3024,160 @@ int colvarmodule::fatal_error(std::string const &message)
 }
 
 
+colvarmodule::mapped_file::mapped_file()
+  : file_data(NULL), file_size(0), mapped(false)
+{}
+
+
+colvarmodule::mapped_file::~mapped_file()
+{
+  close();
+}
+
+
+void colvarmodule::mapped_file::close()
+{
+#if !defined(WIN32) || defined(__CYGWIN__)
+  if (mapped && file_size) {
+    munmap(const_cast<char *>(file_data), file_size);
+  }
+#endif
+  file_data = NULL;
+  file_size = 0;
+  mapped = false;
+  buffer.clear();
+}
+
+
+int colvarmodule::mapped_file::open(std::string const &filename)
+{
+  close();
+#if !defined(WIN32) || defined(__CYGWIN__)
+  int const fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return FILE_ERROR;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0) {
+    file_size = st.st_size;
+    if (file_size == 0) {
+      ::close(fd);
+      return COLVARS_OK;
+    }
+    void *const addr = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      ::close(fd);
+      file_data = reinterpret_cast<char const *>(addr);
+      mapped = true;
+      return COLVARS_OK;
+    }
+  }
+  ::close(fd);
+  file_size = 0;
+#endif
+  // Fall back to reading the whole file
+  std::ifstream is(filename.c_str(), std::ios::binary);
+  if (!is.is_open()) {
+    return FILE_ERROR;
+  }
+  is.seekg(0, std::ios::end);
+  std::streamoff const size = is.tellg();
+  is.seekg(0, std::ios::beg);
+  buffer.resize(size);
+  if (size && !is.read(&(buffer[0]), size)) {
+    buffer.clear();
+    return FILE_ERROR;
+  }
+  file_size = buffer.size();
+  file_data = file_size ? &(buffer[0]) : NULL;
+  return COLVARS_OK;
+}
+
+
+namespace {
+
+  // Scanner of the contents of an index file, mimicking the extraction
+  // operators of std::istream (words are separated by white space)
+  class index_file_scanner {
+  public:
+    index_file_scanner(char const *data, size_t size)
+      : begin(data), end(data+size), cur(data)
+    {}
+    inline void skip_space()
+    {
+      while ((cur < end) && std::isspace(static_cast<unsigned char>(*cur))) {
+        cur++;
+      }
+    }
+    inline bool read_char(char &c)
+    {
+      skip_space();
+      if (cur >= end) return false;
+      c = *(cur++);
+      return true;
+    }
+    inline bool read_word(std::string &word)
+    {
+      skip_space();
+      char const *const word_begin = cur;
+      while ((cur < end) && !std::isspace(static_cast<unsigned char>(*cur))) {
+        cur++;
+      }
+      word.assign(word_begin, cur - word_begin);
+      return (cur > word_begin);
+    }
+    inline bool read_int(int &x)
+    {
+      skip_space();
+      char const *p = cur;
+      bool negative = false;
+      if ((p < end) && ((*p == '+') || (*p == '-'))) {
+        negative = (*p == '-');
+        p++;
+      }
+      char const *const digits = p;
+      // Values out of range fail, as with std::istream
+      unsigned long const max_value = negative ? 2147483648UL : 2147483647UL;
+      unsigned long value = 0;
+      for ( ; (p < end) && (*p >= '0') && (*p <= '9'); p++) {
+        unsigned long const digit = *p - '0';
+        if (value > (max_value - digit) / 10) {
+          return false;
+        }
+        value = 10 * value + digit;
+      }
+      if (p == digits) {
+        return false;
+      }
+      x = negative ? static_cast<int>(-static_cast<long>(value - 1) - 1) :
+        static_cast<int>(value);
+      cur = p;
+      return true;
+    }
+    inline size_t tell() const
+    {
+      return cur - begin;
+    }
+    inline void seek(size_t pos)
+    {
+      cur = begin + pos;
+    }
+  protected:
+    char const *begin;
+    char const *end;
+    char const *cur;
+  };
+
+}
+
+
 int cvm::read_index_file(char const *filename)
 {
-  std::ifstream is(filename, std::ios::binary);
-  if (!is.good()) {
+  // The file is mapped in memory and scanned once; each group is stored
+  // as a contiguous array of atom numbers
+  cvm::mapped_file file;
+  bool const b_opened = (file.open(filename) == COLVARS_OK);
+  if (!b_opened) {
     cvm::error("Error: in opening index file \""+
                std::string(filename)+"\".\n",
                FILE_ERROR);
@@ -1781,13 +3185,15 @@ int cvm::read_index_file(char const *filename)
     index_file_names.push_back(std::string(filename));
   }
 
-  while (is.good()) {
+  index_file_scanner is(file.data(), file.size());
+
+  while (b_opened) {
     char open, close;
     std::string group_name;
     int index_of_group = -1;
-    if ( (is >> open) && (open == '[') &&
-         (is >> group_name) &&
-         (is >> close) && (close == ']') ) {
+    if ( is.read_char(open) && (open == '[') &&
+         is.read_word(group_name) &&
+         is.read_char(close) && (close == ']') ) {
       size_t i = 0;
       for ( ; i < index_group_names.size(); i++) {
         if (index_group_names[i] == group_name) {
@@ -1810,12 +3216,15 @@ int cvm::read_index_file(char const *filename)
     std::vector<int> *new_index_group = new std::vector<int>();
 
     int atom_number = 1;
-    std::streampos pos = is.tellg();
-    while ( (is >> atom_number) && (atom_number > 0) ) {
+    size_t pos = is.tell();
+    while ( is.read_int(atom_number) && (atom_number > 0) ) {
       new_index_group->push_back(atom_number);
-      pos = is.tellg();
+      pos = is.tell();
     }
 
+    // Release the memory reserved in excess while growing the group
+    std::vector<int>(*new_index_group).swap(*new_index_group);
+
     if (old_index_group != NULL) {
       bool equal = false;
       if (new_index_group->size() == old_index_group->size()) {
@@ -1839,13 +3248,11 @@ int cvm::read_index_file(char const *filename)
 
     index_groups[index_of_group] = new_index_group;
 
-    is.clear();
-    is.seekg(pos, std::ios::beg);
+    is.seek(pos);
     std::string delim;
-    if ( (is >> delim) && (delim == "[") ) {
+    if ( is.read_word(delim) && (delim == "[") ) {
       // new group
-      is.clear();
-      is.seekg(pos, std::ios::beg);
+      is.seek(pos);
     } else {
       break;
     }
@@ -2235,6 +3642,7 @@ cvm::step_number colvarmodule::it_restart = 0;
 size_t    colvarmodule::restart_out_freq = 0;
 size_t    colvarmodule::cv_traj_freq = 0;
 bool      colvarmodule::use_scripted_forces = false;
+bool      colvarmodule::b_profiling = false;
 bool      colvarmodule::scripting_after_biases = true;
 
 // i/o constants
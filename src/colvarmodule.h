@@ -58,6 +58,7 @@ class colvarbias;
 class colvarproxy;
 class colvarscript;
 class colvarvalue;
+class colvartraj_frame;
 
 
 /// \brief Collective variables module (main class)
@@ -286,6 +287,54 @@ public:
   /// Remove a named atom group from named_atom_groups
   void unregister_named_atom_group(atom_group *ag);
 
+private:
+
+  /// Atom groups that share positions, centers and rotation with at least
+  /// one identical group
+  std::vector<atom_group *> shared_atom_groups;
+
+public:
+
+  /// \brief Find atom groups with identical atoms and fitting options
+  /// across all variables, so that their positions, centers and optimal
+  /// rotation are computed only once per step
+  int setup_shared_atom_groups();
+
+  /// Make all atom groups compute their own positions again
+  void clear_shared_atom_groups();
+
+  /// \brief Stop sharing data with the given atom group (e.g. before it is
+  /// deleted); if it was the source of other groups, one of them replaces it
+  void remove_shared_atom_group(atom_group *ag);
+
+  /// \brief Apply the forces summed over each set of shared atom groups
+  int apply_shared_atom_group_forces();
+
+  /// A sub-component shared by composite components (defined in colvar.h)
+  struct shared_sub_cvc;
+
+private:
+
+  /// \brief Sub-components shared by composite components, created and
+  /// released by colvar::acquire_shared_sub_cvc() and
+  /// colvar::release_shared_sub_cvc()
+  std::vector<shared_sub_cvc *> shared_sub_cvcs;
+
+public:
+
+  /// Sub-components shared by composite components
+  inline std::vector<shared_sub_cvc *> &shared_sub_cvcs_list()
+  {
+    return shared_sub_cvcs;
+  }
+
+  /// \brief Set up the atom groups of the shared sub-components, which are
+  /// not included in those of any colvar
+  int setup_shared_sub_cvcs();
+
+  /// Delete the shared sub-components left by their consumers
+  void clear_shared_sub_cvcs();
+
   /// Array of collective variables
   std::vector<colvar *> *variables();
 
@@ -440,6 +489,13 @@ public:
   /// Read a restart file
   std::istream & read_restart(std::istream &is);
 
+  /// Parse the "configuration" block of a restart file
+  int read_restart_configuration(std::string const &restart_conf);
+
+  /// \brief Read a restart file in the binary format: each colvar or bias
+  /// reads only its own section, whose checksum is verified
+  int read_restart_binary(std::istream &is);
+
   /// Read the states of individual objects; allows for changes
   std::istream & read_objects_state(std::istream &is);
 
@@ -449,6 +505,53 @@ public:
   /// Write the output restart file
   std::ostream & write_restart(std::ostream &os);
 
+  /// Write the "configuration" block of a restart file
+  std::ostream & write_restart_configuration(std::ostream &os);
+
+  /// \brief Write the state of the module, of each colvar and of each bias
+  /// into a separate section of the binary restart file; keys[i] and
+  /// names[i] identify the object of payloads[i]
+  void write_restart_sections(std::vector<std::string> &keys,
+                              std::vector<std::string> &names,
+                              std::vector<std::string> &payloads);
+
+  /// \brief Write the output restart file in the binary format: a table of
+  /// contents (the key, name, position, size and checksum of the section of
+  /// each object) followed by the sections; grids are written as binary
+  /// data within the sections (see binary_state_flag())
+  /// \param file_size Total number of bytes written
+  int write_restart_binary(std::ostream &os,
+                           std::vector<std::string> const &keys,
+                           std::vector<std::string> const &names,
+                           std::vector<std::string> const &payloads,
+                           size_t &file_size);
+
+  /// \brief Append to a binary restart file a difference segment with
+  /// the blocks of each section that differ from the last ones written
+  /// (restart_out_payloads); sections of unchanged objects are omitted
+  /// \returns Number of bytes written
+  size_t write_restart_diff(std::ostream &os,
+                             std::vector<std::string> const &keys,
+                             std::vector<std::string> const &names,
+                             std::vector<std::string> const &payloads);
+
+  /// Identifier at the beginning of a binary restart file
+  static char const binary_state_magic[9];
+
+  /// Version of the binary restart format
+  static unsigned int const binary_state_version;
+
+  /// Whether the stream starts with a binary restart file (does not move it)
+  static bool is_binary_state(std::istream &is);
+
+  /// \brief Index of the std::ios_base::iword() flag that marks streams
+  /// receiving the sections of a binary restart file; objects may then
+  /// write large arrays of numbers as binary data
+  static int binary_state_flag();
+
+  /// CRC-32 checksum of the given data
+  static unsigned int checksum(char const *data, size_t size);
+
   /// Strips .colvars.state from filename and checks that it is not empty
   static std::string state_file_prefix(char const *filename);
 
@@ -458,6 +561,9 @@ public:
   int close_traj_file();
   /// Write in the trajectory file
   std::ostream & write_traj(std::ostream &os);
+  /// \brief Write a record in the binary trajectory file, preceded by a
+  /// header describing its columns if write_header is true
+  int write_traj_binary(std::ostream &os, bool write_header);
   /// Write explanatory labels in the trajectory file
   std::ostream & write_traj_label(std::ostream &os);
 
@@ -499,9 +605,41 @@ public:
   /// Calculate collective variables
   int calc_colvars();
 
+  /// \brief Update the lists of awake biases and active colvars, and
+  /// compute the atom groups and sub-components shared between components
+  int prepare_colvars();
+
+  /// \brief Build the list of SMP items (one per active component) and
+  /// sort it by decreasing estimated cost
+  int update_variables_active_smp();
+
+  /// \brief Whether colvars and biases should be computed by
+  /// calc_task_graph() in this step
+  bool use_task_graph();
+
+  /// \brief Compute colvars and biases as one graph of tasks over all
+  /// threads: each bias is updated as soon as its own colvars are complete,
+  /// independently of the others
+  int calc_task_graph();
+
+  /// Read positions and compute centers and rotations of the atom groups
+  /// that are shared by multiple components
+  int calc_shared_atom_groups();
+
+  /// \brief Sort the SMP items (variables_active_smp()) by decreasing
+  /// estimated cost, with the items never measured first
+  void sort_variables_active_smp();
+
   /// Calculate biases
   int calc_biases();
 
+  /// \brief Reset the bias forces of all colvars and the total energy,
+  /// and update the list of active biases
+  void prepare_biases();
+
+  /// Update one bias (adding its time to its profile, if enabled)
+  static int update_bias(colvarbias *b);
+
   /// Integrate bias and restraint forces, send colvar forces to atoms
   int update_colvar_forces();
 
@@ -512,7 +650,9 @@ public:
   int end_of_step();
 
   /// \brief Read a collective variable trajectory (post-processing
-  /// only, not called at runtime)
+  /// only, not called at runtime); the index of its frames is saved to a
+  /// file and reused only if colvarsTrajIndexFile is enabled (see
+  /// colvartraj_reader)
   int read_traj(char const *traj_filename,
                 long        traj_read_begin,
                 long        traj_read_end);
@@ -700,6 +840,38 @@ public:
   /// \brief Groups from one or more Gromacs .ndx files
   std::vector<std::vector<int> *> index_groups;
 
+  /// \brief Read-only contents of a file, mapped in memory when the
+  /// platform allows it (otherwise, read into a buffer)
+  class mapped_file {
+  public:
+    mapped_file();
+    ~mapped_file();
+    /// Map the given file, releasing the previous one
+    int open(std::string const &filename);
+    /// Release the file
+    void close();
+    /// Contents of the file (NULL if it is empty)
+    inline char const *data() const
+    {
+      return file_data;
+    }
+    /// Size of the file
+    inline size_t size() const
+    {
+      return file_size;
+    }
+  protected:
+    char const *file_data;
+    size_t file_size;
+    /// Whether file_data is mapped from the file (otherwise it points to buffer)
+    bool mapped;
+    /// Contents of the file, when it cannot be mapped
+    std::vector<char> buffer;
+  private:
+    mapped_file(mapped_file const &);
+    mapped_file & operator = (mapped_file const &);
+  };
+
   /// \brief Read a Gromacs .ndx file
   int read_index_file(char const *filename);
 
@@ -764,9 +936,48 @@ protected:
   /// Appending to the existing trajectory file?
   bool cv_traj_append;
 
+  /// Whether the trajectory file uses the binary format (colvartraj_frame)
+  bool cv_traj_binary;
+
+  /// \brief Whether read_traj() saves the index of the frames next to the
+  /// trajectory file, and reuses it (see colvartraj_reader)
+  bool cv_traj_read_index;
+
+  /// Columns of the binary trajectory (NULL until first used)
+  colvartraj_frame *cv_traj_frame;
+
+  /// Name of the trajectory file for the given output prefix
+  std::string traj_file_name(std::string const &prefix) const;
+
   /// Write labels at the next iteration
   bool cv_traj_write_labels;
 
+  /// Whether restart files are written in the binary format
+  bool restart_out_binary;
+
+  /// \brief Whether differences are appended to the periodic restart file:
+  /// the whole state is still serialized at each update, but only the
+  /// blocks of each section that differ from the previous update are
+  /// written, until their total size exceeds that of the full state
+  bool restart_out_append_diffs;
+
+  /// Size of the last full restart file written with appended differences
+  /// (0 if none)
+  size_t restart_out_base_size;
+
+  /// Size of the difference segments appended to it since
+  size_t restart_out_diffs_size;
+
+  /// Keys of the sections of the last update of the restart file
+  std::vector<std::string> restart_out_keys;
+
+  /// Names of the sections of the last update of the restart file
+  std::vector<std::string> restart_out_names;
+
+  /// \brief Contents of the sections of the last update of the restart file
+  /// (a copy of the whole state, against which differences are computed)
+  std::vector<std::string> restart_out_payloads;
+
 private:
 
   /// Counter for the current depth in the object hierarchy (useg e.g. in output)
@@ -803,6 +1014,82 @@ public:
   /// Calculate the energy and forces of scripted biases
   int calc_scripted_forces();
 
+  /// \brief Wall-clock time and number of calls accumulated by one task
+  /// (a stage of the step, a colvar, a component or a bias) while
+  /// profiling is enabled
+  class profile_counter {
+  public:
+    /// Total time in seconds
+    double total_time;
+    /// Number of calls (steps in which the task was performed)
+    size_t num_calls;
+    inline profile_counter()
+      : total_time(0.0), num_calls(0)
+    {}
+    /// Add the time of a task, counting it as num_calls calls
+    inline void add(double seconds, size_t calls = 1)
+    {
+      total_time += seconds;
+      num_calls += calls;
+    }
+    inline void reset()
+    {
+      total_time = 0.0;
+      num_calls = 0;
+    }
+    /// One line of the profiling report (label, time, calls, ms per call)
+    std::string report(std::string const &label) const;
+  };
+
+  /// Stages of each step, profiled separately
+  enum profile_stage {
+    profile_calc_colvars,
+    profile_calc_biases,
+    profile_calc_task_graph,
+    profile_update_colvar_forces,
+    profile_analyze,
+    profile_write_traj,
+    profile_write_restart,
+    profile_write_bias_output,
+    profile_num_stages
+  };
+
+  /// Whether the time of each stage and object is being accumulated
+  static inline bool profiling()
+  {
+    return b_profiling;
+  }
+
+  /// \brief Current wall-clock time in seconds, from an arbitrary origin
+  /// (processor time when neither C++11 nor OpenMP are available)
+  static double wall_time();
+
+  /// Enable or disable profiling (counters are kept when disabled)
+  void set_profiling(bool on);
+
+  /// Reset all profiling counters
+  void reset_profile();
+
+  /// Summary of the profiling counters of each stage and object
+  std::string profile_report() const;
+
+  /// Steps between profiling summaries printed to the log (0 = never)
+  step_number profiling_freq;
+
+protected:
+
+  /// Whether profiling is enabled
+  static bool b_profiling;
+
+  /// Time accumulated by each stage of the step
+  profile_counter stage_profiles[profile_num_stages];
+
+  /// \brief Add the time since t_start to the given stage
+  /// \returns The current time
+  double add_stage_time(profile_stage stage, double t_start);
+
+public:
+
   /// \brief Pointer to the proxy object, used to retrieve atomic data
   /// from the hosting program; it is static in order to be accessible
   /// from static functions in the colvarmodule class
@@ -29,6 +29,20 @@ namespace {
     *v = val;
   }
 
+  // Characters that delimit the words indexed by colvarparse::index_keywords()
+  inline bool is_key_delimiter(char c)
+  {
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '{') || (c == '}');
+  }
+
+  // FNV-1a hash of a lowercase string, one character at a time
+  unsigned int const key_hash_basis = 2166136261U;
+
+  inline unsigned int key_hash_step(unsigned int h, char c)
+  {
+    return (h ^ static_cast<unsigned char>(c)) * 16777619U;
+  }
+
 }
 
 
@@ -566,6 +580,35 @@ void colvarparse::strip_values(std::string &conf)
   std::list<size_t>::iterator data_begin = data_begin_pos.begin();
   std::list<size_t>::iterator data_end   = data_end_pos.begin();
 
+  // If the values are ordered and do not overlap, which is the case unless
+  // a keyword also appears in the value of another, copy what remains of
+  // the string in a single pass
+  bool b_disjoint = (data_begin_pos.size() == data_end_pos.size());
+  size_t prev_end = 0;
+  for ( ; b_disjoint && (data_begin != data_begin_pos.end());
+        data_begin++, data_end++) {
+    if ((*data_begin < prev_end) || (*data_end < *data_begin) ||
+        (*data_end > conf.size())) {
+      b_disjoint = false;
+    }
+    prev_end = *data_end;
+  }
+
+  data_begin = data_begin_pos.begin();
+  data_end   = data_end_pos.begin();
+
+  if (b_disjoint) {
+    std::string stripped;
+    stripped.reserve(conf.size());
+    for ( ; data_begin != data_begin_pos.end(); data_begin++, data_end++) {
+      stripped.append(conf, offset, *data_begin - offset);
+      offset = *data_end;
+    }
+    stripped.append(conf, offset, std::string::npos);
+    conf.swap(stripped);
+    return;
+  }
+
   for ( ; (data_begin != data_begin_pos.end()) &&
           (data_end   != data_end_pos.end()) ;
         data_begin++, data_end++) {
@@ -582,6 +625,9 @@ void colvarparse::clear_keyword_registry()
   allowed_keywords.clear();
   data_begin_pos.clear();
   data_end_pos.clear();
+  key_index_conf.clear();
+  key_index_source = NULL;
+  key_index.clear();
 }
 
 
@@ -611,15 +657,8 @@ int colvarparse::check_keywords(std::string &conf, char const *key)
     //   cvm::log ("Checking the validity of \""+uk+"\" from line:\n" + line);
     uk = to_lower_cppstr(uk);
 
-    bool found_keyword = false;
-    for (std::list<std::string>::iterator ki = allowed_keywords.begin();
-         ki != allowed_keywords.end(); ki++) {
-      if (uk == *ki) {
-        found_keyword = true;
-        break;
-      }
-    }
-    if (!found_keyword) {
+    // key_set_modes has an entry for each of the allowed keywords
+    if (key_set_modes.find(uk) == key_set_modes.end()) {
       cvm::error("Error: keyword \""+uk+"\" is not supported, "
                  "or not recognized in this context.\n", INPUT_ERROR);
       return INPUT_ERROR;
@@ -673,62 +712,21 @@ bool colvarparse::key_lookup(std::string const &conf,
   // use the lowercase version from now on
   std::string const key(to_lower_cppstr(key_in));
 
-  // "conf_lower" is only used to lookup the keyword, but its value
-  // will be read from "conf", in order not to mess up file names
-  std::string const conf_lower(to_lower_cppstr(conf));
-
   // by default, there is no value, unless we found one
   if (data != NULL) {
     data->clear();
   }
 
-  // start from the first occurrence of key
-  size_t pos = conf_lower.find(key, (save_pos != NULL) ? *save_pos : 0);
+  size_t const pos = find_keyword(conf, key,
+                                  (save_pos != NULL) ? *save_pos : 0,
+                                  (save_pos != NULL) && (*save_pos > 0));
 
-  // iterate over all instances of the substring until it finds it as isolated keyword
-  while (true) {
-
-    if (pos == std::string::npos) {
-      // no valid instance of the keyword has been found
-      if (cvm::debug()) {
-        cvm::log("Keyword \""+std::string(key_in)+"\" not found.\n");
-      }
-      return false;
-    }
-
-    bool b_isolated_left = true, b_isolated_right = true;
-
-    if (pos > 0) {
-      if ( std::string("\n"+std::string(white_space)+
-                       "}").find(conf[pos-1]) ==
-           std::string::npos ) {
-        // none of the valid delimiting characters is on the left of key
-        b_isolated_left = false;
-      }
-    }
-
-    if (pos < conf.size()-key.size()-1) {
-      if ( std::string("\n"+std::string(white_space)+
-                       "{").find(conf[pos+key.size()]) ==
-           std::string::npos ) {
-        // none of the valid delimiting characters is on the right of key
-        b_isolated_right = false;
-      }
-    }
-
-    // check that there are matching braces between here and the end of conf
-    bool const b_not_within_block = (check_braces(conf, pos) == COLVARS_OK);
-
-    bool const b_isolated = (b_isolated_left && b_isolated_right &&
-                             b_not_within_block);
-
-    if (b_isolated) {
-      // found it
-      break;
-    } else {
-      // try the next occurrence of key
-      pos = conf_lower.find(key, pos+key.size());
+  if (pos == std::string::npos) {
+    // no valid instance of the keyword has been found
+    if (cvm::debug()) {
+      cvm::log("Keyword \""+std::string(key_in)+"\" not found.\n");
     }
+    return false;
   }
 
   if (save_pos != NULL) {
@@ -844,6 +842,181 @@ bool colvarparse::key_lookup(std::string const &conf,
 }
 
 
+unsigned int colvarparse::key_hash(char const *key, size_t len)
+{
+  unsigned int h = key_hash_basis;
+  for (size_t i = 0; i < len; i++) {
+    h = key_hash_step(h, key[i]);
+  }
+  return h;
+}
+
+
+void colvarparse::index_keywords(std::string const &conf, bool resume)
+{
+  if ((key_index_source != NULL) && (key_index_conf.size() == conf.size())) {
+    if (resume && (key_index_source == &conf)) {
+      return;
+    }
+    if (key_index_conf == conf) {
+      key_index_source = &conf;
+      return;
+    }
+  }
+
+  key_index_conf = conf;
+  key_index_source = &conf;
+  key_index.clear();
+
+  // Brace depth of each word: only the words at the same depth as the end
+  // of the string are outside of any block
+  std::vector<int> depths;
+
+  size_t const n = conf.size();
+  int depth = 0;
+  size_t i = 0;
+  while (i < n) {
+
+    char const c = conf[i];
+    if (c == '{') depth++;
+    if (c == '}') depth--;
+    if (is_key_delimiter(c)) {
+      i++;
+      continue;
+    }
+
+    size_t const word_begin = i;
+    unsigned int h = key_hash_basis, h_prev = h;
+    for ( ; (i < n) && !is_key_delimiter(conf[i]); i++) {
+      h_prev = h;
+      h = key_hash_step(h, (char) ::tolower(conf[i]));
+    }
+    size_t const word_end = i;
+
+    // Same conditions as the search in key_lookup(): the keyword must be
+    // preceded by white space or a closing brace, and followed by white
+    // space or an opening brace (not checked within the last two
+    // characters of the string)
+    if ((word_begin > 0) && (conf[word_begin-1] == '{')) {
+      continue;
+    }
+
+    bool const b_isolated_right = (word_end+1 < n) ?
+      (conf[word_end] != '}') : !((word_begin == 0) && (word_end == n));
+
+    key_span s;
+    s.pos = word_begin;
+    if (b_isolated_right) {
+      s.hash = h;
+      s.len = word_end - word_begin;
+      key_index.push_back(s);
+      depths.push_back(depth);
+    }
+    if ((word_end == n) && (word_end - word_begin >= 2)) {
+      // A word that ends the string also matches without its last character
+      s.hash = h_prev;
+      s.len = word_end - word_begin - 1;
+      key_index.push_back(s);
+      depths.push_back(depth);
+    }
+  }
+
+  size_t num_keys = 0;
+  for (size_t k = 0; k < key_index.size(); k++) {
+    if (depths[k] == depth) {
+      key_index[num_keys++] = key_index[k];
+    }
+  }
+  key_index.resize(num_keys);
+
+  std::sort(key_index.begin(), key_index.end());
+}
+
+
+size_t colvarparse::find_keyword(std::string const &conf,
+                                 std::string const &key,
+                                 size_t start_pos, bool resume)
+{
+  bool b_indexable = (key.size() > 0);
+  for (size_t i = 0; i < key.size(); i++) {
+    if (is_key_delimiter(key[i])) {
+      b_indexable = false;
+      break;
+    }
+  }
+
+  if (b_indexable) {
+
+    index_keywords(conf, resume);
+
+    key_span s;
+    s.hash = key_hash(key.c_str(), key.size());
+    s.pos = start_pos;
+    s.len = 0;
+    std::vector<key_span>::const_iterator si =
+      std::lower_bound(key_index.begin(), key_index.end(), s);
+    for ( ; (si != key_index.end()) && (si->hash == s.hash); si++) {
+      if (si->len != key.size()) continue;
+      size_t j = 0;
+      for ( ; j < key.size(); j++) {
+        if ((char) ::tolower(conf[si->pos+j]) != key[j]) break;
+      }
+      if (j == key.size()) {
+        return si->pos;
+      }
+    }
+
+    return std::string::npos;
+  }
+
+  // Keywords that cannot be indexed are searched directly
+
+  // "conf_lower" is only used to lookup the keyword, but its value
+  // will be read from "conf", in order not to mess up file names
+  std::string const conf_lower(to_lower_cppstr(conf));
+
+  // start from the first occurrence of key
+  size_t pos = conf_lower.find(key, start_pos);
+
+  // iterate over all instances of the substring until it finds it as isolated keyword
+  while (pos != std::string::npos) {
+
+    bool b_isolated_left = true, b_isolated_right = true;
+
+    if (pos > 0) {
+      if ( std::string("\n"+std::string(white_space)+
+                       "}").find(conf[pos-1]) ==
+           std::string::npos ) {
+        // none of the valid delimiting characters is on the left of key
+        b_isolated_left = false;
+      }
+    }
+
+    if (pos < conf.size()-key.size()-1) {
+      if ( std::string("\n"+std::string(white_space)+
+                       "{").find(conf[pos+key.size()]) ==
+           std::string::npos ) {
+        // none of the valid delimiting characters is on the right of key
+        b_isolated_right = false;
+      }
+    }
+
+    // check that there are matching braces between here and the end of conf
+    bool const b_not_within_block = (check_braces(conf, pos) == COLVARS_OK);
+
+    if (b_isolated_left && b_isolated_right && b_not_within_block) {
+      // found it
+      break;
+    }
+
+    // try the next occurrence of key
+    pos = conf_lower.find(key, pos+key.size());
+  }
+
+  return pos;
+}
+
+
 colvarparse::read_block::read_block(std::string const &key_in,
                                     std::string *data_in)
   : key(key_in), data(data_in)
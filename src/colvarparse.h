@@ -364,6 +364,45 @@ protected:
   /// \brief Remove all the values from the config string
   void strip_values(std::string &conf);
 
+  /// \brief Word of a configuration string that key_lookup() accepts as a
+  /// keyword (i.e. isolated and outside of any block)
+  struct key_span {
+    /// Hash of the lowercase word
+    unsigned int hash;
+    /// Position in the string
+    size_t pos;
+    /// Length
+    size_t len;
+    /// Ordering by hash first, then by position
+    inline bool operator < (key_span const &s) const
+    {
+      return (hash < s.hash) || ((hash == s.hash) && (pos < s.pos));
+    }
+  };
+
+  /// Copy of the configuration string currently indexed
+  std::string key_index_conf;
+
+  /// Address of the configuration string currently indexed
+  std::string const *key_index_source;
+
+  /// Keywords of the configuration string currently indexed
+  std::vector<key_span> key_index;
+
+  /// \brief Index the words of the configuration string in a single pass,
+  /// unless it is already indexed \param conf The configuration string
+  /// \param resume Whether this is a lookup following a previous one of the
+  /// same string, whose contents are then assumed to be unchanged
+  void index_keywords(std::string const &conf, bool resume);
+
+  /// \brief Position of the first valid instance of the lowercase keyword
+  /// key in conf, starting from start_pos (std::string::npos if none)
+  size_t find_keyword(std::string const &conf, std::string const &key,
+                      size_t start_pos, bool resume);
+
+  /// Hash of a lowercase keyword, as used by key_index
+  static unsigned int key_hash(char const *key, size_t len);
+
   /// \brief Configuration string of the object (includes comments)
   std::string config_string;
 
@@ -12,6 +12,7 @@
 #endif
 #include <cerrno>
 
+#include <algorithm>
 #include <sstream>
 #include <cstring>
 #include <cstdio>
@@ -20,7 +21,20 @@
 #include <omp.h>
 #endif
 
+#if (__cplusplus >= 201103L)
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#endif
+
 #include "colvarmodule.h"
+#include "colvarparse.h"
 #include "colvarproxy.h"
 #include "colvarscript.h"
 #include "colvaratoms.h"
@@ -205,6 +219,7 @@ int colvarproxy_system::get_dE_dLambda(cvm::real* force)
 
 colvarproxy_atoms::colvarproxy_atoms()
 {
+  atoms_slots_table_count = 0;
   atoms_rms_applied_force_ = atoms_max_applied_force_ = 0.0;
   atoms_max_applied_force_id_ = -1;
   updated_masses_ = updated_charges_ = false;
@@ -226,12 +241,66 @@ int colvarproxy_atoms::reset()
   atoms_positions.clear();
   atoms_total_forces.clear();
   atoms_new_colvar_forces.clear();
+  atoms_slots_table.clear();
+  atoms_slots_table_count = 0;
   return COLVARS_OK;
 }
 
 
+namespace {
+
+  // Bucket of an atom ID in a table of 2^n buckets (multiplicative hashing)
+  inline size_t atom_id_bucket(int atom_id, size_t mask)
+  {
+    return static_cast<size_t>(static_cast<unsigned int>(atom_id) * 2654435761U) & mask;
+  }
+
+}
+
+
+void colvarproxy_atoms::rebuild_atoms_slots_table(size_t num_buckets)
+{
+  size_t n = 16;
+  while (n < num_buckets) n *= 2;
+  atoms_slots_table.assign(n, -1);
+  size_t const mask = n - 1;
+  for (size_t i = 0; i < atoms_ids.size(); i++) {
+    size_t b = atom_id_bucket(atoms_ids[i], mask);
+    while (atoms_slots_table[b] >= 0) {
+      b = (b + 1) & mask;
+    }
+    atoms_slots_table[b] = i;
+  }
+  atoms_slots_table_count = atoms_ids.size();
+}
+
+
+int colvarproxy_atoms::find_atom_slot(int atom_id)
+{
+  if (atoms_slots_table_count != atoms_ids.size()) {
+    // atoms_ids was changed outside of add_atom_slot()
+    rebuild_atoms_slots_table(2 * atoms_ids.size());
+  }
+  if (atoms_slots_table.empty()) {
+    return -1;
+  }
+  size_t const mask = atoms_slots_table.size() - 1;
+  size_t b = atom_id_bucket(atom_id, mask);
+  while (atoms_slots_table[b] >= 0) {
+    if (atoms_ids[atoms_slots_table[b]] == atom_id) {
+      return atoms_slots_table[b];
+    }
+    b = (b + 1) & mask;
+  }
+  return -1;
+}
+
+
 int colvarproxy_atoms::add_atom_slot(int atom_id)
 {
+  bool const b_table_valid =
+    (atoms_slots_table_count == atoms_ids.size());
+
   atoms_ids.push_back(atom_id);
   atoms_ncopies.push_back(1);
   atoms_masses.push_back(1.0);
@@ -239,7 +308,87 @@ int colvarproxy_atoms::add_atom_slot(int atom_id)
   atoms_positions.push_back(cvm::rvector(0.0, 0.0, 0.0));
   atoms_total_forces.push_back(cvm::rvector(0.0, 0.0, 0.0));
   atoms_new_colvar_forces.push_back(cvm::rvector(0.0, 0.0, 0.0));
-  return (atoms_ids.size() - 1);
+
+  int const index = atoms_ids.size() - 1;
+
+  if (b_table_valid && (2 * atoms_ids.size() <= atoms_slots_table.size())) {
+    size_t const mask = atoms_slots_table.size() - 1;
+    size_t b = atom_id_bucket(atom_id, mask);
+    while (atoms_slots_table[b] >= 0) {
+      b = (b + 1) & mask;
+    }
+    atoms_slots_table[b] = index;
+    atoms_slots_table_count = atoms_ids.size();
+  } else {
+    rebuild_atoms_slots_table(4 * atoms_ids.size());
+  }
+
+  return index;
+}
+
+
+void colvarproxy_atoms::reserve_atoms(size_t num_atoms)
+{
+  size_t const n = atoms_ids.size() + num_atoms;
+  atoms_ids.reserve(n);
+  atoms_ncopies.reserve(n);
+  atoms_masses.reserve(n);
+  atoms_charges.reserve(n);
+  atoms_positions.reserve(n);
+  atoms_total_forces.reserve(n);
+  atoms_new_colvar_forces.reserve(n);
+  if (atoms_slots_table.size() < 2 * n) {
+    rebuild_atoms_slots_table(2 * n);
+  }
+}
+
+
+int colvarproxy_atoms::init_atom_slots(std::vector<int> const &atom_ids,
+                                       std::vector<int> &indices)
+{
+  // Count the atoms not requested yet, each only once
+  std::vector<int> new_ids;
+  for (size_t i = 0; i < atom_ids.size(); i++) {
+    if ((atom_ids[i] >= 0) && (find_atom_slot(atom_ids[i]) < 0)) {
+      new_ids.push_back(atom_ids[i]);
+    }
+  }
+  std::sort(new_ids.begin(), new_ids.end());
+  reserve_atoms(std::unique(new_ids.begin(), new_ids.end()) - new_ids.begin());
+
+  int error_code = COLVARS_OK;
+  indices.resize(atom_ids.size());
+  for (size_t i = 0; i < atom_ids.size(); i++) {
+    if (atom_ids[i] < 0) {
+      indices[i] = INPUT_ERROR;
+      error_code |= INPUT_ERROR;
+      continue;
+    }
+    int const index = find_atom_slot(atom_ids[i]);
+    if (index >= 0) {
+      // this atom id was already recorded
+      atoms_ncopies[index] += 1;
+      indices[i] = index;
+    } else {
+      indices[i] = add_atom_slot(atom_ids[i]);
+    }
+  }
+  return error_code;
+}
+
+
+int colvarproxy_atoms::init_atoms(std::vector<int> const &atom_numbers,
+                                  std::vector<int> &indices)
+{
+  int error_code = COLVARS_OK;
+  indices.resize(atom_numbers.size());
+  for (size_t i = 0; i < atom_numbers.size(); i++) {
+    indices[i] = init_atom(atom_numbers[i]);
+    if (indices[i] < 0) {
+      error_code |= INPUT_ERROR;
+    }
+  }
+  return error_code;
 }
 
 
@@ -419,10 +568,339 @@ void colvarproxy_atom_groups::compute_max_atom_groups_applied_force()
 
 
 
+#if (__cplusplus >= 201103L)
+namespace {
+  /// Index of the current thread in the thread pool (0 for the main thread)
+  thread_local int smp_pool_thread_id = 0;
+}
+
+
+/// Persistent threads used by colvarproxy_smp::smp_mode_threads
+class colvarproxy_smp_thread_pool {
+
+public:
+
+  /// Start num_threads-1 worker threads (the calling thread is the first)
+  colvarproxy_smp_thread_pool(size_t num_threads)
+    : job(NULL), job_size(0), job_generation(0), num_working(0),
+      b_stop(false)
+  {
+    for (size_t i = 1; i < num_threads; i++) {
+      workers.push_back(std::thread(&colvarproxy_smp_thread_pool::worker_loop,
+                                    this, int(i)));
+    }
+  }
+
+  ~colvarproxy_smp_thread_pool()
+  {
+    {
+      std::unique_lock<std::mutex> guard(job_mutex);
+      b_stop = true;
+    }
+    job_start.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+      workers[i].join();
+    }
+  }
+
+  inline size_t num_threads() const
+  {
+    return workers.size() + 1;
+  }
+
+  /// \brief Call f(i) for all i in [0, n) on all threads, each taking the
+  /// next index as soon as it is idle
+  /// \param serial_task If given, run first by the calling thread only
+  void parallel_for(size_t n, std::function<void(size_t)> const &f,
+                    std::function<void()> const *serial_task = NULL)
+  {
+    {
+      std::unique_lock<std::mutex> guard(job_mutex);
+      job = &f;
+      job_size = n;
+      next_index.store(0);
+      num_working = workers.size();
+      job_generation++;
+    }
+    job_start.notify_all();
+    if (serial_task) {
+      (*serial_task)();
+    }
+    run_job(f, n);
+    std::unique_lock<std::mutex> guard(job_mutex);
+    job_done.wait(guard, [this] { return num_working == 0; });
+    job = NULL;
+  }
+
+  /// Lock used by colvarproxy_smp::smp_lock()
+  std::mutex data_mutex;
+
+private:
+
+  void run_job(std::function<void(size_t)> const &f, size_t n)
+  {
+    for (size_t i = next_index.fetch_add(1); i < n;
+         i = next_index.fetch_add(1)) {
+      f(i);
+    }
+  }
+
+  void worker_loop(int id)
+  {
+    smp_pool_thread_id = id;
+    size_t last_generation = 0;
+    while (true) {
+      std::function<void(size_t)> const *f = NULL;
+      size_t n = 0;
+      {
+        std::unique_lock<std::mutex> guard(job_mutex);
+        job_start.wait(guard, [&] {
+          return b_stop || (job_generation != last_generation);
+        });
+        if (b_stop) return;
+        last_generation = job_generation;
+        f = job;
+        n = job_size;
+      }
+      run_job(*f, n);
+      std::unique_lock<std::mutex> guard(job_mutex);
+      if (--num_working == 0) {
+        job_done.notify_one();
+      }
+    }
+  }
+
+  std::vector<std::thread> workers;
+  std::mutex job_mutex;
+  std::condition_variable job_start;
+  std::condition_variable job_done;
+  std::function<void(size_t)> const *job;
+  size_t job_size;
+  std::atomic<size_t> next_index;
+  size_t job_generation;
+  size_t num_working;
+  bool b_stop;
+};
+
+
+/// \brief Tasks for the components, colvars and biases of the module, with
+/// dependencies between them: each task is run by the first idle thread as
+/// soon as all the tasks it depends on are complete.  The graph includes all
+/// colvars and biases, and is rebuilt only when these change; tasks of
+/// objects that are inactive in the current step are skipped.
+class colvarproxy_smp::smp_task_graph {
+
+public:
+
+  smp_task_graph()
+    : num_left(0), error_code(COLVARS_OK)
+  {}
+
+  /// \brief Add the tasks of all colvars and biases of the module
+  /// \param proxy Proxy used to print the thread numbers
+  int build(colvarproxy_smp *proxy)
+  {
+    colvarmodule *cv = cvm::main();
+    std::vector<colvar *> const &colvars_all = *(cv->variables());
+    std::vector<colvarbias *> const &biases_all = cv->biases;
+
+    // Collecting the components of each colvar completes it; the i-th
+    // item task of a colvar computes its i-th active component
+    for (size_t k = 0; k < colvars_all.size(); k++) {
+      colvar *x = colvars_all[k];
+      colvar_index[x] = k;
+      size_t const collect_task = add_task([x] () {
+        return x->collect_cvc_data();
+      });
+      collect_tasks.push_back(collect_task);
+      item_tasks.push_back(tasks.size());
+      for (size_t x_item = 0; x_item < x->num_cvcs(); x_item++) {
+        size_t const item_task = add_task([proxy, x, x_item] () {
+          if (cvm::debug()) {
+            cvm::log("["+cvm::to_str(proxy->smp_thread_id())+"/"+
+                     cvm::to_str(proxy->smp_num_threads())+
+                     "]: smp_task_graph_loop(), cv = "+x->name+
+                     ", cvc = "+cvm::to_str(x_item)+"\n");
+          }
+          std::chrono::steady_clock::time_point const t_start =
+            std::chrono::steady_clock::now();
+          int const error_code = x->calc_cvcs(int(x_item), 1);
+          x->update_cvc_cost_estimate(int(x_item), std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - t_start).count());
+          return error_code;
+        });
+        add_dependency(item_task, collect_task);
+      }
+    }
+
+    // Each bias depends only on its own colvars (the same objects that it
+    // depends upon in the colvardeps tree)
+    for (size_t i = 0; i < biases_all.size(); i++) {
+      colvarbias *b = biases_all[i];
+      size_t const bias_task = add_task([proxy, b] () {
+        if (cvm::debug()) {
+          cvm::log("Calculating bias \""+b->name+"\" on thread "+
+                   cvm::to_str(proxy->smp_thread_id())+"\n");
+        }
+        return colvarmodule::update_bias(b);
+      });
+      bias_index[b] = bias_task;
+      for (size_t icv = 0; icv < b->num_variables(); icv++) {
+        std::map<colvar *, size_t>::const_iterator const it =
+          colvar_index.find(b->variables(icv));
+        if (it == colvar_index.end()) {
+          return cvm::error("Error: bias \""+b->name+"\" uses the variable \""+
+                            b->variables(icv)->name+"\", which is not "
+                            "defined in the module.\n", BUG_ERROR);
+        }
+        add_dependency(collect_tasks[it->second], bias_task);
+      }
+    }
+
+    active.assign(tasks.size(), 0);
+    num_dependencies.assign(tasks.size(), 0);
+    ready.reserve(tasks.size());
+    return COLVARS_OK;
+  }
+
+  /// \brief Mark the tasks of the currently active objects, and make ready
+  /// the tasks without dependencies: the components first, in the order of
+  /// variables_active_smp() (i.e. by decreasing estimated cost)
+  int start()
+  {
+    colvarmodule *cv = cvm::main();
+    std::vector<colvar *> const &items_cv = *(cv->variables_active_smp());
+    std::vector<int> const &items_cvc = *(cv->variables_active_smp_items());
+    std::vector<colvar *> const &colvars_active = *(cv->variables_active());
+    std::vector<colvarbias *> const &biases_active = *(cv->biases_active());
+
+    active.assign(tasks.size(), 0);
+    for (size_t i = 0; i < colvars_active.size(); i++) {
+      active[collect_tasks[get_colvar_index(colvars_active[i])]] = 1;
+    }
+    for (size_t i = 0; i < biases_active.size(); i++) {
+      std::map<colvarbias *, size_t>::const_iterator const it =
+        bias_index.find(biases_active[i]);
+      if (it == bias_index.end()) {
+        return cvm::error("Error: bias \""+biases_active[i]->name+"\" is "
+                          "missing from the task graph.\n", BUG_ERROR);
+      }
+      active[it->second] = 1;
+    }
+
+    // The ready tasks are run last-in first-out: push the skipped and the
+    // other independent tasks first, and the components last
+    ready.clear();
+    for (size_t i = 0; i < items_cv.size(); i++) {
+      active[item_tasks[get_colvar_index(items_cv[i])] + items_cvc[i]] = 2;
+    }
+    for (size_t i = 0; i < tasks.size(); i++) {
+      num_dependencies[i] = num_dependencies_all[i];
+      if ((num_dependencies[i] == 0) && (active[i] != 2)) {
+        ready.push_back(i);
+      }
+    }
+    for (size_t i = items_cv.size(); i > 0; i--) {
+      ready.push_back(item_tasks[get_colvar_index(items_cv[i-1])] +
+                      items_cvc[i-1]);
+    }
+    num_left = tasks.size();
+    error_code = COLVARS_OK;
+    return COLVARS_OK;
+  }
+
+  /// \brief Run tasks on the calling thread until all are complete;
+  /// tasks made ready by the one just completed are run first
+  void run_tasks()
+  {
+    std::unique_lock<std::mutex> guard(graph_mutex);
+    while (num_left > 0) {
+      if (ready.empty()) {
+        task_done.wait(guard);
+        continue;
+      }
+      size_t const i = ready.back();
+      ready.pop_back();
+      int task_error_code = COLVARS_OK;
+      if (active[i]) {
+        guard.unlock();
+        task_error_code = tasks[i]();
+        guard.lock();
+      }
+      error_code |= task_error_code;
+      num_left--;
+      for (size_t j = 0; j < dependents[i].size(); j++) {
+        if (--num_dependencies[dependents[i][j]] == 0) {
+          ready.push_back(dependents[i][j]);
+        }
+      }
+      task_done.notify_all();
+    }
+  }
+
+  /// Errors returned by the tasks
+  inline int get_error() const
+  {
+    return error_code;
+  }
+
+private:
+
+  /// Add a task, and return its index
+  size_t add_task(std::function<int()> const &f)
+  {
+    tasks.push_back(f);
+    dependents.push_back(std::vector<size_t>());
+    num_dependencies_all.push_back(0);
+    return tasks.size() - 1;
+  }
+
+  /// Make the task "after" wait until "before" is complete
+  void add_dependency(size_t before, size_t after)
+  {
+    dependents[before].push_back(after);
+    num_dependencies_all[after]++;
+  }
+
+  /// Index of a colvar in the module's list when the graph was built
+  inline size_t get_colvar_index(colvar *x) const
+  {
+    return colvar_index.find(x)->second;
+  }
+
+  std::vector<std::function<int()> > tasks;
+  std::vector<std::vector<size_t> > dependents;
+  /// Number of tasks that each task depends on
+  std::vector<size_t> num_dependencies_all;
+  std::map<colvar *, size_t> colvar_index;
+  std::map<colvarbias *, size_t> bias_index;
+  /// Collect task of each colvar
+  std::vector<size_t> collect_tasks;
+  /// First item task of each colvar
+  std::vector<size_t> item_tasks;
+  /// Whether each task is run in the current step (0 = skipped)
+  std::vector<int> active;
+  /// Number of tasks that each task is still waiting for
+  std::vector<size_t> num_dependencies;
+  /// Tasks ready to run, the last one first
+  std::vector<size_t> ready;
+  size_t num_left;
+  int error_code;
+  std::mutex graph_mutex;
+  std::condition_variable task_done;
+};
+#endif
+
+
 colvarproxy_smp::colvarproxy_smp()
 {
   b_smp_active = true; // May be disabled by user option
+  smp_atoms_loop_min_size = 4096;
   omp_lock_state = NULL;
+  smp_mode = smp_mode_openmp;
+  thread_pool = NULL;
+  task_graph = NULL;
+  b_smp_task_graph = false;
 #if defined(_OPENMP)
   if (smp_thread_id() == 0) {
     omp_lock_state = reinterpret_cast<void *>(new omp_lock_t);
@@ -441,11 +919,70 @@ colvarproxy_smp::~colvarproxy_smp()
     }
   }
 #endif
+#if (__cplusplus >= 201103L)
+  smp_task_graph_reset();
+  delete thread_pool;
+#endif
+}
+
+
+int colvarproxy_smp::set_smp_mode(std::string const &mode_str, int num_threads)
+{
+  std::string const mode = colvarparse::to_lower_cppstr(mode_str);
+
+  if ((mode == "off") || (mode == "no") || (mode == "false")) {
+    b_smp_active = false;
+    return COLVARS_OK;
+  }
+
+  if ((mode == "on") || (mode == "yes") || (mode == "true") ||
+      (mode == "openmp")) {
+#if !defined(_OPENMP)
+    if (mode == "openmp") {
+      return cvm::error("Error: this build does not support OpenMP; "
+                        "use \"smp threads\" instead.\n",
+                        COLVARS_NOT_IMPLEMENTED);
+    }
+#endif
+    b_smp_active = true;
+    smp_mode = smp_mode_openmp;
+    return COLVARS_OK;
+  }
+
+  if (mode == "threads") {
+#if (__cplusplus >= 201103L)
+    if (num_threads <= 0) {
+      num_threads = int(std::thread::hardware_concurrency());
+    }
+    if (num_threads <= 0) {
+      num_threads = 1;
+    }
+    colvarproxy_smp_thread_pool *pool = thread_pool;
+    if ((pool == NULL) || (pool->num_threads() != size_t(num_threads))) {
+      delete pool;
+      thread_pool = new colvarproxy_smp_thread_pool(num_threads);
+    }
+    b_smp_active = true;
+    smp_mode = smp_mode_threads;
+    return COLVARS_OK;
+#else
+    return cvm::error("Error: \"smp threads\" requires a build with the "
+                      "C++11 standard or higher.\n",
+                      COLVARS_NOT_IMPLEMENTED);
+#endif
+  }
+
+  return cvm::error("Error: invalid value \""+mode_str+"\" for keyword "
+                    "\"smp\"; supported values are on, off, openmp and "
+                    "threads.\n", INPUT_ERROR);
 }
 
 
 int colvarproxy_smp::smp_enabled()
 {
+  if (smp_mode == smp_mode_threads) {
+    return b_smp_active ? COLVARS_OK : COLVARS_ERROR;
+  }
 #if defined(_OPENMP)
   if (b_smp_active) {
     return COLVARS_OK;
@@ -457,12 +994,102 @@ int colvarproxy_smp::smp_enabled()
 }
 
 
+int colvarproxy_smp::smp_task_graph_enabled()
+{
+  if (!b_smp_task_graph || !b_smp_active) {
+    return COLVARS_ERROR;
+  }
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    return COLVARS_OK;
+  }
+#if defined(_OPENMP)
+  return COLVARS_OK;
+#endif
+#endif
+  return COLVARS_NOT_IMPLEMENTED;
+}
+
+
+int colvarproxy_smp::smp_task_graph_loop()
+{
+#if (__cplusplus >= 201103L)
+  if (task_graph == NULL) {
+    task_graph = new smp_task_graph();
+    int const error_code = task_graph->build(this);
+    if (error_code != COLVARS_OK) {
+      smp_task_graph_reset();
+      return error_code;
+    }
+  }
+  smp_task_graph &graph = *task_graph;
+
+  int const error_code = graph.start();
+  if (error_code != COLVARS_OK) {
+    return error_code;
+  }
+  if (smp_mode == smp_mode_threads) {
+    std::function<void(size_t)> const run_tasks = [&graph] (size_t) {
+      graph.run_tasks();
+    };
+    colvarproxy_smp_thread_pool *pool = thread_pool;
+    pool->parallel_for(pool->num_threads(), run_tasks);
+  } else {
+#if defined(_OPENMP)
+#pragma omp parallel
+    graph.run_tasks();
+#else
+    return COLVARS_NOT_IMPLEMENTED;
+#endif
+  }
+  return graph.get_error() | cvm::get_error();
+#else
+  return COLVARS_NOT_IMPLEMENTED;
+#endif
+}
+
+
+void colvarproxy_smp::smp_task_graph_reset()
+{
+#if (__cplusplus >= 201103L)
+  delete task_graph;
+#endif
+  task_graph = NULL;
+}
+
+
 int colvarproxy_smp::smp_colvars_loop()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    colvarmodule *cv = cvm::main();
+    std::function<void(size_t)> const calc_item = [this, cv] (size_t i) {
+      colvar *x = (*(cv->variables_active_smp()))[i];
+      int x_item = (*(cv->variables_active_smp_items()))[i];
+      if (cvm::debug()) {
+        cvm::log("["+cvm::to_str(smp_thread_id())+"/"+
+                 cvm::to_str(smp_num_threads())+
+                 "]: calc_colvars_items_smp(), i = "+cvm::to_str(i)+", cv = "+
+                 x->name+", cvc = "+cvm::to_str(x_item)+"\n");
+      }
+      std::chrono::steady_clock::time_point const t_start =
+        std::chrono::steady_clock::now();
+      x->calc_cvcs(x_item, 1);
+      x->update_cvc_cost_estimate(x_item, std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t_start).count());
+    };
+    thread_pool->parallel_for(cv->variables_active_smp()->size(),
+                                               calc_item);
+    return cvm::get_error();
+  }
+#endif
 #if defined(_OPENMP)
   colvarmodule *cv = cvm::main();
   colvarproxy *proxy = cv->proxy;
-#pragma omp parallel for
+  // Items are sorted by decreasing cost (see colvarmodule::calc_colvars()):
+  // each idle thread takes the next one, so that the cheap items fill in
+  // the time left by the expensive ones
+#pragma omp parallel for schedule(dynamic, 1)
   for (size_t i = 0; i < cv->variables_active_smp()->size(); i++) {
     colvar *x = (*(cv->variables_active_smp()))[i];
     int x_item = (*(cv->variables_active_smp_items()))[i];
@@ -472,7 +1099,9 @@ int colvarproxy_smp::smp_colvars_loop()
                "]: calc_colvars_items_smp(), i = "+cvm::to_str(i)+", cv = "+
                x->name+", cvc = "+cvm::to_str(x_item)+"\n");
     }
+    double const t_start = omp_get_wtime();
     x->calc_cvcs(x_item, 1);
+    x->update_cvc_cost_estimate(x_item, omp_get_wtime() - t_start);
   }
   return cvm::get_error();
 #else
@@ -483,6 +1112,22 @@ int colvarproxy_smp::smp_colvars_loop()
 
 int colvarproxy_smp::smp_biases_loop()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    colvarmodule *cv = cvm::main();
+    std::function<void(size_t)> const update_bias = [this, cv] (size_t i) {
+      colvarbias *b = (*(cv->biases_active()))[i];
+      if (cvm::debug()) {
+        cvm::log("Calculating bias \""+b->name+"\" on thread "+
+                 cvm::to_str(smp_thread_id())+"\n");
+      }
+      colvarmodule::update_bias(b);
+    };
+    thread_pool->parallel_for(cv->biases_active()->size(),
+                                               update_bias);
+    return cvm::get_error();
+  }
+#endif
 #if defined(_OPENMP)
   colvarmodule *cv = cvm::main();
 #pragma omp parallel
@@ -494,7 +1139,7 @@ int colvarproxy_smp::smp_biases_loop()
         cvm::log("Calculating bias \""+b->name+"\" on thread "+
                  cvm::to_str(smp_thread_id())+"\n");
       }
-      b->update();
+      colvarmodule::update_bias(b);
     }
   }
   return cvm::get_error();
@@ -506,6 +1151,26 @@ int colvarproxy_smp::smp_biases_loop()
 
 int colvarproxy_smp::smp_biases_script_loop()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    colvarmodule *cv = cvm::main();
+    std::function<void(size_t)> const update_bias = [this, cv] (size_t i) {
+      colvarbias *b = (*(cv->biases_active()))[i];
+      if (cvm::debug()) {
+        cvm::log("Calculating bias \""+b->name+"\" on thread "+
+                 cvm::to_str(smp_thread_id())+"\n");
+      }
+      colvarmodule::update_bias(b);
+    };
+    // Scripts are run by the calling thread, which owns the interpreter
+    std::function<void()> const calc_scripts = [cv] () {
+      cv->calc_scripted_forces();
+    };
+    thread_pool->parallel_for(cv->biases_active()->size(),
+                                               update_bias, &calc_scripts);
+    return cvm::get_error();
+  }
+#endif
 #if defined(_OPENMP)
   colvarmodule *cv = cvm::main();
 #pragma omp parallel
@@ -521,7 +1186,7 @@ int colvarproxy_smp::smp_biases_script_loop()
         cvm::log("Calculating bias \""+b->name+"\" on thread "+
                  cvm::to_str(smp_thread_id())+"\n");
       }
-      b->update();
+      colvarmodule::update_bias(b);
     }
   }
   return cvm::get_error();
@@ -535,6 +1200,11 @@ int colvarproxy_smp::smp_biases_script_loop()
 
 int colvarproxy_smp::smp_thread_id()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    return smp_pool_thread_id;
+  }
+#endif
 #if defined(_OPENMP)
   return omp_get_thread_num();
 #else
@@ -545,6 +1215,11 @@ int colvarproxy_smp::smp_thread_id()
 
 int colvarproxy_smp::smp_num_threads()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    return int(thread_pool->num_threads());
+  }
+#endif
 #if defined(_OPENMP)
   return omp_get_max_threads();
 #else
@@ -553,8 +1228,30 @@ int colvarproxy_smp::smp_num_threads()
 }
 
 
+bool colvarproxy_smp::smp_atoms_loop_enabled(size_t num_atoms)
+{
+  if (smp_mode == smp_mode_threads) {
+    // Loops over atoms are only parallelized with OpenMP
+    return false;
+  }
+#if defined(_OPENMP)
+  return b_smp_active && (num_atoms >= smp_atoms_loop_min_size) &&
+    !omp_in_parallel() && (omp_get_max_threads() > 1);
+#else
+  (void) num_atoms;
+  return false;
+#endif
+}
+
+
 int colvarproxy_smp::smp_lock()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    thread_pool->data_mutex.lock();
+    return COLVARS_OK;
+  }
+#endif
 #if defined(_OPENMP)
   omp_set_lock(reinterpret_cast<omp_lock_t *>(omp_lock_state));
 #endif
@@ -564,6 +1261,12 @@ int colvarproxy_smp::smp_lock()
 
 int colvarproxy_smp::smp_trylock()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    return thread_pool->data_mutex.try_lock() ?
+      COLVARS_OK : COLVARS_ERROR;
+  }
+#endif
 #if defined(_OPENMP)
   return omp_test_lock(reinterpret_cast<omp_lock_t *>(omp_lock_state)) ?
     COLVARS_OK : COLVARS_ERROR;
@@ -575,6 +1278,12 @@ int colvarproxy_smp::smp_trylock()
 
 int colvarproxy_smp::smp_unlock()
 {
+#if (__cplusplus >= 201103L)
+  if (smp_mode == smp_mode_threads) {
+    thread_pool->data_mutex.unlock();
+    return COLVARS_OK;
+  }
+#endif
 #if defined(_OPENMP)
   omp_unset_lock(reinterpret_cast<omp_lock_t *>(omp_lock_state));
 #endif
@@ -617,14 +1326,299 @@ int colvarproxy_script::run_colvar_gradient_callback(std::string const & /* name
 
 
 
+#if (__cplusplus >= 201103L)
+/// \brief Background thread writing output files: data is written in the
+/// order in which it was handed over, and the total size of the data not yet
+/// written is bounded
+class colvarproxy_async_writer {
+
+public:
+
+  colvarproxy_async_writer(size_t max_bytes)
+    : max_pending_bytes(max_bytes), pending_bytes(0), busy(false),
+      stop(false), worker(&colvarproxy_async_writer::run, this)
+  {
+  }
+
+  ~colvarproxy_async_writer()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    job_ready.notify_all();
+    worker.join();
+  }
+
+  /// \brief Queue the data (whose contents are taken) for writing to file,
+  /// waiting first if the pending data would exceed the maximum size;
+  /// flush or close (and delete) the file afterwards if requested
+  void submit(std::ofstream *file, std::string const &name,
+              std::string &data, bool flush, bool close)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [&] {
+      return (pending_bytes == 0) ||
+        (pending_bytes + data.size() <= max_pending_bytes);
+    });
+    jobs.push_back(write_job());
+    write_job &j = jobs.back();
+    j.file = file;
+    j.name = name;
+    j.data.swap(data);
+    j.flush = flush;
+    j.close = close;
+    pending_bytes += j.data.size();
+    job_ready.notify_one();
+  }
+
+  /// \brief Change the maximum size of the data not yet written; this
+  /// applies also to the files already open
+  void set_max_pending_bytes(size_t max_bytes)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    max_pending_bytes = max_bytes;
+    job_done.notify_all();
+  }
+
+  /// Wait until all queued data has been written
+  void drain()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [this] { return jobs.empty() && !busy; });
+  }
+
+  /// Return (and clear) the messages of the errors occurred so far
+  std::string get_errors()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string result;
+    result.swap(errors);
+    return result;
+  }
+
+private:
+
+  struct write_job {
+    std::ofstream *file;
+    std::string name;
+    std::string data;
+    bool flush;
+    bool close;
+  };
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      job_ready.wait(lock, [this] { return stop || !jobs.empty(); });
+      if (jobs.empty()) {
+        return;
+      }
+      write_job j(std::move(jobs.front()));
+      jobs.pop_front();
+      busy = true;
+      lock.unlock();
+      bool const was_good = j.file->good();
+      if (j.data.size()) {
+        j.file->write(j.data.data(), j.data.size());
+      }
+      if (j.flush) {
+        j.file->flush();
+      }
+      bool const failed = was_good && !j.file->good();
+      if (j.close) {
+        j.file->close();
+        delete j.file;
+      }
+      lock.lock();
+      if (failed) {
+        errors += "Error: cannot write to file \""+j.name+"\".\n";
+      }
+      pending_bytes -= j.data.size();
+      busy = false;
+      job_done.notify_all();
+    }
+  }
+
+  size_t max_pending_bytes;
+  size_t pending_bytes;
+  bool busy;
+  bool stop;
+  std::string errors;
+  std::deque<write_job> jobs;
+  std::mutex mutex;
+  std::condition_variable job_ready;
+  std::condition_variable job_done;
+  std::thread worker;
+};
+
+
+namespace {
+
+/// \brief Stream buffer collecting the output of one file in chunks, which
+/// are handed over to the background thread when full or when flushed
+class async_output_streambuf : public std::streambuf {
+
+public:
+
+  async_output_streambuf(colvarproxy_async_writer *w, std::ofstream *f,
+                         std::string const &n)
+    : writer(w), file(f), name(n), buffer(chunk_size)
+  {
+    setp(&(buffer[0]), &(buffer[0]) + buffer.size());
+  }
+
+  ~async_output_streambuf()
+  {
+    hand_over(false, true);
+  }
+
+protected:
+
+  int_type overflow(int_type c) override
+  {
+    hand_over(false, false);
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  int sync() override
+  {
+    hand_over(true, false);
+    return 0;
+  }
+
+  void hand_over(bool flush, bool close)
+  {
+    std::string data(pbase(), pptr());
+    setp(&(buffer[0]), &(buffer[0]) + buffer.size());
+    if (data.size() || flush || close) {
+      writer->submit(file, name, data, flush, close);
+    }
+  }
+
+  static size_t const chunk_size = 65536;
+
+  colvarproxy_async_writer *writer;
+  std::ofstream *file;
+  std::string name;
+  std::vector<char> buffer;
+};
+
+
+/// Output stream whose contents are written by the background thread
+class async_output_ostream : public std::ostream {
+
+public:
+
+  async_output_ostream(colvarproxy_async_writer *w, std::ofstream *f,
+                       std::string const &n)
+    : std::ostream(NULL), sbuf(w, f, n)
+  {
+    rdbuf(&sbuf);
+  }
+
+  ~async_output_ostream()
+  {
+    rdbuf(NULL);
+  }
+
+private:
+
+  async_output_streambuf sbuf;
+};
+
+}
+#endif
+
+
 colvarproxy_io::colvarproxy_io()
 {
   input_buffer_ = NULL;
   restart_frequency_engine = 0;
+  b_async_output = false;
+  async_output_max_bytes = 0;
+  async_writer = NULL;
 }
 
 
-colvarproxy_io::~colvarproxy_io() {}
+colvarproxy_io::~colvarproxy_io()
+{
+#if (__cplusplus >= 201103L)
+  delete async_writer;
+#endif
+}
+
+
+int colvarproxy_io::set_async_output(bool on, size_t max_buffer_size)
+{
+#if (__cplusplus >= 201103L)
+  if (async_writer) {
+    if ((!on) && (output_files.size() == 0)) {
+      // No stream uses the writer anymore
+      drain_output_streams();
+      delete async_writer;
+      async_writer = NULL;
+    } else {
+      // Streams opened previously keep the current writer
+      async_writer->set_max_pending_bytes(max_buffer_size);
+    }
+  }
+  b_async_output = on;
+  async_output_max_bytes = max_buffer_size;
+  return COLVARS_OK;
+#else
+  if (on) {
+    return cvm::error("Error: asynchronous output requires a build with "
+                      "C++11 or later.\n", COLVARS_NOT_IMPLEMENTED);
+  }
+  return COLVARS_OK;
+#endif
+}
+
+
+int colvarproxy_io::drain_output_streams()
+{
+#if (__cplusplus >= 201103L)
+  if (async_writer) {
+    async_writer->drain();
+  }
+#endif
+  return check_async_output_errors();
+}
+
+
+int colvarproxy_io::check_async_output_errors()
+{
+#if (__cplusplus >= 201103L)
+  if (async_writer) {
+    std::string const errors = async_writer->get_errors();
+    if (errors.size()) {
+      return cvm::error(errors, FILE_ERROR);
+    }
+  }
+#endif
+  return COLVARS_OK;
+}
+
+
+std::ostream *colvarproxy_io::async_output_stream(std::ofstream *osf,
+                                                  std::string const &output_name)
+{
+#if (__cplusplus >= 201103L)
+  if (!async_writer) {
+    async_writer = new colvarproxy_async_writer(async_output_max_bytes);
+  }
+  return new async_output_ostream(async_writer, osf, output_name);
+#else
+  (void) output_name;
+  return osf;
+#endif
+}
 
 
 int colvarproxy_io::get_frame(long int&)
@@ -648,7 +1642,7 @@ int colvarproxy_io::backup_file(char const * /* filename */)
 
 int colvarproxy_io::remove_file(char const *filename)
 {
-  int error_code = COLVARS_OK;
+  int error_code = drain_output_streams();
 #if defined(WIN32) && !defined(__CYGWIN__)
   // Because the file may be open by other processes, rename it to filename.old
   std::string const renamed_file(std::string(filename)+".old");
@@ -681,7 +1675,7 @@ int colvarproxy_io::remove_file(char const *filename)
 
 int colvarproxy_io::rename_file(char const *filename, char const *newfilename)
 {
-  int error_code = COLVARS_OK;
+  int error_code = drain_output_streams();
 #if defined(WIN32) && !defined(__CYGWIN__)
   // On straight Windows, must remove the destination before renaming it
   error_code |= remove_file(newfilename);
@@ -725,12 +1719,11 @@ int colvarproxy::close_files()
   std::list<std::string>::iterator    osni = output_stream_names.begin();
   std::list<std::ostream *>::iterator osi  = output_files.begin();
   for ( ; osi != output_files.end(); osi++, osni++) {
-    ((std::ofstream *) (*osi))->close();
-    delete *osi;
+    close_stream(*osi);
   }
   output_files.clear();
   output_stream_names.clear();
-  return COLVARS_OK;
+  return drain_output_streams();
 }
 
 
@@ -794,6 +1787,7 @@ int colvarproxy::post_run()
     error_code |= colvars->write_output_files();
   }
   error_code |= flush_output_streams();
+  error_code |= drain_output_streams();
   return error_code;
 }
 
@@ -861,6 +1855,9 @@ std::ostream * colvarproxy::output_stream(std::string const &output_name,
   std::ostream *os = get_output_stream(output_name);
   if (os != NULL) return os;
 
+  // Files closed earlier may still be written by the background thread
+  drain_output_streams();
+
   if (!(mode & (std::ios_base::app | std::ios_base::ate))) {
     backup_file(output_name);
   }
@@ -868,11 +1865,13 @@ std::ostream * colvarproxy::output_stream(std::string const &output_name,
   if (!osf->is_open()) {
     cvm::error("Error: cannot write to file/channel \""+output_name+"\".\n",
                FILE_ERROR);
+    delete osf;
     return NULL;
   }
+  os = b_async_output ? async_output_stream(osf, output_name) : osf;
   output_stream_names.push_back(output_name);
-  output_files.push_back(osf);
-  return osf;
+  output_files.push_back(os);
+  return os;
 }
 
 
@@ -902,8 +1901,8 @@ int colvarproxy::flush_output_stream(std::ostream *os)
   std::list<std::string>::iterator    osni = output_stream_names.begin();
   for ( ; osi != output_files.end(); osi++, osni++) {
     if (*osi == os) {
-      ((std::ofstream *) (*osi))->flush();
-      return COLVARS_OK;
+      (*osi)->flush();
+      return check_async_output_errors();
     }
   }
   return cvm::error("Error: trying to flush an output file/channel "
@@ -918,9 +1917,20 @@ int colvarproxy::flush_output_streams()
 
   std::list<std::ostream *>::iterator osi  = output_files.begin();
   for ( ; osi != output_files.end(); osi++) {
-    ((std::ofstream *) (*osi))->flush();
+    (*osi)->flush();
   }
-  return COLVARS_OK;
+  return check_async_output_errors();
+}
+
+
+void colvarproxy::close_stream(std::ostream *os)
+{
+  // Asynchronous streams close their file from the background thread
+  std::ofstream *osf = dynamic_cast<std::ofstream *>(os);
+  if (osf) {
+    osf->close();
+  }
+  delete os;
 }
 
 
@@ -933,11 +1943,10 @@ int colvarproxy::close_output_stream(std::string const &output_name)
   std::list<std::string>::iterator    osni = output_stream_names.begin();
   for ( ; osi != output_files.end(); osi++, osni++) {
     if (*osni == output_name) {
-      ((std::ofstream *) (*osi))->close();
-      delete *osi;
+      close_stream(*osi);
       output_files.erase(osi);
       output_stream_names.erase(osni);
-      return COLVARS_OK;
+      return check_async_output_errors();
     }
   }
   return cvm::error("Error: trying to close an output file/channel "
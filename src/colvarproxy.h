@@ -36,6 +36,8 @@
 
 // forward declarations
 class colvarscript;
+class colvarproxy_async_writer;
+class colvarproxy_smp_thread_pool;
 
 
 /// Methods for accessing the simulation system (PBCs, integrator, etc)
@@ -200,6 +202,18 @@ public:
                             std::string const     &atom_name,
                             std::string const     &segment_id);
 
+  /// \brief Prepare a list of atoms for collective variables calculation,
+  /// selecting them by numeric index (1-based); the result is the same as
+  /// calling init_atom() on each of them, but proxies may override this to
+  /// check the atoms and register them with the program all at once
+  /// \param atom_numbers Atom numbers \param indices Indices of the
+  /// corresponding slots in the arrays (or error codes, as init_atom())
+  virtual int init_atoms(std::vector<int> const &atom_numbers,
+                         std::vector<int> &indices);
+
+  /// Reserve memory in the arrays for this many more atoms
+  virtual void reserve_atoms(size_t num_atoms);
+
   /// \brief Used by the atom class destructor: rather than deleting the array slot
   /// (costly) set the corresponding atoms_ncopies to zero
   virtual void clear_atom(int index);
@@ -406,6 +420,28 @@ protected:
   /// requested yet; returns the index in the arrays
   int add_atom_slot(int atom_id);
 
+  /// \brief Index of the slot of this atom ID in the arrays, or -1 if the
+  /// atom has not been requested yet (hashed lookup)
+  int find_atom_slot(int atom_id);
+
+  /// \brief Used by init_atoms(): find the slots of the given atom IDs, or
+  /// create them in order for those not requested yet (memory is reserved
+  /// beforehand); the slots created are those after the current size of
+  /// atoms_ids \param atom_ids Atom IDs, as returned by check_atom_id()
+  /// \param indices Indices of the slots (INPUT_ERROR for negative IDs)
+  int init_atom_slots(std::vector<int> const &atom_ids,
+                      std::vector<int> &indices);
+
+  /// \brief Hash table of the slot indices, by atom ID (open addressing
+  /// with linear probing, -1 for empty buckets)
+  std::vector<int> atoms_slots_table;
+
+  /// Number of elements of atoms_ids in atoms_slots_table
+  size_t atoms_slots_table_count;
+
+  /// Rebuild atoms_slots_table for the given number of buckets
+  void rebuild_atoms_slots_table(size_t num_buckets);
+
 };
 
 
@@ -571,6 +607,26 @@ public:
   /// cvm::deps feature)
   bool b_smp_active;
 
+  /// Implementations of threaded parallelization
+  enum smp_mode_t {
+    /// OpenMP (default, when the code is compiled with it)
+    smp_mode_openmp,
+    /// Pool of C++11 std::thread objects, owned by this proxy
+    smp_mode_threads
+  };
+
+  /// \brief Set b_smp_active and the implementation used from the value
+  /// of the "smp" keyword (on, off, openmp or threads)
+  /// \param num_threads Number of threads used by the "threads" mode
+  /// (0 = number of cores reported by the system)
+  virtual int set_smp_mode(std::string const &mode, int num_threads = 0);
+
+  /// Implementation currently selected
+  inline smp_mode_t get_smp_mode() const
+  {
+    return smp_mode;
+  }
+
   /// Whether threaded parallelization is available (TODO: make this a cvm::deps feature)
   virtual int smp_enabled();
 
@@ -583,12 +639,38 @@ public:
   /// Distribute calculation of biases across threads 2nd through last, with all scripted biased on 1st thread
   virtual int smp_biases_script_loop();
 
+  /// \brief Whether colvars and biases are computed as a single graph of
+  /// tasks (see smp_task_graph_loop())
+  bool b_smp_task_graph;
+
+  /// \brief Whether smp_task_graph_loop() is requested and available
+  virtual int smp_task_graph_enabled();
+
+  /// \brief Compute the components of the active colvars, collect them and
+  /// update the active biases as tasks over all threads: each colvar is
+  /// completed as soon as its components are, and each bias is updated as
+  /// soon as its own colvars are complete
+  virtual int smp_task_graph_loop();
+
+  /// \brief Discard the task graph of smp_task_graph_loop(), so that it is
+  /// rebuilt at the next step (called when colvars or biases are added or
+  /// deleted)
+  virtual void smp_task_graph_reset();
+
   /// Index of this thread
   virtual int smp_thread_id();
 
   /// Number of threads sharing this address space
   virtual int smp_num_threads();
 
+  /// \brief Whether a loop over num_atoms atoms within a single object
+  /// (e.g. the optimal fit of a large atom group) should be split across
+  /// threads; false when already running inside a parallel loop
+  virtual bool smp_atoms_loop_enabled(size_t num_atoms);
+
+  /// Minimum number of atoms for smp_atoms_loop_enabled() to return true
+  size_t smp_atoms_loop_min_size;
+
   /// Lock the proxy's shared data for access by a thread, if threads are implemented; if not implemented, does nothing
   virtual int smp_lock();
 
@@ -602,6 +684,18 @@ protected:
 
   /// Lock state for OpenMP
   void *omp_lock_state;
+
+  /// Implementation currently selected
+  smp_mode_t smp_mode;
+
+  /// Thread pool and lock used by smp_mode_threads (NULL until selected)
+  colvarproxy_smp_thread_pool *thread_pool;
+
+  /// Tasks of all colvars and biases (defined in colvarproxy.cpp)
+  class smp_task_graph;
+
+  /// Task graph used by smp_task_graph_loop() (NULL until first needed)
+  smp_task_graph *task_graph;
 };
 
 
@@ -750,6 +844,22 @@ public:
     return input_buffer_;
   }
 
+  /// \brief Write the output files opened from now on from a background
+  /// thread (requires C++11); max_buffer_size is the maximum number of bytes
+  /// waiting to be written, beyond which writing to a file waits for the
+  /// background thread (this also applies to the files already open)
+  int set_async_output(bool on, size_t max_buffer_size);
+
+  /// Whether output files are written from a background thread
+  inline bool async_output() const
+  {
+    return b_async_output;
+  }
+
+  /// \brief Wait until all data written to the output files so far is
+  /// handed over to the operating system, and report any write errors
+  int drain_output_streams();
+
 protected:
 
   /// Prefix of the input state file to be read next
@@ -772,6 +882,23 @@ protected:
 
   /// Buffer from which the input state information may be read
   char const *input_buffer_;
+
+  /// Whether output files are written from a background thread
+  bool b_async_output;
+
+  /// Maximum number of bytes waiting to be written by the background thread
+  size_t async_output_max_bytes;
+
+  /// Background thread writing output files (defined in colvarproxy.cpp)
+  colvarproxy_async_writer *async_writer;
+
+  /// \brief Create an output stream for the given file, whose contents are
+  /// written by the background thread
+  std::ostream *async_output_stream(std::ofstream *osf,
+                                    std::string const &output_name);
+
+  /// Report the write errors of the background thread occurred so far
+  int check_async_output_errors();
 };
 
 
@@ -893,6 +1020,9 @@ public:
 
 protected:
 
+  /// Close (if it is a file) and delete the given output stream
+  void close_stream(std::ostream *os);
+
   /// Collected error messages
   std::string error_output;
 
@@ -448,6 +448,31 @@ CVSCRIPT(cv_printframelabels,
          return COLVARS_OK;
          )
 
+CVSCRIPT(cv_profile,
+         "Control profiling and get the times spent by each stage and object\n"
+         "report : string - The profiling report",
+         0, 1,
+         "action : string - One of \"on\", \"off\" or \"reset\"",
+         char const *argstr =
+           script->obj_to_str(script->get_module_cmd_arg(0, objc, objv));
+         if (argstr) {
+           std::string const action(argstr);
+           if (action == "on") {
+             script->module()->set_profiling(true);
+           } else if (action == "off") {
+             script->module()->set_profiling(false);
+           } else if (action == "reset") {
+             script->module()->reset_profile();
+           } else {
+             script->add_error_msg("Unknown profiling action \""+action+
+                                   "\"");
+             return COLVARSCRIPT_ERROR;
+           }
+         }
+         script->set_result_str(script->module()->profile_report());
+         return COLVARS_OK;
+         )
+
 CVSCRIPT(cv_reset,
          "Delete all internal configuration",
          0, 0,
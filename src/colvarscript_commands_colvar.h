@@ -112,6 +112,15 @@ CVSCRIPT(colvar_getconfig,
          return COLVARS_OK;
          )
 
+CVSCRIPT(colvar_getcvccosts,
+         "Return the estimated time of each component, as measured when computed in parallel\n"
+         "costs : array of floats - Times in seconds (-1 if not measured yet)",
+         0, 0,
+         "",
+         script->set_result_real_vec(this_colvar->get_cvc_cost_estimates());
+         return COLVARS_OK;
+         )
+
 CVSCRIPT(colvar_getgradients,
          "Return the atomic gradients of this colvar\n"
          "gradients : array of arrays of floats - Atomic gradients",
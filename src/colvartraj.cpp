@@ -0,0 +1,853 @@
+// -*- c++ -*-
+
+// This file is part of the Collective Variables module (Colvars).
+// The original version of Colvars and its updates are located at:
+// https://github.com/Colvars/colvars
+// Please update all Colvars source files before making any changes.
+// If you wish to distribute your changes, please submit them to the
+// Colvars repository at GitHub.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <sstream>
+
+#include <sys/stat.h>
+
+#include "colvarmodule.h"
+#include "colvartraj.h"
+
+
+char const colvartraj_frame::binary_magic[9] = "CVTRAJB\n";
+
+unsigned int const colvartraj_frame::binary_version = 1;
+
+
+colvartraj_frame::colvartraj_frame()
+  : record_groups(false)
+{
+}
+
+
+void colvartraj_frame::clear(bool with_groups)
+{
+  column_values.clear();
+  record_groups = with_groups;
+  if (with_groups) {
+    column_groups.clear();
+    group_offsets.clear();
+  }
+}
+
+
+void colvartraj_frame::add_group(char const *prefix, std::string const &name,
+                                 size_t width, std::string const &type)
+{
+  column_group g;
+  g.label = std::string(prefix)+name;
+  g.width = width;
+  g.type = type.size() ? type : std::string("vector");
+  group_offsets[g.label] = column_values.size();
+  column_groups.push_back(g);
+}
+
+
+void colvartraj_frame::add(char const *prefix, std::string const &name,
+                           cvm::real x)
+{
+  if (record_groups) {
+    add_group(prefix, name, 1, "scalar");
+  }
+  column_values.push_back(x);
+}
+
+
+void colvartraj_frame::add(char const *prefix, std::string const &name,
+                           colvarvalue const &x)
+{
+  size_t const n = x.size();
+  if (record_groups) {
+    add_group(prefix, name, n, colvarvalue::type_keyword(x.type()));
+  }
+  for (size_t i = 0; i < n; i++) {
+    column_values.push_back(x[i]);
+  }
+}
+
+
+void colvartraj_frame::set_groups(std::vector<column_group> const &groups)
+{
+  record_groups = false;
+  if (groups.size() == column_groups.size()) {
+    bool same = true;
+    for (size_t i = 0; same && (i < groups.size()); i++) {
+      same = (groups[i].width == column_groups[i].width) &&
+        (groups[i].label == column_groups[i].label);
+    }
+    if (same) {
+      return;
+    }
+  }
+  column_groups = groups;
+  group_offsets.clear();
+  size_t num_columns = 0;
+  for (size_t i = 0; i < column_groups.size(); i++) {
+    group_offsets[column_groups[i].label] = num_columns;
+    num_columns += column_groups[i].width;
+  }
+  column_values.assign(num_columns, 0.0);
+}
+
+
+bool colvartraj_frame::get(char const *prefix, std::string const &name,
+                           colvarvalue &x) const
+{
+  std::map<std::string, size_t>::const_iterator const gi =
+    group_offsets.find(std::string(prefix)+name);
+  if (gi == group_offsets.end()) {
+    return false;
+  }
+  size_t const n = x.size();
+  if (gi->second + n > column_values.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < n; i++) {
+    x[i] = column_values[gi->second + i];
+  }
+  return true;
+}
+
+
+bool colvartraj_frame::is_binary(std::istream &is)
+{
+  char buffer[8];
+  std::streampos const start_pos = is.tellg();
+  is.read(buffer, 8);
+  bool const result = is.good() && (std::memcmp(buffer, binary_magic, 8) == 0);
+  is.clear();
+  is.seekg(start_pos, std::ios::beg);
+  return result;
+}
+
+
+std::ostream &colvartraj_frame::write_binary_header(std::ostream &os,
+                                                    std::string const &units)
+  const
+{
+  std::ostringstream text;
+  text << "units " << (units.size() ? units : std::string("default")) << "\n";
+  for (size_t i = 0; i < column_groups.size(); i++) {
+    text << column_groups[i].label << " " << column_groups[i].width << " "
+         << column_groups[i].type << "\n";
+  }
+  std::string const text_str = text.str();
+  unsigned int const text_length = text_str.size();
+  os.write(binary_magic, 8);
+  os.write(reinterpret_cast<char const *>(&binary_version),
+           sizeof(binary_version));
+  os.write(reinterpret_cast<char const *>(&text_length), sizeof(text_length));
+  os.write(text_str.c_str(), text_length);
+  return os;
+}
+
+
+std::ostream &colvartraj_frame::write_binary_record(std::ostream &os,
+                                                    cvm::step_number step)
+  const
+{
+  os.write(reinterpret_cast<char const *>(&step), sizeof(step));
+  if (column_values.size()) {
+    os.write(reinterpret_cast<char const *>(&(column_values[0])),
+             column_values.size() * sizeof(cvm::real));
+  }
+  return os;
+}
+
+
+int colvartraj_frame::parse_binary_header_text(std::string const &text,
+                                               std::vector<column_group> &groups,
+                                               std::string &units)
+{
+  std::istringstream is(text);
+  std::string line;
+  groups.clear();
+  units.clear();
+  while (std::getline(is, line)) {
+    std::istringstream line_is(line);
+    column_group g;
+    if (units.size() == 0) {
+      std::string key;
+      if (!(line_is >> key >> units) || (key != "units")) {
+        return cvm::error("Error: missing units in the header of a binary "
+                          "trajectory.\n", INPUT_ERROR);
+      }
+      continue;
+    }
+    if (!(line_is >> g.label >> g.width >> g.type)) {
+      return cvm::error("Error: cannot parse line \""+line+"\" in the header "
+                        "of a binary trajectory.\n", INPUT_ERROR);
+    }
+    groups.push_back(g);
+  }
+  return COLVARS_OK;
+}
+
+
+int colvartraj_frame::read_binary_header_text(std::string const &text)
+{
+  std::vector<column_group> groups;
+  int const error_code = parse_binary_header_text(text, groups, units_str);
+  if (error_code != COLVARS_OK) {
+    return error_code;
+  }
+  column_groups.clear();
+  group_offsets.clear();
+  column_values.clear();
+  set_groups(groups);
+  return COLVARS_OK;
+}
+
+
+int colvartraj_frame::read_binary(std::istream &is, cvm::step_number &step)
+{
+  char buffer[8];
+  while (true) {
+    if (!is.read(buffer, 8)) {
+      return (is.gcount() == 0) ? COLVARS_NO_SUCH_FRAME :
+        cvm::error("Error: truncated binary trajectory.\n", FILE_ERROR);
+    }
+    if (std::memcmp(buffer, binary_magic, 8) != 0) {
+      break;
+    }
+    unsigned int version = 0, text_length = 0;
+    is.read(reinterpret_cast<char *>(&version), sizeof(version));
+    is.read(reinterpret_cast<char *>(&text_length), sizeof(text_length));
+    if (!is || (version != binary_version)) {
+      return cvm::error("Error: unsupported version or byte order of a "
+                        "binary trajectory.\n", INPUT_ERROR);
+    }
+    std::string text(text_length, ' ');
+    if (text_length && !is.read(&(text[0]), text_length)) {
+      return cvm::error("Error: truncated binary trajectory.\n", FILE_ERROR);
+    }
+    int const error_code = read_binary_header_text(text);
+    if (error_code != COLVARS_OK) {
+      return error_code;
+    }
+  }
+  std::memcpy(&step, buffer, sizeof(step));
+  if (column_values.size() &&
+      !is.read(reinterpret_cast<char *>(&(column_values[0])),
+               column_values.size() * sizeof(cvm::real))) {
+    return cvm::error("Error: truncated binary trajectory.\n", FILE_ERROR);
+  }
+  return COLVARS_OK;
+}
+
+
+namespace {
+
+  /// Whether c separates numbers in a line of the text trajectory
+  inline bool is_separator(char c)
+  {
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') ||
+      (c == '(') || (c == ')') || (c == ',');
+  }
+
+  /// Whether c is a blank character
+  inline bool is_blank(char c)
+  {
+    return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+  }
+
+  /// Move p past blank characters
+  inline char const *skip_blanks(char const *p, char const *end)
+  {
+    while ((p < end) && is_blank(*p)) p++;
+    return p;
+  }
+
+  /// Move p past the current word
+  inline char const *skip_word(char const *p, char const *end)
+  {
+    while ((p < end) && !is_separator(*p)) p++;
+    return p;
+  }
+
+  /// Parse an integer at p, and move p past it
+  inline bool parse_step(char const *&p, char const *end,
+                         cvm::step_number &step)
+  {
+    p = skip_blanks(p, end);
+    bool const negative = (p < end) && (*p == '-');
+    if (negative) p++;
+    char const *const start = p;
+    step = 0;
+    while ((p < end) && (*p >= '0') && (*p <= '9')) {
+      step = 10 * step + (*p - '0');
+      p++;
+    }
+    if (negative) step = -step;
+    return (p > start) && ((p == end) || is_separator(*p));
+  }
+
+  /// \brief Parse the next real number after p (skipping the delimiters of
+  /// vector values), and move p past it
+  inline bool parse_real(char const *&p, char const *end, cvm::real &x)
+  {
+    while ((p < end) && is_separator(*p)) p++;
+    char word[64];
+    size_t n = 0;
+    while ((p < end) && !is_separator(*p) && (n < sizeof(word) - 1)) {
+      word[n++] = *(p++);
+    }
+    if (n == 0) {
+      return false;
+    }
+    word[n] = '\0';
+    char *tail = NULL;
+    x = std::strtod(word, &tail);
+    return tail == (word + n);
+  }
+
+  /// End of the line starting at p (position of the newline character)
+  inline char const *line_end(char const *p, char const *end)
+  {
+    char const *eol =
+      reinterpret_cast<char const *>(std::memchr(p, '\n', end - p));
+    return eol ? eol : end;
+  }
+
+  /// Whether the line at p is the labels line of a text trajectory
+  inline bool is_labels_line(char const *p, char const *end)
+  {
+    p = skip_blanks(p, end);
+    if ((p == end) || (*p != '#')) return false;
+    p = skip_blanks(p + 1, end);
+    return (end - p >= 4) && (std::strncmp(p, "step", 4) == 0);
+  }
+
+  /// Whether the lines starting at p1 and p2 are identical
+  inline bool same_line(char const *p1, char const *p2, char const *end)
+  {
+    char const *const eol1 = line_end(p1, end);
+    char const *const eol2 = line_end(p2, end);
+    return ((eol1 - p1) == (eol2 - p2)) &&
+      (std::memcmp(p1, p2, eol1 - p1) == 0);
+  }
+
+  /// Size of the header of a binary trajectory at p (0 if incomplete)
+  inline size_t binary_header_size(char const *p, char const *end)
+  {
+    size_t const fixed_size = 8 + 2 * sizeof(unsigned int);
+    if (size_t(end - p) < fixed_size) return 0;
+    unsigned int text_length = 0;
+    std::memcpy(&text_length, p + 8 + sizeof(unsigned int),
+                sizeof(text_length));
+    if (size_t(end - p) < fixed_size + text_length) return 0;
+    return fixed_size + text_length;
+  }
+
+  /// Modification time of a file, in seconds (0 if not available)
+  cvm::step_number file_mtime(std::string const &filename)
+  {
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return 0;
+    return cvm::step_number(st.st_mtime);
+  }
+
+  /// \brief Checksum of the beginning and of the end of the given data,
+  /// used to detect a trajectory file replaced by another one
+  unsigned int sampled_checksum(char const *data, size_t size)
+  {
+    if (size == 0) return 0;
+    size_t const sample_size = std::min(size, size_t(65536));
+    return cvm::checksum(data, sample_size) ^
+      cvm::checksum(data + size - sample_size, sample_size);
+  }
+}
+
+
+char const colvartraj_reader::index_magic[9] = "CVTRAJI\n";
+
+unsigned int const colvartraj_reader::index_version = 2;
+
+
+colvartraj_reader::colvartraj_reader()
+  : data(NULL), data_size(0), binary(false), scanned_size(0),
+    steps_increasing(true), steps_even(true)
+{
+}
+
+
+colvartraj_reader::~colvartraj_reader()
+{
+  close();
+}
+
+
+void colvartraj_reader::close()
+{
+  file.close();
+  data = NULL;
+  data_size = 0;
+  binary = false;
+  scanned_size = 0;
+  headers.clear();
+  frame_steps.clear();
+  frame_offsets.clear();
+  steps_increasing = true;
+  steps_even = true;
+}
+
+
+int colvartraj_reader::open(std::string const &filename, bool use_index_file)
+{
+  close();
+  file_name = filename;
+  if (file.open(file_name) != COLVARS_OK) {
+    return cvm::error("Error: cannot open file \""+file_name+"\".\n",
+                      FILE_ERROR);
+  }
+  data = file.data();
+  data_size = file.size();
+
+  binary = (data_size >= 8) &&
+    (std::memcmp(data, colvartraj_frame::binary_magic, 8) == 0);
+
+  bool const index_loaded = use_index_file &&
+    (read_index_file() == COLVARS_OK);
+  size_t const indexed_size = scanned_size;
+
+  int error_code = binary ? scan_binary() : scan_text();
+  if (error_code != COLVARS_OK) {
+    return error_code;
+  }
+
+  if (use_index_file && (!index_loaded || (scanned_size != indexed_size))) {
+    write_index_file();
+  }
+  return COLVARS_OK;
+}
+
+
+void colvartraj_reader::add_frame(cvm::step_number step, size_t offset)
+{
+  size_t const n = frame_steps.size();
+  if (n > 0) {
+    cvm::step_number const delta = step - frame_steps[n-1];
+    if (delta <= 0) {
+      steps_increasing = false;
+    }
+    if ((n > 1) && (delta != (frame_steps[1] - frame_steps[0]))) {
+      steps_even = false;
+    }
+  }
+  frame_steps.push_back(step);
+  frame_offsets.push_back(offset);
+}
+
+
+int colvartraj_reader::scan_text()
+{
+  char const *const end = data + data_size;
+  size_t pos = scanned_size;
+  // Labels line not yet followed by a frame
+  size_t pending_labels = data_size;
+
+  while (pos < data_size) {
+    char const *const line = data + pos;
+    char const *const eol =
+      reinterpret_cast<char const *>(std::memchr(line, '\n', data_size - pos));
+    if (eol == NULL) {
+      // Incomplete line, possibly still being written
+      break;
+    }
+    size_t const next_pos = (eol - data) + 1;
+    char const *p = skip_blanks(line, eol);
+
+    if ((p == eol) || (*p == '#')) {
+      if (is_labels_line(line, eol)) {
+        pending_labels = pos;
+      }
+      pos = next_pos;
+      continue;
+    }
+
+    cvm::step_number step = 0;
+    if (!parse_step(p, eol, step)) {
+      return cvm::error("Error: cannot parse the step number at position "+
+                        cvm::to_str(pos)+" of file \""+file_name+"\".\n",
+                        INPUT_ERROR);
+    }
+
+    if (pending_labels < data_size) {
+      if (headers.empty() ||
+          !same_line(data + headers.back().offset, data + pending_labels,
+                     end)) {
+        header_info h;
+        h.offset = pending_labels;
+        h.first_frame = frame_steps.size();
+        headers.push_back(h);
+        add_frame(step, pos);
+        int const error_code = parse_header(headers.back());
+        if (error_code != COLVARS_OK) {
+          return error_code;
+        }
+        pending_labels = data_size;
+        pos = next_pos;
+        continue;
+      }
+      pending_labels = data_size;
+    } else if (headers.empty()) {
+      return cvm::error("Error: missing labels before the first frame of "
+                        "file \""+file_name+"\".\n", INPUT_ERROR);
+    }
+
+    add_frame(step, pos);
+    pos = next_pos;
+  }
+
+  // Resume from the last labels line if no frame follows it yet
+  scanned_size = (pending_labels < data_size) ? pending_labels : pos;
+  return COLVARS_OK;
+}
+
+
+int colvartraj_reader::scan_binary()
+{
+  char const *const end = data + data_size;
+  size_t pos = scanned_size;
+
+  while (pos < data_size) {
+    if ((data_size - pos >= 8) &&
+        (std::memcmp(data + pos, colvartraj_frame::binary_magic, 8) == 0)) {
+      size_t const header_size = binary_header_size(data + pos, end);
+      if (header_size == 0) {
+        break;
+      }
+      header_info h;
+      h.offset = pos;
+      h.first_frame = frame_steps.size();
+      headers.push_back(h);
+      int const error_code = parse_header(headers.back());
+      if (error_code != COLVARS_OK) {
+        return error_code;
+      }
+      pos += header_size;
+      continue;
+    }
+    if (headers.empty()) {
+      return cvm::error("Error: missing header at the beginning of file \""+
+                        file_name+"\".\n", INPUT_ERROR);
+    }
+    size_t const record_size = sizeof(cvm::step_number) +
+      headers.back().num_columns * sizeof(cvm::real);
+    if (data_size - pos < record_size) {
+      break;
+    }
+    cvm::step_number step = 0;
+    std::memcpy(&step, data + pos, sizeof(step));
+    add_frame(step, pos);
+    pos += record_size;
+  }
+
+  scanned_size = pos;
+  return COLVARS_OK;
+}
+
+
+int colvartraj_reader::parse_header(header_info &h) const
+{
+  char const *const end = data + data_size;
+  h.groups.clear();
+  h.num_columns = 0;
+
+  if (binary) {
+    size_t const header_size = binary_header_size(data + h.offset, end);
+    unsigned int version = 0;
+    std::memcpy(&version, data + h.offset + 8, sizeof(version));
+    if ((header_size == 0) || (version != colvartraj_frame::binary_version)) {
+      return cvm::error("Error: unsupported version or byte order of the "
+                        "binary trajectory \""+file_name+"\".\n",
+                        INPUT_ERROR);
+    }
+    size_t const text_start = 8 + 2 * sizeof(unsigned int);
+    std::string const text(data + h.offset + text_start,
+                           header_size - text_start);
+    std::string units;
+    int const error_code =
+      colvartraj_frame::parse_binary_header_text(text, h.groups, units);
+    if (error_code != COLVARS_OK) {
+      return error_code;
+    }
+  } else {
+    // Labels are the words following "# step"
+    std::vector<std::string> labels;
+    char const *p = data + h.offset;
+    char const *eol = line_end(p, end);
+    p = skip_blanks(p, eol) + 1;
+    p = skip_word(skip_blanks(p, eol), eol);
+    while ((p = skip_blanks(p, eol)) < eol) {
+      char const *const word_end = skip_word(p, eol);
+      labels.push_back(std::string(p, word_end));
+      p = (word_end > p) ? word_end : p + 1;
+    }
+    // The number of components of each quantity is given by the
+    // parentheses of the first frame
+    p = data + frame_offsets[h.first_frame];
+    eol = line_end(p, end);
+    cvm::step_number step;
+    parse_step(p, eol, step);
+    while ((p = skip_blanks(p, eol)) < eol) {
+      colvartraj_frame::column_group g;
+      g.width = 0;
+      if (*p == '(') {
+        while ((p < eol) && (*p != ')')) {
+          if (!is_separator(*p)) {
+            g.width++;
+            p = skip_word(p, eol);
+          } else {
+            p++;
+          }
+        }
+        if (p < eol) p++;
+        g.type = "vector";
+      } else {
+        g.width = 1;
+        p = skip_word(p, eol);
+        g.type = "scalar";
+      }
+      if (h.groups.size() < labels.size()) {
+        g.label = labels[h.groups.size()];
+      }
+      h.groups.push_back(g);
+    }
+    if (h.groups.size() != labels.size()) {
+      return cvm::error("Error: the number of labels ("+
+                        cvm::to_str(labels.size())+") at position "+
+                        cvm::to_str(h.offset)+" of file \""+file_name+
+                        "\" does not match the number of quantities ("+
+                        cvm::to_str(h.groups.size())+
+                        ") in the following line.\n", INPUT_ERROR);
+    }
+  }
+
+  for (size_t i = 0; i < h.groups.size(); i++) {
+    h.num_columns += h.groups[i].width;
+  }
+  return COLVARS_OK;
+}
+
+
+colvartraj_reader::header_info const &
+colvartraj_reader::frame_header(size_t i) const
+{
+  // Last header whose first frame is not after i
+  size_t lo = 0, hi = headers.size();
+  while (hi - lo > 1) {
+    size_t const mid = (lo + hi) / 2;
+    if (headers[mid].first_frame <= i) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return headers[lo];
+}
+
+
+size_t colvartraj_reader::find_step(cvm::step_number step) const
+{
+  size_t const n = frame_steps.size();
+  if ((n == 0) || (step <= frame_steps[0])) {
+    return 0;
+  }
+  if (steps_increasing) {
+    if (steps_even && (n > 1)) {
+      cvm::step_number const stride = frame_steps[1] - frame_steps[0];
+      cvm::step_number const i = (step - frame_steps[0] + stride - 1) / stride;
+      return (i < cvm::step_number(n)) ? size_t(i) : n;
+    }
+    return std::lower_bound(frame_steps.begin(), frame_steps.end(), step) -
+      frame_steps.begin();
+  }
+  for (size_t i = 0; i < n; i++) {
+    if (frame_steps[i] >= step) return i;
+  }
+  return n;
+}
+
+
+int colvartraj_reader::read_frame(size_t i, colvartraj_frame &frame) const
+{
+  if (i >= frame_steps.size()) {
+    return COLVARS_NO_SUCH_FRAME;
+  }
+  header_info const &h = frame_header(i);
+  frame.set_groups(h.groups);
+  std::vector<cvm::real> &values = frame.modify_values();
+  char const *p = data + frame_offsets[i];
+
+  if (binary) {
+    if (values.size()) {
+      std::memcpy(&(values[0]), p + sizeof(cvm::step_number),
+                  values.size() * sizeof(cvm::real));
+    }
+    return COLVARS_OK;
+  }
+
+  char const *const eol = line_end(p, data + data_size);
+  cvm::step_number step;
+  parse_step(p, eol, step);
+  for (size_t ic = 0; ic < values.size(); ic++) {
+    if (!parse_real(p, eol, values[ic])) {
+      return cvm::error("Error: cannot parse the frame at step "+
+                        cvm::to_str(frame_steps[i])+" of file \""+
+                        file_name+"\".\n", INPUT_ERROR);
+    }
+  }
+  return COLVARS_OK;
+}
+
+
+int colvartraj_reader::read_index_file()
+{
+  std::ifstream is(index_file_name(file_name).c_str(), std::ios::binary);
+  if (!is.is_open()) {
+    return COLVARS_NO_SUCH_FRAME;
+  }
+
+  char magic[8];
+  unsigned int version = 0;
+  cvm::step_number indexed_size = 0, file_size = 0, mtime = 0, checksum = 0;
+  cvm::step_number num_headers = 0, num_frames = 0;
+  is.read(magic, 8);
+  is.read(reinterpret_cast<char *>(&version), sizeof(version));
+  is.read(reinterpret_cast<char *>(&indexed_size), sizeof(indexed_size));
+  is.read(reinterpret_cast<char *>(&file_size), sizeof(file_size));
+  is.read(reinterpret_cast<char *>(&mtime), sizeof(mtime));
+  is.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
+  is.read(reinterpret_cast<char *>(&num_headers), sizeof(num_headers));
+  is.read(reinterpret_cast<char *>(&num_frames), sizeof(num_frames));
+  if (!is || (std::memcmp(magic, index_magic, 8) != 0) ||
+      (version != index_version) || (indexed_size < 0) ||
+      (size_t(indexed_size) > data_size) || (num_headers < 0) ||
+      (num_frames < 0) || (num_headers + num_frames > indexed_size)) {
+    // Stale or foreign index: it will be rebuilt
+    return INPUT_ERROR;
+  }
+
+  // The trajectory may only have been appended to since it was indexed: a
+  // file of the same size must also have the same modification time, and
+  // the indexed part must begin and end with the same data
+  if ((size_t(file_size) > data_size) ||
+      ((size_t(file_size) == data_size) && (mtime != file_mtime(file_name))) ||
+      (checksum != cvm::step_number(sampled_checksum(data, indexed_size)))) {
+    return INPUT_ERROR;
+  }
+
+  std::vector<cvm::step_number> entries(2 * (num_headers + num_frames));
+  if (entries.size() &&
+      !is.read(reinterpret_cast<char *>(&(entries[0])),
+               entries.size() * sizeof(cvm::step_number))) {
+    return INPUT_ERROR;
+  }
+
+  size_t k = 0;
+  headers.resize(num_headers);
+  for (size_t ih = 0; ih < headers.size(); ih++) {
+    headers[ih].offset = entries[k++];
+    headers[ih].first_frame = entries[k++];
+  }
+  frame_steps.reserve(num_frames);
+  frame_offsets.reserve(num_frames);
+  for (cvm::step_number i = 0; i < num_frames; i++) {
+    cvm::step_number const step = entries[k++];
+    add_frame(step, entries[k++]);
+  }
+
+  // Check that the first and last frames are still where they were
+  bool valid = true;
+  for (size_t j = 0; valid && (j < 2) && (j < frame_steps.size()); j++) {
+    size_t const i = (j == 0) ? 0 : frame_steps.size() - 1;
+    cvm::step_number step = 0;
+    if (frame_offsets[i] + sizeof(step) > size_t(indexed_size)) {
+      valid = false;
+    } else if (binary) {
+      std::memcpy(&step, data + frame_offsets[i], sizeof(step));
+    } else {
+      char const *p = data + frame_offsets[i];
+      valid = parse_step(p, line_end(p, data + data_size), step);
+    }
+    valid = valid && (step == frame_steps[i]);
+  }
+
+  for (size_t ih = 0; valid && (ih < headers.size()); ih++) {
+    valid = (headers[ih].offset < data_size) &&
+      (headers[ih].first_frame <= frame_steps.size()) &&
+      (binary || (headers[ih].first_frame < frame_steps.size())) &&
+      (parse_header(headers[ih]) == COLVARS_OK);
+  }
+
+  if (!valid) {
+    headers.clear();
+    frame_steps.clear();
+    frame_offsets.clear();
+    steps_increasing = steps_even = true;
+    return INPUT_ERROR;
+  }
+
+  scanned_size = indexed_size;
+  return COLVARS_OK;
+}
+
+
+int colvartraj_reader::write_index_file() const
+{
+  std::string const index_name = index_file_name(file_name);
+  std::ofstream os(index_name.c_str(), std::ios::binary);
+  if (!os.is_open()) {
+    cvm::log("Warning: cannot write the index file \""+index_name+"\".\n");
+    return COLVARS_OK;
+  }
+
+  cvm::step_number const indexed_size = scanned_size;
+  cvm::step_number const file_size = data_size;
+  cvm::step_number const mtime = file_mtime(file_name);
+  cvm::step_number const checksum = sampled_checksum(data, scanned_size);
+  cvm::step_number const num_headers = headers.size();
+  cvm::step_number const num_frames = frame_steps.size();
+  os.write(index_magic, 8);
+  os.write(reinterpret_cast<char const *>(&index_version),
+           sizeof(index_version));
+  os.write(reinterpret_cast<char const *>(&indexed_size), sizeof(indexed_size));
+  os.write(reinterpret_cast<char const *>(&file_size), sizeof(file_size));
+  os.write(reinterpret_cast<char const *>(&mtime), sizeof(mtime));
+  os.write(reinterpret_cast<char const *>(&checksum), sizeof(checksum));
+  os.write(reinterpret_cast<char const *>(&num_headers), sizeof(num_headers));
+  os.write(reinterpret_cast<char const *>(&num_frames), sizeof(num_frames));
+
+  std::vector<cvm::step_number> entries;
+  entries.reserve(2 * (headers.size() + frame_steps.size()));
+  for (size_t ih = 0; ih < headers.size(); ih++) {
+    entries.push_back(headers[ih].offset);
+    entries.push_back(headers[ih].first_frame);
+  }
+  for (size_t i = 0; i < frame_steps.size(); i++) {
+    entries.push_back(frame_steps[i]);
+    entries.push_back(frame_offsets[i]);
+  }
+  if (entries.size()) {
+    os.write(reinterpret_cast<char const *>(&(entries[0])),
+             entries.size() * sizeof(cvm::step_number));
+  }
+
+  if (!os) {
+    cvm::log("Warning: cannot write the index file \""+index_name+"\".\n");
+  }
+  return COLVARS_OK;
+}
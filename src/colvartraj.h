@@ -0,0 +1,286 @@
+// -*- c++ -*-
+
+// This file is part of the Collective Variables module (Colvars).
+// The original version of Colvars and its updates are located at:
+// https://github.com/Colvars/colvars
+// Please update all Colvars source files before making any changes.
+// If you wish to distribute your changes, please submit them to the
+// Colvars repository at GitHub.
+
+#ifndef COLVARTRAJ_H
+#define COLVARTRAJ_H
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "colvarmodule.h"
+#include "colvarvalue.h"
+
+
+/// \brief Columns of one frame of the Colvars trajectory, stored as real
+/// numbers in the order in which they are written
+///
+/// This is used by the binary format of colvars.traj, which consists of
+/// one or more blocks made of a header followed by fixed-size records:
+/// - header: the 8 characters of binary_magic, the format version (32-bit
+///   integer, also used to check the byte order), the length of the header
+///   text (32-bit integer) and the header text itself; the first line of
+///   the text is "units <unit system>", and each following line describes a
+///   group of consecutive columns as "<label> <number of columns> <type>";
+/// - record: the step number (64-bit integer) followed by the values of all
+///   columns (64-bit floating-point numbers), in the native byte order.
+/// A new header is written whenever the set of columns changes.
+class colvartraj_frame {
+
+public:
+
+  /// Group of consecutive columns holding one quantity (e.g. the value of a
+  /// colvar, made of one or more real numbers)
+  struct column_group {
+    /// Label of the quantity, the same used in the text format
+    std::string label;
+    /// Number of columns
+    size_t width;
+    /// Type of the quantity (see colvarvalue::type_keyword())
+    std::string type;
+  };
+
+  /// Constructor
+  colvartraj_frame();
+
+  /// \brief Discard the values of the current frame (memory is kept);
+  /// if with_groups is true, also start recording the column groups
+  void clear(bool with_groups = false);
+
+  /// Column groups, recorded by the last call to clear(true)
+  inline std::vector<column_group> const &groups() const
+  {
+    return column_groups;
+  }
+
+  /// Values of the current frame
+  inline std::vector<cvm::real> const &values() const
+  {
+    return column_values;
+  }
+
+  /// Values of the current frame (modifiable)
+  inline std::vector<cvm::real> &modify_values()
+  {
+    return column_values;
+  }
+
+  /// \brief Set the column groups and the number of values; nothing is
+  /// reallocated if the groups are the same as the current ones
+  void set_groups(std::vector<column_group> const &groups);
+
+  /// Append a scalar quantity, labeled as prefix+name
+  void add(char const *prefix, std::string const &name, cvm::real x);
+
+  /// Append a quantity with one or more components, labeled as prefix+name
+  void add(char const *prefix, std::string const &name, colvarvalue const &x);
+
+  /// \brief Copy into x the quantity labeled prefix+name in the current
+  /// frame; x must already have the correct type
+  /// \returns Whether the quantity was found
+  bool get(char const *prefix, std::string const &name, colvarvalue &x) const;
+
+  /// Identifier at the beginning of each header of a binary trajectory
+  static char const binary_magic[9];
+
+  /// Version of the binary format
+  static unsigned int const binary_version;
+
+  /// Whether the stream starts with a binary trajectory (does not move it)
+  static bool is_binary(std::istream &is);
+
+  /// Write a header describing the current column groups
+  std::ostream &write_binary_header(std::ostream &os,
+                                    std::string const &units) const;
+
+  /// Write the values of the current frame as a record
+  std::ostream &write_binary_record(std::ostream &os,
+                                    cvm::step_number step) const;
+
+  /// \brief Read the next record of a binary trajectory, and the header
+  /// preceding it if there is one
+  /// \returns COLVARS_OK, COLVARS_NO_SUCH_FRAME at the end of the file, or
+  /// an error code if the file is corrupted
+  int read_binary(std::istream &is, cvm::step_number &step);
+
+  /// Unit system of the last header read
+  inline std::string const &units() const
+  {
+    return units_str;
+  }
+
+  /// Parse the text of a header of a binary trajectory
+  static int parse_binary_header_text(std::string const &text,
+                                      std::vector<column_group> &groups,
+                                      std::string &units);
+
+protected:
+
+  /// Whether add() records the column groups
+  bool record_groups;
+
+  /// Column groups
+  std::vector<column_group> column_groups;
+
+  /// Values of the columns
+  std::vector<cvm::real> column_values;
+
+  /// Index of the first column of each group, by label
+  std::map<std::string, size_t> group_offsets;
+
+  /// Unit system of the last header read
+  std::string units_str;
+
+  /// Add a group of the given width and type, labeled as prefix+name
+  void add_group(char const *prefix, std::string const &name, size_t width,
+                 std::string const &type);
+
+  /// Parse the header text, and set the column groups
+  int read_binary_header_text(std::string const &text);
+};
+
+
+/// \brief Random-access reader of a Colvars trajectory file (text or binary
+/// format), intended for post-processing large files
+///
+/// The file is mapped in memory, and its frames are indexed by step number
+/// and position in the file in a single pass; the index may be saved to and
+/// loaded from a sidecar file (see index_file_name()), which is extended if
+/// the trajectory has grown since; the sidecar file is discarded if the size,
+/// modification time or sampled checksum of the trajectory show that it was
+/// rewritten rather than appended to.  The steps of the trajectory are looked up
+/// in constant time when they are evenly spaced, and each frame is parsed
+/// only when requested, without memory allocations.
+class colvartraj_reader {
+
+public:
+
+  /// Constructor
+  colvartraj_reader();
+
+  /// Destructor
+  ~colvartraj_reader();
+
+  /// \brief Open the given file and index its frames
+  /// \param use_index_file Load the index from the sidecar file if it is
+  /// up to date with the trajectory, and (re)write it otherwise
+  int open(std::string const &filename, bool use_index_file = false);
+
+  /// Release the file and the index
+  void close();
+
+  /// Name of the sidecar index file of a trajectory file
+  static std::string index_file_name(std::string const &filename)
+  {
+    return filename+".idx";
+  }
+
+  /// Whether the file is in the binary format
+  inline bool is_binary() const
+  {
+    return binary;
+  }
+
+  /// Number of complete frames in the file
+  inline size_t num_frames() const
+  {
+    return frame_steps.size();
+  }
+
+  /// Step number of the i-th frame
+  inline cvm::step_number frame_step(size_t i) const
+  {
+    return frame_steps[i];
+  }
+
+  /// \brief Index of the first frame whose step is equal to or greater than
+  /// the given one, or num_frames() if there is none
+  size_t find_step(cvm::step_number step) const;
+
+  /// Copy the column groups and the values of the i-th frame into frame
+  int read_frame(size_t i, colvartraj_frame &frame) const;
+
+  /// Magic string at the beginning of the index file
+  static char const index_magic[9];
+
+  /// Version of the index file format
+  static unsigned int const index_version;
+
+protected:
+
+  /// Set of columns, valid from the given frame until the next header
+  struct header_info {
+    /// Position of the header in the file
+    size_t offset;
+    /// Index of the first frame following the header
+    size_t first_frame;
+    /// Column groups
+    std::vector<colvartraj_frame::column_group> groups;
+    /// Total number of columns (values) of a frame
+    size_t num_columns;
+    header_info() : offset(0), first_frame(0), num_columns(0) {}
+  };
+
+  /// Name of the file
+  std::string file_name;
+
+  /// File mapped in memory
+  cvm::mapped_file file;
+
+  /// Contents of the file
+  char const *data;
+
+  /// Size of the file
+  size_t data_size;
+
+  /// Whether the file is in the binary format
+  bool binary;
+
+  /// Number of bytes of the file already indexed
+  size_t scanned_size;
+
+  /// Headers of the file
+  std::vector<header_info> headers;
+
+  /// Step numbers of the frames
+  std::vector<cvm::step_number> frame_steps;
+
+  /// Positions of the frames in the file
+  std::vector<size_t> frame_offsets;
+
+  /// Whether the step numbers are increasing
+  bool steps_increasing;
+
+  /// Whether the step numbers are evenly spaced
+  bool steps_even;
+
+  /// Append a frame to the index
+  void add_frame(cvm::step_number step, size_t offset);
+
+  /// Index the file from scanned_size onwards (text format)
+  int scan_text();
+
+  /// Index the file from scanned_size onwards (binary format)
+  int scan_binary();
+
+  /// Parse the column groups of the given header
+  int parse_header(header_info &h) const;
+
+  /// Header of the i-th frame
+  header_info const &frame_header(size_t i) const;
+
+  /// Load the index from the sidecar file, if it matches the trajectory
+  int read_index_file();
+
+  /// Write the index to the sidecar file
+  int write_index_file() const;
+};
+
+#endif
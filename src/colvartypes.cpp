@@ -12,6 +12,7 @@
 
 #include "colvarmodule.h"
 #include "colvartypes.h"
+#include "colvarproxy.h"
 #include "colvarparse.h"
 
 #ifdef COLVARS_LAMMPS
@@ -25,6 +26,7 @@
 
 bool      colvarmodule::rotation::monitor_crossings = false;
 cvm::real colvarmodule::rotation::crossing_threshold = 1.0E-02;
+bool      colvarmodule::rotation::use_qcp = false;
 
 
 std::string cvm::rvector::to_simple_string() const
@@ -325,6 +327,98 @@ void colvarmodule::rotation::build_correlation_matrix(
 }
 
 
+void colvarmodule::rotation::build_correlation_matrix(
+                                        std::vector<cvm::real> const &pos1_x,
+                                        std::vector<cvm::real> const &pos1_y,
+                                        std::vector<cvm::real> const &pos1_z,
+                                        std::vector<cvm::atom_pos> const &pos2)
+{
+  // Accumulate into scalars, so that the loop can be vectorized and reduced
+  // across threads
+  cvm::real cxx = 0.0, cxy = 0.0, cxz = 0.0;
+  cvm::real cyx = 0.0, cyy = 0.0, cyz = 0.0;
+  cvm::real czx = 0.0, czy = 0.0, czz = 0.0;
+  size_t const n = pos1_x.size();
+  cvm::real const *x1 = pos1_x.size() ? &(pos1_x[0]) : NULL;
+  cvm::real const *y1 = pos1_y.size() ? &(pos1_y[0]) : NULL;
+  cvm::real const *z1 = pos1_z.size() ? &(pos1_z[0]) : NULL;
+  cvm::atom_pos const *p2 = pos2.size() ? &(pos2[0]) : NULL;
+  bool const b_smp = (cvm::proxy != NULL) &&
+    (cvm::proxy)->smp_atoms_loop_enabled(n);
+  (void) b_smp;
+#if defined(_OPENMP)
+#pragma omp parallel for if (b_smp) \
+  reduction(+:cxx,cxy,cxz,cyx,cyy,cyz,czx,czy,czz)
+#endif
+  for (long i = 0; i < long(n); i++) {
+    cvm::real const x2 = p2[i].x, y2 = p2[i].y, z2 = p2[i].z;
+    cxx += x1[i] * x2;
+    cxy += x1[i] * y2;
+    cxz += x1[i] * z2;
+    cyx += y1[i] * x2;
+    cyy += y1[i] * y2;
+    cyz += y1[i] * z2;
+    czx += z1[i] * x2;
+    czy += z1[i] * y2;
+    czz += z1[i] * z2;
+  }
+  C.xx() += cxx;
+  C.xy() += cxy;
+  C.xz() += cxz;
+  C.yx() += cyx;
+  C.yy() += cyy;
+  C.yz() += cyz;
+  C.zx() += czx;
+  C.zy() += czy;
+  C.zz() += czz;
+}
+
+
+void colvarmodule::rotation::build_correlation_matrix(
+                                        std::vector<cvm::atom_pos> const &pos1,
+                                        std::vector<cvm::real> const &pos2_x,
+                                        std::vector<cvm::real> const &pos2_y,
+                                        std::vector<cvm::real> const &pos2_z)
+{
+  cvm::real cxx = 0.0, cxy = 0.0, cxz = 0.0;
+  cvm::real cyx = 0.0, cyy = 0.0, cyz = 0.0;
+  cvm::real czx = 0.0, czy = 0.0, czz = 0.0;
+  size_t const n = pos2_x.size();
+  cvm::atom_pos const *p1 = pos1.size() ? &(pos1[0]) : NULL;
+  cvm::real const *x2 = pos2_x.size() ? &(pos2_x[0]) : NULL;
+  cvm::real const *y2 = pos2_y.size() ? &(pos2_y[0]) : NULL;
+  cvm::real const *z2 = pos2_z.size() ? &(pos2_z[0]) : NULL;
+  bool const b_smp = (cvm::proxy != NULL) &&
+    (cvm::proxy)->smp_atoms_loop_enabled(n);
+  (void) b_smp;
+#if defined(_OPENMP)
+#pragma omp parallel for if (b_smp) \
+  reduction(+:cxx,cxy,cxz,cyx,cyy,cyz,czx,czy,czz)
+#endif
+  for (long i = 0; i < long(n); i++) {
+    cvm::real const x1 = p1[i].x, y1 = p1[i].y, z1 = p1[i].z;
+    cxx += x1 * x2[i];
+    cxy += x1 * y2[i];
+    cxz += x1 * z2[i];
+    cyx += y1 * x2[i];
+    cyy += y1 * y2[i];
+    cyz += y1 * z2[i];
+    czx += z1 * x2[i];
+    czy += z1 * y2[i];
+    czz += z1 * z2[i];
+  }
+  C.xx() += cxx;
+  C.xy() += cxy;
+  C.xz() += cxz;
+  C.yx() += cyx;
+  C.yy() += cyy;
+  C.yz() += cyz;
+  C.zx() += czx;
+  C.zy() += czy;
+  C.zz() += czz;
+}
+
+
 void colvarmodule::rotation::compute_overlap_matrix()
 {
   // build the "overlap" matrix, whose eigenvectors are stationary
@@ -390,6 +484,208 @@ void diagonalize_matrix(cvm::matrix2d<cvm::real> &m,
 #endif
 
 
+namespace {
+
+/// Determinant of the 3x3 minor of m obtained by removing row r and column c
+inline cvm::real minor_4x4(cvm::real const m[4][4], size_t r, size_t c)
+{
+  size_t ri[3], ci[3];
+  for (size_t i = 0, k = 0; i < 4; i++) if (i != r) ri[k++] = i;
+  for (size_t j = 0, k = 0; j < 4; j++) if (j != c) ci[k++] = j;
+  return
+    m[ri[0]][ci[0]] * (m[ri[1]][ci[1]]*m[ri[2]][ci[2]] - m[ri[1]][ci[2]]*m[ri[2]][ci[1]]) -
+    m[ri[0]][ci[1]] * (m[ri[1]][ci[0]]*m[ri[2]][ci[2]] - m[ri[1]][ci[2]]*m[ri[2]][ci[0]]) +
+    m[ri[0]][ci[2]] * (m[ri[1]][ci[0]]*m[ri[2]][ci[1]] - m[ri[1]][ci[1]]*m[ri[2]][ci[0]]);
+}
+
+/// Compute the adjugate of the 4x4 matrix m, and return its determinant
+inline cvm::real adjugate_4x4(cvm::real const m[4][4], cvm::real adj[4][4])
+{
+  for (size_t i = 0; i < 4; i++) {
+    for (size_t j = 0; j < 4; j++) {
+      adj[j][i] = (((i+j) % 2) ? -1.0 : 1.0) * minor_4x4(m, i, j);
+    }
+  }
+  cvm::real det = 0.0;
+  for (size_t j = 0; j < 4; j++) {
+    det += m[0][j] * adj[j][0];
+  }
+  return det;
+}
+
+}
+
+
+int colvarmodule::rotation::calc_leading_eigenpair_qcp()
+{
+  // S is symmetric and traceless, so its characteristic polynomial is
+  // x^4 + c2 x^2 + c1 x + c0, with coefficients given by Newton's identities
+  cvm::real s[4][4], s2[4][4];
+  size_t i, j, k;
+  for (i = 0; i < 4; i++) {
+    for (j = 0; j < 4; j++) {
+      s[i][j] = S[i][j];
+    }
+  }
+  cvm::real tr2 = 0.0, tr3 = 0.0;
+  for (i = 0; i < 4; i++) {
+    for (j = 0; j < 4; j++) {
+      s2[i][j] = 0.0;
+      for (k = 0; k < 4; k++) {
+        s2[i][j] += s[i][k] * s[k][j];
+      }
+      tr3 += s2[i][j] * s[j][i];
+    }
+    tr2 += s2[i][i];
+  }
+  if (tr2 <= 0.0) {
+    // Null overlap matrix: no preferred orientation
+    return COLVARS_ERROR;
+  }
+
+  cvm::real adj[4][4];
+  cvm::real const c2 = -0.5 * tr2;
+  cvm::real const c1 = -1.0/3.0 * tr3;
+  cvm::real const c0 = adjugate_4x4(s, adj);
+
+  // Newton iteration from above the largest root (sum of L_i^2 = tr2)
+  // converges monotonically, because all roots are real
+  cvm::real l = cvm::sqrt(tr2);
+  bool converged = false;
+  for (size_t iter = 0; iter < 100; iter++) {
+    cvm::real const l2 = l*l;
+    cvm::real const p = (l2 + c2) * l2 + c1 * l + c0;
+    cvm::real const dp = (4.0 * l2 + 2.0 * c2) * l + c1;
+    if (dp == 0.0) break;
+    cvm::real const delta = p / dp;
+    l -= delta;
+    if (cvm::fabs(delta) <= 1.0e-14 * cvm::fabs(l)) {
+      converged = true;
+      break;
+    }
+  }
+  if (!converged) return COLVARS_ERROR;
+
+  // The columns of the adjugate of (S - l I) are parallel to the eigenvector
+  for (i = 0; i < 4; i++) {
+    s[i][i] -= l;
+  }
+  adjugate_4x4(s, adj);
+  size_t best = 0;
+  cvm::real best_norm2 = 0.0;
+  for (j = 0; j < 4; j++) {
+    cvm::real norm2 = 0.0;
+    for (i = 0; i < 4; i++) {
+      norm2 += adj[i][j] * adj[i][j];
+    }
+    if (norm2 > best_norm2) {
+      best_norm2 = norm2;
+      best = j;
+    }
+  }
+  // A vanishing adjugate means that the leading eigenvalue is degenerate
+  // (or almost so), and the eigenvector is not well defined by the above
+  if (!(best_norm2 > 1.0e-24 * tr2 * tr2 * tr2)) return COLVARS_ERROR;
+
+  cvm::real const norm = cvm::sqrt(best_norm2);
+  cvm::real const sign = (adj[0][best] < 0.0) ? -1.0 : 1.0;
+  S_eigval[0] = l;
+  for (i = 0; i < 4; i++) {
+    S_eigvec[0][i] = sign * adj[i][best] / norm;
+  }
+
+  return COLVARS_OK;
+}
+
+
+void colvarmodule::rotation::calc_dQ0_projector_qcp()
+{
+  // (L0 I - S + Q0 Q0^T) has eigenvalue 1 along Q0 and (L0 - Lk) along the
+  // other eigenvectors; its inverse minus Q0 Q0^T is the required projector
+  cvm::real const L0 = S_eigval[0];
+  cvm::real m[4][4], adj[4][4];
+  size_t i, j;
+  for (i = 0; i < 4; i++) {
+    for (j = 0; j < 4; j++) {
+      m[i][j] = ((i == j) ? L0 : 0.0) - S_backup[i][j] +
+        S_eigvec[0][i] * S_eigvec[0][j];
+    }
+  }
+  cvm::real const det = adjugate_4x4(m, adj);
+  for (i = 0; i < 4; i++) {
+    for (j = 0; j < 4; j++) {
+      dQ0_proj[i][j] = adj[i][j] / det - S_eigvec[0][i] * S_eigvec[0][j];
+    }
+  }
+}
+
+
+void colvarmodule::rotation::build_dS(cvm::atom_pos const &a,
+                                      cvm::real s,
+                                      cvm::matrix2d<cvm::rvector> &ds)
+{
+  cvm::real const ax = a.x, ay = a.y, az = a.z;
+  ds[0][0].set(    ax,     ay,     az);
+  ds[1][0].set(   0.0,   s*az, -s*ay);
+  ds[0][1] = ds[1][0];
+  ds[2][0].set(-s*az,    0.0,   s*ax);
+  ds[0][2] = ds[2][0];
+  ds[3][0].set(  s*ay, -s*ax,    0.0);
+  ds[0][3] = ds[3][0];
+  ds[1][1].set(    ax,    -ay,    -az);
+  ds[2][1].set(    ay,     ax,    0.0);
+  ds[1][2] = ds[2][1];
+  ds[3][1].set(    az,    0.0,     ax);
+  ds[1][3] = ds[3][1];
+  ds[2][2].set(   -ax,     ay,    -az);
+  ds[3][2].set(   0.0,     az,     ay);
+  ds[2][3] = ds[3][2];
+  ds[3][3].set(   -ax,    -ay,     az);
+}
+
+
+void colvarmodule::rotation::calc_dS_dot_q(cvm::atom_pos const &a,
+                                           cvm::real s,
+                                           cvm::quaternion const &Q,
+                                           cvm::rvector ds_q[4])
+{
+  // Same as build_dS() followed by ds_q[i] = sum_j ds[i][j] * Q[j]
+  cvm::real const ax = a.x, ay = a.y, az = a.z;
+  cvm::real const q0 = Q[0], q1 = Q[1], q2 = Q[2], q3 = Q[3];
+  cvm::real const q123 = q1*ax + q2*ay + q3*az;
+  ds_q[0].set(q0*ax + s*(q3*ay - q2*az),
+              q0*ay + s*(q1*az - q3*ax),
+              q0*az + s*(q2*ax - q1*ay));
+  ds_q[1].set(q123,
+              s*q0*az - q1*ay + q2*ax,
+              -s*q0*ay - q1*az + q3*ax);
+  ds_q[2].set(-s*q0*az + q1*ay - q2*ax,
+              q123,
+              s*q0*ax - q2*az + q3*ay);
+  ds_q[3].set(s*q0*ay + q1*az - q3*ax,
+              -s*q0*ax + q2*az - q3*ay,
+              q123);
+}
+
+
+cvm::rvector colvarmodule::rotation::dQ0_dot(cvm::atom_pos const &a,
+                                             cvm::real s,
+                                             cvm::quaternion const &v) const
+{
+  cvm::rvector ds_q0[4];
+  calc_dS_dot_q(a, s, q, ds_q0);
+  cvm::rvector result(0.0);
+  for (size_t i = 0; i < 4; i++) {
+    cvm::real w = 0.0;
+    for (size_t p = 0; p < 4; p++) {
+      w += v[p] * dQ0_proj[p][i];
+    }
+    result += w * ds_q0[i];
+  }
+  return result;
+}
+
+
 // Calculate the rotation, plus its derivatives
 
 void colvarmodule::rotation::calc_optimal_rotation(
@@ -399,6 +695,82 @@ void colvarmodule::rotation::calc_optimal_rotation(
   C.resize(3, 3);
   C.reset();
   build_correlation_matrix(pos1, pos2);
+  calc_optimal_rotation_from_C(pos1, pos2);
+}
+
+
+void colvarmodule::rotation::calc_optimal_rotation(
+                                        std::vector<cvm::real> const &pos1_x,
+                                        std::vector<cvm::real> const &pos1_y,
+                                        std::vector<cvm::real> const &pos1_z,
+                                        std::vector<cvm::atom_pos> const &pos2)
+{
+  C.resize(3, 3);
+  C.reset();
+  build_correlation_matrix(pos1_x, pos1_y, pos1_z, pos2);
+
+  // Derivatives with respect to the second group need the positions of the
+  // first group one at a time: only assemble them when those are requested
+  std::vector<cvm::atom_pos> pos1;
+  if ((dQ0_2.size() > 0) || b_debug_gradients) {
+    pos1.resize(pos1_x.size());
+    for (size_t i = 0; i < pos1.size(); i++) {
+      pos1[i] = cvm::atom_pos(pos1_x[i], pos1_y[i], pos1_z[i]);
+    }
+  }
+  calc_optimal_rotation_from_C(pos1, pos2);
+}
+
+
+void colvarmodule::rotation::calc_optimal_rotation(
+                                        std::vector<cvm::atom_pos> const &pos1,
+                                        std::vector<cvm::real> const &pos2_x,
+                                        std::vector<cvm::real> const &pos2_y,
+                                        std::vector<cvm::real> const &pos2_z,
+                                        cvm::rvector const &shift2)
+{
+  C.resize(3, 3);
+  C.reset();
+  build_correlation_matrix(pos1, pos2_x, pos2_y, pos2_z);
+
+  // Contribution of the shift, sum_i pos1[i] (x) shift2
+  cvm::atom_pos sum1(0.0, 0.0, 0.0);
+  for (size_t i = 0; i < pos1.size(); i++) {
+    sum1 += pos1[i];
+  }
+  C.xx() += sum1.x * shift2.x;
+  C.xy() += sum1.x * shift2.y;
+  C.xz() += sum1.x * shift2.z;
+  C.yx() += sum1.y * shift2.x;
+  C.yy() += sum1.y * shift2.y;
+  C.yz() += sum1.y * shift2.z;
+  C.zx() += sum1.z * shift2.x;
+  C.zy() += sum1.z * shift2.y;
+  C.zz() += sum1.z * shift2.z;
+
+  // Derivatives with respect to the first group need the positions of the
+  // second group one at a time: only assemble them when those are requested
+  std::vector<cvm::atom_pos> pos2;
+  if ((dQ0_1.size() > 0) || b_debug_gradients) {
+    pos2.resize(pos2_x.size());
+    for (size_t i = 0; i < pos2.size(); i++) {
+      pos2[i] = cvm::atom_pos(pos2_x[i], pos2_y[i], pos2_z[i]) + shift2;
+    }
+  }
+  calc_optimal_rotation_from_C(pos1, pos2);
+}
+
+
+void colvarmodule::rotation::calc_optimal_rotation_from_C(
+                                        std::vector<cvm::atom_pos> const &pos1,
+                                        std::vector<cvm::atom_pos> const &pos2)
+{
+  if ((pos1.size() < dQ0_2.size()) || (pos2.size() < dQ0_1.size()) ||
+      (b_debug_gradients && (pos1.empty() || pos2.empty()))) {
+    cvm::error("Error: missing positions needed to compute the derivatives "
+               "of the optimal rotation.\n", BUG_ERROR);
+    return;
+  }
 
   S.resize(4, 4);
   S.reset();
@@ -414,6 +786,10 @@ void colvarmodule::rotation::calc_optimal_rotation(
   S_eigval.resize(4);
   S_eigvec.resize(4, 4);
 
+  // Only the leading eigenpair is needed, unless gradients are being tested
+  bool const b_qcp = use_qcp && !b_debug_gradients &&
+    (calc_leading_eigenpair_qcp() == COLVARS_OK);
+
 #ifdef COLVARS_LAMMPS
   MathEigen::Jacobi<cvm::real,
                     cvm::vector1d<cvm::real> &,
@@ -422,26 +798,24 @@ void colvarmodule::rotation::calc_optimal_rotation(
                                        cvm::vector1d<cvm::real> &,
                                        cvm::matrix2d<cvm::real> &> *>(jacobi);
 
-  int ierror = ecalc->Diagonalize(S, S_eigval, S_eigvec);
-  if (ierror) {
-    cvm::error("Too many iterations in jacobi diagonalization.\n"
-               "This is usually the result of an ill-defined set of atoms for "
-               "rotational alignment (RMSD, rotateReference, etc).\n");
+  if (!b_qcp) {
+    int ierror = ecalc->Diagonalize(S, S_eigval, S_eigvec);
+    if (ierror) {
+      cvm::error("Too many iterations in jacobi diagonalization.\n"
+                 "This is usually the result of an ill-defined set of atoms for "
+                 "rotational alignment (RMSD, rotateReference, etc).\n");
+    }
   }
 #else
-  diagonalize_matrix(S, S_eigval, S_eigvec);
+  if (!b_qcp) {
+    diagonalize_matrix(S, S_eigval, S_eigvec);
+  }
 #endif
 
 
-  // eigenvalues and eigenvectors
+  // leading eigenvalue and eigenvector
   cvm::real const L0 = S_eigval[0];
-  cvm::real const L1 = S_eigval[1];
-  cvm::real const L2 = S_eigval[2];
-  cvm::real const L3 = S_eigval[3];
   cvm::quaternion const Q0(S_eigvec[0]);
-  cvm::quaternion const Q1(S_eigvec[1]);
-  cvm::quaternion const Q2(S_eigvec[2]);
-  cvm::quaternion const Q3(S_eigvec[3]);
 
   lambda = L0;
   q = Q0;
@@ -458,6 +832,12 @@ void colvarmodule::rotation::calc_optimal_rotation(
   }
 
   if (b_debug_gradients) {
+    cvm::real const L1 = S_eigval[1];
+    cvm::real const L2 = S_eigval[2];
+    cvm::real const L3 = S_eigval[3];
+    cvm::quaternion const Q1(S_eigvec[1]);
+    cvm::quaternion const Q2(S_eigvec[2]);
+    cvm::quaternion const Q3(S_eigvec[3]);
     cvm::log("L0 = "+cvm::to_str(L0, cvm::cv_width, cvm::cv_prec)+
              ", Q0 = "+cvm::to_str(Q0, cvm::cv_width, cvm::cv_prec)+
              ", Q0*Q0 = "+cvm::to_str(Q0.inner(Q0), cvm::cv_width, cvm::cv_prec)+
@@ -479,115 +859,82 @@ void colvarmodule::rotation::calc_optimal_rotation(
   // calculate derivatives of L0 and Q0 with respect to each atom in
   // either group; note: if dS_1 is a null vector, nothing will be
   // calculated
-  size_t ia;
-  for (ia = 0; ia < dS_1.size(); ia++) {
-
-    cvm::real const &a2x = pos2[ia].x;
-    cvm::real const &a2y = pos2[ia].y;
-    cvm::real const &a2z = pos2[ia].z;
-
-    cvm::matrix2d<cvm::rvector> &ds_1 = dS_1[ia];
-
-    // derivative of the S matrix
-    ds_1.reset();
-    ds_1[0][0].set( a2x,  a2y,  a2z);
-    ds_1[1][0].set( 0.0,  a2z, -a2y);
-    ds_1[0][1] = ds_1[1][0];
-    ds_1[2][0].set(-a2z,  0.0,  a2x);
-    ds_1[0][2] = ds_1[2][0];
-    ds_1[3][0].set( a2y, -a2x,  0.0);
-    ds_1[0][3] = ds_1[3][0];
-    ds_1[1][1].set( a2x, -a2y, -a2z);
-    ds_1[2][1].set( a2y,  a2x,  0.0);
-    ds_1[1][2] = ds_1[2][1];
-    ds_1[3][1].set( a2z,  0.0,  a2x);
-    ds_1[1][3] = ds_1[3][1];
-    ds_1[2][2].set(-a2x,  a2y, -a2z);
-    ds_1[3][2].set( 0.0,  a2z,  a2y);
-    ds_1[2][3] = ds_1[3][2];
-    ds_1[3][3].set(-a2x, -a2y,  a2z);
+  // (this is also used by dQ0_1_dot() and dQ0_2_dot())
+  dQ0_proj.resize(4, 4);
+  if (b_qcp) {
+    calc_dQ0_projector_qcp();
+  } else {
+    for (size_t i = 0; i < 4; i++) {
+      for (size_t j = 0; j < 4; j++) {
+        dQ0_proj[i][j] = 0.0;
+        for (size_t k = 1; k < 4; k++) {
+          dQ0_proj[i][j] += S_eigvec[k][i] * S_eigvec[k][j] /
+            (L0 - S_eigval[k]);
+        }
+      }
+    }
+  }
 
+  // matrix multiplications; derivatives of L_0 and Q_0 are
+  // calculated using Hellmann-Feynman theorem (i.e. exploiting the
+  // fact that the eigenvectors Q_i form an orthonormal basis)
+  size_t ia;
+  cvm::rvector ds_q0[4];
+  for (ia = 0; ia < dQ0_1.size(); ia++) {
+    calc_dS_dot_q(pos2[ia], 1.0, Q0, ds_q0);
     cvm::rvector                &dl0_1 = dL0_1[ia];
     cvm::vector1d<cvm::rvector> &dq0_1 = dQ0_1[ia];
-
-    // matrix multiplications; derivatives of L_0 and Q_0 are
-    // calculated using Hellmann-Feynman theorem (i.e. exploiting the
-    // fact that the eigenvectors Q_i form an orthonormal basis)
-
     dl0_1.reset();
     for (size_t i = 0; i < 4; i++) {
-      for (size_t j = 0; j < 4; j++) {
-        dl0_1 += Q0[i] * ds_1[i][j] * Q0[j];
-      }
+      dl0_1 += Q0[i] * ds_q0[i];
     }
-
     dq0_1.reset();
     for (size_t p = 0; p < 4; p++) {
       for (size_t i = 0; i < 4; i++) {
-        for (size_t j = 0; j < 4; j++) {
-          dq0_1[p] +=
-            (Q1[i] * ds_1[i][j] * Q0[j]) / (L0-L1) * Q1[p] +
-            (Q2[i] * ds_1[i][j] * Q0[j]) / (L0-L2) * Q2[p] +
-            (Q3[i] * ds_1[i][j] * Q0[j]) / (L0-L3) * Q3[p];
-        }
+        dq0_1[p] += dQ0_proj[p][i] * ds_q0[i];
       }
     }
   }
 
   // do the same for the second group
-  for (ia = 0; ia < dS_2.size(); ia++) {
-
-    cvm::real const &a1x = pos1[ia].x;
-    cvm::real const &a1y = pos1[ia].y;
-    cvm::real const &a1z = pos1[ia].z;
-
-    cvm::matrix2d<cvm::rvector> &ds_2 = dS_2[ia];
-
-    ds_2.reset();
-    ds_2[0][0].set( a1x,  a1y,  a1z);
-    ds_2[1][0].set( 0.0, -a1z,  a1y);
-    ds_2[0][1] = ds_2[1][0];
-    ds_2[2][0].set( a1z,  0.0, -a1x);
-    ds_2[0][2] = ds_2[2][0];
-    ds_2[3][0].set(-a1y,  a1x,  0.0);
-    ds_2[0][3] = ds_2[3][0];
-    ds_2[1][1].set( a1x, -a1y, -a1z);
-    ds_2[2][1].set( a1y,  a1x,  0.0);
-    ds_2[1][2] = ds_2[2][1];
-    ds_2[3][1].set( a1z,  0.0,  a1x);
-    ds_2[1][3] = ds_2[3][1];
-    ds_2[2][2].set(-a1x,  a1y, -a1z);
-    ds_2[3][2].set( 0.0,  a1z,  a1y);
-    ds_2[2][3] = ds_2[3][2];
-    ds_2[3][3].set(-a1x, -a1y,  a1z);
-
+  for (ia = 0; ia < dQ0_2.size(); ia++) {
+    calc_dS_dot_q(pos1[ia], -1.0, Q0, ds_q0);
     cvm::rvector                &dl0_2 = dL0_2[ia];
     cvm::vector1d<cvm::rvector> &dq0_2 = dQ0_2[ia];
-
     dl0_2.reset();
     for (size_t i = 0; i < 4; i++) {
-      for (size_t j = 0; j < 4; j++) {
-        dl0_2 += Q0[i] * ds_2[i][j] * Q0[j];
-      }
+      dl0_2 += Q0[i] * ds_q0[i];
     }
-
     dq0_2.reset();
     for (size_t p = 0; p < 4; p++) {
       for (size_t i = 0; i < 4; i++) {
-        for (size_t j = 0; j < 4; j++) {
-          dq0_2[p] +=
-            (Q1[i] * ds_2[i][j] * Q0[j]) / (L0-L1) * Q1[p] +
-            (Q2[i] * ds_2[i][j] * Q0[j]) / (L0-L2) * Q2[p] +
-            (Q3[i] * ds_2[i][j] * Q0[j]) / (L0-L3) * Q3[p];
-        }
+        dq0_2[p] += dQ0_proj[p][i] * ds_q0[i];
       }
     }
+  }
+
+  if (b_debug_gradients) {
+
+    cvm::matrix2d<cvm::rvector> ds_2(4, 4);
+    cvm::matrix2d<cvm::real> S_new(4, 4);
+    cvm::vector1d<cvm::real> S_new_eigval(4);
+    cvm::matrix2d<cvm::real> S_new_eigvec(4, 4);
 
-    if (b_debug_gradients) {
+    for (ia = 0; ia < pos2.size(); ia++) {
+
+      // derivatives of L0 and Q0 wrt this atom of the second group
+      calc_dS_dot_q(pos1[ia], -1.0, Q0, ds_q0);
+      cvm::rvector dl0_2(0.0);
+      cvm::rvector dq0_2[4];
+      for (size_t p = 0; p < 4; p++) {
+        dl0_2 += Q0[p] * ds_q0[p];
+        dq0_2[p].reset();
+        for (size_t i = 0; i < 4; i++) {
+          dq0_2[p] += dQ0_proj[p][i] * ds_q0[i];
+        }
+      }
 
-      cvm::matrix2d<cvm::real> S_new(4, 4);
-      cvm::vector1d<cvm::real> S_new_eigval(4);
-      cvm::matrix2d<cvm::real> S_new_eigvec(4, 4);
+      build_dS(pos1[ia], -1.0, ds_2);
 
       // make an infitesimal move along each cartesian coordinate of
       // this atom, and solve again the eigenvector problem
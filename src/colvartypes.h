@@ -1352,29 +1352,50 @@ public:
   /// Used for debugging gradients
   cvm::matrix2d<cvm::real> S_backup;
 
-  /// Derivatives of S
-  std::vector< cvm::matrix2d<cvm::rvector> > dS_1,  dS_2;
   /// Derivatives of leading eigenvalue
   std::vector< cvm::rvector >                dL0_1, dL0_2;
   /// Derivatives of leading eigenvector
   std::vector< cvm::vector1d<cvm::rvector> > dQ0_1, dQ0_2;
 
-  /// Allocate space for the derivatives of the rotation
+  /// \brief Sum over the other eigenvectors of S of Q_k Q_k^T / (L_0 - L_k),
+  /// which maps dS Q_0 onto the derivative of Q_0
+  cvm::matrix2d<cvm::real> dQ0_proj;
+
+  /// \brief Allocate space for the derivatives of the rotation with respect
+  /// to the first group (only needed when all components of dQ0_1 are used:
+  /// see dQ0_1_dot() otherwise)
   inline void request_group1_gradients(size_t n)
   {
-    dS_1.resize(n, cvm::matrix2d<cvm::rvector>(4, 4));
     dL0_1.resize(n, cvm::rvector(0.0, 0.0, 0.0));
     dQ0_1.resize(n, cvm::vector1d<cvm::rvector>(4));
   }
 
-  /// Allocate space for the derivatives of the rotation
+  /// \brief Allocate space for the derivatives of the rotation with respect
+  /// to the second group (only needed when all components of dQ0_2 are used:
+  /// see dQ0_2_dot() otherwise)
   inline void request_group2_gradients(size_t n)
   {
-    dS_2.resize(n, cvm::matrix2d<cvm::rvector>(4, 4));
     dL0_2.resize(n, cvm::rvector(0.0, 0.0, 0.0));
     dQ0_2.resize(n, cvm::vector1d<cvm::rvector>(4));
   }
 
+  /// \brief Return sum_p v_p dQ0_p/dx for one atom of the first group, given
+  /// the position of the matching atom in the second group; this only uses
+  /// data computed by calc_optimal_rotation() for all groups
+  inline cvm::rvector dQ0_1_dot(cvm::atom_pos const &pos2,
+                                cvm::quaternion const &v) const
+  {
+    return dQ0_dot(pos2, 1.0, v);
+  }
+
+  /// \brief Return sum_p v_p dQ0_p/dx for one atom of the second group,
+  /// given the position of the matching atom in the first group
+  inline cvm::rvector dQ0_2_dot(cvm::atom_pos const &pos1,
+                                cvm::quaternion const &v) const
+  {
+    return dQ0_dot(pos1, -1.0, v);
+  }
+
   /// \brief Calculate the optimal rotation and store the
   /// corresponding eigenvalue and eigenvector in the arguments l0 and
   /// q0; if the gradients have been previously requested, calculate
@@ -1388,6 +1409,30 @@ public:
   void calc_optimal_rotation(std::vector<atom_pos> const &pos1,
                              std::vector<atom_pos> const &pos2);
 
+  /// \brief Same as above, with the first set of positions given as separate
+  /// arrays of Cartesian components (see cvm::atom_group::pos_x)
+  void calc_optimal_rotation(std::vector<cvm::real> const &pos1_x,
+                             std::vector<cvm::real> const &pos1_y,
+                             std::vector<cvm::real> const &pos1_z,
+                             std::vector<atom_pos> const &pos2);
+
+  /// \brief Same as above, with the second set of positions given as
+  /// separate arrays of Cartesian components, each position being shifted by
+  /// shift2 (e.g. to center it)
+  void calc_optimal_rotation(std::vector<atom_pos> const &pos1,
+                             std::vector<cvm::real> const &pos2_x,
+                             std::vector<cvm::real> const &pos2_y,
+                             std::vector<cvm::real> const &pos2_z,
+                             cvm::rvector const &shift2);
+
+  /// \brief Steps of calc_optimal_rotation() that follow the calculation of
+  /// C, when the caller has already set C (e.g. for many sets of reference
+  /// positions at once); pos1 (pos2) may be empty unless derivatives wrt the
+  /// second (first) group, or gradient tests, are needed: an error is raised
+  /// otherwise
+  void calc_optimal_rotation_from_C(std::vector<cvm::atom_pos> const &pos1,
+                                    std::vector<cvm::atom_pos> const &pos2);
+
   /// Default constructor
   rotation();
 
@@ -1508,6 +1553,11 @@ public:
   /// \brief Threshold for the eigenvalue crossing test
   static cvm::real crossing_threshold;
 
+  /// \brief Whether to compute the leading eigenpair of S by Newton
+  /// iteration on its characteristic polynomial (QCP, Theobald 2005),
+  /// falling back to the Jacobi diagonalization only when that fails
+  static bool use_qcp;
+
 protected:
 
   /// \brief Previous value of the rotation (used to warn the user
@@ -1519,9 +1569,47 @@ protected:
   void build_correlation_matrix(std::vector<cvm::atom_pos> const &pos1,
                                 std::vector<cvm::atom_pos> const &pos2);
 
+  /// Build the correlation matrix C from separate arrays of components
+  void build_correlation_matrix(std::vector<cvm::real> const &pos1_x,
+                                std::vector<cvm::real> const &pos1_y,
+                                std::vector<cvm::real> const &pos1_z,
+                                std::vector<cvm::atom_pos> const &pos2);
+
+  /// \brief Build the correlation matrix C from separate arrays of
+  /// components of the second group
+  void build_correlation_matrix(std::vector<cvm::atom_pos> const &pos1,
+                                std::vector<cvm::real> const &pos2_x,
+                                std::vector<cvm::real> const &pos2_y,
+                                std::vector<cvm::real> const &pos2_z);
+
   /// Compute the overlap matrix S (used by calc_optimal_rotation())
   void compute_overlap_matrix();
 
+  /// \brief Compute only the leading eigenvalue and eigenvector of S (stored
+  /// in S_eigval[0] and S_eigvec[0]) with the QCP method:
+  /// Theobald DL. Rapid calculation of RMSDs using a quaternion-based
+  /// characteristic polynomial. Acta Cryst A 61(4):478-80 (2005)
+  /// DOI: 10.1107/S0108767305015266
+  /// Returns COLVARS_ERROR if the leading eigenvalue is (nearly) degenerate
+  int calc_leading_eigenpair_qcp();
+
+  /// Compute dQ0_proj from the leading eigenpair of S only
+  void calc_dQ0_projector_qcp();
+
+  /// \brief Derivatives of S with respect to one atom, given the position a
+  /// of the matching atom in the other group (s = 1 for the first group,
+  /// s = -1 for the second)
+  static void build_dS(cvm::atom_pos const &a, cvm::real s,
+                       cvm::matrix2d<cvm::rvector> &ds);
+
+  /// \brief Compute dS Q (with dS as in build_dS()) without building dS
+  static void calc_dS_dot_q(cvm::atom_pos const &a, cvm::real s,
+                            cvm::quaternion const &Q, cvm::rvector ds_q[4]);
+
+  /// Implementation of dQ0_1_dot() and dQ0_2_dot()
+  cvm::rvector dQ0_dot(cvm::atom_pos const &a, cvm::real s,
+                       cvm::quaternion const &v) const;
+
   /// Pointer to instance of Jacobi solver
   void *jacobi;
 };
@@ -105,6 +105,9 @@ write_colvars_config "dihedralwalls" "" ${dirname}/test.legacy.in
 create_test_dir "distance-wall-bypassExtended-off"
 write_colvars_config "distance-extended" "harmonicwalls-bypassExtended-off" ${dirname}/test.in
 
+create_test_dir "distancepairslist_harmonicwallsvector"
+write_colvars_config "distancepairslist" "harmonicwallsvector" ${dirname}/test.in
+
 # Tests for each colvar without a bias
 for colvar in \
     "distance" \
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+
+#include "colvarmodule.h"
+#include "colvarproxy_test.h"
+
+
+// Check that output files written by the background thread (asyncOutput)
+// have the same contents as those written directly, also when the maximum
+// size of the pending data is changed while the files are open
+
+namespace {
+
+size_t const num_atoms = 4;
+size_t const num_steps = 1500;
+
+/// Output modes compared by the test
+enum output_mode {
+  output_sync,
+  output_async,
+  /// Asynchronous, with a pending data limit of one byte from halfway on
+  output_async_resized
+};
+
+std::string output_prefix(output_mode mode)
+{
+  return "async_output_" + cvm::to_str(int(mode));
+}
+
+std::string config(output_mode mode)
+{
+  std::ostringstream os;
+  os << "colvarsTrajFrequency 1\n"
+     << "colvarsRestartFrequency 100\n"
+     << "asyncOutput " << ((mode == output_sync) ? "off" : "on") << "\n"
+     << "asyncOutputBufferSize 1\n";
+  for (size_t k = 0; k < 3; k++) {
+    os << "colvar {\n"
+       << "  name d" << k+1 << "\n"
+       << "  outputAppliedForce on\n"
+       << "  distance {\n"
+       << "    group1 {\n"
+       << "      atomNumbers " << k+1 << "\n"
+       << "    }\n"
+       << "    group2 {\n"
+       << "      atomNumbers " << k+2 << "\n"
+       << "    }\n"
+       << "  }\n"
+       << "}\n"
+       << "harmonic {\n"
+       << "  colvars d" << k+1 << "\n"
+       << "  centers 1.5\n"
+       << "  forceConstant 2.0\n"
+       << "  outputEnergy on\n"
+       << "}\n";
+  }
+  return os.str();
+}
+
+int run(output_mode mode)
+{
+  colvarproxy_test *proxy = new colvarproxy_test();
+  proxy->output_prefix() = output_prefix(mode);
+  proxy->restart_output_prefix() = output_prefix(mode) + ".restart";
+  if ((proxy->colvars->read_config_string(config(mode)) != COLVARS_OK) ||
+      (proxy->colvars->setup_output() != COLVARS_OK)) {
+    std::cerr << "Error: cannot set up the module." << std::endl;
+    delete proxy;
+    return 1;
+  }
+  std::srand(13);
+  for (size_t step = 0; step < num_steps; step++) {
+    if ((mode == output_async_resized) && (step == num_steps/2)) {
+      proxy->set_async_output(true, 1);
+    }
+    if (colvarproxy_test_utils::calc_random_step(proxy, num_atoms,
+                                                 cvm::rvector(1.5, 0.0, 0.0),
+                                                 0.3)) {
+      delete proxy;
+      return 1;
+    }
+  }
+  int const error_code =
+    proxy->colvars->write_restart_file(output_prefix(mode) + ".colvars.state") |
+    proxy->drain_output_streams();
+  delete proxy;
+  if (error_code != COLVARS_OK) {
+    std::cerr << "Error: cannot write the output files." << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  output_mode const modes[3] = { output_sync, output_async,
+                                 output_async_resized };
+  char const *suffixes[3] = { ".colvars.traj", ".colvars.state",
+                              ".restart.colvars.state" };
+
+  int error_code = 0;
+  for (size_t m = 0; m < 3; m++) {
+    error_code = error_code || run(modes[m]);
+  }
+
+  int failures = 0;
+  for (size_t f = 0; (f < 3) && !error_code; f++) {
+    std::string const ref_filename = output_prefix(output_sync) + suffixes[f];
+    std::string const ref = colvarproxy_test_utils::read_file(ref_filename);
+    if (ref.size() == 0) {
+      std::cerr << "Error: file \"" << ref_filename << "\" is empty."
+                << std::endl;
+      failures++;
+    }
+    for (size_t m = 1; m < 3; m++) {
+      std::string const filename = output_prefix(modes[m]) + suffixes[f];
+      if (colvarproxy_test_utils::read_file(filename) != ref) {
+        std::cerr << "Error: file \"" << filename << "\" differs from \""
+                  << ref_filename << "\"." << std::endl;
+        failures++;
+      }
+    }
+  }
+
+  for (size_t m = 0; m < 3; m++) {
+    for (size_t f = 0; f < 3; f++) {
+      std::remove((output_prefix(modes[m]) + suffixes[f]).c_str());
+    }
+  }
+  if (error_code) {
+    return 1;
+  }
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Asynchronous and direct output files are identical.");
+}
@@ -0,0 +1,228 @@
+#include <iostream>
+#include <map>
+#include <cstdlib>
+
+#include "colvarmodule.h"
+#include "colvarproxy_test.h"
+
+
+// Check the slots of the atoms requested from the proxy (find_atom_slot(),
+// init_atoms() and reserve_atoms()): request the same atoms repeatedly, one
+// at a time or in bulk, and check their slots and copy counts, also after
+// releasing them
+
+namespace {
+
+int const max_atom_number = 3000;
+size_t const num_rounds = 40;
+size_t const round_size = 500;
+
+/// Proxy whose init_atoms() can either use the default implementation
+/// (init_atom() for each atom) or init_atom_slots(), as the engine proxies
+class colvarproxy_slots_test : public colvarproxy_test {
+public:
+
+  bool bulk;
+
+  colvarproxy_slots_test(bool bulk_in) : bulk(bulk_in) {}
+
+  int init_atoms(std::vector<int> const &atom_numbers,
+                 std::vector<int> &indices)
+  {
+    if (!bulk) {
+      return colvarproxy_test::init_atoms(atom_numbers, indices);
+    }
+    std::vector<int> ids(atom_numbers.size());
+    for (size_t i = 0; i < atom_numbers.size(); i++) {
+      ids[i] = check_atom_id(atom_numbers[i]);
+    }
+    return init_atom_slots(ids, indices);
+  }
+
+  /// Add a slot without add_atom_slot(), as done by some engines
+  void add_slot_directly(int atom_id)
+  {
+    atoms_ids.push_back(atom_id);
+    atoms_ncopies.push_back(1);
+    atoms_masses.push_back(1.0);
+    atoms_charges.push_back(0.0);
+    atoms_positions.push_back(cvm::rvector(0.0));
+    atoms_total_forces.push_back(cvm::rvector(0.0));
+    atoms_new_colvar_forces.push_back(cvm::rvector(0.0));
+  }
+
+  size_t num_slots() const
+  {
+    return atoms_ids.size();
+  }
+
+  size_t capacity() const
+  {
+    return atoms_ids.capacity();
+  }
+
+  size_t num_copies(int index) const
+  {
+    return atoms_ncopies[index];
+  }
+
+  int find_slot(int atom_id)
+  {
+    return find_atom_slot(atom_id);
+  }
+};
+
+/// Expected state of the slots: IDs in order of request, and copy counts
+struct slots_model {
+  std::vector<int> ids;
+  std::map<int, size_t> copies;
+  void request(int atom_id)
+  {
+    if (copies.find(atom_id) == copies.end()) {
+      ids.push_back(atom_id);
+      copies[atom_id] = 0;
+    }
+    copies[atom_id] += 1;
+  }
+};
+
+int check_slots(char const *label, colvarproxy_slots_test *proxy,
+                slots_model &model)
+{
+  if (proxy->num_slots() != model.ids.size()) {
+    std::cerr << "Error: " << label << ": " << proxy->num_slots()
+              << " slots instead of " << model.ids.size() << "." << std::endl;
+    return 1;
+  }
+  for (size_t k = 0; k < model.ids.size(); k++) {
+    int const id = model.ids[k];
+    if ((proxy->get_atom_id(k) != id) || (proxy->find_slot(id) != int(k)) ||
+        (proxy->num_copies(k) != model.copies[id])) {
+      std::cerr << "Error: " << label << ": slot " << k << " has ID "
+                << proxy->get_atom_id(k) << " and " << proxy->num_copies(k)
+                << " copies, instead of ID " << id << " and "
+                << model.copies[id] << " copies." << std::endl;
+      return 1;
+    }
+  }
+  if (proxy->find_slot(2*max_atom_number) != -1) {
+    std::cerr << "Error: " << label << ": found a slot for an atom that was "
+              << "not requested." << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+/// Check the slots of the atoms given in indices
+int check_indices(char const *label, colvarproxy_slots_test *proxy,
+                  std::vector<int> const &numbers,
+                  std::vector<int> const &indices)
+{
+  if (indices.size() != numbers.size()) {
+    std::cerr << "Error: " << label << ": " << indices.size()
+              << " indices for " << numbers.size() << " atoms." << std::endl;
+    return 1;
+  }
+  for (size_t i = 0; i < numbers.size(); i++) {
+    if ((indices[i] < 0) || (proxy->get_atom_id(indices[i]) != numbers[i]-1)) {
+      std::cerr << "Error: " << label << ": atom number " << numbers[i]
+                << " has the slot " << indices[i] << "." << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int run(bool bulk)
+{
+  char const *label = bulk ? "bulk" : "one at a time";
+  colvarproxy_slots_test *proxy = new colvarproxy_slots_test(bulk);
+  slots_model model;
+  int failures = 0;
+
+  proxy->reserve_atoms(max_atom_number);
+  if (proxy->capacity() < size_t(max_atom_number)) {
+    std::cerr << "Error: " << label << ": memory for "
+              << proxy->capacity() << " atoms was reserved instead of "
+              << max_atom_number << "." << std::endl;
+    failures++;
+  }
+
+  std::srand(29);
+  for (size_t round = 0; (round < num_rounds) && !failures; round++) {
+    std::vector<int> numbers(round_size), indices;
+    for (size_t i = 0; i < round_size; i++) {
+      // the range grows with each round, so that new atoms are mixed with
+      // atoms requested before
+      numbers[i] = 1 + std::rand() % (max_atom_number * (round+1) / num_rounds);
+      model.request(numbers[i]-1);
+    }
+    if (round % 2) {
+      for (size_t i = 0; i < round_size; i++) {
+        indices.push_back(proxy->init_atom(numbers[i]));
+      }
+    } else {
+      proxy->init_atoms(numbers, indices);
+    }
+    failures += check_indices(label, proxy, numbers, indices);
+    if (round == num_rounds/2) {
+      // atoms_ids is changed without updating the table of the slots
+      proxy->add_slot_directly(max_atom_number);
+      model.request(max_atom_number);
+    }
+  }
+  failures += check_slots(label, proxy, model);
+
+  if (bulk) {
+    // invalid atom numbers are reported (with the same code as init_atom()),
+    // but the others are requested
+    std::vector<int> numbers, indices;
+    numbers.push_back(1);
+    numbers.push_back(0);
+    numbers.push_back(2);
+    if ((proxy->init_atoms(numbers, indices) == COLVARS_OK) ||
+        (indices.size() != 3) || (indices[1] != INPUT_ERROR)) {
+      std::cerr << "Error: " << label << ": an invalid atom number was "
+                << "accepted." << std::endl;
+      failures++;
+    }
+    model.request(0);
+    model.request(1);
+  }
+
+  // Release all copies; the slots are kept, and reused when the atoms are
+  // requested again
+  for (size_t k = 0; k < model.ids.size(); k++) {
+    for (size_t c = 0; c < model.copies[model.ids[k]]; c++) {
+      proxy->clear_atom(k);
+    }
+    model.copies[model.ids[k]] = 0;
+  }
+  failures += check_slots("released", proxy, model);
+  {
+    std::vector<int> numbers, indices;
+    for (int n = 1; n <= 10; n++) {
+      numbers.push_back(n);
+      model.request(n-1);
+    }
+    proxy->init_atoms(numbers, indices);
+    failures += check_indices(label, proxy, numbers, indices);
+    failures += check_slots("requested again", proxy, model);
+  }
+
+  cvm::clear_error();
+  delete proxy;
+  return failures;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  int const failures = run(false) + run(true);
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Atom slots and copy counts are correct, for atoms requested one at a "
+    "time and in bulk.");
+}
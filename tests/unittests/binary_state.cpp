@@ -0,0 +1,158 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+
+#include "colvarmodule.h"
+#include "colvarproxy_test.h"
+
+
+// Check that a state file in the binary format restores the same state as
+// the text format, and that a corrupted binary state file is rejected
+
+namespace {
+
+size_t const num_atoms = 4;
+size_t const num_steps = 40;
+
+std::string const binary_name("binary_state_binary.colvars.state");
+std::string const text_name("binary_state_text.colvars.state");
+std::string const restored_name("binary_state_restored.colvars.state");
+
+/// A metadynamics bias on a grid and a moving restraint, whose states
+/// include both numbers and grids
+std::string const config =
+  "colvar {\n"
+  "  name d\n"
+  "  width 0.2\n"
+  "  lowerBoundary 0.0\n"
+  "  upperBoundary 6.0\n"
+  "  distance {\n"
+  "    group1 {\n"
+  "      atomNumbers 1 2\n"
+  "    }\n"
+  "    group2 {\n"
+  "      atomNumbers 3 4\n"
+  "    }\n"
+  "  }\n"
+  "}\n"
+  "metadynamics {\n"
+  "  name meta\n"
+  "  colvars d\n"
+  "  hillWeight 0.1\n"
+  "  hillWidth 1.0\n"
+  "  newHillFrequency 5\n"
+  "}\n"
+  "harmonic {\n"
+  "  name h\n"
+  "  colvars d\n"
+  "  centers 2.0\n"
+  "  forceConstant 1.0\n"
+  "  targetCenters 3.0\n"
+  "  targetNumSteps 100\n"
+  "}\n";
+
+/// Proxy that records whether any error was reported
+class colvarproxy_state_test : public colvarproxy_test {
+public:
+  bool found_error;
+  colvarproxy_state_test() : found_error(false) {}
+  void error(std::string const &message)
+  {
+    found_error = true;
+    colvarproxy_test::error(message);
+  }
+};
+
+/// Run the simulation, and write its state in both formats
+int write_states()
+{
+  colvarproxy_test *proxy = new colvarproxy_test();
+  if (proxy->colvars->read_config_string(config) != COLVARS_OK) {
+    std::cerr << "Error: cannot read the configuration." << std::endl;
+    delete proxy;
+    return 1;
+  }
+  std::srand(17);
+  for (size_t step = 0; step < num_steps; step++) {
+    if (colvarproxy_test_utils::calc_random_step(proxy, num_atoms,
+                                                 cvm::rvector(1.0, 0.0, 0.0),
+                                                 0.3)) {
+      delete proxy;
+      return 1;
+    }
+  }
+  int error_code =
+    proxy->colvars->read_config_string("colvarsStateFormat binary\n") |
+    proxy->colvars->write_restart_file(binary_name) |
+    proxy->colvars->read_config_string("colvarsStateFormat text\n") |
+    proxy->colvars->write_restart_file(text_name);
+  delete proxy;
+  if (error_code != COLVARS_OK) {
+    std::cerr << "Error: cannot write the state files." << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+/// Load the binary state file in a new module; if valid, write the state
+/// restored in the text format
+int restore_state(bool &found_error)
+{
+  colvarproxy_state_test *proxy = new colvarproxy_state_test();
+  int error_code = proxy->colvars->read_config_string(config);
+  proxy->input_prefix() = binary_name;
+  error_code |= proxy->colvars->setup_input();
+  found_error = proxy->found_error || (error_code != COLVARS_OK);
+  if (!found_error) {
+    error_code |= proxy->colvars->write_restart_file(restored_name);
+  }
+  cvm::clear_error();
+  delete proxy;
+  return (found_error || (error_code == COLVARS_OK)) ? 0 : 1;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  int failures = 0;
+  bool found_error = false;
+
+  if (write_states() || restore_state(found_error)) {
+    return 1;
+  }
+  if (found_error) {
+    std::cerr << "Error: cannot load the binary state file." << std::endl;
+    failures++;
+  } else if (colvarproxy_test_utils::read_file(restored_name) !=
+             colvarproxy_test_utils::read_file(text_name)) {
+    std::cerr << "Error: the state restored from \"" << binary_name
+              << "\" differs from \"" << text_name << "\"." << std::endl;
+    failures++;
+  }
+
+  // Change one byte of the last section of the binary file
+  std::string contents = colvarproxy_test_utils::read_file(binary_name);
+  contents[contents.size() - 8] ^= 0x01;
+  {
+    std::ofstream os(binary_name.c_str(), std::ios::binary);
+    os << contents;
+  }
+  if (restore_state(found_error)) {
+    return 1;
+  }
+  if (!found_error) {
+    std::cerr << "Error: the corrupted binary state file was accepted."
+              << std::endl;
+    failures++;
+  }
+
+  std::remove(binary_name.c_str());
+  std::remove(text_name.c_str());
+  std::remove(restored_name.c_str());
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "The binary state file restores the same state as the text one, and its "
+    "corruption is detected.");
+}
@@ -0,0 +1,201 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+#include "colvarmodule.h"
+#include "colvaratoms.h"
+#include "colvarproxy_test.h"
+
+
+// Check that large atom selections added in bulk (add_atoms(),
+// add_atom_ids(), and index groups read with cvm::mapped_file) give the same
+// groups as adding one atom at a time, including repeated atoms and atoms
+// already in the group
+
+namespace {
+
+size_t const num_numbers = 20000;
+int const max_atom_number = 5000;
+
+std::string const index_filename("bulk_atom_selection.ndx");
+std::string const empty_filename("bulk_atom_selection_empty.ndx");
+
+/// Write an index file with a large group (written twice, which is allowed
+/// when the contents are identical) and a small one, using irregular
+/// white space between the numbers
+void write_index_file(std::vector<int> const &big,
+                      std::vector<int> const &small)
+{
+  std::ofstream os(index_filename.c_str());
+  char const *separators[] = { " ", "  ", "\t", "\n", " \n  " };
+  for (size_t copy = 0; copy < 2; copy++) {
+    os << "[ big ]\n";
+    for (size_t i = 0; i < big.size(); i++) {
+      os << big[i] << separators[std::rand() % 5];
+    }
+    os << "\n";
+  }
+  os << "[ small ]\n";
+  for (size_t i = 0; i < small.size(); i++) {
+    os << small[i] << " ";
+  }
+  os << "\n";
+  std::ofstream empty_os(empty_filename.c_str());
+}
+
+int check_mapped_file()
+{
+  int failures = 0;
+  cvm::mapped_file file;
+  if ((file.open(index_filename) != COLVARS_OK) ||
+      (std::string(file.data(), file.size()) !=
+       colvarproxy_test_utils::read_file(index_filename))) {
+    std::cerr << "Error: the mapped contents of \"" << index_filename
+              << "\" differ from the file." << std::endl;
+    failures++;
+  }
+  if ((file.open(empty_filename) != COLVARS_OK) || (file.size() != 0) ||
+      (file.data() != NULL)) {
+    std::cerr << "Error: the empty file \"" << empty_filename
+              << "\" is not mapped as empty." << std::endl;
+    failures++;
+  }
+  if ((file.open("bulk_atom_selection_missing.ndx") == COLVARS_OK) ||
+      (file.size() != 0)) {
+    std::cerr << "Error: a missing file was opened." << std::endl;
+    failures++;
+  }
+  return failures;
+}
+
+int check_index_groups(std::vector<int> const &big,
+                       std::vector<int> const &small)
+{
+  std::vector<std::string> const &names = cvm::main()->index_group_names;
+  std::vector<std::vector<int> *> const &groups = cvm::main()->index_groups;
+  if ((names.size() != 2) || (names[0] != "big") || (names[1] != "small") ||
+      (groups.size() != 2) || (*(groups[0]) != big) ||
+      (*(groups[1]) != small)) {
+    std::cerr << "Error: the index groups read from \"" << index_filename
+              << "\" differ from those written." << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+/// Compare the atoms of two groups, and their properties
+int compare_groups(char const *label, cvm::atom_group const &group,
+                   cvm::atom_group const &ref)
+{
+  if (group.ids() != ref.ids()) {
+    std::cerr << "Error: the IDs of the " << label << " group ("
+              << group.ids().size() << " atoms) differ from those added one "
+              << "at a time (" << ref.ids().size() << " atoms)." << std::endl;
+    return 1;
+  }
+  if (group.size() != ref.size()) {
+    std::cerr << "Error: the " << label << " group has " << group.size()
+              << " atoms instead of " << ref.size() << "." << std::endl;
+    return 1;
+  }
+  for (size_t i = 0; i < ref.size(); i++) {
+    if ((group[i].id != ref[i].id) ||
+        (group[i].proxy_index() != ref[i].proxy_index()) ||
+        (group[i].mass != ref[i].mass)) {
+      std::cerr << "Error: atom " << i << " of the " << label
+                << " group differs from that added one at a time."
+                << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  std::srand(23);
+  std::vector<int> big(num_numbers), small;
+  for (size_t i = 0; i < num_numbers; i++) {
+    big[i] = 1 + std::rand() % max_atom_number;
+  }
+  small.push_back(7);
+  small.push_back(3);
+  small.push_back(7);
+  small.push_back(max_atom_number);
+  write_index_file(big, small);
+
+  int failures = check_mapped_file();
+
+  colvarproxy_test *proxy = new colvarproxy_test();
+  if (proxy->colvars->read_config_string("indexFile " + index_filename +
+                                         "\n") != COLVARS_OK) {
+    std::cerr << "Error: cannot read \"" << index_filename << "\"."
+              << std::endl;
+    failures++;
+  } else {
+    failures += check_index_groups(big, small);
+  }
+  std::remove(index_filename.c_str());
+  std::remove(empty_filename.c_str());
+
+  // Reference: the atoms added one at a time
+  cvm::atom_group *ref = new cvm::atom_group("ref");
+  for (size_t i = 0; i < big.size(); i++) {
+    ref->add_atom(cvm::atom(big[i]));
+  }
+
+  // Index group, whose atoms are added in bulk
+  cvm::atom_group *from_index = new cvm::atom_group("from_index");
+  from_index->parse("indexGroup big\n");
+  failures += compare_groups("index", *from_index, *ref);
+
+  // Bulk addition after some of the atoms were added one at a time
+  cvm::atom_group *mixed = new cvm::atom_group("mixed");
+  for (size_t i = 0; i < big.size()/2; i++) {
+    mixed->add_atom(cvm::atom(big[i]));
+  }
+  std::vector<cvm::atom> new_atoms;
+  for (size_t i = 0; i < big.size(); i++) {
+    new_atoms.push_back(cvm::atom(big[i]));
+  }
+  mixed->add_atoms(new_atoms);
+  new_atoms.clear();
+  failures += compare_groups("mixed", *mixed, *ref);
+
+  // Atom IDs, as used by scalable groups, with an invalid ID in the list
+  {
+    cvm::atom_group ids_ref, ids_bulk;
+    std::vector<int> ids;
+    for (size_t i = 0; i < big.size(); i++) {
+      ids_ref.add_atom_id(big[i]-1);
+      ids.push_back(big[i]-1);
+      if (i == big.size()/3) {
+        ids.push_back(-1);
+      }
+    }
+    if (ids_bulk.add_atom_ids(ids) == COLVARS_OK) {
+      std::cerr << "Error: an invalid atom ID was accepted." << std::endl;
+      failures++;
+    }
+    if (ids_bulk.ids() != ids_ref.ids()) {
+      std::cerr << "Error: the atom IDs added in bulk ("
+                << ids_bulk.ids().size() << ") differ from those added one at "
+                << "a time (" << ids_ref.ids().size() << ")." << std::endl;
+      failures++;
+    }
+  }
+
+  delete from_index;
+  delete mixed;
+  delete ref;
+  cvm::clear_error();
+  delete proxy;
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Atoms added in bulk and from index files match those added one at a "
+    "time.");
+}
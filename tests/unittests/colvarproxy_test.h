@@ -0,0 +1,145 @@
+// -*- c++ -*-
+
+#ifndef COLVARPROXY_TEST_H
+#define COLVARPROXY_TEST_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "colvarmodule.h"
+#include "colvarproxy.h"
+
+
+/// \brief Minimal proxy used by the unit tests: atoms are added on request
+/// (numbers start from 1), positions and forces are accessed directly
+class colvarproxy_test : public colvarproxy {
+
+public:
+
+  colvarproxy_test()
+  {
+    angstrom_value = 1.0;
+    boundaries_type = boundaries_non_periodic;
+    colvars = new colvarmodule(this);
+  }
+
+  ~colvarproxy_test()
+  {
+    delete colvars;
+    colvars = NULL;
+  }
+
+  int init_atom(int atom_number)
+  {
+    int const aid = atom_number-1;
+    int const slot = find_atom_slot(aid);
+    if (slot >= 0) {
+      atoms_ncopies[slot] += 1;
+      return slot;
+    }
+    return add_atom_slot(aid);
+  }
+
+  int check_atom_id(int atom_number)
+  {
+    return atom_number-1;
+  }
+
+  /// Set the position of the atom with the given number
+  void set_atom_position(int atom_number, cvm::atom_pos const &pos)
+  {
+    int const slot = find_atom_slot(atom_number-1);
+    if (slot >= 0) atoms_positions[slot] = pos;
+  }
+
+  /// Set the mass of the atom with the given number (used by the atom
+  /// groups after colvarmodule::setup())
+  void set_atom_mass(int atom_number, cvm::real mass)
+  {
+    int const slot = find_atom_slot(atom_number-1);
+    if (slot >= 0) atoms_masses[slot] = mass;
+  }
+
+  /// Force applied by the module on the atom with the given number
+  cvm::rvector get_atom_force(int atom_number)
+  {
+    int const slot = find_atom_slot(atom_number-1);
+    return (slot >= 0) ? atoms_new_colvar_forces[slot] : cvm::rvector(0.0);
+  }
+
+  /// Run one step of the module with freshly cleared forces
+  int calc_step()
+  {
+    for (size_t i = 0; i < atoms_new_colvar_forces.size(); i++) {
+      atoms_new_colvar_forces[i].reset();
+    }
+    int const error_code = colvars->calc();
+    colvarmodule::it++;
+    return error_code;
+  }
+
+  /// Expose the slot lookup to the tests
+  int get_atom_slot(int atom_number)
+  {
+    return find_atom_slot(atom_number-1);
+  }
+};
+
+
+namespace colvarproxy_test_utils {
+
+  /// Uniform random number in [-1:1]
+  inline cvm::real random_real()
+  {
+    return 2.0 * (cvm::real(std::rand()) / cvm::real(RAND_MAX)) - 1.0;
+  }
+
+  /// Random position in a cube of the given half-side
+  inline cvm::atom_pos random_pos(cvm::real scale)
+  {
+    return scale * cvm::atom_pos(random_real(), random_real(), random_real());
+  }
+
+  /// Contents of a file (empty if it cannot be read)
+  inline std::string read_file(std::string const &filename)
+  {
+    std::ifstream is(filename.c_str(), std::ios::binary);
+    std::ostringstream os;
+    os << is.rdbuf();
+    return os.str();
+  }
+
+  /// \brief Place the atoms 1 to num_atoms at (i-1)*spacing, each displaced
+  /// by random_pos(noise), and run one step of the module
+  inline int calc_random_step(colvarproxy_test *proxy, size_t num_atoms,
+                              cvm::rvector const &spacing, cvm::real noise)
+  {
+    for (size_t i = 0; i < num_atoms; i++) {
+      proxy->set_atom_position(i+1, cvm::real(i) * spacing + random_pos(noise));
+    }
+    cvm::step_number const step = cvm::step_absolute();
+    if (proxy->calc_step() != COLVARS_OK) {
+      std::cerr << "Error: cannot compute step " << step << "." << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+
+  /// \brief Print the number of failures, or the given message if there are
+  /// none; returns the exit code of the test
+  inline int report_failures(int failures, std::string const &message)
+  {
+    if (failures) {
+      std::cerr << failures << " failures." << std::endl;
+      return 1;
+    }
+    std::cout << message << std::endl;
+    return 0;
+  }
+}
+
+#endif
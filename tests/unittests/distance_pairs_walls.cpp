@@ -0,0 +1,189 @@
+#include <iostream>
+#include <sstream>
+#include <cmath>
+
+#include "colvarmodule.h"
+#include "colvar.h"
+#include "colvarbias.h"
+#include "colvarproxy_test.h"
+
+
+// Check the values and atomic forces of a harmonicWallsVector restraint
+// applied to a distancePairsList variable and to a scalar distance, against
+// a direct calculation of the same quantities
+
+namespace {
+
+size_t const num_atoms = 6;
+
+// Pairs of atom numbers, and number of pairs in each element
+int const pairs[5][2] = { {1, 2}, {3, 4}, {5, 6}, {1, 4}, {2, 6} };
+size_t const group_sizes[3] = { 1, 2, 2 };
+int const exponent = 6;
+
+cvm::real const pairs_width = 0.5;
+cvm::real const lower_walls[4] = { 3.0, 3.0, 3.0, 3.5 };
+cvm::real const upper_walls[4] = { 4.0, 4.0, 5.0, 4.0 };
+cvm::real const lower_wall_k = 2.0;
+cvm::real const upper_wall_k = 8.0;
+
+cvm::real distance(std::vector<cvm::atom_pos> const &pos, int a1, int a2)
+{
+  return (pos[a2-1] - pos[a1-1]).norm();
+}
+
+/// Elements of the distancePairsList variable, followed by the distance
+/// between atoms 1 and 5
+std::vector<cvm::real> ref_values(std::vector<cvm::atom_pos> const &pos)
+{
+  std::vector<cvm::real> values;
+  size_t ip = 0;
+  for (size_t k = 0; k < 3; k++) {
+    if (group_sizes[k] == 1) {
+      values.push_back(distance(pos, pairs[ip][0], pairs[ip][1]));
+      ip++;
+      continue;
+    }
+    cvm::real sum = 0.0;
+    for (size_t j = 0; j < group_sizes[k]; j++, ip++) {
+      sum += std::pow(distance(pos, pairs[ip][0], pairs[ip][1]),
+                      -1.0*exponent);
+    }
+    values.push_back(std::pow(sum/cvm::real(group_sizes[k]),
+                              -1.0/cvm::real(exponent)));
+  }
+  values.push_back(distance(pos, 1, 5));
+  return values;
+}
+
+cvm::real ref_energy(std::vector<cvm::atom_pos> const &pos)
+{
+  std::vector<cvm::real> const values = ref_values(pos);
+  cvm::real energy = 0.0;
+  for (size_t ie = 0; ie < values.size(); ie++) {
+    cvm::real const w = (ie < 3) ? pairs_width : 1.0;
+    if (values[ie] < lower_walls[ie]) {
+      cvm::real const d = values[ie] - lower_walls[ie];
+      energy += 0.5 * lower_wall_k / (w*w) * d*d;
+    }
+    if (values[ie] > upper_walls[ie]) {
+      cvm::real const d = values[ie] - upper_walls[ie];
+      energy += 0.5 * upper_wall_k / (w*w) * d*d;
+    }
+  }
+  return energy;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  colvarproxy_test *proxy = new colvarproxy_test();
+
+  std::ostringstream conf;
+  conf << "colvar {\n"
+       << "  name pairs\n"
+       << "  width " << pairs_width << "\n"
+       << "  distancePairsList {\n"
+       << "    atomPairs {";
+  for (size_t ip = 0; ip < 5; ip++) {
+    conf << " " << pairs[ip][0] << " " << pairs[ip][1];
+  }
+  conf << " }\n"
+       << "    pairGroupSizes { 1 2 2 }\n"
+       << "    exponent " << exponent << "\n"
+       << "  }\n"
+       << "}\n"
+       << "colvar {\n"
+       << "  name d15\n"
+       << "  distance {\n"
+       << "    group1 { atomNumbers 1 }\n"
+       << "    group2 { atomNumbers 5 }\n"
+       << "  }\n"
+       << "}\n"
+       << "harmonicWallsVector {\n"
+       << "  name walls\n"
+       << "  colvars pairs d15\n"
+       << "  lowerWalls {";
+  for (size_t ie = 0; ie < 4; ie++) conf << " " << lower_walls[ie];
+  conf << " }\n  upperWalls {";
+  for (size_t ie = 0; ie < 4; ie++) conf << " " << upper_walls[ie];
+  conf << " }\n"
+       << "  lowerWallConstant " << lower_wall_k << "\n"
+       << "  upperWallConstant " << upper_wall_k << "\n"
+       << "}\n";
+
+  if (proxy->colvars->read_config_string(conf.str()) != COLVARS_OK) {
+    std::cerr << "Error: cannot read the configuration." << std::endl;
+    return 1;
+  }
+
+  // Chosen so that lower walls, upper walls and neither are all exercised
+  std::vector<cvm::atom_pos> pos(num_atoms);
+  pos[0] = cvm::atom_pos(0.0, 0.0, 0.0);
+  pos[1] = cvm::atom_pos(2.5, 0.0, 0.0);
+  pos[2] = cvm::atom_pos(0.0, 3.0, 0.0);
+  pos[3] = cvm::atom_pos(0.0, 3.0, 5.0);
+  pos[4] = cvm::atom_pos(4.0, 1.0, 1.0);
+  pos[5] = cvm::atom_pos(1.0, -1.0, 2.0);
+  for (size_t i = 0; i < num_atoms; i++) {
+    proxy->set_atom_position(i+1, pos[i]);
+  }
+
+  if (proxy->calc_step() != COLVARS_OK) {
+    std::cerr << "Error: cannot compute the variables." << std::endl;
+    return 1;
+  }
+
+  int failures = 0;
+  cvm::real const tol = 1.0e-8;
+
+  std::vector<cvm::real> const values = ref_values(pos);
+  colvarvalue const &x_pairs = cvm::colvar_by_name("pairs")->value();
+  colvarvalue const &x_d15 = cvm::colvar_by_name("d15")->value();
+  if (x_pairs.size() != 3) {
+    std::cerr << "Error: \"pairs\" has " << x_pairs.size()
+              << " elements instead of 3." << std::endl;
+    return 1;
+  }
+  for (size_t ie = 0; ie < 4; ie++) {
+    cvm::real const x = (ie < 3) ? x_pairs[ie] : x_d15.real_value;
+    if (cvm::fabs(x - values[ie]) > tol) {
+      std::cerr << "Error: element " << ie << " is " << x
+                << " instead of " << values[ie] << std::endl;
+      failures++;
+    }
+  }
+
+  cvm::real const energy = cvm::bias_by_name("walls")->get_energy();
+  cvm::real const energy_ref = ref_energy(pos);
+  if (energy_ref == 0.0 || cvm::fabs(energy - energy_ref) > tol) {
+    std::cerr << "Error: energy is " << energy << " instead of "
+              << energy_ref << std::endl;
+    failures++;
+  }
+
+  // Forces against finite differences of the reference energy
+  cvm::real const h = 1.0e-5;
+  for (size_t i = 0; i < num_atoms; i++) {
+    cvm::rvector const f = proxy->get_atom_force(i+1);
+    for (size_t d = 0; d < 3; d++) {
+      std::vector<cvm::atom_pos> pos_p(pos), pos_m(pos);
+      pos_p[i][d] += h;
+      pos_m[i][d] -= h;
+      cvm::real const f_ref = -1.0 * (ref_energy(pos_p) - ref_energy(pos_m)) /
+        (2.0 * h);
+      if (cvm::fabs(f[d] - f_ref) > 1.0e-5 * (1.0 + cvm::fabs(f_ref))) {
+        std::cerr << "Error: force component " << d << " on atom " << i+1
+                  << " is " << f[d] << " instead of " << f_ref << std::endl;
+        failures++;
+      }
+    }
+  }
+
+  delete proxy;
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Values, energy and forces match the reference.");
+}
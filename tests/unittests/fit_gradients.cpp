@@ -0,0 +1,221 @@
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+
+#include "colvarmodule.h"
+#include "colvarproxy.h"
+#include "colvar.h"
+#include "colvaratoms.h"
+
+
+// Check the fit gradients of an atom group with a separate fitting group
+// against the original O(N*M) algorithm, and that the eigenvector component
+// follows the fitted positions of its atoms
+
+namespace {
+
+/// Minimal proxy: atoms are added on request, positions are set by hand
+class test_proxy : public colvarproxy {
+public:
+  test_proxy()
+  {
+    colvars = new colvarmodule(this);
+  }
+  ~test_proxy()
+  {
+    delete colvars;
+    colvars = NULL;
+  }
+  int init_atom(int atom_number)
+  {
+    for (size_t i = 0; i < atoms_ids.size(); i++) {
+      if (atoms_ids[i] == atom_number-1) {
+        atoms_ncopies[i] += 1;
+        return i;
+      }
+    }
+    return add_atom_slot(atom_number-1);
+  }
+  int check_atom_id(int atom_number)
+  {
+    return atom_number-1;
+  }
+};
+
+cvm::real random_real()
+{
+  return 2.0 * (cvm::real(std::rand()) / cvm::real(RAND_MAX)) - 1.0;
+}
+
+cvm::atom_pos random_pos(cvm::real scale)
+{
+  return scale * cvm::atom_pos(random_real(), random_real(), random_real());
+}
+
+/// Value of the eigenvector colvar "ev" at the current positions
+cvm::real eigenvector_value(test_proxy *proxy)
+{
+  proxy->colvars->calc();
+  return cvm::main()->colvar_by_name("ev")->value().real_value;
+}
+
+/// Check that the eigenvector component is computed from the current
+/// positions: it must not change under a rigid roto-translation of its
+/// atoms, and must change when they are displaced along the vector
+int check_eigenvector(test_proxy *proxy)
+{
+  size_t const num_ev_atoms = 10;
+  std::vector<cvm::rvector> &positions = *(proxy->modify_atom_positions());
+
+  std::ostringstream conf;
+  conf << "colvar {\n  name ev\n  eigenvector {\n    atoms { atomNumbers {";
+  for (size_t i = 0; i < num_ev_atoms; i++) conf << " " << i+1;
+  conf << " } }\n    refPositions {";
+  for (size_t i = 0; i < num_ev_atoms; i++) {
+    conf << " " << cvm::to_str(positions[i] + random_pos(0.5));
+  }
+  conf << " }\n    vector {";
+  std::vector<cvm::rvector> vec(num_ev_atoms);
+  for (size_t i = 0; i < num_ev_atoms; i++) {
+    vec[i] = random_pos(1.0);
+    conf << " " << cvm::to_str(vec[i]);
+  }
+  conf << " }\n  }\n}\n";
+  if (proxy->colvars->read_config_string(conf.str()) != COLVARS_OK) {
+    std::cerr << "Error: cannot define the eigenvector colvar." << std::endl;
+    return 1;
+  }
+
+  int failures = 0;
+  cvm::real const x0 = eigenvector_value(proxy);
+
+  cvm::rotation const rot(-1.1, cvm::rvector(0.3, -0.5, 1.0));
+  for (size_t i = 0; i < num_ev_atoms; i++) {
+    positions[i] = rot.rotate(positions[i]) + cvm::atom_pos(5.0, 2.0, -3.0);
+  }
+  cvm::real const x1 = eigenvector_value(proxy);
+  if (cvm::fabs(x1 - x0) > 1.0e-8 * (1.0 + cvm::fabs(x0))) {
+    std::cerr << "Error: the eigenvector value changed from " << x0 << " to "
+              << x1 << " after a rigid roto-translation." << std::endl;
+    failures++;
+  }
+
+  for (size_t i = 0; i < num_ev_atoms; i++) {
+    positions[i] += rot.rotate(0.2 * vec[i]);
+  }
+  cvm::real const x2 = eigenvector_value(proxy);
+  if (cvm::fabs(x2 - x1) < 1.0e-3) {
+    std::cerr << "Error: the eigenvector value (" << x2 << ") did not change "
+              << "when the atoms were displaced along the vector." << std::endl;
+    failures++;
+  }
+
+  return failures;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  size_t const num_atoms = 50;
+  size_t const num_fit_atoms = 40;
+
+  std::srand(1);
+
+  test_proxy *proxy = new test_proxy();
+
+  std::ostringstream conf;
+  conf << "atomNumbers {";
+  for (size_t i = 0; i < num_atoms; i++) conf << " " << i+1;
+  conf << " }\n";
+  conf << "centerReference on\n"
+       << "rotateReference on\n"
+       << "fittingGroup {\n  atomNumbers {";
+  for (size_t i = 0; i < num_fit_atoms; i++) conf << " " << num_atoms+i+1;
+  conf << " }\n}\n";
+  conf << "refPositions {";
+  std::vector<cvm::atom_pos> ref_pos(num_fit_atoms);
+  for (size_t i = 0; i < num_fit_atoms; i++) {
+    ref_pos[i] = random_pos(10.0);
+    conf << " " << cvm::to_str(ref_pos[i]);
+  }
+  conf << " }\n";
+
+  cvm::atom_group *group = new cvm::atom_group("atoms");
+  if (group->parse(conf.str()) != COLVARS_OK) {
+    std::cerr << "Error: cannot parse atom group." << std::endl;
+    return 1;
+  }
+  group->setup();
+
+  // Full derivatives of the rotation, used by the reference calculation below
+  group->rot.request_group1_gradients(num_fit_atoms);
+
+  // Rotated and perturbed copy of the reference for the fitting group
+  std::vector<cvm::rvector> &positions = *(proxy->modify_atom_positions());
+  cvm::rotation const rot_ref(0.7, cvm::rvector(0.2, 1.0, -0.4));
+  for (size_t i = 0; i < positions.size(); i++) {
+    positions[i] = (i < num_atoms) ? random_pos(10.0) :
+      rot_ref.rotate(ref_pos[i-num_atoms]) + random_pos(0.5) +
+      cvm::atom_pos(3.0, -1.0, 2.0);
+  }
+
+  group->reset_atoms_data();
+  group->read_positions();
+  group->calc_required_properties();
+  for (size_t i = 0; i < group->size(); i++) {
+    (*group)[i].grad = random_pos(1.0);
+  }
+  group->calc_fit_gradients();
+
+  // Original algorithm
+  cvm::atom_group *fit_group = group->fitting_group;
+  std::vector<cvm::atom_pos> fit_gradients(fit_group->size());
+  {
+    cvm::rvector atom_grad;
+    for (size_t i = 0; i < group->size(); i++) {
+      atom_grad += (*group)[i].grad;
+    }
+    atom_grad = (group->rot.inverse()).rotate(atom_grad);
+    atom_grad *= (-1.0)/(cvm::real(fit_group->size()));
+    for (size_t j = 0; j < fit_group->size(); j++) {
+      fit_gradients[j] = atom_grad;
+    }
+    cvm::rotation const rot_inv = group->rot.inverse();
+    for (size_t i = 0; i < group->size(); i++) {
+      cvm::atom_pos const pos_orig =
+        rot_inv.rotate(group->position(i) - group->ref_pos_cog);
+      cvm::quaternion const dxdq =
+        group->rot.q.position_derivative_inner(pos_orig, (*group)[i].grad);
+      for (size_t j = 0; j < fit_group->size(); j++) {
+        for (size_t iq = 0; iq < 4; iq++) {
+          fit_gradients[j] += dxdq[iq] * group->rot.dQ0_1[j][iq];
+        }
+      }
+    }
+  }
+
+  cvm::real max_diff = 0.0, max_norm = 0.0;
+  for (size_t j = 0; j < fit_group->size(); j++) {
+    cvm::real const diff = (fit_group->fit_gradients[j] - fit_gradients[j]).norm();
+    if (diff > max_diff) max_diff = diff;
+    if (fit_gradients[j].norm() > max_norm) max_norm = fit_gradients[j].norm();
+  }
+
+  std::cout << "max |fit gradient|            = "
+            << cvm::to_str(max_norm, cvm::cv_width, cvm::cv_prec) << std::endl;
+  std::cout << "max |fit gradient difference| = "
+            << cvm::to_str(max_diff, cvm::cv_width, cvm::cv_prec) << std::endl;
+
+  delete group;
+
+  int const ev_failures = check_eigenvector(proxy);
+  delete proxy;
+
+  if (max_diff > 1.0e-10 * max_norm) {
+    std::cerr << "Error: fit gradients differ from the reference." << std::endl;
+    return 1;
+  }
+  return ev_failures ? 1 : 0;
+}
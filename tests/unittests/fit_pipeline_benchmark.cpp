@@ -0,0 +1,111 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+#include "colvarmodule.h"
+#include "colvartypes.h"
+
+
+// Time the steps of the optimal-fit pipeline of atom groups (correlation
+// matrix + eigenvector, rotation of the coordinates) on synthetic
+// coordinates, using either an array of vectors or a structure of arrays
+
+namespace {
+
+cvm::real random_real()
+{
+  return 2.0 * (cvm::real(std::rand()) / cvm::real(RAND_MAX)) - 1.0;
+}
+
+}
+
+
+extern "C" int main(int argc, char *argv[]) {
+
+  size_t const num_atoms = (argc > 1) ? std::atoi(argv[1]) : 10000;
+  size_t const num_iter = (argc > 2) ? std::atoi(argv[2]) : 1000;
+
+  std::srand(1);
+
+  std::vector<cvm::atom_pos> pos1(num_atoms), pos2(num_atoms);
+  std::vector<cvm::real> pos1_x(num_atoms), pos1_y(num_atoms),
+    pos1_z(num_atoms);
+  cvm::rotation const rot_ref(1.0, cvm::rvector(0.3, -0.5, 0.8));
+  for (size_t i = 0; i < num_atoms; i++) {
+    pos2[i] = 10.0 * cvm::atom_pos(random_real(), random_real(), random_real());
+    pos1[i] = rot_ref.rotate(pos2[i]) +
+      0.5 * cvm::atom_pos(random_real(), random_real(), random_real());
+    pos1_x[i] = pos1[i].x;
+    pos1_y[i] = pos1[i].y;
+    pos1_z[i] = pos1[i].z;
+  }
+
+  cvm::rotation rot_aos, rot_soa;
+
+  std::clock_t start = std::clock();
+  for (size_t iter = 0; iter < num_iter; iter++) {
+    rot_aos.calc_optimal_rotation(pos1, pos2);
+  }
+  double const t_fit_aos = double(std::clock() - start) /
+    double(CLOCKS_PER_SEC) / double(num_iter);
+
+  start = std::clock();
+  for (size_t iter = 0; iter < num_iter; iter++) {
+    rot_soa.calc_optimal_rotation(pos1_x, pos1_y, pos1_z, pos2);
+  }
+  double const t_fit_soa = double(std::clock() - start) /
+    double(CLOCKS_PER_SEC) / double(num_iter);
+
+  // Rotate the coordinates forth and back, so that they stay bounded
+  cvm::rmatrix const rot_mat = rot_soa.matrix();
+  cvm::rmatrix const rot_mat_t = rot_soa.inverse().matrix();
+  cvm::rmatrix const *mats[2] = { &rot_mat, &rot_mat_t };
+
+  start = std::clock();
+  for (size_t iter = 0; iter < num_iter; iter++) {
+    cvm::rmatrix const &m = *(mats[iter % 2]);
+    for (size_t i = 0; i < num_atoms; i++) {
+      pos1[i] = m * pos1[i];
+    }
+  }
+  double const t_rot_aos = double(std::clock() - start) /
+    double(CLOCKS_PER_SEC) / double(num_iter);
+
+  start = std::clock();
+  for (size_t iter = 0; iter < num_iter; iter++) {
+    cvm::rmatrix const &m = *(mats[iter % 2]);
+    cvm::real const rxx = m.xx(), rxy = m.xy(), rxz = m.xz();
+    cvm::real const ryx = m.yx(), ryy = m.yy(), ryz = m.yz();
+    cvm::real const rzx = m.zx(), rzy = m.zy(), rzz = m.zz();
+    cvm::real *px = &(pos1_x[0]), *py = &(pos1_y[0]), *pz = &(pos1_z[0]);
+    for (size_t i = 0; i < num_atoms; i++) {
+      cvm::real const x = px[i], y = py[i], z = pz[i];
+      px[i] = rxx * x + rxy * y + rxz * z;
+      py[i] = ryx * x + ryy * y + ryz * z;
+      pz[i] = rzx * x + rzy * y + rzz * z;
+    }
+  }
+  double const t_rot_soa = double(std::clock() - start) /
+    double(CLOCKS_PER_SEC) / double(num_iter);
+
+  cvm::real max_pos_diff = 0.0;
+  for (size_t i = 0; i < num_atoms; i++) {
+    cvm::real const diff =
+      (pos1[i] - cvm::atom_pos(pos1_x[i], pos1_y[i], pos1_z[i])).norm();
+    if (diff > max_pos_diff) max_pos_diff = diff;
+  }
+
+  std::cout << "Atoms                        = " << num_atoms << std::endl;
+  std::cout << "|q (AoS) - q (SoA)|          = "
+            << cvm::to_str((rot_aos.q - rot_soa.q).norm(),
+                           cvm::cv_width, cvm::cv_prec) << std::endl;
+  std::cout << "max |rotated pos difference| = "
+            << cvm::to_str(max_pos_diff, cvm::cv_width, cvm::cv_prec)
+            << std::endl;
+  std::cout << "Time per fit, AoS (s)        = " << t_fit_aos << std::endl;
+  std::cout << "Time per fit, SoA (s)        = " << t_fit_soa << std::endl;
+  std::cout << "Time per rotation, AoS (s)   = " << t_rot_aos << std::endl;
+  std::cout << "Time per rotation, SoA (s)   = " << t_rot_soa << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+
+#include "colvarmodule.h"
+#include "colvar.h"
+#include "colvarproxy_test.h"
+
+
+// Check that geometric path variables evaluating only a window of frames
+// around the closest one (frameWindow) have the same values as those
+// evaluating all frames, along a trajectory that moves back and forth along
+// the path and also jumps between distant frames
+
+namespace {
+
+size_t const num_atoms = 12;
+size_t const num_frames = 20;
+size_t const num_steps = 200;
+
+std::vector<cvm::atom_pos> base_pos, path_dir;
+
+std::vector<cvm::atom_pos> path_positions(cvm::real t)
+{
+  std::vector<cvm::atom_pos> pos(num_atoms);
+  for (size_t i = 0; i < num_atoms; i++) {
+    pos[i] = base_pos[i] + t * path_dir[i];
+  }
+  return pos;
+}
+
+std::string frame_filename(size_t f)
+{
+  return "gpath_frame_window_" + cvm::to_str(f+1) + ".xyz";
+}
+
+std::string const path_filename("gpath_frame_window.path");
+
+/// Write the reference frames as XYZ files, and the values of the distances
+/// used by the CV-based paths as a path file
+void write_frames()
+{
+  std::ofstream path_os(path_filename.c_str());
+  for (size_t f = 0; f < num_frames; f++) {
+    std::vector<cvm::atom_pos> pos = path_positions(cvm::real(f));
+    for (size_t i = 0; i < num_atoms; i++) {
+      pos[i] += colvarproxy_test_utils::random_pos(0.05);
+    }
+    std::ofstream os(frame_filename(f).c_str());
+    os << num_atoms << "\n\n";
+    os.precision(12);
+    for (size_t i = 0; i < num_atoms; i++) {
+      os << "C " << pos[i].x << " " << pos[i].y << " " << pos[i].z << "\n";
+    }
+    path_os.precision(12);
+    for (size_t k = 0; k < 3; k++) {
+      path_os << (k ? " " : "") << (pos[2*k+1] - pos[2*k]).norm();
+    }
+    path_os << "\n";
+  }
+}
+
+void remove_frames()
+{
+  for (size_t f = 0; f < num_frames; f++) {
+    std::remove(frame_filename(f).c_str());
+  }
+  std::remove(path_filename.c_str());
+}
+
+std::string cartesian_path_conf(std::string const &name,
+                                std::string const &type,
+                                std::string const &window_conf)
+{
+  std::ostringstream os;
+  os << "colvar {\n"
+     << "  name " << name << "\n"
+     << "  " << type << " {\n"
+     << "    atoms {\n"
+     << "      atomNumbersRange 1-" << num_atoms << "\n"
+     << "    }\n";
+  for (size_t f = 0; f < num_frames; f++) {
+    os << "    refPositionsFile" << f+1 << " " << frame_filename(f) << "\n";
+  }
+  os << window_conf
+     << "  }\n"
+     << "}\n";
+  return os.str();
+}
+
+std::string cv_path_conf(std::string const &name,
+                         std::string const &type,
+                         std::string const &window_conf)
+{
+  std::ostringstream os;
+  os << "colvar {\n"
+     << "  name " << name << "\n"
+     << "  " << type << " {\n";
+  for (size_t k = 0; k < 3; k++) {
+    os << "    distance {\n"
+       << "      name d" << k+1 << "\n"
+       << "      group1 {\n"
+       << "        atomNumbers " << 2*k+1 << "\n"
+       << "      }\n"
+       << "      group2 {\n"
+       << "        atomNumbers " << 2*k+2 << "\n"
+       << "      }\n"
+       << "    }\n";
+  }
+  os << "    pathFile " << path_filename << "\n"
+     << window_conf
+     << "  }\n"
+     << "}\n";
+  return os.str();
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  std::srand(3);
+  base_pos.resize(num_atoms);
+  path_dir.resize(num_atoms);
+  for (size_t i = 0; i < num_atoms; i++) {
+    base_pos[i] = colvarproxy_test_utils::random_pos(5.0);
+    path_dir[i] = 0.2 * colvarproxy_test_utils::random_pos(1.0);
+  }
+  // the distances used by the CV-based paths grow steadily along the path,
+  // so that consecutive frames are also the closest ones
+  for (size_t k = 0; k < 3; k++) {
+    cvm::rvector const d = base_pos[2*k+1] - base_pos[2*k];
+    path_dir[2*k+1] = path_dir[2*k] + (0.3 / d.norm()) * d;
+  }
+  write_frames();
+
+  std::string const window_s("    frameWindow 3\n    fullScanFrequency 7\n");
+  std::string const window_z("    frameWindow 2\n    fullScanFrequency 0\n");
+  std::string const conf =
+    cartesian_path_conf("s_window", "gspath", window_s) +
+    cartesian_path_conf("s_full", "gspath", "") +
+    cartesian_path_conf("z_window", "gzpath", window_z) +
+    cartesian_path_conf("z_full", "gzpath", "") +
+    cv_path_conf("scv_window", "gspathCV", window_s) +
+    cv_path_conf("scv_full", "gspathCV", "") +
+    cv_path_conf("zcv_window", "gzpathCV", window_z) +
+    cv_path_conf("zcv_full", "gzpathCV", "");
+
+  colvarproxy_test *proxy = new colvarproxy_test();
+  if (proxy->colvars->read_config_string(conf) != COLVARS_OK) {
+    std::cerr << "Error: cannot read the configuration." << std::endl;
+    remove_frames();
+    return 1;
+  }
+  remove_frames();
+
+  char const *pairs[4][2] = {
+    { "s_window", "s_full" }, { "z_window", "z_full" },
+    { "scv_window", "scv_full" }, { "zcv_window", "zcv_full" } };
+
+  int failures = 0;
+  cvm::real const tol = 1.0e-10;
+  for (size_t step = 0; step < num_steps; step++) {
+    // back and forth along the whole path, with a jump halfway
+    cvm::real t = 1.0 + 0.5 * (num_frames - 3) * (1.0 - std::cos(0.05 * step));
+    if (step == num_steps/2) t = 2.0;
+    std::vector<cvm::atom_pos> pos = path_positions(t);
+    cvm::rotation const rot(0.01 * step, cvm::rvector(0.3, 1.0, 0.2));
+    for (size_t i = 0; i < num_atoms; i++) {
+      pos[i] = rot.rotate(pos[i]) + colvarproxy_test_utils::random_pos(0.05);
+      proxy->set_atom_position(i+1, pos[i]);
+    }
+    if (proxy->calc_step() != COLVARS_OK) {
+      std::cerr << "Error: cannot compute step " << step << "." << std::endl;
+      return 1;
+    }
+    for (size_t k = 0; k < 4; k++) {
+      cvm::real const x_window = cvm::colvar_by_name(pairs[k][0])->value().real_value;
+      cvm::real const x_full = cvm::colvar_by_name(pairs[k][1])->value().real_value;
+      if (cvm::fabs(x_window - x_full) > tol) {
+        std::cerr << "Error: " << pairs[k][0] << " at step " << step << " is "
+                  << x_window << " instead of " << x_full << std::endl;
+        failures++;
+      }
+    }
+  }
+
+  delete proxy;
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Windowed and full scans of the frames give the same values.");
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "colvarmodule.h"
+#include "colvarparse.h"
+#include "colvarproxy_test.h"
+
+
+// Check that colvarparse::key_lookup(), which looks up keywords in an index
+// of the configuration string, gives the same results as the previous
+// implementation (searching the string for each keyword) on randomly
+// generated configurations, including repeated lookups of the same keyword
+// and lookups in different strings of the same size
+
+namespace {
+
+size_t const num_configs = 2000;
+
+/// Previous implementation of colvarparse::key_lookup(), without the
+/// registration of the keyword and of the position of its value
+bool ref_key_lookup(std::string const &conf,
+                    char const *key_in,
+                    std::string *data,
+                    size_t *save_pos)
+{
+  std::string const white_space(colvarparse::white_space);
+  std::string const key(colvarparse::to_lower_cppstr(key_in));
+  std::string const conf_lower(colvarparse::to_lower_cppstr(conf));
+
+  if (data != NULL) {
+    data->clear();
+  }
+
+  size_t pos = conf_lower.find(key, (save_pos != NULL) ? *save_pos : 0);
+
+  while (true) {
+
+    if (pos == std::string::npos) {
+      return false;
+    }
+
+    bool b_isolated_left = true, b_isolated_right = true;
+
+    if (pos > 0) {
+      if (std::string("\n"+white_space+"}").find(conf[pos-1]) ==
+          std::string::npos) {
+        b_isolated_left = false;
+      }
+    }
+
+    if (pos < conf.size()-key.size()-1) {
+      if (std::string("\n"+white_space+"{").find(conf[pos+key.size()]) ==
+          std::string::npos) {
+        b_isolated_right = false;
+      }
+    }
+
+    bool const b_not_within_block =
+      (colvarparse::check_braces(conf, pos) == COLVARS_OK);
+
+    if (b_isolated_left && b_isolated_right && b_not_within_block) {
+      break;
+    }
+    pos = conf_lower.find(key, pos+key.size());
+  }
+
+  size_t pl = conf.rfind("\n", pos);
+  size_t line_begin = (pl == std::string::npos) ? 0 : pos;
+  size_t nl = conf.find("\n", pos);
+  size_t line_end = (nl == std::string::npos) ? conf.size() : nl;
+  std::string line(conf, line_begin, (line_end-line_begin));
+
+  size_t data_begin =
+    (colvarparse::to_lower_cppstr(line)).find(key) + key.size();
+  data_begin = line.find_first_not_of(white_space, data_begin+1);
+
+  if (data_begin != std::string::npos) {
+
+    size_t data_end = line.find_last_not_of(white_space) + 1;
+    data_end = (data_end == std::string::npos) ? line.size() : data_end;
+
+    size_t brace = line.find('{', data_begin);
+    size_t brace_last = brace;
+
+    if (brace != std::string::npos) {
+
+      int brace_count = 1;
+
+      while (brace_count > 0) {
+
+        brace = line.find_first_of("{}", brace_last+1);
+        while (brace < std::string::npos) {
+          brace_last = brace;
+          if (line[brace] == '{') brace_count++;
+          if (line[brace] == '}') brace_count--;
+          if (brace_count == 0) {
+            data_end = brace+1;
+            break;
+          }
+          brace = line.find_first_of("{}", brace+1);
+        }
+
+        if (brace_count == 0) {
+          data_end = brace+1;
+          break;
+        }
+
+        if (brace == std::string::npos) {
+          if (line_end >= conf.size()) {
+            return false;
+          }
+          line_begin = line_end;
+          nl = conf.find('\n', line_begin+1);
+          if (nl == std::string::npos)
+            line_end = conf.size();
+          else
+            line_end = nl;
+          line.append(conf, line_begin, (line_end-line_begin));
+        }
+      }
+
+      data_begin = line.find_first_of('{') + 1;
+      data_begin = line.find_first_not_of(white_space, data_begin);
+
+      data_end = line.find_last_of('}', line.size()) - 1;
+      data_end = line.find_last_not_of(white_space, data_end) + 1;
+    }
+
+    if (data != NULL) {
+      data->append(line, data_begin, (data_end-data_begin));
+    }
+  }
+
+  if (save_pos != NULL) *save_pos = line_end;
+
+  return true;
+}
+
+char const *words[] = { "name", "Name", "NAME", "colvar", "colvars", "width",
+                        "x", "1.0", "name2", "atomNumbers", "atoms" };
+size_t const num_words = sizeof(words) / sizeof(words[0]);
+
+char const *separators[] = { " ", "  ", "\t", "\n", " \n", "\n  ", "" };
+size_t const num_separators = sizeof(separators) / sizeof(separators[0]);
+
+/// Keywords looked up, including some that cannot be indexed
+char const *keys[] = { "name", "NAME", "colvar", "colvars", "width", "x",
+                       "atomnumbers", "atoms", "nam", "ame", "name2", "1.0",
+                       "width 1.0", "colvar {" };
+size_t const num_keys = sizeof(keys) / sizeof(keys[0]);
+
+size_t random_index(size_t n)
+{
+  return size_t(std::rand()) % n;
+}
+
+/// Random configuration string with balanced braces
+std::string random_config(int depth)
+{
+  std::string conf;
+  size_t const num_items = 1 + random_index(8);
+  for (size_t i = 0; i < num_items; i++) {
+    conf += separators[random_index(num_separators)];
+    conf += words[random_index(num_words)];
+    if ((depth < 3) && (random_index(4) == 0)) {
+      conf += separators[random_index(num_separators)];
+      conf += "{";
+      conf += random_config(depth+1);
+      conf += "}";
+    }
+  }
+  conf += separators[random_index(num_separators)];
+  return conf;
+}
+
+/// Look up all instances of key in conf with both implementations, and
+/// count the differences
+int compare_lookups(colvarparse &parse, std::string const &conf,
+                    char const *key)
+{
+  size_t save_pos = 0, ref_save_pos = 0;
+  for (size_t n = 0; n <= conf.size(); n++) {
+    std::string data, ref_data;
+    bool const found = parse.key_lookup(conf, key, &data, &save_pos);
+    bool const ref_found = ref_key_lookup(conf, key, &ref_data, &ref_save_pos);
+    if ((found != ref_found) || (data != ref_data) ||
+        (save_pos != ref_save_pos)) {
+      std::cerr << "Error: lookup " << n+1 << " of \"" << key << "\" in \""
+                << conf << "\" gives (" << found << ", \"" << data << "\", "
+                << save_pos << ") instead of (" << ref_found << ", \""
+                << ref_data << "\", " << ref_save_pos << ")" << std::endl;
+      return 1;
+    }
+    if (!found) break;
+  }
+  return 0;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  colvarproxy_test *proxy = new colvarproxy_test();
+  colvarparse parse;
+
+  std::srand(19);
+  int failures = 0;
+  for (size_t c = 0; c < num_configs; c++) {
+    std::string conf = random_config(0);
+    for (size_t k = 0; k < num_keys; k++) {
+      failures += compare_lookups(parse, conf, keys[k]);
+    }
+    // Change one character other than a brace: the index must be rebuilt
+    // for the new string, which has the same size
+    size_t i = random_index(conf.size());
+    while ((conf[i] == '{') || (conf[i] == '}')) {
+      i = random_index(conf.size());
+    }
+    conf[i] = (random_index(2) == 0) ? ' ' : 'x';
+    for (size_t k = 0; k < num_keys; k++) {
+      failures += compare_lookups(parse, conf, keys[k]);
+    }
+    if (failures > 10) break;
+  }
+
+  cvm::clear_error();
+  delete proxy;
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Indexed keyword lookups give the same results as direct searches.");
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+#include "colvarmodule.h"
+#include "colvartypes.h"
+
+
+// Compare the QCP and Jacobi solutions of the optimal rotation problem on
+// synthetic coordinates, and time both
+
+namespace {
+
+cvm::real random_real()
+{
+  return 2.0 * (cvm::real(std::rand()) / cvm::real(RAND_MAX)) - 1.0;
+}
+
+double time_rotation(cvm::rotation &rot,
+                     std::vector<cvm::atom_pos> const &pos1,
+                     std::vector<cvm::atom_pos> const &pos2,
+                     size_t num_iter)
+{
+  std::clock_t const start = std::clock();
+  for (size_t iter = 0; iter < num_iter; iter++) {
+    rot.calc_optimal_rotation(pos1, pos2);
+  }
+  return double(std::clock() - start) / double(CLOCKS_PER_SEC) /
+    double(num_iter);
+}
+
+}
+
+
+extern "C" int main(int argc, char *argv[]) {
+
+  size_t const num_atoms = (argc > 1) ? std::atoi(argv[1]) : 100;
+  size_t const num_iter = (argc > 2) ? std::atoi(argv[2]) : 10000;
+
+  std::srand(1);
+
+  // Reference, and rotated + perturbed copy, both centered
+  std::vector<cvm::atom_pos> pos1(num_atoms), pos2(num_atoms);
+  cvm::rotation const rot_ref(1.0, cvm::rvector(0.3, -0.5, 0.8));
+  cvm::atom_pos cog1(0.0), cog2(0.0);
+  for (size_t i = 0; i < num_atoms; i++) {
+    pos1[i] = 10.0 * cvm::atom_pos(random_real(), random_real(), random_real());
+    pos2[i] = rot_ref.rotate(pos1[i]) +
+      0.5 * cvm::atom_pos(random_real(), random_real(), random_real());
+    cog1 += pos1[i];
+    cog2 += pos2[i];
+  }
+  for (size_t i = 0; i < num_atoms; i++) {
+    pos1[i] -= cog1 / cvm::real(num_atoms);
+    pos2[i] -= cog2 / cvm::real(num_atoms);
+  }
+
+  cvm::rotation rot_jacobi, rot_qcp;
+  rot_jacobi.request_group1_gradients(num_atoms);
+  rot_qcp.request_group1_gradients(num_atoms);
+
+  cvm::rotation::use_qcp = false;
+  double const t_jacobi = time_rotation(rot_jacobi, pos1, pos2, num_iter);
+  cvm::rotation::use_qcp = true;
+  double const t_qcp = time_rotation(rot_qcp, pos1, pos2, num_iter);
+
+  // The two eigenvectors may differ by their sign
+  cvm::real const sign = (rot_jacobi.q.inner(rot_qcp.q) < 0.0) ? -1.0 : 1.0;
+  cvm::real max_dq0_diff = 0.0;
+  for (size_t i = 0; i < num_atoms; i++) {
+    for (size_t p = 0; p < 4; p++) {
+      cvm::real const diff =
+        (rot_jacobi.dQ0_1[i][p] - sign * rot_qcp.dQ0_1[i][p]).norm();
+      if (diff > max_dq0_diff) max_dq0_diff = diff;
+    }
+  }
+
+  std::cout << "Atoms                     = " << num_atoms << std::endl;
+  std::cout << "lambda (Jacobi)           = "
+            << cvm::to_str(rot_jacobi.lambda, cvm::cv_width, cvm::cv_prec)
+            << std::endl;
+  std::cout << "lambda (QCP)              = "
+            << cvm::to_str(rot_qcp.lambda, cvm::cv_width, cvm::cv_prec)
+            << std::endl;
+  std::cout << "|q (Jacobi) - q (QCP)|    = "
+            << cvm::to_str((rot_jacobi.q - sign * rot_qcp.q).norm(),
+                           cvm::cv_width, cvm::cv_prec) << std::endl;
+  std::cout << "max |dQ0 difference|      = "
+            << cvm::to_str(max_dq0_diff, cvm::cv_width, cvm::cv_prec)
+            << std::endl;
+  std::cout << "Time per call, Jacobi (s) = " << t_jacobi << std::endl;
+  std::cout << "Time per call, QCP (s)    = " << t_qcp << std::endl;
+
+  return 0;
+}
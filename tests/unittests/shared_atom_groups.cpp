@@ -0,0 +1,237 @@
+#include <iostream>
+#include <sstream>
+#include <cmath>
+
+#include "colvarmodule.h"
+#include "colvar.h"
+#include "colvarproxy_test.h"
+
+
+// Check that atom groups with the same atoms and fitting options, computed
+// only once and with their forces summed, give the same energies and forces
+// as the same variables defined each on its own; this includes steps where
+// the variable that owns the shared data is inactive, and the deletion of
+// that variable
+
+namespace {
+
+size_t const num_atoms = 7;
+size_t const num_steps = 5;
+
+/// Steps from which the first variable (and its bias) is deleted
+size_t const delete_step = 3;
+
+cvm::real const ref_coords[6][3] = {
+  { 0.0, 0.0, 0.0 }, { 1.5, 0.0, 0.0 }, { 1.5, 1.5, 0.0 },
+  { 0.0, 1.5, 0.5 }, { 0.5, 0.5, 1.5 }, { 2.0, 1.0, 1.5 } };
+
+std::string ref_positions_conf()
+{
+  std::ostringstream os;
+  os << "refPositions";
+  for (size_t i = 0; i < 6; i++) {
+    os << " (" << ref_coords[i][0] << ", " << ref_coords[i][1] << ", "
+       << ref_coords[i][2] << ")";
+  }
+  return os.str();
+}
+
+/// Variables using the same fitted group, each with a restraint: the first
+/// one is defined first (so its group provides the shared data) and is
+/// computed only every other step
+std::string colvar_conf(size_t k)
+{
+  std::ostringstream os;
+  if (k == 0) {
+    os << "colvar {\n"
+       << "  name d\n"
+       << "  timeStepFactor 2\n"
+       << "  distance {\n"
+       << "    group1 {\n"
+       << "      atomNumbers 1 2 3 4 5 6\n"
+       << "      centerToReference yes\n"
+       << "      rotateToReference yes\n"
+       << "      " << ref_positions_conf() << "\n"
+       << "    }\n"
+       << "    group2 {\n"
+       << "      atomNumbers 7\n"
+       << "    }\n"
+       << "  }\n"
+       << "}\n"
+       << "harmonic {\n"
+       << "  colvars d\n"
+       << "  timeStepFactor 2\n"
+       << "  centers 2.0\n"
+       << "  forceConstant 5.0\n"
+       << "}\n";
+  }
+  if (k == 1) {
+    os << "colvar {\n"
+       << "  name r\n"
+       << "  rmsd {\n"
+       << "    atoms {\n"
+       << "      atomNumbers 1 2 3 4 5 6\n"
+       << "    }\n"
+       << "    " << ref_positions_conf() << "\n"
+       << "  }\n"
+       << "}\n"
+       << "harmonic {\n"
+       << "  colvars r\n"
+       << "  centers 0.5\n"
+       << "  forceConstant 20.0\n"
+       << "}\n";
+  }
+  if (k == 2) {
+    os << "colvar {\n"
+       << "  name e\n"
+       << "  eigenvector {\n"
+       << "    atoms {\n"
+       << "      atomNumbers 1 2 3 4 5 6\n"
+       << "    }\n"
+       << "    " << ref_positions_conf() << "\n"
+       << "    vector (1.0, 0.0, 0.0) (0.0, 1.0, 0.0) (0.0, 0.0, 1.0)"
+       << " (-1.0, 0.0, 0.0) (0.0, -1.0, 0.0) (0.0, 0.0, -1.0)\n"
+       << "  }\n"
+       << "}\n"
+       << "harmonic {\n"
+       << "  colvars e\n"
+       << "  centers 1.0\n"
+       << "  forceConstant 10.0\n"
+       << "}\n";
+  }
+  return os.str();
+}
+
+/// Proxy that records whether any atom groups were found to be shared
+class colvarproxy_shared_test : public colvarproxy_test {
+public:
+  bool found_shared;
+  colvarproxy_shared_test() : found_shared(false) {}
+  void log(std::string const &message)
+  {
+    if (message.find("atom groups identical to others") != std::string::npos) {
+      found_shared = true;
+    }
+  }
+};
+
+std::vector<cvm::atom_pos> step_positions(size_t step)
+{
+  std::srand(1 + step);
+  std::vector<cvm::atom_pos> pos(num_atoms);
+  for (size_t i = 0; i < 6; i++) {
+    pos[i] = cvm::atom_pos(ref_coords[i][0], ref_coords[i][1], ref_coords[i][2]) +
+      colvarproxy_test_utils::random_pos(0.3);
+  }
+  pos[6] = cvm::atom_pos(3.0, 3.0, 3.0) + colvarproxy_test_utils::random_pos(0.3);
+  return pos;
+}
+
+struct step_result {
+  cvm::real energy;
+  std::vector<cvm::rvector> forces;
+  step_result() : energy(0.0), forces(num_atoms, cvm::rvector(0.0)) {}
+};
+
+/// Run num_steps steps of a module defining the given variables; if
+/// delete_first is true, delete the first variable at delete_step
+int run(std::vector<size_t> const &cvs, bool delete_first,
+        std::vector<step_result> &results, bool &found_shared)
+{
+  colvarproxy_shared_test *proxy = new colvarproxy_shared_test();
+  std::string conf;
+  for (size_t k = 0; k < cvs.size(); k++) {
+    conf += colvar_conf(cvs[k]);
+  }
+  if (proxy->colvars->read_config_string(conf) != COLVARS_OK) {
+    std::cerr << "Error: cannot read the configuration." << std::endl;
+    delete proxy;
+    return 1;
+  }
+  found_shared = proxy->found_shared;
+
+  results.assign(num_steps, step_result());
+  for (size_t step = 0; step < num_steps; step++) {
+    if (delete_first && (step == delete_step)) {
+      delete cvm::colvar_by_name("d");
+    }
+    std::vector<cvm::atom_pos> const pos = step_positions(step);
+    for (size_t i = 0; i < num_atoms; i++) {
+      proxy->set_atom_position(i+1, pos[i]);
+    }
+    if (proxy->calc_step() != COLVARS_OK) {
+      std::cerr << "Error: cannot compute step " << step << "." << std::endl;
+      delete proxy;
+      return 1;
+    }
+    results[step].energy = proxy->colvars->total_bias_energy;
+    for (size_t i = 0; i < num_atoms; i++) {
+      results[step].forces[i] = proxy->get_atom_force(i+1);
+    }
+  }
+
+  delete proxy;
+  return 0;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  // Reference: each variable in its own module, where nothing is shared
+  std::vector<step_result> ref_results(num_steps);
+  for (size_t k = 0; k < 3; k++) {
+    std::vector<step_result> results;
+    bool found_shared = false;
+    if (run(std::vector<size_t>(1, k), false, results, found_shared)) {
+      return 1;
+    }
+    for (size_t step = 0; step < num_steps; step++) {
+      if ((k == 0) && (step >= delete_step)) continue;
+      ref_results[step].energy += results[step].energy;
+      for (size_t i = 0; i < num_atoms; i++) {
+        ref_results[step].forces[i] += results[step].forces[i];
+      }
+    }
+  }
+
+  std::vector<size_t> all_cvs;
+  for (size_t k = 0; k < 3; k++) all_cvs.push_back(k);
+  std::vector<step_result> results;
+  bool found_shared = false;
+  if (run(all_cvs, true, results, found_shared)) {
+    return 1;
+  }
+
+  int failures = 0;
+  if (!found_shared) {
+    std::cerr << "Error: the atom groups were not shared." << std::endl;
+    failures++;
+  }
+
+  cvm::real const tol = 1.0e-10;
+  for (size_t step = 0; step < num_steps; step++) {
+    if ((ref_results[step].energy == 0.0) ||
+        (cvm::fabs(results[step].energy - ref_results[step].energy) >
+         tol * (1.0 + cvm::fabs(ref_results[step].energy)))) {
+      std::cerr << "Error: energy at step " << step << " is "
+                << results[step].energy << " instead of "
+                << ref_results[step].energy << std::endl;
+      failures++;
+    }
+    for (size_t i = 0; i < num_atoms; i++) {
+      cvm::rvector const &f = results[step].forces[i];
+      cvm::rvector const &f_ref = ref_results[step].forces[i];
+      if ((f - f_ref).norm() > tol * (1.0 + f_ref.norm())) {
+        std::cerr << "Error: force on atom " << i+1 << " at step " << step
+                  << " is " << f << " instead of " << f_ref << std::endl;
+        failures++;
+      }
+    }
+  }
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Shared atom groups give the same energies and forces as separate "
+    "ones.");
+}
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+
+#include "colvarmodule.h"
+#include "colvar.h"
+#include "colvarproxy_test.h"
+
+
+// Check that sub-components shared by composite components
+// (sharedSubComponents) give the same energies and forces as separate
+// sub-components, including steps where some of the composite components,
+// and all of the users of some sub-components, are inactive, and atom masses
+// set after the configuration
+
+namespace {
+
+size_t const num_atoms = 5;
+size_t const num_steps = 10;
+
+std::string const path_filename("shared_sub_cvcs.path");
+
+std::string distance_conf(std::string const &name, std::string const &atoms1,
+                          std::string const &atoms2)
+{
+  return "    distance {\n"
+    "      name " + name + "\n"
+    "      group1 {\n"
+    "        atomNumbers " + atoms1 + "\n"
+    "      }\n"
+    "      group2 {\n"
+    "        atomNumbers " + atoms2 + "\n"
+    "      }\n"
+    "    }\n";
+}
+
+std::string config(bool shared)
+{
+  std::string const sub_cvcs_12 =
+    distance_conf("d1", "1", "2") + distance_conf("d2", "3", "4");
+  std::string const sub_cvcs = sub_cvcs_12 + distance_conf("d3", "1 3", "5");
+  std::string const shared_conf = shared ? "    sharedSubComponents on\n" : "";
+  std::ostringstream os;
+  // the two path variables are the only users of d3, and are computed
+  // every other step
+  os << "colvar {\n"
+     << "  name s\n"
+     << "  timeStepFactor 2\n"
+     << "  gspathCV {\n" << sub_cvcs << shared_conf
+     << "    pathFile " << path_filename << "\n"
+     << "  }\n"
+     << "}\n"
+     << "colvar {\n"
+     << "  name z\n"
+     << "  timeStepFactor 2\n"
+     << "  gzpathCV {\n" << sub_cvcs << shared_conf
+     << "    pathFile " << path_filename << "\n"
+     << "  }\n"
+     << "}\n"
+     << "colvar {\n"
+     << "  name l\n"
+     << "  linearCombination {\n" << sub_cvcs_12 << shared_conf
+     << "  }\n"
+     << "}\n"
+     << "harmonic {\n"
+     << "  colvars s\n"
+     << "  centers 0.3\n"
+     << "  forceConstant 10.0\n"
+     << "}\n"
+     << "harmonic {\n"
+     << "  colvars z\n"
+     << "  centers 0.0\n"
+     << "  forceConstant 10.0\n"
+     << "}\n"
+     << "harmonic {\n"
+     << "  colvars l\n"
+     << "  centers 5.0\n"
+     << "  forceConstant 1.0\n"
+     << "}\n";
+  return os.str();
+}
+
+struct step_result {
+  cvm::real energy;
+  std::vector<cvm::rvector> forces;
+};
+
+int run(bool shared, std::vector<step_result> &results)
+{
+  colvarproxy_test *proxy = new colvarproxy_test();
+  if (proxy->colvars->read_config_string(config(shared)) != COLVARS_OK) {
+    std::cerr << "Error: cannot read the configuration." << std::endl;
+    delete proxy;
+    return 1;
+  }
+  // Masses are only known after the configuration, as in LAMMPS: the atom
+  // groups of the shared sub-components must be updated too
+  for (size_t i = 0; i < num_atoms; i++) {
+    proxy->set_atom_mass(i+1, 1.0 + 2.0*i);
+  }
+  proxy->colvars->setup();
+  std::srand(11);
+  results.resize(num_steps);
+  for (size_t step = 0; step < num_steps; step++) {
+    if (colvarproxy_test_utils::calc_random_step(proxy, num_atoms,
+                                                 cvm::rvector(1.0, 0.5, 0.0),
+                                                 1.5)) {
+      delete proxy;
+      return 1;
+    }
+    results[step].energy = proxy->colvars->total_bias_energy;
+    results[step].forces.resize(num_atoms);
+    for (size_t i = 0; i < num_atoms; i++) {
+      results[step].forces[i] = proxy->get_atom_force(i+1);
+    }
+  }
+  delete proxy;
+  return 0;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  {
+    std::ofstream os(path_filename.c_str());
+    for (size_t f = 0; f < 8; f++) {
+      os << 2.0 + 0.5*f << " " << 3.0 + 0.3*f << " " << 4.0 - 0.2*f << "\n";
+    }
+  }
+
+  std::vector<step_result> ref_results, results;
+  int const error_code = run(false, ref_results) || run(true, results);
+  std::remove(path_filename.c_str());
+  if (error_code) {
+    return 1;
+  }
+
+  int failures = 0;
+  cvm::real const tol = 1.0e-10;
+  for (size_t step = 0; step < num_steps; step++) {
+    if (cvm::fabs(results[step].energy - ref_results[step].energy) >
+        tol * (1.0 + cvm::fabs(ref_results[step].energy))) {
+      std::cerr << "Error: energy at step " << step << " is "
+                << results[step].energy << " instead of "
+                << ref_results[step].energy << std::endl;
+      failures++;
+    }
+    for (size_t i = 0; i < num_atoms; i++) {
+      cvm::rvector const &f = results[step].forces[i];
+      cvm::rvector const &f_ref = ref_results[step].forces[i];
+      if ((f_ref.norm() == 0.0) || ((f - f_ref).norm() > tol * (1.0 + f_ref.norm()))) {
+        std::cerr << "Error: force on atom " << i+1 << " at step " << step
+                  << " is " << f << " instead of " << f_ref << std::endl;
+        failures++;
+      }
+    }
+  }
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Shared sub-components give the same energies and forces as separate "
+    "ones.");
+}
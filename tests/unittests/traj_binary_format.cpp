@@ -0,0 +1,255 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+
+#include "colvarmodule.h"
+#include "colvar.h"
+#include "colvarbias.h"
+#include "colvartraj.h"
+#include "colvarproxy_test.h"
+
+
+// Check that the text and binary formats of the Colvars trajectory contain
+// the same frames: write both from the same simulation, read them back and
+// compare them with the values computed at each step, including steps
+// following the deletion of a bias (which changes the columns)
+
+namespace {
+
+size_t const num_atoms = 4;
+size_t const num_steps = 6;
+
+/// Step at which the bias "hv" is deleted
+size_t const delete_step = 3;
+
+std::string const prefix_text("traj_binary_format_text");
+std::string const prefix_binary("traj_binary_format_binary");
+
+std::string config(bool binary)
+{
+  std::ostringstream os;
+  os << "colvarsTrajFrequency 1\n"
+     << "colvarsTrajFormat " << (binary ? "binary" : "text") << "\n"
+     << "colvar {\n"
+     << "  name d\n"
+     << "  outputAppliedForce on\n"
+     << "  distance {\n"
+     << "    group1 {\n"
+     << "      atomNumbers 1 2\n"
+     << "    }\n"
+     << "    group2 {\n"
+     << "      atomNumbers 3\n"
+     << "    }\n"
+     << "  }\n"
+     << "}\n"
+     << "colvar {\n"
+     << "  name v\n"
+     << "  distanceVec {\n"
+     << "    group1 {\n"
+     << "      atomNumbers 1\n"
+     << "    }\n"
+     << "    group2 {\n"
+     << "      atomNumbers 4\n"
+     << "    }\n"
+     << "  }\n"
+     << "}\n"
+     << "harmonic {\n"
+     << "  name hd\n"
+     << "  colvars d\n"
+     << "  centers 2.0\n"
+     << "  forceConstant 3.0\n"
+     << "  outputEnergy on\n"
+     << "}\n"
+     << "harmonic {\n"
+     << "  name hv\n"
+     << "  colvars v\n"
+     << "  centers (1.0, 0.5, -0.5)\n"
+     << "  forceConstant 2.0\n"
+     << "  outputEnergy on\n"
+     << "}\n";
+  return os.str();
+}
+
+/// Quantities computed at one step, in the order of the trajectory columns
+struct step_result {
+  cvm::step_number step;
+  std::vector<cvm::real> values;
+};
+
+/// Run the simulation writing the trajectory in the given format
+int run(bool binary, std::vector<step_result> &results)
+{
+  colvarproxy_test *proxy = new colvarproxy_test();
+  proxy->output_prefix() = binary ? prefix_binary : prefix_text;
+  if ((proxy->colvars->read_config_string(config(binary)) != COLVARS_OK) ||
+      (proxy->colvars->setup_output() != COLVARS_OK)) {
+    std::cerr << "Error: cannot set up the module." << std::endl;
+    delete proxy;
+    return 1;
+  }
+  std::srand(7);
+  results.resize(num_steps);
+  for (size_t step = 0; step < num_steps; step++) {
+    if (step == delete_step) {
+      delete cvm::bias_by_name("hv");
+    }
+    results[step].step = cvm::step_absolute();
+    if (colvarproxy_test_utils::calc_random_step(proxy, num_atoms,
+                                                 cvm::rvector(1.0, 0.0, 0.0),
+                                                 0.5)) {
+      delete proxy;
+      return 1;
+    }
+    std::vector<cvm::real> &values = results[step].values;
+    colvar *d = cvm::colvar_by_name("d");
+    colvarvalue const &v = cvm::colvar_by_name("v")->value();
+    values.push_back(d->value().real_value);
+    values.push_back(d->applied_force().real_value);
+    for (size_t k = 0; k < 3; k++) {
+      values.push_back(v[k]);
+    }
+    values.push_back(cvm::bias_by_name("hd")->get_energy());
+    if (step < delete_step) {
+      values.push_back(cvm::bias_by_name("hv")->get_energy());
+    }
+  }
+  // Closes the trajectory file
+  delete proxy;
+  return 0;
+}
+
+/// Read the frames of a text trajectory
+int read_text(std::string const &filename, std::vector<step_result> &frames)
+{
+  std::ifstream is(filename.c_str());
+  if (!is.good()) {
+    std::cerr << "Error: cannot open " << filename << std::endl;
+    return 1;
+  }
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty() || (line[0] == '#')) continue;
+    // vector values are written as "( x , y , z )"
+    for (size_t i = 0; i < line.size(); i++) {
+      if ((line[i] == '(') || (line[i] == ')') || (line[i] == ',')) {
+        line[i] = ' ';
+      }
+    }
+    std::istringstream line_is(line);
+    step_result frame;
+    line_is >> frame.step;
+    cvm::real x;
+    while (line_is >> x) {
+      frame.values.push_back(x);
+    }
+    frames.push_back(frame);
+  }
+  return 0;
+}
+
+/// Read the frames of a binary trajectory
+int read_binary(std::string const &filename, std::vector<step_result> &frames,
+                size_t &num_headers)
+{
+  std::ifstream is(filename.c_str(), std::ios::binary);
+  if (!is.good() || !colvartraj_frame::is_binary(is)) {
+    std::cerr << "Error: " << filename << " is not a binary trajectory."
+              << std::endl;
+    return 1;
+  }
+  colvartraj_frame frame;
+  std::vector<colvartraj_frame::column_group> groups;
+  num_headers = 0;
+  while (true) {
+    step_result result;
+    int const error_code = frame.read_binary(is, result.step);
+    if (error_code == COLVARS_NO_SUCH_FRAME) break;
+    if (error_code != COLVARS_OK) {
+      std::cerr << "Error: cannot read frame " << frames.size() << " of "
+                << filename << std::endl;
+      return 1;
+    }
+    if ((num_headers == 0) || (frame.groups().size() != groups.size())) {
+      groups = frame.groups();
+      num_headers++;
+    }
+    result.values = frame.values();
+    frames.push_back(result);
+  }
+  return 0;
+}
+
+int compare(char const *label, std::vector<step_result> const &frames,
+            std::vector<step_result> const &ref, cvm::real tol)
+{
+  int failures = 0;
+  if (frames.size() != ref.size()) {
+    std::cerr << "Error: the " << label << " trajectory has " << frames.size()
+              << " frames instead of " << ref.size() << std::endl;
+    return 1;
+  }
+  for (size_t f = 0; f < ref.size(); f++) {
+    if (frames[f].step != ref[f].step) {
+      std::cerr << "Error: frame " << f << " of the " << label
+                << " trajectory has step " << frames[f].step
+                << " instead of " << ref[f].step << std::endl;
+      failures++;
+    }
+    if (frames[f].values.size() != ref[f].values.size()) {
+      std::cerr << "Error: frame " << f << " of the " << label
+                << " trajectory has " << frames[f].values.size()
+                << " columns instead of " << ref[f].values.size() << std::endl;
+      failures++;
+      continue;
+    }
+    for (size_t i = 0; i < ref[f].values.size(); i++) {
+      cvm::real const x = frames[f].values[i];
+      cvm::real const x_ref = ref[f].values[i];
+      if (cvm::fabs(x - x_ref) > tol * (1.0 + cvm::fabs(x_ref))) {
+        std::cerr << "Error: column " << i << " of frame " << f << " of the "
+                  << label << " trajectory is " << x << " instead of "
+                  << x_ref << std::endl;
+        failures++;
+      }
+    }
+  }
+  return failures;
+}
+
+}
+
+
+extern "C" int main(int /* argc */, char * /* argv */ []) {
+
+  std::string const text_filename(prefix_text+".colvars.traj");
+  std::string const binary_filename(prefix_binary+".colvars.traj.bin");
+
+  std::vector<step_result> ref_text, ref_binary, frames_text, frames_binary;
+  size_t num_headers = 0;
+  int error_code = run(false, ref_text) || run(true, ref_binary) ||
+    read_text(text_filename, frames_text) ||
+    read_binary(binary_filename, frames_binary, num_headers);
+  std::remove(text_filename.c_str());
+  std::remove(binary_filename.c_str());
+  if (error_code) {
+    return 1;
+  }
+
+  int failures = 0;
+  // the binary format stores the values exactly, the text format with the
+  // default precision of 14 digits
+  failures += compare("binary", frames_binary, ref_binary, 0.0);
+  failures += compare("text", frames_text, ref_text, 1.0e-12);
+  failures += compare("text (against the binary)", frames_text, frames_binary,
+                      1.0e-12);
+  if (num_headers != 2) {
+    std::cerr << "Error: the binary trajectory has " << num_headers
+              << " headers instead of 2." << std::endl;
+    failures++;
+  }
+
+  return colvarproxy_test_utils::report_failures(failures,
+    "Text and binary trajectories contain the same frames.");
+}
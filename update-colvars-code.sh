@@ -217,7 +217,7 @@ then
   done
 
   # Update makefiles for library
-  for src in ${source}/lammps/lib/colvars/Makefile.{common,deps}
+  for src in ${source}/lammps/lib/colvars/Makefile.{common,deps,lammps.empty}
   do \
     tgt=$(basename ${src})
     condcopy "${src}" "${target}/lib/colvars/${tgt}"
@@ -103,6 +103,9 @@ public:
 
   virtual int check_atom_id(int atom_number);
 
+  virtual int init_atoms(std::vector<int> const &atom_numbers,
+                         std::vector<int> &indices);
+
   virtual int init_atom(cvm::residue_id const &residue,
                         std::string const     &atom_name,
                         std::string const     &segment_id);
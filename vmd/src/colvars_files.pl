@@ -7,7 +7,8 @@ our ( @colvars_cu );
 our ( @colvars_ccpp );
 our ( @colvars_h );
 
-$colvars_defines = " -DVMDCOLVARS";
+# -pthread is needed by the "smp threads" option (std::thread)
+$colvars_defines = " -DVMDCOLVARS -pthread";
 
 @colvars_cc      = ();
 @colvars_cu      = ();
@@ -43,6 +44,7 @@ $colvars_defines = " -DVMDCOLVARS";
                     'colvarscript_commands.C',
                     'colvarscript_commands_bias.C',
                     'colvarscript_commands_colvar.C',
+                    'colvartraj.C',
                     'colvartypes.C',
                     'colvarvalue.C',
                     'nr_jacobi.C');
@@ -73,6 +75,7 @@ $colvars_defines = " -DVMDCOLVARS";
                     'colvarscript_commands_bias.h',
                     'colvarscript_commands_colvar.h',
                     'colvars_version.h',
+                    'colvartraj.h',
                     'colvartypes.h',
                     'colvarvalue.h',
                     'nr_jacobi.h');